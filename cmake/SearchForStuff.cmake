@@ -18,16 +18,24 @@ find_package(assimp REQUIRED)
 
 #################################################
 # find VTK
-# required helper for generation of meshes for primitive shapes
-find_package(VTK REQUIRED)
+# optional helper for generation of meshes for primitive shapes. Without
+# VTK, only MeshShapeGeneratorNative is available.
+find_package(VTK QUIET)
 # This should ideally be included but leads to compile errors.
 #include(${VTK_USE_FILE})
 #message("################################ ${VTK_USE_FILE}")
 
-if(VTK_LIBRARIES)
-  set(VTK_LIBS ${VTK_LIBRARIES})
+if(VTK_FOUND)
+  message(STATUS "Found VTK, building MeshShapeGeneratorVtk")
+  add_definitions("-DHAVE_VTK")
+  if(VTK_LIBRARIES)
+    set(VTK_LIBS ${VTK_LIBRARIES})
+  else()
+    set(VTK_LIBS vtkHybrid vtkWidgets)
+  endif()
 else()
-  set(VTK_LIBS vtkHybrid vtkWidgets)
+  message(STATUS "VTK not found, building without MeshShapeGeneratorVtk")
+  set(VTK_LIBS)
 endif()
 
 #################################################
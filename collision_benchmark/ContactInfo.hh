@@ -26,6 +26,7 @@
 #include <memory>
 #include <iostream>
 #include <limits>
+#include <cassert>
 
 namespace collision_benchmark
 {
@@ -145,7 +146,7 @@ class ContactInfo
           model1(c.model1),
           modelPart1(c.modelPart1),
           model2(c.model2),
-          modelPart2(c.modelpart2) {}
+          modelPart2(c.modelPart2) {}
   public: virtual ~ContactInfo() {}
 
   // checks for validity of the contact configuration
@@ -206,6 +207,252 @@ class ContactInfo
   public: ModelID model2;
   public: ModelPartID modelPart2;
 };
+
+/**
+ * \brief Buffer of contact points between pairs of bodies, stored as
+ * structure of arrays.
+ *
+ * This holds the same information as a vector of ContactInfo,
+ * but each field of the contact points is stored in a contiguous array:
+ * Contact point *i* has the position ``positions[i]``, normal ``normals[i]``,
+ * and so on, and belongs to the pair of bodies at index ``pairIndices[i]``.
+ * The points of one pair are always stored consecutively.
+ *
+ * The buffer is meant to be owned by the caller of a contact query and
+ * re-used for subsequent queries. Clear() does not release any memory and
+ * does not destruct any elements, so once the buffer has grown to the
+ * largest number of contacts encountered, filling it again does not
+ * require any heap allocations (this includes ModelID and ModelPartID
+ * types like std::string which are re-assigned in-place).
+ * For this reason, the arrays can be larger than the number of contacts
+ * in the buffer: Only use the first NumContacts() (or NumPairs())
+ * elements.
+ *
+ * Template parameters:
+ * - Vector3Impl Math 3D vector implementation
+ * - WrenchImpl Math wrench implementation
+ * - ModelIdImpl ID type used to identify models in the world
+ * - ModelPartIdImpl ID type to identify individual parts of a model, e.g. links
+ */
+template<class Vector3Impl, class WrenchImpl,
+         typename ModelIdImpl, typename ModelPartIdImpl>
+class ContactBuffer
+{
+  public: typedef Vector3Impl Vector3;
+  public: typedef WrenchImpl Wrench;
+  public: typedef ModelIdImpl ModelID;
+  public: typedef ModelPartIdImpl ModelPartID;
+
+  private: typedef ContactBuffer<Vector3, Wrench, ModelID, ModelPartID> Self;
+  public: typedef std::shared_ptr<Self> Ptr;
+  public: typedef std::shared_ptr<const Self> ConstPtr;
+
+  public: ContactBuffer(): numPairs(0), numContacts(0) {}
+
+  /// Removes all contacts. Does not release any memory.
+  public: void Clear()
+  {
+    numPairs = 0;
+    numContacts = 0;
+  }
+
+  /// Reserves memory for the given number of pairs and contacts.
+  public: void Reserve(const std::size_t pairs, const std::size_t contacts)
+  {
+    model1.reserve(pairs);
+    modelPart1.reserve(pairs);
+    model2.reserve(pairs);
+    modelPart2.reserve(pairs);
+    pairBegin.reserve(pairs);
+    pairEnd.reserve(pairs);
+    positions.reserve(contacts);
+    normals.reserve(contacts);
+    wrenches.reserve(contacts);
+    depths.reserve(contacts);
+    pairIndices.reserve(contacts);
+  }
+
+  /// \return number of pairs of bodies in contact
+  public: std::size_t NumPairs() const { return numPairs; }
+
+  /// \return total number of contact points of all pairs
+  public: std::size_t NumContacts() const { return numContacts; }
+
+  /// \return true if there are no contacts in the buffer
+  public: bool Empty() const { return numPairs == 0; }
+
+  /// Starts a new pair of bodies. Subsequent calls of AddContact() will add
+  /// contact points to this pair. Like ContactInfo, model1 and model2 are
+  /// swapped if necessary, so that model1 is always 'smaller' than model2.
+  /// \return the index of the new pair
+  public: std::size_t AddPair(const ModelID &model1_,
+                              const ModelPartID &modelPart1_,
+                              const ModelID &model2_,
+                              const ModelPartID &modelPart2_)
+  {
+    const bool swap = !(model1_ < model2_);
+    Set(model1, numPairs, swap ? model2_ : model1_);
+    Set(modelPart1, numPairs, swap ? modelPart2_ : modelPart1_);
+    Set(model2, numPairs, swap ? model1_ : model2_);
+    Set(modelPart2, numPairs, swap ? modelPart1_ : modelPart2_);
+    Set(pairBegin, numPairs, numContacts);
+    Set(pairEnd, numPairs, numContacts);
+    return numPairs++;
+  }
+
+  /// Adds a contact point to the pair last added with AddPair().
+  public: void AddContact(const Vector3 &position,
+                          const Vector3 &normal,
+                          const Wrench &wrench,
+                          const double depth)
+  {
+    assert(numPairs > 0);
+    Set(positions, numContacts, position);
+    Set(normals, numContacts, normal);
+    Set(wrenches, numContacts, wrench);
+    Set(depths, numContacts, depth);
+    Set(pairIndices, numContacts, numPairs - 1);
+    ++numContacts;
+    pairEnd[numPairs - 1] = numContacts;
+  }
+
+  /// Removes the pair which was last added with AddPair(), including all
+  /// its contact points. Can be used if it turns out that there are no
+  /// valid contact points for the pair.
+  public: void RemoveLastPair()
+  {
+    if (numPairs == 0) return;
+    --numPairs;
+    numContacts = pairBegin[numPairs];
+  }
+
+  /// \return number of contact points of the pair at \e pairIdx
+  public: std::size_t NumContacts(const std::size_t pairIdx) const
+  {
+    return pairEnd[pairIdx] - pairBegin[pairIdx];
+  }
+
+  /// Returns maximum depth amongst all contacts of the pair at \e pairIdx
+  /// in \e max.
+  /// \return false if the pair has no contacts
+  public: bool MaxDepth(const std::size_t pairIdx, double &max) const
+  {
+    return MaxDepth(pairBegin[pairIdx], pairEnd[pairIdx], max);
+  }
+
+  /// Returns maximum depth amongst all contacts in the buffer in \e max.
+  /// \return false if the buffer has no contacts
+  public: bool MaxDepth(double &max) const
+  {
+    return MaxDepth(0, numContacts, max);
+  }
+
+  /// Adds the pair and all contacts in \e info to the buffer.
+  /// \param ContactInfoT any instantiated type of
+  ///    collision_benchmark::ContactInfo with compatible types.
+  public: template<class ContactInfoT>
+          void Append(const ContactInfoT &info)
+  {
+    AddPair(info.model1, info.modelPart1, info.model2, info.modelPart2);
+    for (typename std::vector<typename ContactInfoT::Contact>::const_iterator
+         cit = info.contacts.begin(); cit != info.contacts.end(); ++cit)
+    {
+      AddContact(cit->position, cit->normal, cit->wrench, cit->depth);
+    }
+  }
+
+  /// Adds all pairs and contacts in \e infos to the buffer.
+  /// \param ContactInfoPtrT shared pointer to any instantiated type of
+  ///    collision_benchmark::ContactInfo with compatible types.
+  public: template<class ContactInfoPtrT>
+          void Append(const std::vector<ContactInfoPtrT> &infos)
+  {
+    for (typename std::vector<ContactInfoPtrT>::const_iterator
+         it = infos.begin(); it != infos.end(); ++it)
+    {
+      Append(**it);
+    }
+  }
+
+  /// Copies the pair at \e pairIdx into \e info.
+  /// \param ContactInfoT any instantiated type of
+  ///    collision_benchmark::ContactInfo with compatible types.
+  public: template<class ContactInfoT>
+          void GetContactInfo(const std::size_t pairIdx,
+                              ContactInfoT &info) const
+  {
+    info.model1 = model1[pairIdx];
+    info.modelPart1 = modelPart1[pairIdx];
+    info.model2 = model2[pairIdx];
+    info.modelPart2 = modelPart2[pairIdx];
+    info.contacts.clear();
+    for (std::size_t i = pairBegin[pairIdx]; i < pairEnd[pairIdx]; ++i)
+    {
+      info.contacts.push_back(typename ContactInfoT::Contact
+                              (positions[i], normals[i],
+                               wrenches[i], depths[i]));
+    }
+  }
+
+  public: friend std::ostream &operator << (std::ostream &o, const Self &b)
+  {
+    for (std::size_t p = 0; p < b.numPairs; ++p)
+    {
+      if (p > 0) o << ", ";
+      o << "(Model1: " << b.model1[p] << "/" << b.modelPart1[p]
+        << ". Model2: " << b.model2[p] << "/" << b.modelPart2[p]
+        << "; Contacts: " << b.NumContacts(p) << ")";
+    }
+    return o;
+  }
+
+  // helper which sets \e vec[idx] to \e val, growing \e vec if needed.
+  // \e idx must not be larger than the size of \e vec.
+  private: template<typename T>
+           static void Set(std::vector<T> &vec, const std::size_t idx,
+                           const T &val)
+  {
+    if (idx < vec.size()) vec[idx] = val;
+    else vec.push_back(val);
+  }
+
+  // helper which gets the maximum depth of the contacts [begin, end)
+  private: bool MaxDepth(const std::size_t begin, const std::size_t end,
+                         double &max) const
+  {
+    if (begin >= end) return false;
+    max = -std::numeric_limits<double>::max();
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      if (depths[i] > max) max = depths[i];
+    }
+    return true;
+  }
+
+  // Contact point arrays. Only the first NumContacts() elements are valid.
+  public: std::vector<Vector3> positions;
+  public: std::vector<Vector3> normals;
+  public: std::vector<Wrench> wrenches;
+  // penetration depth (see Contact::depth)
+  public: std::vector<double> depths;
+  // index of the pair each contact point belongs to
+  public: std::vector<std::size_t> pairIndices;
+
+  // Pair arrays. Only the first NumPairs() elements are valid.
+  // model1 is always 'smaller' than model2.
+  public: std::vector<ModelID> model1;
+  public: std::vector<ModelPartID> modelPart1;
+  public: std::vector<ModelID> model2;
+  public: std::vector<ModelPartID> modelPart2;
+  // contact points of pair p are in the range [pairBegin[p], pairEnd[p])
+  public: std::vector<std::size_t> pairBegin;
+  public: std::vector<std::size_t> pairEnd;
+
+  // number of valid pairs
+  private: std::size_t numPairs;
+  // number of valid contact points
+  private: std::size_t numContacts;
+};
 }  // namespace
 
 #endif  // COLLISION_BENCHMARK_CONTACTINFO
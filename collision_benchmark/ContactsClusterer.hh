@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_CONTACTSCLUSTERER_H
+#define COLLISION_BENCHMARK_CONTACTSCLUSTERER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Clusters contact points into clusters of a maximum radius.
+ *
+ * Each point is added to the first cluster (in order of creation) whose
+ * center is not further than the tolerance radius away from the point.
+ * If there is no such cluster, a new cluster is created for the point.
+ * The center of a cluster is the average of all points added to it.
+ *
+ * The cluster centers are kept in a uniform spatial hash with a cell size
+ * equal to the tolerance radius, so only the clusters in the 27 cells
+ * around a point have to be checked when adding it, and the centers are
+ * updated incrementally. Adding n points is therefore close to linear in n
+ * instead of depending on the number of clusters.
+ *
+ * The tolerance is a property of each instance, so several instances can
+ * be used from different threads at the same time.
+ *
+ * \param Vector3 the vector type for the points. Has to support X(), Y(),
+ *  Z(), Length(), subtraction and division by a scalar.
+ */
+template<class Vector3>
+class ContactsClusterer
+{
+  /// \brief Constructor
+  /// \param[in] toleranceRadius the maximum distance of a point to the
+  ///   center of the cluster it is added to.
+  public: explicit ContactsClusterer(const double toleranceRadius = 0)
+  {
+    Clear(toleranceRadius);
+  }
+
+  /// \brief Removes all clusters and sets a new tolerance radius.
+  /// Memory allocated for the clusters is kept for re-use.
+  /// \param[in] toleranceRadius the maximum distance of a point to the
+  ///   center of the cluster it is added to.
+  public: void Clear(const double toleranceRadius)
+  {
+    this->tolerance = std::max(0.0, toleranceRadius);
+    // with a zero tolerance only equal points are clustered, so any
+    // cell size would do.
+    this->cellSize = this->tolerance > 0 ? this->tolerance : 1.0;
+    this->centers.clear();
+    this->sizes.clear();
+    this->cells.clear();
+  }
+
+  /// \brief Adds a point to the first cluster it fits into, or creates a
+  /// new cluster for it.
+  /// \param[in] p the point
+  /// \return index of the cluster the point was added to
+  public: std::size_t Add(const Vector3 &p)
+  {
+    const CellKey pCell = GetCell(p);
+    std::size_t found = std::numeric_limits<std::size_t>::max();
+    for (int dx = -1; dx <= 1; ++dx)
+    {
+      for (int dy = -1; dy <= 1; ++dy)
+      {
+        for (int dz = -1; dz <= 1; ++dz)
+        {
+          const CellKey key(pCell.x + dx, pCell.y + dy, pCell.z + dz);
+          typename CellMap::const_iterator cIt = this->cells.find(key);
+          if (cIt == this->cells.end()) continue;
+          for (std::vector<std::size_t>::const_iterator
+               it = cIt->second.begin(); it != cIt->second.end(); ++it)
+          {
+            if ((*it < found) &&
+                ((this->centers[*it] - p).Length() <= this->tolerance))
+              found = *it;
+          }
+        }
+      }
+    }
+
+    if (found == std::numeric_limits<std::size_t>::max())
+    {
+      found = this->centers.size();
+      this->centers.push_back(p);
+      this->sizes.push_back(1);
+      this->cells[pCell].push_back(found);
+      return found;
+    }
+
+    // update the running average and move the cluster to another
+    // cell if its center moved out of the current one
+    Vector3 &center = this->centers[found];
+    const CellKey oldCell = GetCell(center);
+    ++this->sizes[found];
+    center += (p - center) / static_cast<double>(this->sizes[found]);
+    const CellKey newCell = GetCell(center);
+    if (!(newCell == oldCell))
+    {
+      std::vector<std::size_t> &oldIdxs = this->cells[oldCell];
+      oldIdxs.erase(std::find(oldIdxs.begin(), oldIdxs.end(), found));
+      if (oldIdxs.empty()) this->cells.erase(oldCell);
+      this->cells[newCell].push_back(found);
+    }
+    return found;
+  }
+
+  /// \return number of clusters
+  public: std::size_t GetNumClusters() const
+  {
+    return this->centers.size();
+  }
+
+  /// \return center points of all clusters, in order of their creation
+  public: const std::vector<Vector3> &GetCenters() const
+  {
+    return this->centers;
+  }
+
+  /// \return number of points in each cluster, in order of their creation
+  public: const std::vector<std::size_t> &GetSizes() const
+  {
+    return this->sizes;
+  }
+
+  // \brief Integer coordinates of a cell in the spatial hash
+  private: struct CellKey
+  {
+    CellKey(const int64_t _x, const int64_t _y, const int64_t _z)
+      :x(_x), y(_y), z(_z) {}
+    bool operator==(const CellKey &o) const
+    {
+      return x == o.x && y == o.y && z == o.z;
+    }
+    int64_t x, y, z;
+  };
+
+  // \brief Hash function for CellKey
+  private: struct CellKeyHash
+  {
+    std::size_t operator()(const CellKey &k) const
+    {
+      // large primes to spread neighbouring cells over the buckets
+      return static_cast<std::size_t>(
+               (static_cast<uint64_t>(k.x) * 73856093u) ^
+               (static_cast<uint64_t>(k.y) * 19349663u) ^
+               (static_cast<uint64_t>(k.z) * 83492791u));
+    }
+  };
+
+  private: typedef std::unordered_map<CellKey, std::vector<std::size_t>,
+                                      CellKeyHash> CellMap;
+
+  // \brief returns the cell of the spatial hash which \e p lies in
+  private: CellKey GetCell(const Vector3 &p) const
+  {
+    return CellKey(static_cast<int64_t>(std::floor(p.X() / this->cellSize)),
+                   static_cast<int64_t>(std::floor(p.Y() / this->cellSize)),
+                   static_cast<int64_t>(std::floor(p.Z() / this->cellSize)));
+  }
+
+  // \brief maximum distance of a point to the center of its cluster
+  private: double tolerance;
+
+  // \brief edge length of the cells in the spatial hash
+  private: double cellSize;
+
+  // \brief center points of all clusters
+  private: std::vector<Vector3> centers;
+
+  // \brief number of points in each cluster
+  private: std::vector<std::size_t> sizes;
+
+  // \brief indices of the clusters with their center in each cell
+  private: CellMap cells;
+};
+}  // namespace collision_benchmark
+
+#endif  // COLLISION_BENCHMARK_CONTACTSCLUSTERER_H
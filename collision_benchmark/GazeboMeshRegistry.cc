@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboMeshRegistry.hh>
+#include <collision_benchmark/MeshHelper.hh>
+
+#include <gazebo/common/Mesh.hh>
+#include <gazebo/common/MeshManager.hh>
+
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using collision_benchmark::GazeboMeshRegistry;
+
+const std::string GazeboMeshRegistry::URI_PREFIX = "memory://";
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboMeshRegistry &GazeboMeshRegistry::Instance()
+{
+  static GazeboMeshRegistry instance;
+  return instance;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::string GazeboMeshRegistry::Register(const std::string &name,
+                                         const MeshDataT::ConstPtr &data,
+                                         const std::string &ext)
+{
+  if (!data || data->GetNumVertices() == 0 || data->GetNumFaces() == 0)
+  {
+    std::cerr << "Cannot register empty mesh " << name << std::endl;
+    return "";
+  }
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  std::string uri = URI_PREFIX + name + "." + ext;
+  for (int i = 1; ; ++i)
+  {
+    std::map<std::string, MeshDataT::ConstPtr>::const_iterator it =
+      this->meshes.find(uri);
+    if (it == this->meshes.end()) break;
+    // the same data was registered before
+    if (it->second == data) return uri;
+    std::stringstream str;
+    str << URI_PREFIX << name << "_" << i << "." << ext;
+    uri = str.str();
+  }
+
+  AddToMeshManager(uri, data);
+  this->meshes[uri] = data;
+  return uri;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboMeshRegistry::IsRegistered(const std::string &uri) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->meshes.find(uri) != this->meshes.end();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboMeshRegistry::MeshDataT::ConstPtr
+GazeboMeshRegistry::GetMeshData(const std::string &uri) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  std::map<std::string, MeshDataT::ConstPtr>::const_iterator it =
+    this->meshes.find(uri);
+  if (it == this->meshes.end()) return MeshDataT::ConstPtr();
+  return it->second;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboMeshRegistry::WriteToFile(const std::string &uri,
+                                     const std::string &filename) const
+{
+  MeshDataT::ConstPtr data = GetMeshData(uri);
+  if (!data)
+  {
+    std::cerr << "Mesh " << uri << " is not registered" << std::endl;
+    return false;
+  }
+  std::string ext = boost::filesystem::path(uri).extension().string();
+  if (!ext.empty() && ext[0] == '.') ext = ext.substr(1);
+  return collision_benchmark::WriteTrimesh(filename, ext, data);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboMeshRegistry::IsMemoryURI(const std::string &uri)
+{
+  return uri.compare(0, URI_PREFIX.size(), URI_PREFIX) == 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboMeshRegistry::AddToMeshManager(const std::string &uri,
+                                          const MeshDataT::ConstPtr &data)
+{
+  typedef MeshDataT::Index Index;
+
+  // no normals are needed because the mesh is only used by the physics
+  gazebo::common::SubMesh *subMesh = new gazebo::common::SubMesh();
+  subMesh->SetPrimitiveType(gazebo::common::SubMesh::TRIANGLES);
+  const std::vector<float> &vertices = data->GetVertexBuffer();
+  for (size_t i = 0; i + 2 < vertices.size(); i += 3)
+  {
+    subMesh->AddVertex(ignition::math::Vector3d(vertices[i], vertices[i+1],
+                                                vertices[i+2]));
+  }
+  const std::vector<Index> &indices = data->GetIndexBuffer();
+  for (std::vector<Index>::const_iterator it = indices.begin();
+       it != indices.end(); ++it)
+  {
+    subMesh->AddIndex(*it);
+  }
+
+  gazebo::common::Mesh *mesh = new gazebo::common::Mesh();
+  mesh->SetName(uri);
+  mesh->AddSubMesh(subMesh);
+  // the MeshManager takes ownership of the mesh
+  gazebo::common::MeshManager::Instance()->AddMesh(mesh);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_GAZEBOMESHREGISTRY_H
+#define COLLISION_BENCHMARK_GAZEBOMESHREGISTRY_H
+
+#include <collision_benchmark/MeshData.hh>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Serves mesh data to Gazebo directly from memory.
+ *
+ * Meshes are registered under a synthetic URI of the form
+ * ``memory://<name>.<ext>``, which can be used in the ``<uri>`` element
+ * of an SDF ``<mesh>``. Registering a mesh adds it to Gazebo's
+ * gazebo::common::MeshManager under this URI, where the physics engines
+ * look up meshes before trying to load them from file, so no file has to
+ * be written and parsed for each world.
+ *
+ * The URIs are only valid within this process, so they can't be used
+ * for visuals which are displayed in gzclient. GazeboPhysicsWorld only uses
+ * them for the collision shapes, which gzclient doesn't need to display the
+ * models. Files for the meshes are
+ * written with WriteToFile() only when they are needed, e.g. when the world
+ * is saved with GazeboPhysicsWorld::SaveToFile().
+ *
+ * Meshes can't be removed from gazebo::common::MeshManager, so they stay
+ * registered until the end of the process.
+ */
+class GazeboMeshRegistry
+{
+  public: typedef MeshData<float, 3> MeshDataT;
+
+  /// \brief Prefix of all URIs of registered meshes
+  public: static const std::string URI_PREFIX;
+
+  /// \return the instance of the registry
+  public: static GazeboMeshRegistry &Instance();
+
+  /// \brief Registers the mesh \e data under a URI generated from \e name.
+  /// If \e name was already registered with other data, a unique suffix
+  /// is added to the URI.
+  /// \param[in] name name of the mesh, which must be usable as a filename
+  /// \param[in] data the mesh data. Must not be changed after registering.
+  /// \param[in] ext file extension for the URI. Gazebo only accepts
+  ///   URIs with extensions of mesh formats it supports.
+  /// \return the URI, or an empty string if \e data is empty.
+  public: std::string Register(const std::string &name,
+                               const MeshDataT::ConstPtr &data,
+                               const std::string &ext = "stl");
+
+  /// \return true if \e uri is the URI of a registered mesh
+  public: bool IsRegistered(const std::string &uri) const;
+
+  /// \return the mesh data registered under \e uri, or NULL if there
+  ///   is no such mesh.
+  public: MeshDataT::ConstPtr GetMeshData(const std::string &uri) const;
+
+  /// \brief Writes the mesh registered under \e uri to \e filename, in the
+  /// format given by the extension of \e uri.
+  /// \return false if there is no such mesh or the file can't be written
+  public: bool WriteToFile(const std::string &uri,
+                           const std::string &filename) const;
+
+  /// \return true if \e uri starts with URI_PREFIX
+  public: static bool IsMemoryURI(const std::string &uri);
+
+  private: GazeboMeshRegistry() {}
+  private: GazeboMeshRegistry(const GazeboMeshRegistry&);
+  private: GazeboMeshRegistry &operator=(const GazeboMeshRegistry&);
+
+  // \brief Adds \e data as gazebo::common::Mesh with name \e uri to the
+  // gazebo::common::MeshManager.
+  private: static void AddToMeshManager(const std::string &uri,
+                                        const MeshDataT::ConstPtr &data);
+
+  // \brief all registered meshes by URI
+  private: std::map<std::string, MeshDataT::ConstPtr> meshes;
+
+  // \brief protects \e meshes
+  private: mutable std::mutex mutex;
+};
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_GAZEBOMESHREGISTRY_H
@@ -55,7 +55,9 @@ using collision_benchmark::StartWaiter;
 const std::string GazeboMultipleWorlds::MirrorName = "mirror";
 
 GazeboMultipleWorlds::GazeboMultipleWorlds()
-  : started(false)
+  : started(false),
+    interactiveMode(false),
+    headless(false)
 {
 }
 
@@ -67,11 +69,13 @@ GazeboMultipleWorlds::~GazeboMultipleWorlds()
 ///////////////////////////////////////////////////////////////////////////////
 bool GazeboMultipleWorlds::InitServer(const bool loadMirror,
                                       const bool allowControlViaMirror,
-                                      const bool enforceContactCalc)
+                                      const bool enforceContactCalc,
+                                      const bool headless)
 {
   started = false;
   GzMultipleWorldsServer::WorldLoader_M loaders =
-    collision_benchmark::GetSupportedGazeboWorldLoaders(enforceContactCalc);
+    collision_benchmark::GetSupportedGazeboWorldLoaders(enforceContactCalc,
+                                                        headless);
 
   if (loaders.empty())
   {
@@ -79,13 +83,19 @@ bool GazeboMultipleWorlds::InitServer(const bool loadMirror,
     return false;
   }
 
-  WorldLoader::Ptr universalLoader(new GazeboWorldLoader(enforceContactCalc));
+  WorldLoader::Ptr universalLoader(new GazeboWorldLoader(enforceContactCalc,
+                                                         headless));
 
   server.reset(new GazeboMultipleWorldsServer(loaders, universalLoader));
 
   int argc = 1;
   const char * argv = "MultipleWorldsServer";
-  server->Start(argc, &argv);
+  // fails e.g. if the port of the Gazebo master is in use
+  if (!server->Start(argc, &argv))
+  {
+    std::cerr << "Could not start the Gazebo server." << std::endl;
+    return false;
+  }
 
   std::string mirrorName = "";
   if (loadMirror) mirrorName = MirrorName;
@@ -358,7 +368,11 @@ bool GazeboMultipleWorlds::Init(const bool loadMirror,
   }
 
   // this must be the parent process
-  InitServer(loadMirror, allowControlViaMirror, enforceContactCalc);
+  if (!InitServer(loadMirror, allowControlViaMirror, enforceContactCalc,
+                  IsHeadless()))
+  {
+    return false;
+  }
   assert(server);
   return true;
 }
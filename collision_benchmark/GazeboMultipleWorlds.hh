@@ -79,8 +79,10 @@ class GazeboMultipleWorlds
   // Must be called before Run() and before Load().
   // A call to this function will fork the process with fork().
   // \param[in] useInteractiveMode flag whether the gzclient is to be loaded to
-  //      allow interactive mode. If false, gzclient is not loaded.
+  //      allow interactive mode.
   // \param[in] additionalGuis additional guis to load in gzclient
+  // \return false if the server could not be started, e.g. because the
+  //      port of the Gazebo master is in use.
   public: bool Init(const bool loadMirror = true,
                     const bool enforceContactCalc = false,
                     const bool allowControlViaMirror = true,
@@ -101,6 +103,16 @@ class GazeboMultipleWorlds
 
   public: bool InteractiveMode() { return interactiveMode; }
 
+  // \brief Sets whether the worlds are loaded in headless mode (see
+  // GazeboPhysicsWorld::SetHeadless()), so that setting model poses is not
+  // throttled. Disabled by default. Must be called before Init() to take
+  // effect.
+  public: void SetHeadless(const bool flag) { headless = flag; }
+
+  // \return whether the worlds are loaded in headless mode,
+  //    see SetHeadless()
+  public: bool IsHeadless() const { return headless; }
+
   // \brief Runs the multiple worlds server.
   // Can be run in blocking or non-blocking mode.
   //
@@ -152,9 +164,12 @@ class GazeboMultipleWorlds
   protected: bool IsParent() const;
 
     // Initializes the multiple worlds server
+    // \param[in] headless whether the worlds are loaded in headless mode,
+    //      see GazeboPhysicsWorld::SetHeadless()
   protected: bool InitServer(const bool loadMirror,
                              const bool allowControlViaMirror,
-                             const bool enforceContactCalc);
+                             const bool enforceContactCalc,
+                             const bool headless = false);
 
 
   protected: void KillClient();
@@ -175,6 +190,9 @@ class GazeboMultipleWorlds
   // \brief flag whether the gzclient is to be loaded to allow interactive mode
   private: bool interactiveMode;
 
+  // \brief flag whether the worlds are loaded in headless mode
+  private: bool headless;
+
 };  // class GazeboMultipleWorlds
 }  // namespace
 #endif  // COLLISION_BENCHMARK_GAZEBOMULTIPLEWORLDS_H
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboNamespaceNotifier.hh>
+
+#include <gazebo/transport/TopicManager.hh>
+
+#include <chrono>
+#include <functional>
+#include <list>
+
+using collision_benchmark::GazeboNamespaceNotifier;
+
+const int GazeboNamespaceNotifier::PollInterval;
+
+//////////////////////////////////////////////////////////////////////////
+GazeboNamespaceNotifier &GazeboNamespaceNotifier::Instance()
+{
+  static GazeboNamespaceNotifier instance;
+  return instance;
+}
+
+//////////////////////////////////////////////////////////////////////////
+GazeboNamespaceNotifier::GazeboNamespaceNotifier()
+  : numWaiters(0),
+    stop(false)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+GazeboNamespaceNotifier::~GazeboNamespaceNotifier()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stop = true;
+  }
+  this->waitersChanged.notify_all();
+  if (this->watcher.joinable()) this->watcher.join();
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool GazeboNamespaceNotifier::WaitFor(const std::string &worldNamespace,
+                                      const double maxWaitTime)
+{
+  return this->WaitForAll(std::vector<std::string>(1, worldNamespace),
+                          maxWaitTime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool GazeboNamespaceNotifier::WaitForAll
+        (const std::vector<std::string> &worldNamespaces,
+         const double maxWaitTime,
+         std::vector<std::string> *missing)
+{
+  const std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>
+      (std::chrono::duration<double>(maxWaitTime));
+
+  std::unique_lock<std::mutex> lock(this->mutex);
+  std::function<bool()> allKnown = [this, &worldNamespaces]()
+  {
+    for (std::vector<std::string>::const_iterator
+         it = worldNamespaces.begin(); it != worldNamespaces.end(); ++it)
+    {
+      if (!this->known.count(*it)) return false;
+    }
+    return true;
+  };
+
+  bool found = allKnown();
+  if (!found)
+  {
+    // the namespaces may have arrived since the watcher last checked
+    this->Refresh(lock);
+    found = allKnown();
+  }
+  if (!found)
+  {
+    ++this->numWaiters;
+    this->StartWatcher();
+    this->waitersChanged.notify_all();
+    found = this->namespacesChanged.wait_until(lock, deadline, allKnown);
+    --this->numWaiters;
+  }
+
+  if (missing)
+  {
+    missing->clear();
+    for (std::vector<std::string>::const_iterator
+         it = worldNamespaces.begin(); it != worldNamespaces.end(); ++it)
+    {
+      if (!this->known.count(*it)) missing->push_back(*it);
+    }
+  }
+  return found;
+}
+
+//////////////////////////////////////////////////////////////////////////
+bool GazeboNamespaceNotifier::IsAvailable(const std::string &worldNamespace)
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  if (this->known.count(worldNamespace)) return true;
+  this->Refresh(lock);
+  return this->known.count(worldNamespace) > 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+void GazeboNamespaceNotifier::Refresh(std::unique_lock<std::mutex> &lock)
+{
+  std::list<std::string> namespaces;
+  lock.unlock();
+  gazebo::transport::TopicManager * topicManager =
+    gazebo::transport::TopicManager::Instance();
+  if (topicManager) topicManager->GetTopicNamespaces(namespaces);
+  lock.lock();
+
+  bool added = false;
+  for (std::list<std::string>::const_iterator it = namespaces.begin();
+       it != namespaces.end(); ++it)
+  {
+    if (this->known.insert(*it).second) added = true;
+  }
+  if (added) this->namespacesChanged.notify_all();
+}
+
+//////////////////////////////////////////////////////////////////////////
+void GazeboNamespaceNotifier::StartWatcher()
+{
+  if (this->watcher.joinable()) return;
+  this->watcher = std::thread(&GazeboNamespaceNotifier::WatchLoop, this);
+}
+
+//////////////////////////////////////////////////////////////////////////
+void GazeboNamespaceNotifier::WatchLoop()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (!this->stop)
+  {
+    if (this->numWaiters == 0)
+    {
+      // nobody is waiting, so there is no need to check the namespaces
+      this->waitersChanged.wait(lock);
+      continue;
+    }
+    this->Refresh(lock);
+    if (this->stop) break;
+    this->waitersChanged.wait_for(lock,
+                                  std::chrono::milliseconds(PollInterval));
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_GAZEBONAMESPACENOTIFIER_H
+#define COLLISION_BENCHMARK_GAZEBONAMESPACENOTIFIER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Notifies threads when namespaces of worlds have been announced
+ * to the Gazebo transport system.
+ *
+ * A single watcher thread keeps track of the namespaces known to the
+ * gazebo::transport::TopicManager and wakes up all waiting threads through
+ * a condition variable as soon as new namespaces have arrived. Each waiter
+ * only checks the set of known namespaces, so any number of threads can
+ * wait for any number of namespaces without fetching the namespace list
+ * themselves.
+ *
+ * Gazebo has no callback for namespace announcements, so the watcher
+ * checks the list of namespaces every PollInterval milliseconds. It only
+ * does so while there are waiting threads, and sleeps otherwise.
+ * Namespaces are never removed from the transport system, so once a
+ * namespace is known it stays known.
+ */
+class GazeboNamespaceNotifier
+{
+  /// \brief Interval (milliseconds) in which the watcher thread checks
+  /// for new namespaces while there are waiting threads.
+  public: static const int PollInterval = 5;
+
+  /// \return the instance of the notifier
+  public: static GazeboNamespaceNotifier &Instance();
+
+  public: ~GazeboNamespaceNotifier();
+
+  /// \brief Waits until \e worldNamespace has been announced.
+  /// \param[in] maxWaitTime maximum time to wait (seconds)
+  /// \return true if the namespace is available, false if it did not
+  ///   appear within \e maxWaitTime.
+  public: bool WaitFor(const std::string &worldNamespace,
+                       const double maxWaitTime);
+
+  /// \brief Waits until all of \e worldNamespaces have been announced.
+  /// \param[in] maxWaitTime maximum time to wait (seconds)
+  /// \param[out] missing if not NULL, the namespaces which did not appear
+  ///   within \e maxWaitTime are returned in here.
+  /// \return true if all namespaces are available
+  public: bool WaitForAll(const std::vector<std::string> &worldNamespaces,
+                          const double maxWaitTime,
+                          std::vector<std::string> *missing = NULL);
+
+  /// \return true if \e worldNamespace has been announced already
+  public: bool IsAvailable(const std::string &worldNamespace);
+
+  private: GazeboNamespaceNotifier();
+  private: GazeboNamespaceNotifier(const GazeboNamespaceNotifier&);
+  private: GazeboNamespaceNotifier &operator=
+                (const GazeboNamespaceNotifier&);
+
+  // \brief Main loop of the watcher thread
+  private: void WatchLoop();
+
+  // \brief Adds the namespaces currently in the transport system to
+  // \e known and wakes up the waiters if there are new ones.
+  // \param[in] lock lock on \e mutex, which is released while the
+  //    namespaces are fetched from the transport system.
+  private: void Refresh(std::unique_lock<std::mutex> &lock);
+
+  // \brief starts the watcher thread if it is not running yet.
+  // Must be called with \e mutex locked.
+  private: void StartWatcher();
+
+  // \brief all namespaces which have been announced so far
+  private: std::set<std::string> known;
+
+  // \brief number of threads currently waiting for namespaces
+  private: int numWaiters;
+
+  // \brief set to true to terminate the watcher thread
+  private: bool stop;
+
+  // \brief protects all members
+  private: std::mutex mutex;
+
+  // \brief notifies the watcher of new waiters
+  private: std::condition_variable waitersChanged;
+
+  // \brief notifies the waiters of new namespaces
+  private: std::condition_variable namespacesChanged;
+
+  // \brief the watcher thread
+  private: std::thread watcher;
+};
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_GAZEBONAMESPACENOTIFIER_H
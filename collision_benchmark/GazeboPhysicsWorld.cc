@@ -23,6 +23,7 @@
 #include <collision_benchmark/GazeboStateCompare.hh>
 #include <collision_benchmark/GazeboHelpers.hh>
 #include <collision_benchmark/GazeboWorldLoader.hh>
+#include <collision_benchmark/GazeboMeshRegistry.hh>
 #include <collision_benchmark/Helpers.hh>
 #include <collision_benchmark/boost_std_conversion.hh>
 
@@ -31,15 +32,20 @@
 
 #include <boost/filesystem.hpp>
 #include <algorithm>
+#include <atomic>
 
 using collision_benchmark::GazeboPhysicsWorld;
+using collision_benchmark::GazeboMeshRegistry;
 using collision_benchmark::Contact;
 using collision_benchmark::ContactInfo;
 
 //////////////////////////////////////////////////////////////////////////////
-GazeboPhysicsWorld::GazeboPhysicsWorld(bool _enforceContactComputation)
+GazeboPhysicsWorld::GazeboPhysicsWorld(bool _enforceContactComputation,
+                                       bool _headless)
   : enforceContactComputation(_enforceContactComputation),
-    paused(false)
+    paused(false),
+    headless(_headless),
+    headlessPoseChanged(false)
 {
 }
 
@@ -180,6 +186,21 @@ bool CopyAllResourcesHelper(const sdf::ElementPtr &elem,
                     << fullDestinationDir << std::endl;
           return false;
         }
+        if (GazeboMeshRegistry::IsMemoryURI(uri))
+        {
+          // the mesh is kept in memory and has to be written to file now
+          boost::filesystem::path fullDestinationFile =
+            fullDestinationDir / relPath.filename();
+          if (!GazeboMeshRegistry::Instance().WriteToFile
+                                   (uri, fullDestinationFile.string()))
+          {
+            std::cerr << "Could not write mesh " << uri << " to "
+                      << fullDestinationFile << std::endl;
+            return false;
+          }
+          uriElem->GetValue()->Set("file://" + uriDest.string());
+          continue;
+        }
         // find the file in the existing GAZEBO_RESOURCE_PATH
         boost::filesystem::path filename = gazebo::common::find_file(uri);
         if (filename.empty())
@@ -473,26 +494,35 @@ GazeboPhysicsWorld::AddModelFromShape(const std::string &modelname,
     gazebo::common::SystemPaths::Instance()->AddGazeboPaths(outputPath);
   }
 
+  // The visual is written to file, because it may be displayed by clients
+  // such as gzclient, which run in other processes.
   sdf::ElementPtr shapeGeom =
     shape->GetShapeSDF(true, outputPath, outputSubdir);
+  if (!shapeGeom)
+  {
+    std::cerr << "Could not construct shape SDF" << std::endl;
+    return ret;
+  }
   sdf::ElementPtr visual(new sdf::Element());
   visual->SetName("visual");
   visual->AddAttribute("name", "string", "visual", true, "visual name");
   visual->InsertElement(shapeGeom);
   link->InsertElement(visual);
 
+  // The collision shape is only loaded by the physics engines in this
+  // process, so it is served from memory instead of being re-read from
+  // file. It is only written to file when the world is saved.
   sdf::ElementPtr shapeColl;
   if (collShape)
   {
-    shapeColl = collShape->GetShapeSDF(true, outputPath, outputSubdir);
+    shapeColl = collShape->GetShapeSDFInMemory(true);
   }
   else
   {
-    // build collision shape out of the visual shape
-    if (shape->SupportLowRes())
-      shapeColl = shape->GetShapeSDF(false, outputPath, outputSubdir);
-    else
-      shapeColl = shapeGeom;
+    // build collision shape out of the visual shape, using the low
+    // resolution mesh if there is one
+    const bool detailed = !shape->SupportLowRes();
+    shapeColl = shape->GetShapeSDFInMemory(detailed);
   }
 
   if (!shapeColl)
@@ -590,6 +620,84 @@ GazeboPhysicsWorld::SetWorldState(const WorldState &state, bool isDiff)
   return collision_benchmark::SUCCESS;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetWorldSnapshot(GazeboWorldSnapshot &snapshot) const
+{
+  snapshot.Capture(world);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+collision_benchmark::OpResult
+GazeboPhysicsWorld::SetWorldSnapshot(const GazeboWorldSnapshot &snapshot)
+{
+  if (!snapshot.Restore(world)) return collision_benchmark::FAILED;
+  return collision_benchmark::SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::UpdateStateFingerprint
+              (GazeboStateFingerprint &fingerprint) const
+{
+  const gazebo::physics::Model_V models = world->Models();
+  bool sameModels = fingerprint.IsComputed() &&
+                    (fingerprint.GetNumModels() == models.size());
+  for (gazebo::physics::Model_V::const_iterator it = models.begin();
+       sameModels && it != models.end(); ++it)
+  {
+    sameModels = fingerprint.HasModel((*it)->GetName());
+  }
+  if (!sameModels)
+  {
+    fingerprint.Compute(GetWorldState());
+    return;
+  }
+
+  const gazebo::common::Time realTime = world->RealTime();
+  const gazebo::common::Time simTime = world->SimTime();
+  const uint64_t iterations = world->Iterations();
+  for (gazebo::physics::Model_V::const_iterator it = models.begin();
+       it != models.end(); ++it)
+  {
+    const gazebo::physics::ModelPtr &m = *it;
+    // static models only move if they are placed explicitly
+    if (m->IsStatic() &&
+        fingerprint.ModelPlacementMatches(m->GetName(), m->WorldPose(),
+                                          m->Scale()))
+      continue;
+    fingerprint.UpdateModel(gazebo::physics::ModelState(m, realTime,
+                                                        simTime, iterations));
+  }
+
+  if (fingerprint.GetCheckLights())
+  {
+    const gazebo::physics::Light_V lights = world->Lights();
+    for (gazebo::physics::Light_V::const_iterator it = lights.begin();
+         it != lights.end(); ++it)
+    {
+      fingerprint.UpdateLight(gazebo::physics::LightState(*it, realTime,
+                                                          simTime,
+                                                          iterations));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::SetHeadless(const bool flag)
+{
+  this->headless = flag;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboPhysicsWorld::IsHeadless() const
+{
+  return this->headless;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboPhysicsWorld::ConsumeHeadlessPoseChange()
+{
+  return this->headlessPoseChanged.exchange(false);
+}
 
 //////////////////////////////////////////////////////////////////////////////
 bool GazeboPhysicsWorld::SetBasicModelState(const ModelID  &_id,
@@ -613,22 +721,31 @@ bool GazeboPhysicsWorld::SetBasicModelState(const ModelID  &_id,
 
   // std::cout << "Setting world state " << _state << std::endl;
 
-  // Fix / HACK: Because World::posePub is throttled for publishing the
-  // pose, space the publishing of poses apart to make sure they are
-  // actually published.
-  // Get the current time
-  gazebo::common::Time currentTime = gazebo::common::Time::GetWallTime();
-  static const double updatePeriod = 1.0 / 60.0;
-  // Skip publication if the time difference is less than the update period.
-  double timeDiff = (currentTime - this->prevPoseSetTime).Double();
-  if (timeDiff < updatePeriod)
+  if (this->headless)
   {
-    /* std::cout << "WARNING: Throttling the setting of the pose due to the "
-              << "gazebo::physics::World throttle on pose publishing. "
-              << __FILE__ << std::endl;*/
-    gazebo::common::Time::Sleep((updatePeriod - timeDiff) + 1e-03);
+    // the pose may not be published due to the throttle, so it has
+    // to be published separately if needed.
+    this->headlessPoseChanged = true;
+  }
+  else
+  {
+    // Fix / HACK: Because World::posePub is throttled for publishing the
+    // pose, space the publishing of poses apart to make sure they are
+    // actually published.
+    // Get the current time
+    gazebo::common::Time currentTime = gazebo::common::Time::GetWallTime();
+    static const double updatePeriod = 1.0 / 60.0;
+    // Skip publication if the time difference is less than the update period.
+    double timeDiff = (currentTime - this->prevPoseSetTime).Double();
+    if (timeDiff < updatePeriod)
+    {
+      /* std::cout << "WARNING: Throttling the setting of the pose due to the "
+                << "gazebo::physics::World throttle on pose publishing. "
+                << __FILE__ << std::endl;*/
+      gazebo::common::Time::Sleep((updatePeriod - timeDiff) + 1e-03);
+    }
+    this->prevPoseSetTime = currentTime;
   }
-  this->prevPoseSetTime = currentTime;
 
   m->SetWorldPose(pose);
 
@@ -696,15 +813,15 @@ void GazeboPhysicsWorld::Update(int steps, bool force)
   // Step(), or first pause the world.
   if (!world->IsPaused())
   {
-    static bool printOnce = true;
-    if (printOnce)
+    // worlds may be updated concurrently (see WorldManager)
+    static std::atomic<bool> printOnce(true);
+    if (printOnce.exchange(false))
     {
       std::cout << "WARNING: The Gazebo world is not paused. "
         <<"In GazeboPhysicsWorld::Update(), we operate it in "
         <<"paused mode and rely on manually doing the updates "
         <<"instead of letting the gazebo world update "
         <<"itself continuously." << std::endl;
-      printOnce = false;
     }
     world->SetPaused(true);
   }
@@ -754,21 +871,82 @@ bool GazeboPhysicsWorld::SupportsContacts() const
 }
 
 //////////////////////////////////////////////////////////////////////////////
-// helper function which can be used to get contact info of either
-// all models (m1 and m2 set to NULL), or for one model
-// (m1 = NULL and m2 = NULL) or for two models (m1 != NULL and m2 != NULL).
-std::vector<GazeboPhysicsWorld::ContactInfoPtr>
-GetContactInfoHelper(const gazebo::physics::WorldPtr &world,
-                     const GazeboPhysicsWorld::ModelID * m1 = NULL,
-                     const GazeboPhysicsWorld::ModelID * m2 = NULL)
+GazeboPhysicsWorld::NameID
+GazeboPhysicsWorld::GetModelNameID(const ModelID &id) const
+{
+  std::lock_guard<std::mutex> lock(this->nameIdsMutex);
+  return this->modelNameIds.Intern(id);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboPhysicsWorld::NameID
+GazeboPhysicsWorld::GetLinkNameID(const ModelPartID &id) const
+{
+  std::lock_guard<std::mutex> lock(this->nameIdsMutex);
+  return this->linkNameIds.Intern(id);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboPhysicsWorld::ModelID
+GazeboPhysicsWorld::GetModelName(const NameID id) const
+{
+  std::lock_guard<std::mutex> lock(this->nameIdsMutex);
+  return this->modelNameIds.GetName(id);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboPhysicsWorld::ModelPartID
+GazeboPhysicsWorld::GetLinkName(const NameID id) const
+{
+  std::lock_guard<std::mutex> lock(this->nameIdsMutex);
+  return this->linkNameIds.GetName(id);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetContactNameIDs(const gazebo::physics::Contact &c,
+                                           NameID &m1, NameID &l1,
+                                           NameID &m2, NameID &l2) const
+{
+  GZ_ASSERT(c.collision1->GetModel(), "Model of collision1 must be set");
+  GZ_ASSERT(c.collision1->GetLink(), "Link of collision1 must be set");
+  GZ_ASSERT(c.collision2->GetModel(), "Model of collision2 must be set");
+  GZ_ASSERT(c.collision2->GetLink(), "Link of collision2 must be set");
+
+  // gazebo entity IDs are unique amongst all entities (models and links),
+  // so one map can be used for both.
+  const gazebo::physics::Base * entities[4] =
+    { c.collision1->GetModel().get(), c.collision1->GetLink().get(),
+      c.collision2->GetModel().get(), c.collision2->GetLink().get() };
+  NameID * ids[4] = { &m1, &l1, &m2, &l2 };
+  for (int i = 0; i < 4; ++i)
+  {
+    std::unordered_map<uint32_t, NameID>::const_iterator it =
+      this->entityNameIds.find(entities[i]->GetId());
+    if (it != this->entityNameIds.end())
+    {
+      *ids[i] = it->second;
+      continue;
+    }
+    // first time this entity is encountered: even indices are models,
+    // odd ones are links
+    NameInterner &table = (i % 2 == 0) ? this->modelNameIds : this->linkNameIds;
+    *ids[i] = table.Intern(entities[i]->GetName());
+    this->entityNameIds[entities[i]->GetId()] = *ids[i];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+template<class Callback>
+void GazeboPhysicsWorld::ForEachContact(const NameID m1, const NameID m2,
+                                        const Callback &callback) const
 {
-  std::vector<GazeboPhysicsWorld::ContactInfoPtr> ret;
   const gazebo::physics::ContactManager* contactManager =
     world->Physics()->GetContactManager();
   GZ_ASSERT(contactManager, "Contact manager has to be set");
   const std::vector<gazebo::physics::Contact*>& contacts =
     contactManager->GetContacts();
   // std::cout << "World has " << contacts.size() << "contacts." << std::endl;
+  std::lock_guard<std::mutex> lock(this->nameIdsMutex);
   for (int cIdx = 0; cIdx < contactManager->GetContactCount(); ++cIdx)
   {
     if (cIdx >= contacts.size())
@@ -777,24 +955,20 @@ GetContactInfoHelper(const gazebo::physics::WorldPtr &world,
                       << cIdx << ", size = " << contacts.size());
     }
     const gazebo::physics::Contact * c = contacts[cIdx];
-    GZ_ASSERT(c->collision1->GetModel(), "Model of collision1 must be set");
-    GZ_ASSERT(c->collision1->GetLink(), "Link of collision1 must be set");
-    GZ_ASSERT(c->collision2->GetModel(), "Model of collision2 must be set");
-    GZ_ASSERT(c->collision2->GetLink(), "Link of collision2 must be set");
 
-    std::string m1Name = c->collision1->GetModel()->GetName();
-    std::string m2Name = c->collision2->GetModel()->GetName();
+    NameID cm1, cl1, cm2, cl2;
+    GetContactNameIDs(*c, cm1, cl1, cm2, cl2);
 
-    if (m1)
+    if (m1 >= 0)
     {
-      if (m2)
-      { // m1Name and m2Name do not correspond to m1 and m2
-        if ((*m1 != m1Name || *m2 != m2Name) &&
-            (*m1 != m2Name || *m2 != m1Name)) continue;
+      if (m2 >= 0)
+      { // cm1 and cm2 do not correspond to m1 and m2
+        if ((m1 != cm1 || m2 != cm2) &&
+            (m1 != cm2 || m2 != cm1)) continue;
       }
       else
-      { // m1 has to be m1Name or m2Name to continue
-        if (*m1 != m1Name && *m1 != m2Name) continue;
+      { // m1 has to be cm1 or cm2 to continue
+        if (m1 != cm1 && m1 != cm2) continue;
       }
     }
 
@@ -809,48 +983,199 @@ GetContactInfoHelper(const gazebo::physics::WorldPtr &world,
       {
         std::cerr << "CONSISTENCY GazeboPhysicsWorld: With no contacts, "
                   << "there should be no collision!! World: " << world->Name()
-                  << " Models: " << m1Name << ", " << m2Name << std::endl;
+                  << " Models: " << this->modelNameIds.GetName(cm1) << ", "
+                  << this->modelNameIds.GetName(cm2) << std::endl;
       }
       continue;
     }
 
-    GazeboPhysicsWorld::ContactInfoPtr
-      cInfo(new GazeboPhysicsWorld::ContactInfo
-            (m1Name, c->collision1->GetLink()->GetName(),
-             m2Name, c->collision2->GetLink()->GetName()));
-    for (int i = 0; i < c->count; ++i)
+    callback(*c, cm1, cl1, cm2, cl2);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Helper function which checks whether contact point \e i of \e c is valid.
+// \e world is used for printing information only.
+bool IsValidContactPoint(const gazebo::physics::Contact &c, const int i,
+                         const gazebo::physics::World &world)
+{
+  if (c.depths[i] < 0)
+  {
+    // negative depths shoudl be considered invalid if they
+    // are far beyond 0
+    static double tol = 1e-03;
+    if (c.depths[i] < -tol)
+    {
+      std::cout << "DEBUG-INFO: Negative contact distance found in world "
+                << world.Name() <<", depth = " << c.depths[i]
+                << ". Skipping contact. " << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Helper function which adds all valid contact points of \e c to
+// \e contacts. \e world is used for printing information only.
+// \return false if all contact points were skipped
+bool AddContactPoints(const gazebo::physics::Contact &c,
+                      const gazebo::physics::World &world,
+                      std::vector<GazeboPhysicsWorld::Contact> &contacts)
+{
+  bool added = false;
+  for (int i = 0; i < c.count; ++i)
+  {
+    if (!IsValidContactPoint(c, i, world)) continue;
+    contacts.push_back
+      (GazeboPhysicsWorld::Contact(c.positions[i], c.normals[i],
+                                   c.wrench[i], c.depths[i]));
+    added = true;
+  }
+  return added;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Helper function which adds all valid contact points of \e c to the
+// pair last added to \e buffer. \e world is used for printing
+// information only.
+// \return false if all contact points were skipped
+template<class ContactBufferT>
+bool AddContactPoints(const gazebo::physics::Contact &c,
+                      const gazebo::physics::World &world,
+                      ContactBufferT &buffer)
+{
+  bool added = false;
+  for (int i = 0; i < c.count; ++i)
+  {
+    if (!IsValidContactPoint(c, i, world)) continue;
+    buffer.AddContact(c.positions[i], c.normals[i],
+                      c.wrench[i], c.depths[i]);
+    added = true;
+  }
+  return added;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Helper which prints a warning that all contact points were skipped
+void PrintSkippedContactWarning(const std::string &m1, const std::string &l1,
+                                const std::string &m2, const std::string &l2,
+                                const gazebo::physics::World &world)
+{
+  std::cout << "WARNING: All contact points gotten from models "
+            << m1 << " / " << l1 << ", " << m2 << " / " << l2
+            << " world " << world.Name() <<" skipped. " << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::vector<GazeboPhysicsWorld::ContactInfoPtr>
+GazeboPhysicsWorld::GetContactInfoHelper(const ModelID * m1,
+                                         const ModelID * m2) const
+{
+  // resolve the names to IDs once, so that the contacts can
+  // be filtered by integer comparison
+  NameID m1ID = m1 ? GetModelNameID(*m1) : NameInterner::InvalidID;
+  NameID m2ID = m2 ? GetModelNameID(*m2) : NameInterner::InvalidID;
+
+  std::vector<ContactInfoPtr> ret;
+  ForEachContact(m1ID, m2ID,
+    [&](const gazebo::physics::Contact &c,
+        const NameID cm1, const NameID cl1, const NameID cm2, const NameID cl2)
+    {
+      const std::string &m1Name = this->modelNameIds.GetName(cm1);
+      const std::string &l1Name = this->linkNameIds.GetName(cl1);
+      const std::string &m2Name = this->modelNameIds.GetName(cm2);
+      const std::string &l2Name = this->linkNameIds.GetName(cl2);
+      ContactInfoPtr cInfo(new ContactInfo(m1Name, l1Name, m2Name, l2Name));
+      if (!AddContactPoints(c, *world, cInfo->contacts))
+        PrintSkippedContactWarning(m1Name, l1Name, m2Name, l2Name, *world);
+      else
+        ret.push_back(cInfo);
+    });
+  return ret;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetContactInfo(const NameID m1, const NameID m2,
+                                   std::vector<IdContactInfo> &contacts) const
+{
+  contacts.clear();
+  ForEachContact(m1, m2,
+    [&](const gazebo::physics::Contact &c,
+        const NameID cm1, const NameID cl1, const NameID cm2, const NameID cl2)
     {
-      if (c->depths[i] < 0)
+      contacts.push_back(IdContactInfo(cm1, cl1, cm2, cl2));
+      if (!AddContactPoints(c, *world, contacts.back().contacts))
       {
-        // negative depths shoudl be considered invalid if they
-        // are far beyond 0
-        static double tol = 1e-03;
-        if (c->depths[i] < -tol)
-        {
-          std::cout << "DEBUG-INFO: Negative contact distance found in world "
-                    << world->Name() <<", depth = " << c->depths[i]
-                    << ". Skipping contact. " << std::endl;
-          continue;
-        }
+        PrintSkippedContactWarning(this->modelNameIds.GetName(cm1),
+                                   this->linkNameIds.GetName(cl1),
+                                   this->modelNameIds.GetName(cm2),
+                                   this->linkNameIds.GetName(cl2),
+                                   *world);
+        contacts.pop_back();
       }
-      cInfo->contacts.push_back
-        (GazeboPhysicsWorld::Contact(c->positions[i], c->normals[i],
-                                     c->wrench[i], c->depths[i]));
-    }
+    });
+}
 
-    if (cInfo->contacts.empty())
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetContactInfo(const NameID m1, const NameID m2,
+                                        IdContactBuffer &buffer) const
+{
+  buffer.Clear();
+  ForEachContact(m1, m2,
+    [&](const gazebo::physics::Contact &c,
+        const NameID cm1, const NameID cl1, const NameID cm2, const NameID cl2)
     {
-     std::cout << "WARNING: All contact points gotten from models "
-               << m1Name << " / " << c->collision1->GetLink()->GetName() << ", "
-               << m2Name << " / " << c->collision2->GetLink()->GetName()
-               << " world " << world->Name() <<" skipped. " << std::endl;
-    }
-    else
+      buffer.AddPair(cm1, cl1, cm2, cl2);
+      if (!AddContactPoints(c, *world, buffer))
+      {
+        PrintSkippedContactWarning(this->modelNameIds.GetName(cm1),
+                                   this->linkNameIds.GetName(cl1),
+                                   this->modelNameIds.GetName(cm2),
+                                   this->linkNameIds.GetName(cl2),
+                                   *world);
+        buffer.RemoveLastPair();
+      }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetContactBufferHelper(const NameID m1,
+                                                const NameID m2,
+                                                ContactBuffer &buffer) const
+{
+  buffer.Clear();
+  ForEachContact(m1, m2,
+    [&](const gazebo::physics::Contact &c,
+        const NameID cm1, const NameID cl1, const NameID cm2, const NameID cl2)
     {
-      ret.push_back(cInfo);
-    }
-  }
-  return ret;
+      // the names are assigned to the strings already in the buffer,
+      // which will not allocate memory once the buffer is warmed up.
+      const std::string &m1Name = this->modelNameIds.GetName(cm1);
+      const std::string &l1Name = this->linkNameIds.GetName(cl1);
+      const std::string &m2Name = this->modelNameIds.GetName(cm2);
+      const std::string &l2Name = this->linkNameIds.GetName(cl2);
+      buffer.AddPair(m1Name, l1Name, m2Name, l2Name);
+      if (!AddContactPoints(c, *world, buffer))
+      {
+        PrintSkippedContactWarning(m1Name, l1Name, m2Name, l2Name, *world);
+        buffer.RemoveLastPair();
+      }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetContactInfo(ContactBuffer &buffer) const
+{
+  GetContactBufferHelper(NameInterner::InvalidID, NameInterner::InvalidID,
+                         buffer);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboPhysicsWorld::GetContactInfo(const ModelID &m1, const ModelID &m2,
+                                        ContactBuffer &buffer) const
+{
+  GetContactBufferHelper(GetModelNameID(m1), GetModelNameID(m2), buffer);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -921,14 +1246,14 @@ GetNativeContactsHelper(const gazebo::physics::WorldPtr &world,
 std::vector<GazeboPhysicsWorld::ContactInfoPtr>
 GazeboPhysicsWorld::GetContactInfo() const
 {
-  return GetContactInfoHelper(world);
+  return GetContactInfoHelper();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 std::vector<GazeboPhysicsWorld::ContactInfoPtr>
 GazeboPhysicsWorld::GetContactInfo(const ModelID &m1, const ModelID &m2) const
 {
-  return GetContactInfoHelper(world, &m1, &m2);
+  return GetContactInfoHelper(&m1, &m2);
 }
 
 //////////////////////////////////////////////////////////////////////////////
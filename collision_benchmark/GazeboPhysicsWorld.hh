@@ -21,6 +21,9 @@
 #define COLLISION_BENCHMARK_GAZEBOPHYSICSWORLD
 
 #include <collision_benchmark/PhysicsWorld.hh>
+#include <collision_benchmark/NameInterner.hh>
+#include <collision_benchmark/GazeboWorldState.hh>
+#include <collision_benchmark/GazeboStateFingerprint.hh>
 #include <gazebo/physics/PhysicsTypes.hh>
 #include <gazebo/physics/World.hh>
 #include <gazebo/physics/Contact.hh>
@@ -29,9 +32,12 @@
 #include <gazebo/transport/TransportTypes.hh>
 #endif
 
+#include <atomic>
 #include <vector>
 #include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace collision_benchmark
 {
@@ -81,6 +87,7 @@ class GazeboPhysicsWorld
   public: typedef typename ParentClass::WorldState WorldState;
   public: typedef typename ParentClass::ContactInfo ContactInfo;
   public: typedef typename ParentClass::ContactInfoPtr ContactInfoPtr;
+  public: typedef typename ParentClass::ContactBuffer ContactBuffer;
   public: typedef typename ParentClass::Shape Shape;
   public: typedef typename ParentClass::ModelLoadResult ModelLoadResult;
 
@@ -95,6 +102,22 @@ class GazeboPhysicsWorld
   public: typedef typename ParentClass::PhysicsEnginePtr PhysicsEnginePtr;
   public: typedef typename ParentClass::WorldPtr WorldPtr;
 
+  /// Dense integer ID of a model or link name, as handed out by
+  /// GetModelNameID() and GetLinkNameID().
+  public: typedef NameInterner::ID NameID;
+
+  /// Contact information which identifies the models and links with
+  /// their NameID instead of their names. Model 1 is always the
+  /// one with the smaller ID.
+  public: typedef collision_benchmark::ContactInfo<Contact, NameID, NameID>
+                  IdContactInfo;
+
+  /// Contact buffer which identifies the models and links with
+  /// their NameID instead of their names.
+  public: typedef collision_benchmark::ContactBuffer<Vector3, Wrench,
+                                                     NameID, NameID>
+                  IdContactBuffer;
+
   // set to true (default) to wait for the namespace for be loaded in
   // the Load* methods. Max wait time can be set in \e OnLoadMaxWaitForNamespace
   // and \e OnLoadMaxWaitForNamespaceSleep
@@ -103,13 +126,16 @@ class GazeboPhysicsWorld
   // time (seconds) to wait for
   public: static constexpr float OnLoadMaxWaitForNamespace = 10;
   // if \e OnLoadWaitForNamespace, sleep time in-between checks to wait for
-  // whether the namespace has been loaded
+  // whether the namespace has been loaded. Not used any more, as waiting
+  // threads are woken up by GazeboNamespaceNotifier.
   public: static constexpr float OnLoadWaitForNamespaceSleep = 1;
 
   // \param enforceContactComputation by default, contacts in Gazebo are only
   //  computed if there is at least one subscriber to the contacts topic.
   //  Use this flag to enforce contacts computation in any case.
-  public: GazeboPhysicsWorld(bool enforceContactComputation = false);
+  // \param headless enables the headless mode, see SetHeadless().
+  public: GazeboPhysicsWorld(bool enforceContactComputation = false,
+                             bool headless = false);
   public: GazeboPhysicsWorld(const GazeboPhysicsWorld &w) {}
   public: virtual ~GazeboPhysicsWorld();
 
@@ -142,8 +168,11 @@ class GazeboPhysicsWorld
 
   public: virtual bool SupportsShapes() const;
 
-  // The gazebo implementation needs to write mesh shapes to file. This method
+  // The gazebo implementation needs to write the visual mesh shapes to file,
+  // so that clients such as gzclient can load them. This method
   // will use the return value of GetMeshOutputPath() for this.
+  // The collision shapes are served from memory (see
+  // Shape::GetShapeSDFInMemory()) and only written when the world is saved.
   public: virtual ModelLoadResult
                   AddModelFromShape(const std::string &modelname,
                                     const Shape::Ptr &shape,
@@ -168,6 +197,22 @@ class GazeboPhysicsWorld
 
   public: virtual OpResult SetWorldState(const WorldState &state, bool isDiff);
 
+  // Captures the state of the world in \e snapshot. This is a lot
+  // faster than GetWorldState(), see GazeboWorldSnapshot.
+  public: void GetWorldSnapshot(GazeboWorldSnapshot &snapshot) const;
+
+  // Sets the world to the state captured in \e snapshot, which may also
+  // have been captured in another world with the same models.
+  public: OpResult SetWorldSnapshot(const GazeboWorldSnapshot &snapshot);
+
+  // Updates \e fingerprint to the current state of the world. If the
+  // fingerprint was computed for this world before and no models were
+  // inserted or removed since, only the models which may have moved are
+  // updated: all non-static models, and static models of which the pose
+  // or scale has changed.
+  public: void UpdateStateFingerprint
+              (GazeboStateFingerprint &fingerprint) const;
+
   public: virtual void Update(int steps = 1, bool force = false);
 
   public: virtual void SetPaused(bool flag);
@@ -185,6 +230,48 @@ class GazeboPhysicsWorld
   public: virtual std::vector<ContactInfoPtr>
                   GetContactInfo(const ModelID &m1, const ModelID &m2) const;
 
+  public: virtual void GetContactInfo(ContactBuffer &buffer) const;
+
+  public: virtual void GetContactInfo(const ModelID &m1, const ModelID &m2,
+                                      ContactBuffer &buffer) const;
+
+  /// \brief Returns the dense integer ID of the model name \e id.
+  /// The IDs are stable for the lifetime of this world, also across removal
+  /// and re-insertion of models with the same name.
+  /// It is not required that the model exists in the world.
+  public: NameID GetModelNameID(const ModelID &id) const;
+
+  /// \brief Returns the dense integer ID of the link name \e id.
+  /// Link names are interned separately from model names, the
+  /// same link name in different models has the same ID.
+  public: NameID GetLinkNameID(const ModelPartID &id) const;
+
+  /// \return the model name for this ID. Throws an exception if the
+  ///   ID was not handed out by this world.
+  public: ModelID GetModelName(const NameID id) const;
+
+  /// \return the link name for this ID. Throws an exception if the
+  ///   ID was not handed out by this world.
+  public: ModelPartID GetLinkName(const NameID id) const;
+
+  /// \brief Like GetContactInfo(), but models and links are identified
+  /// with their NameID. The filtering of models is done on the integer IDs
+  /// and no strings are copied.
+  /// \param[in] m1 ID of the first model (see GetModelNameID()), or
+  ///   negative to get contacts of all models.
+  /// \param[in] m2 ID of the second model, or negative to get
+  ///   all contacts of \e m1.
+  /// \param[out] contacts all contacts. The vector is cleared first.
+  public: void GetContactInfo(const NameID m1, const NameID m2,
+                              std::vector<IdContactInfo> &contacts) const;
+
+  /// \brief Like GetContactInfo(NameID, NameID, std::vector<IdContactInfo>&)
+  /// but fills the caller-owned \e buffer, which is cleared first.
+  /// Once the buffer has grown large enough, this does not need any
+  /// heap allocations.
+  public: void GetContactInfo(const NameID m1, const NameID m2,
+                              IdContactBuffer &buffer) const;
+
   /// Current warning for Gazebo implementation: Returned shared pointers
   /// are flakey, they will be deleted as soon as
   /// Gazebo ContactManager deletes them. This will be resolved as soon as
@@ -214,6 +301,24 @@ class GazeboPhysicsWorld
   // See also constructor parameter.
   public: void SetEnforceContactsComputation(bool flag);
 
+  // Enables or disables the headless mode. By default, SetBasicModelState()
+  // spaces subsequent calls at least 1/60 s apart, because
+  // gazebo::physics::World throttles the publishing of poses and would
+  // otherwise drop poses which clients such as gzclient should display.
+  // In headless mode, poses are set without waiting. Poses dropped by
+  // the throttle can be published separately, see
+  // ConsumeHeadlessPoseChange().
+  public: void SetHeadless(const bool flag);
+
+  // \return whether the headless mode is enabled, see SetHeadless()
+  public: bool IsHeadless() const;
+
+  // Returns true if a pose was set with SetBasicModelState() in headless
+  // mode since the last call of this function. This can be used to
+  // publish the latest poses for visualization when required, e.g. in
+  // MirrorWorld::Sync().
+  public: bool ConsumeHeadlessPoseChange();
+
   public: virtual bool SetBasicModelState(const ModelID &id,
                                           const BasicState &state);
 
@@ -239,6 +344,35 @@ class GazeboPhysicsWorld
   // \brief called after a world has been loaded
   private: void PostWorldLoaded();
 
+  // Gets the name IDs of the models and links of the contact. Gazebo
+  // entity IDs are mapped to the name IDs, so the names are only
+  // looked up the first time an entity is encountered.
+  // Requires that nameIdsMutex is locked.
+  private: void GetContactNameIDs(const gazebo::physics::Contact &c,
+                                  NameID &m1, NameID &l1,
+                                  NameID &m2, NameID &l2) const;
+
+  // Helper which calls \e callback for each contact in the world which
+  // happens between models \e m1 and \e m2 (see GetContactInfo(NameID,
+  // NameID, std::vector<IdContactInfo>&) for meaning of the IDs), with
+  // the name IDs of the models and links involved in the contact.
+  private: template<class Callback>
+           void ForEachContact(const NameID m1, const NameID m2,
+                               const Callback &callback) const;
+
+  // Helper function which can be used to get contact info of either
+  // all models (m1 and m2 set to NULL), or for one model
+  // (m1 != NULL and m2 = NULL) or for two models (m1 != NULL and m2 != NULL).
+  private: std::vector<ContactInfoPtr>
+           GetContactInfoHelper(const ModelID * m1 = NULL,
+                                const ModelID * m2 = NULL) const;
+
+  // Helper which fills \e buffer with the contacts between models
+  // \e m1 and \e m2 (negative for all models, see
+  // GetContactInfo(NameID, NameID, std::vector<IdContactInfo>&)).
+  private: void GetContactBufferHelper(const NameID m1, const NameID m2,
+                                       ContactBuffer &buffer) const;
+
   // Helper function which copies files which are specified as URIs in
   // the ``<uri>`` elemens within elements \e parentElementNames.
   // It copies the files to ``destinationBase/destinationSubdir`` and
@@ -278,6 +412,20 @@ class GazeboPhysicsWorld
   // last time the pose of a model was set. Needed for a hack to
   // avoid issues with the gazebo::physics::World pose publishing throttle.
   private: gazebo::common::Time prevPoseSetTime;
+  // if true, poses are set without waiting for the pose publishing throttle
+  private: std::atomic<bool> headless;
+  // true if a pose was set in headless mode since the last call of
+  // ConsumeHeadlessPoseChange()
+  private: std::atomic<bool> headlessPoseChanged;
+
+  // table of model name IDs
+  private: mutable NameInterner modelNameIds;
+  // table of link name IDs
+  private: mutable NameInterner linkNameIds;
+  // maps the gazebo entity ID of models and links to their name ID
+  private: mutable std::unordered_map<uint32_t, NameID> entityNameIds;
+  // mutex protecting modelNameIds, linkNameIds and entityNameIds
+  private: mutable std::mutex nameIdsMutex;
 };  // class GazeboPhysicsWorld
 
 /// \def GazeboPhysicsWorldPtr
@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboStateBatchCompare.hh>
+
+#include <gazebo/physics/WorldState.hh>
+#include <gazebo/physics/ModelState.hh>
+#include <gazebo/physics/LinkState.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using gazebo::physics::WorldState;
+using gazebo::physics::ModelState;
+using gazebo::physics::LinkState;
+using collision_benchmark::GazeboStateCompare;
+using collision_benchmark::GazeboStateBatchCompare;
+
+// first value of each field in the arrays, and the end of the last field.
+// Orientations are stored as quaternions (w, x, y, z), all others as
+// three values (x, y, z).
+static const size_t FieldBegin[GazeboStateBatchCompare::NUM_FIELDS + 1] =
+  { 0, 3, 7, 10, 13, 16, 19, 22, 25, 28 };
+
+//////////////////////////////////////////////////////////////////////////////
+// returns true if \e field is only compared if CheckDynamics is enabled
+static bool IsDynamicsField(const GazeboStateBatchCompare::Field field)
+{
+  return field == GazeboStateBatchCompare::ACCELERATION ||
+         field == GazeboStateBatchCompare::ACCELERATION_ORIENTATION ||
+         field == GazeboStateBatchCompare::FORCE ||
+         field == GazeboStateBatchCompare::TORQUE;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboStateBatchCompare::GazeboStateBatchCompare
+      (const GazeboStateCompare::Tolerances &_tolerances):
+  tolerances(_tolerances)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateBatchCompare::Compare
+      (const std::vector<gazebo::physics::WorldState> &states,
+       Report &report)
+{
+  std::vector<const gazebo::physics::WorldState*> statePtrs;
+  statePtrs.reserve(states.size());
+  for (std::vector<gazebo::physics::WorldState>::const_iterator
+       it = states.begin(); it != states.end(); ++it)
+  {
+    statePtrs.push_back(&(*it));
+  }
+  return Compare(statePtrs, report);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateBatchCompare::Compare
+      (const std::vector<const gazebo::physics::WorldState*> &states,
+       Report &report)
+{
+  report = Report();
+  this->names.clear();
+  if (states.empty()) return true;
+
+  CollectNames(*states[0], this->names);
+  std::vector<std::string> otherNames;
+  for (size_t w = 1; w < states.size(); ++w)
+  {
+    CollectNames(*states[w], otherNames);
+    if (otherNames != this->names)
+    {
+      report.structureEqual = false;
+      report.structureWorld = w;
+      return false;
+    }
+  }
+
+  const size_t numEntities = this->names.size();
+  for (size_t v = 0; v < NumValues; ++v)
+  {
+    this->values[v].resize(states.size() * numEntities);
+  }
+  for (size_t w = 0; w < states.size(); ++w)
+  {
+    FillValues(*states[w], w);
+  }
+
+  ComputeDeviations(states.size());
+
+  for (size_t e = 0; e < numEntities; ++e)
+  {
+    for (int f = 0; f < NUM_FIELDS; ++f)
+    {
+      const Field field = static_cast<Field>(f);
+      if (!this->tolerances.CheckDynamics && IsDynamicsField(field))
+        continue;
+      // same as in EqualFloats(), values are equal if the deviation
+      // is less than the tolerance.
+      const double tolerance = GetTolerance(field);
+      if (this->deviations[f][e] < tolerance) continue;
+      Divergence d;
+      d.entity = this->names[e];
+      d.field = field;
+      d.world = GetWorstWorld(e, field, states.size());
+      d.deviation = this->deviations[f][e];
+      d.tolerance = tolerance;
+      report.divergences.push_back(d);
+    }
+  }
+  return report.Equal();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+double GazeboStateBatchCompare::GetTolerance(const Field field) const
+{
+  switch (field)
+  {
+    case POSITION: return this->tolerances.Position;
+    case ORIENTATION: return this->tolerances.Orientation;
+    case SCALE: return this->tolerances.Scale;
+    case VELOCITY: return this->tolerances.Velocity;
+    case VELOCITY_ORIENTATION: return this->tolerances.VelocityOrientation;
+    case ACCELERATION: return this->tolerances.Acceleration;
+    case ACCELERATION_ORIENTATION:
+      return this->tolerances.AccelerationOrientation;
+    case FORCE: return this->tolerances.Force;
+    case TORQUE: return this->tolerances.Torque;
+    default: break;
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::string GazeboStateBatchCompare::GetFieldName(const Field field)
+{
+  switch (field)
+  {
+    case POSITION: return "position";
+    case ORIENTATION: return "orientation";
+    case SCALE: return "scale";
+    case VELOCITY: return "velocity";
+    case VELOCITY_ORIENTATION: return "angular velocity";
+    case ACCELERATION: return "acceleration";
+    case ACCELERATION_ORIENTATION: return "angular acceleration";
+    case FORCE: return "force";
+    case TORQUE: return "torque";
+    default: break;
+  }
+  return "unknown";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::CollectNames
+                (const WorldState &state,
+                 std::vector<std::string> &entityNames)
+{
+  entityNames.clear();
+  for (gazebo::physics::ModelState_M::const_iterator
+       it = state.GetModelStates().begin();
+       it != state.GetModelStates().end(); ++it)
+  {
+    CollectNames(it->second, "", entityNames);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::CollectNames
+                (const ModelState &model, const std::string &prefix,
+                 std::vector<std::string> &entityNames)
+{
+  const std::string modelName = prefix + model.GetName();
+  entityNames.push_back(modelName);
+  for (gazebo::physics::LinkState_M::const_iterator
+       it = model.GetLinkStates().begin();
+       it != model.GetLinkStates().end(); ++it)
+  {
+    entityNames.push_back(modelName + "::" + it->first);
+  }
+  for (gazebo::physics::ModelState_M::const_iterator
+       it = model.NestedModelStates().begin();
+       it != model.NestedModelStates().end(); ++it)
+  {
+    CollectNames(it->second, modelName + "::", entityNames);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::FillValues(const WorldState &state,
+                                         const size_t w)
+{
+  const size_t base = w * this->names.size();
+  size_t e = 0;
+  for (gazebo::physics::ModelState_M::const_iterator
+       it = state.GetModelStates().begin();
+       it != state.GetModelStates().end(); ++it)
+  {
+    FillValues(it->second, base, e);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::FillValues(const ModelState &model,
+                                         const size_t base, size_t &e)
+{
+  static const ignition::math::Vector3d One(1, 1, 1);
+
+  // the model itself. Models don't have dynamics, so all of those
+  // values are zero.
+  size_t idx = base + e;
+  const ignition::math::Pose3d &modelPose = model.Pose();
+  SetValues(FieldBegin[POSITION], idx, modelPose.Pos());
+  SetQuaternion(idx, modelPose.Rot());
+  SetValues(FieldBegin[SCALE], idx, model.Scale());
+  for (size_t v = FieldBegin[VELOCITY]; v < NumValues; ++v)
+  {
+    this->values[v][idx] = 0;
+  }
+  ++e;
+
+  for (gazebo::physics::LinkState_M::const_iterator
+       it = model.GetLinkStates().begin();
+       it != model.GetLinkStates().end(); ++it, ++e)
+  {
+    const LinkState &l = it->second;
+    idx = base + e;
+    const ignition::math::Pose3d &pose = l.Pose();
+    SetValues(FieldBegin[POSITION], idx, pose.Pos());
+    SetQuaternion(idx, pose.Rot());
+    SetValues(FieldBegin[SCALE], idx, One);
+    // like in GazeboStateCompare, the angular parts of the velocity,
+    // acceleration and wrench are stored as Euler angles
+    SetValues(FieldBegin[VELOCITY], idx, l.Velocity().Pos());
+    SetValues(FieldBegin[VELOCITY_ORIENTATION], idx,
+              l.Velocity().Rot().Euler());
+    if (this->tolerances.CheckDynamics)
+    {
+      SetValues(FieldBegin[ACCELERATION], idx, l.Acceleration().Pos());
+      SetValues(FieldBegin[ACCELERATION_ORIENTATION], idx,
+                l.Acceleration().Rot().Euler());
+      SetValues(FieldBegin[FORCE], idx, l.Wrench().Pos());
+      SetValues(FieldBegin[TORQUE], idx, l.Wrench().Rot().Euler());
+    }
+    else
+    {
+      for (size_t v = FieldBegin[ACCELERATION]; v < NumValues; ++v)
+      {
+        this->values[v][idx] = 0;
+      }
+    }
+  }
+
+  for (gazebo::physics::ModelState_M::const_iterator
+       it = model.NestedModelStates().begin();
+       it != model.NestedModelStates().end(); ++it)
+  {
+    FillValues(it->second, base, e);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::SetValues(const size_t first, const size_t idx,
+                                        const ignition::math::Vector3d &vec)
+{
+  this->values[first][idx] = vec.X();
+  this->values[first + 1][idx] = vec.Y();
+  this->values[first + 2][idx] = vec.Z();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::SetQuaternion
+                (const size_t idx, const ignition::math::Quaterniond &q)
+{
+  const size_t first = FieldBegin[ORIENTATION];
+  this->values[first][idx] = q.W();
+  this->values[first + 1][idx] = q.X();
+  this->values[first + 2][idx] = q.Y();
+  this->values[first + 3][idx] = q.Z();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateBatchCompare::ComputeDeviations(const size_t numWorlds)
+{
+  const size_t numEntities = this->names.size();
+  for (int f = 0; f < NUM_FIELDS; ++f)
+  {
+    this->deviations[f].assign(numEntities, 0.0);
+  }
+  if (numEntities == 0) return;
+
+  for (int f = 0; f < NUM_FIELDS; ++f)
+  {
+    const Field field = static_cast<Field>(f);
+    if (field == ORIENTATION) continue;
+    if (!this->tolerances.CheckDynamics && IsDynamicsField(field)) continue;
+    double *dev = this->deviations[f].data();
+    for (size_t v = FieldBegin[f]; v < FieldBegin[f + 1]; ++v)
+    {
+      const double *ref = this->values[v].data();
+      for (size_t w = 1; w < numWorlds; ++w)
+      {
+        // plain loop over contiguous arrays, which the compiler
+        // can vectorize
+        const double *x = ref + w * numEntities;
+        for (size_t e = 0; e < numEntities; ++e)
+        {
+          dev[e] = std::max(dev[e], std::fabs(x[e] - ref[e]));
+        }
+      }
+    }
+  }
+
+  double *dev = this->deviations[ORIENTATION].data();
+  for (size_t w = 1; w < numWorlds; ++w)
+  {
+    for (size_t e = 0; e < numEntities; ++e)
+    {
+      dev[e] = std::max(dev[e], AngleDeviation(w, e));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+size_t GazeboStateBatchCompare::GetWorstWorld(const size_t e,
+                                              const Field field,
+                                              const size_t numWorlds) const
+{
+  size_t worst = 0;
+  double maxDev = -1;
+  for (size_t w = 1; w < numWorlds; ++w)
+  {
+    double dev = 0;
+    if (field == ORIENTATION)
+    {
+      dev = AngleDeviation(w, e);
+    }
+    else
+    {
+      for (size_t v = FieldBegin[field]; v < FieldBegin[field + 1]; ++v)
+      {
+        dev = std::max(dev, Deviation(v, w, e));
+      }
+    }
+    if (dev > maxDev)
+    {
+      maxDev = dev;
+      worst = w;
+    }
+  }
+  return worst;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+double GazeboStateBatchCompare::Deviation(const size_t v, const size_t w,
+                                          const size_t e) const
+{
+  const std::vector<double> &vals = this->values[v];
+  return std::fabs(vals[w * this->names.size() + e] - vals[e]);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+double GazeboStateBatchCompare::AngleDeviation(const size_t w,
+                                               const size_t e) const
+{
+  const size_t idx = w * this->names.size() + e;
+  double dot = 0;
+  for (size_t v = FieldBegin[ORIENTATION]; v < FieldBegin[ORIENTATION + 1];
+       ++v)
+  {
+    dot += this->values[v][idx] * this->values[v][e];
+  }
+  // q and -q are the same orientation
+  return 2.0 * std::acos(std::min(1.0, std::fabs(dot)));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::ostream &collision_benchmark::operator<<
+                (std::ostream &o,
+                 const GazeboStateBatchCompare::Report &report)
+{
+  if (!report.structureEqual)
+  {
+    o << "World " << report.structureWorld << " has different models "
+      << "or links than world 0." << std::endl;
+    return o;
+  }
+  if (report.divergences.empty())
+  {
+    o << "All worlds are equal." << std::endl;
+    return o;
+  }
+  for (std::vector<GazeboStateBatchCompare::Divergence>::const_iterator
+       it = report.divergences.begin(); it != report.divergences.end(); ++it)
+  {
+    o << it->entity << ": " << GazeboStateBatchCompare::GetFieldName(it->field)
+      << " of world " << it->world << " deviates from world 0 by "
+      << it->deviation
+      << " (tolerance " << it->tolerance << ")" << std::endl;
+  }
+  return o;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_GAZEBOSTATE_BATCHCOMPARE_HH
+#define COLLISION_BENCHMARK_GAZEBOSTATE_BATCHCOMPARE_HH
+
+#include <collision_benchmark/GazeboStateCompare.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Compares the states of many Gazebo worlds at once.
+ *
+ * The states of all models and links of N worlds are lined up in aligned
+ * arrays, one array per value and world, holding the value of all entities
+ * (models and links). The maximum deviation of each entity from the first
+ * world is then computed for all entities in one pass over the arrays,
+ * which replaces N-1 pairwise calls of GazeboStateCompare::Equal().
+ *
+ * The first world (world 0) is the reference. All other worlds are
+ * compared against it, not against each other, so the worlds are equal if
+ * they are all within the tolerances of world 0. Two of the other worlds
+ * may then still differ from each other by up to twice the tolerance.
+ *
+ * Other than GazeboStateCompare::Equal(), orientations are compared with
+ * the angle between the quaternions, so GazeboStateCompare::Tolerances
+ * ::Orientation is the maximum angle (radians) of the rotation between
+ * two orientations. Joint states and lights are not compared.
+ *
+ * The arrays are kept between calls of Compare(), so one instance should be
+ * used to compare the worlds repeatedly, e.g. after each step.
+ */
+class GazeboStateBatchCompare
+{
+  /// \brief Classes of values which are compared, each with its own
+  /// tolerance in GazeboStateCompare::Tolerances
+  public: enum Field
+  {
+    POSITION = 0,
+    ORIENTATION,
+    SCALE,
+    VELOCITY,
+    VELOCITY_ORIENTATION,
+    ACCELERATION,
+    ACCELERATION_ORIENTATION,
+    FORCE,
+    TORQUE,
+    NUM_FIELDS
+  };
+
+  /// \brief One value of an entity which deviates more than its tolerance
+  public: struct Divergence
+  {
+    /// scoped name of the model or link
+    std::string entity;
+    /// the value which deviates
+    Field field;
+    /// index of the world which deviates most from the first world
+    size_t world;
+    /// deviation of \e world from the first world
+    double deviation;
+    /// tolerance applied to \e field
+    double tolerance;
+  };
+
+  /// \brief Result of a comparison. All deviations are relative to the
+  /// reference world 0, see class description.
+  public: struct Report
+  {
+    Report(): structureEqual(true), structureWorld(0) {}
+
+    /// \return true if all worlds are equal within the tolerances
+    bool Equal() const { return structureEqual && divergences.empty(); }
+
+    /// false if the worlds don't have the same models and links, in
+    /// which case no values were compared.
+    bool structureEqual;
+    /// if \e structureEqual is false, index of the first world which
+    /// has different models or links than the first world.
+    size_t structureWorld;
+    /// all values which deviate more than the tolerance, in order of the
+    /// entities and fields.
+    std::vector<Divergence> divergences;
+  };
+
+  /// \brief Constructor
+  /// \param[in] tolerances tolerances for the fields. The dynamics
+  ///   (acceleration, force, torque) are only compared if
+  ///   \e tolerances.CheckDynamics is true.
+  public: explicit GazeboStateBatchCompare
+      (const GazeboStateCompare::Tolerances &tolerances =
+         GazeboStateCompare::Tolerances::Default);
+
+  /// \brief Compares all \e states against the first one, which is the
+  /// reference.
+  /// \param[out] report the result, with all values of all worlds
+  ///   which deviate from the first world more than the tolerance.
+  /// \return true if all states are equal within the tolerances
+  public: bool Compare
+      (const std::vector<const gazebo::physics::WorldState*> &states,
+       Report &report);
+
+  /// \brief Convenience function to compare states which are not
+  ///   stored as pointers.
+  public: bool Compare
+      (const std::vector<gazebo::physics::WorldState> &states,
+       Report &report);
+
+  /// \return number of entities (models and links) of the last comparison
+  public: size_t GetNumEntities() const { return this->names.size(); }
+
+  /// \return scoped names of all entities of the last comparison
+  public: const std::vector<std::string> &GetEntityNames() const
+          { return this->names; }
+
+  /// \brief Returns the maximum deviation of an entity from the first world
+  /// in the last comparison.
+  /// \param[in] entity index of the entity in GetEntityNames()
+  /// \param[in] field the field
+  public: double GetMaxDeviation(const size_t entity, const Field field) const
+          { return this->deviations[field][entity]; }
+
+  /// \return the tolerance which is applied to \e field
+  public: double GetTolerance(const Field field) const;
+
+  /// \return name of \e field
+  public: static std::string GetFieldName(const Field field);
+
+  // \brief Number of values which are stored per entity
+  private: static const size_t NumValues = 28;
+
+  // \brief Collects the names of all entities in \e state (in the order
+  // of the arrays) into \e entityNames.
+  private: static void CollectNames(const gazebo::physics::WorldState &state,
+                                    std::vector<std::string> &entityNames);
+
+  // \brief Adds the names of model \e model, its links and its nested
+  // models to \e entityNames, with model names prefixed by \e prefix.
+  private: static void CollectNames(const gazebo::physics::ModelState &model,
+                                    const std::string &prefix,
+                                    std::vector<std::string> &entityNames);
+
+  // \brief Writes the values of all entities of \e state into the arrays
+  // for world \e w.
+  private: void FillValues(const gazebo::physics::WorldState &state,
+                           const size_t w);
+
+  // \brief Writes the values of \e model, its links and nested models
+  // to the arrays, starting at entity \e e of the world at offset \e base.
+  private: void FillValues(const gazebo::physics::ModelState &model,
+                           const size_t base, size_t &e);
+
+  // \brief Writes \e vec to the values \e first to \e first + 2
+  // at index \e idx.
+  private: void SetValues(const size_t first, const size_t idx,
+                          const ignition::math::Vector3d &vec);
+
+  // \brief Writes \e q (w, x, y, z) to the orientation values at \e idx.
+  private: void SetQuaternion(const size_t idx,
+                              const ignition::math::Quaterniond &q);
+
+  // \brief Computes the maximum deviation of all entities for all fields
+  private: void ComputeDeviations(const size_t numWorlds);
+
+  // \brief Returns the index of the world which deviates most from the
+  // first world in \e field for entity \e e.
+  private: size_t GetWorstWorld(const size_t e, const Field field,
+                                const size_t numWorlds) const;
+
+  // \brief Deviation of value \e v of entity \e e in world \e w from
+  // the first world.
+  private: double Deviation(const size_t v, const size_t w,
+                            const size_t e) const;
+
+  // \brief Angle between the orientations of entity \e e in world \e w
+  // and in the first world.
+  private: double AngleDeviation(const size_t w, const size_t e) const;
+
+  // \brief tolerances for the fields
+  private: GazeboStateCompare::Tolerances tolerances;
+
+  // \brief scoped names of all entities
+  private: std::vector<std::string> names;
+
+  // \brief The values of all entities of all worlds. values[v] holds
+  // value v of all entities, world after world: index w * N + e for
+  // N entities.
+  private: std::vector<double> values[NumValues];
+
+  // \brief maximum deviation of all entities from the first world,
+  // per field.
+  private: std::vector<double> deviations[NUM_FIELDS];
+};
+
+/// \brief Prints the report
+std::ostream &operator<<(std::ostream &o,
+                         const GazeboStateBatchCompare::Report &report);
+
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_GAZEBOSTATE_BATCHCOMPARE_HH
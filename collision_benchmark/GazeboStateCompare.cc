@@ -20,6 +20,7 @@
  */
 
 #include <collision_benchmark/GazeboStateCompare.hh>
+#include <collision_benchmark/GazeboStateFingerprint.hh>
 #include <collision_benchmark/GazeboHelpers.hh>
 #include <collision_benchmark/MathHelpers.hh>
 
@@ -47,6 +48,89 @@ const GazeboStateCompare::Tolerances GazeboStateCompare::Tolerances::Default
 bool GazeboStateCompare::Equal(const WorldState &s1, const WorldState &s2,
                                const Tolerances &tolerances,
                                const bool checkLights)
+{
+  if (!EqualStructure(s1, s2, checkLights)) return false;
+
+  // compare model states
+  gazebo::physics::ModelState_M::const_iterator iter_mdl1, iter_mdl2;
+  if (s1.GetModelStates().size() > 0)
+    for (iter_mdl1 = s1.GetModelStates().begin(),
+         iter_mdl2 = s2.GetModelStates().begin();
+         iter_mdl1 != s1.GetModelStates().end(),
+         iter_mdl2 != s2.GetModelStates().end();
+         ++iter_mdl1, ++iter_mdl2)
+    {
+      if (!Equal(iter_mdl1->second, iter_mdl2->second, tolerances))
+      {
+#ifdef DEBUG
+        std::cout << "Model states not equal." << std::endl;
+#endif
+        return false;
+      }
+    }
+
+  // Compare light states
+  if (checkLights && !EqualLights(s1, s2, tolerances)) return false;
+
+  return true;
+}
+
+bool GazeboStateCompare::Equal(const WorldState &s1, const WorldState &s2,
+                               const GazeboStateFingerprint &f1,
+                               const GazeboStateFingerprint &f2,
+                               std::vector<std::string> *differentModels)
+{
+  // matching fingerprints are equal up to a hash collision, which is
+  // negligible (see GazeboStateFingerprint)
+  if (f1.Matches(f2)) return true;
+  if (!differentModels && f1.StructureDiffers(f2)) return false;
+
+  const Tolerances &tolerances = f1.GetTolerances();
+  const bool checkLights = f1.GetCheckLights();
+  if (!EqualStructure(s1, s2, checkLights))
+  {
+    if (differentModels)
+    {
+      // report the models which are only in one of the states
+      std::vector<std::string> names;
+      f1.GetMismatchingModels(f2, names);
+      for (std::vector<std::string>::const_iterator it = names.begin();
+           it != names.end(); ++it)
+      {
+        if ((s1.GetModelStates().count(*it) == 0) ||
+            (s2.GetModelStates().count(*it) == 0))
+          differentModels->push_back(*it);
+      }
+    }
+    return false;
+  }
+
+  // compare only the models for which the fingerprints don't match.
+  // EqualStructure() already checked that the model names are equal.
+  bool equal = true;
+  gazebo::physics::ModelState_M::const_iterator iter_mdl1, iter_mdl2;
+  for (iter_mdl1 = s1.GetModelStates().begin(),
+       iter_mdl2 = s2.GetModelStates().begin();
+       iter_mdl1 != s1.GetModelStates().end();
+       ++iter_mdl1, ++iter_mdl2)
+  {
+    if (f1.ModelMatches(f2, iter_mdl1->first)) continue;
+    if (!Equal(iter_mdl1->second, iter_mdl2->second, tolerances))
+    {
+      if (!differentModels) return false;
+      differentModels->push_back(iter_mdl1->first);
+      equal = false;
+    }
+  }
+
+  if (checkLights && !EqualLights(s1, s2, tolerances)) return false;
+
+  return equal;
+}
+
+bool GazeboStateCompare::EqualStructure(const WorldState &s1,
+                                        const WorldState &s2,
+                                        const bool checkLights)
 {
   if (s1.Insertions().size() != s2.Insertions().size() ||
       s1.Deletions().size() != s2.Deletions().size() ||
@@ -149,25 +233,15 @@ bool GazeboStateCompare::Equal(const WorldState &s1, const WorldState &s2,
       }
     }
 
-  // compare model states
-  if (s1.GetModelStates().size() > 0)
-    for (iter_mdl1 = s1.GetModelStates().begin(),
-         iter_mdl2 = s2.GetModelStates().begin();
-         iter_mdl1 != s1.GetModelStates().end(),
-         iter_mdl2 != s2.GetModelStates().end();
-         ++iter_mdl1, ++iter_mdl2)
-    {
-      if (!Equal(iter_mdl1->second, iter_mdl2->second, tolerances))
-      {
-#ifdef DEBUG
-        std::cout << "Model states not equal." << std::endl;
-#endif
-        return false;
-      }
-    }
+  return true;
+}
 
-  // Compare light states
-  if (checkLights && s1.LightStates().size() > 0)
+bool GazeboStateCompare::EqualLights(const WorldState &s1,
+                                     const WorldState &s2,
+                                     const Tolerances &tolerances)
+{
+  gazebo::physics::LightState_M::const_iterator iter_lt1, iter_lt2;
+  if (s1.LightStates().size() > 0)
     for (iter_lt1 = s1.LightStates().begin(),
          iter_lt2 = s2.LightStates().begin();
          iter_lt1 != s1.LightStates().end(),
@@ -24,6 +24,9 @@
 
 #include <ignition/math/Pose3.hh>
 
+#include <string>
+#include <vector>
+
 // forward declarations
 namespace gazebo
 {
@@ -43,6 +46,8 @@ namespace gazebo
 
 namespace collision_benchmark
 {
+class GazeboStateFingerprint;
+
 /**
  * Provides a number of functions to check for equality of
  * states within a Gazebo world to be equal
@@ -109,6 +114,25 @@ struct GazeboStateCompare
                     const gazebo::physics::WorldState &s2,
                     const Tolerances &tolerance = Tolerances::Default,
                     const bool checkLights = true);
+  // \brief Compares two world states like the other Equal(), but returns
+  // true if the fingerprints match, and skips the detailed comparison of
+  // all models for which the fingerprints match. Returns false early if
+  // the fingerprints show that the structures of the states differ.
+  // Matching fingerprints are equal up to a hash collision, which has a
+  // probability of about 2^-64 per comparison (see GazeboStateFingerprint).
+  // The tolerances and whether to check the lights are taken from \e f1.
+  // \param[in] f1 fingerprint of \e s1
+  // \param[in] f2 fingerprint of \e s2, with the same tolerances as \e f1
+  // \param[out] differentModels if not NULL, all models with mismatching
+  //    fingerprints are compared and the names of the models which are not
+  //    equal are added to it,
+  //    including models which are only in one of the states. If NULL,
+  //    the comparison stops at the first difference.
+  static bool Equal(const gazebo::physics::WorldState &s1,
+                    const gazebo::physics::WorldState &s2,
+                    const GazeboStateFingerprint &f1,
+                    const GazeboStateFingerprint &f2,
+                    std::vector<std::string> *differentModels = NULL);
   static bool Equal(const gazebo::physics::ModelState &s1,
                     const gazebo::physics::ModelState &s2,
                     const Tolerances &tolerance = Tolerances::Default);
@@ -129,6 +153,18 @@ struct GazeboStateCompare
                     const ignition::math::Pose3d &p2,
                     const double &positionTolerance,
                     const double &orientationTolerance);
+
+  // \brief Compares the insertions, deletions and the names of the models
+  // and lights of both states.
+  private: static bool EqualStructure(const gazebo::physics::WorldState &s1,
+                                      const gazebo::physics::WorldState &s2,
+                                      const bool checkLights);
+
+  // \brief Compares the light states of both states, which need to have
+  // the same structure.
+  private: static bool EqualLights(const gazebo::physics::WorldState &s1,
+                                   const gazebo::physics::WorldState &s2,
+                                   const Tolerances &tolerances);
 };
 }
 #endif  //  COLLISION_BENCHMARK_GAZEBOSTATE_COMPARE_HH
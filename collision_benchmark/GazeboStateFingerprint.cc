@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboStateFingerprint.hh>
+
+#include <gazebo/physics/WorldState.hh>
+#include <gazebo/physics/ModelState.hh>
+#include <gazebo/physics/LightState.hh>
+#include <gazebo/physics/LinkState.hh>
+#include <gazebo/physics/JointState.hh>
+#include <gazebo/physics/CollisionState.hh>
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+using gazebo::physics::WorldState;
+using gazebo::physics::ModelState;
+using gazebo::physics::LightState;
+using gazebo::physics::LinkState;
+using gazebo::physics::JointState;
+using gazebo::physics::CollisionState;
+using collision_benchmark::GazeboStateCompare;
+using collision_benchmark::GazeboStateFingerprint;
+
+//////////////////////////////////////////////////////////////////////////////
+// Accumulates quantized values and names into one 64 bit hash.
+class GazeboStateFingerprint::Hasher
+{
+  public: Hasher(): hash(0xcbf29ce484222325ULL), valid(true) {}
+
+  public: void Add(const uint64_t v)
+  {
+    // mixing function of splitmix64
+    uint64_t z = this->hash ^ (v + 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    this->hash = z ^ (z >> 31);
+  }
+
+  public: void Add(const std::string &s)
+  {
+    // FNV-1a over the characters
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+      h = (h ^ static_cast<unsigned char>(*it)) * 0x100000001b3ULL;
+    }
+    Add(h);
+  }
+
+  // adds the index of the bucket of size \e t which \e v falls into
+  public: void Add(const double v, const double t)
+  {
+    const double bucket = std::floor(v / t);
+    // also false for NaN
+    if (!(std::fabs(bucket) < 9e18))
+    {
+      this->valid = false;
+      return;
+    }
+    Add(static_cast<uint64_t>(static_cast<int64_t>(bucket)));
+  }
+
+  public: void Add(const ignition::math::Vector3d &v, const double t)
+  {
+    Add(v.X(), t);
+    Add(v.Y(), t);
+    Add(v.Z(), t);
+  }
+
+  // adds the pose the same way it is compared in GazeboStateCompare, with
+  // the orientation as Euler angles
+  public: void Add(const ignition::math::Pose3d &p,
+                   const double positionTolerance,
+                   const double orientationTolerance)
+  {
+    Add(p.Pos(), positionTolerance);
+    Add(p.Rot().Euler(), orientationTolerance);
+  }
+
+  public: uint64_t hash;
+  public: bool valid;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboStateFingerprint::GazeboStateFingerprint
+      (const GazeboStateCompare::Tolerances &_tolerances,
+       const bool _checkLights):
+  tolerances(_tolerances),
+  checkLights(_checkLights),
+  validTolerances(true),
+  computed(false),
+  changesHash(0),
+  hash(0),
+  structureHash(0),
+  numInvalid(0)
+{
+  const GazeboStateCompare::Tolerances &t = this->tolerances;
+  this->validTolerances = t.Position > 0 && t.Orientation > 0 &&
+                          t.Scale > 0 && t.Velocity > 0 &&
+                          t.VelocityOrientation > 0 && t.JointAngle > 0;
+  if (t.CheckDynamics)
+  {
+    this->validTolerances = this->validTolerances &&
+                            t.Acceleration > 0 &&
+                            t.AccelerationOrientation > 0 &&
+                            t.Force > 0 && t.Torque > 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateFingerprint::Compute(const WorldState &s)
+{
+  this->models.clear();
+  this->lights.clear();
+  this->numInvalid = 0;
+
+  Hasher changes;
+  changes.Add(static_cast<uint64_t>(s.Insertions().size()));
+  for (std::vector<std::string>::const_iterator
+       it = s.Insertions().begin(); it != s.Insertions().end(); ++it)
+    changes.Add(*it);
+  changes.Add(static_cast<uint64_t>(s.Deletions().size()));
+  for (std::vector<std::string>::const_iterator
+       it = s.Deletions().begin(); it != s.Deletions().end(); ++it)
+    changes.Add(*it);
+  this->changesHash = changes.hash;
+  this->hash = this->changesHash;
+  this->structureHash = this->changesHash;
+
+  for (gazebo::physics::ModelState_M::const_iterator
+       it = s.GetModelStates().begin(); it != s.GetModelStates().end(); ++it)
+  {
+    SetEntry(this->models, it->first, ComputeModel(it->second));
+  }
+
+  if (this->checkLights)
+  {
+    for (gazebo::physics::LightState_M::const_iterator
+         it = s.LightStates().begin(); it != s.LightStates().end(); ++it)
+    {
+      SetEntry(this->lights, it->first, ComputeLight(it->second));
+    }
+  }
+  this->computed = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateFingerprint::UpdateModel(const ModelState &s)
+{
+  SetEntry(this->models, s.GetName(), ComputeModel(s));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateFingerprint::UpdateLight(const LightState &s)
+{
+  if (!this->checkLights) return;
+  SetEntry(this->lights, s.GetName(), ComputeLight(s));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateFingerprint::RemoveModel(const std::string &name)
+{
+  EntryMap::iterator it = this->models.find(name);
+  if (it == this->models.end()) return false;
+  this->hash -= Contribution(it->first, it->second.hash);
+  this->structureHash -= Contribution(it->first, it->second.structureHash);
+  if (!it->second.valid) --this->numInvalid;
+  this->models.erase(it);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateFingerprint::Matches(const GazeboStateFingerprint &other) const
+{
+  return this->computed && other.computed &&
+         this->validTolerances && SameTolerances(other) &&
+         (this->numInvalid == 0) && (other.numInvalid == 0) &&
+         (this->models.size() == other.models.size()) &&
+         (this->lights.size() == other.lights.size()) &&
+         (this->hash == other.hash);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateFingerprint::ModelMatches(const GazeboStateFingerprint &other,
+                                          const std::string &name) const
+{
+  if (!this->validTolerances || !SameTolerances(other)) return false;
+  EntryMap::const_iterator it1 = this->models.find(name);
+  EntryMap::const_iterator it2 = other.models.find(name);
+  if (it1 == this->models.end() || it2 == other.models.end()) return false;
+  return it1->second.valid && it2->second.valid &&
+         (it1->second.hash == it2->second.hash);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateFingerprint::StructureDiffers
+                (const GazeboStateFingerprint &other) const
+{
+  // without the lights in both, the structures can't be compared
+  return this->computed && other.computed &&
+         (this->checkLights == other.checkLights) &&
+         ((this->models.size() != other.models.size()) ||
+          (this->lights.size() != other.lights.size()) ||
+          (this->structureHash != other.structureHash));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateFingerprint::ModelPlacementMatches
+                (const std::string &name,
+                 const ignition::math::Pose3d &pose,
+                 const ignition::math::Vector3d &scale) const
+{
+  EntryMap::const_iterator it = this->models.find(name);
+  if (it == this->models.end() || !it->second.valid) return false;
+  Hasher placement;
+  placement.Add(pose, this->tolerances.Position, this->tolerances.Orientation);
+  placement.Add(scale, this->tolerances.Scale);
+  return placement.valid && (placement.hash == it->second.placementHash);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateFingerprint::GetMismatchingModels
+                (const GazeboStateFingerprint &other,
+                 std::vector<std::string> &names) const
+{
+  // both maps are ordered by name, so they can be merged in one pass
+  EntryMap::const_iterator it1 = this->models.begin();
+  EntryMap::const_iterator it2 = other.models.begin();
+  while (it1 != this->models.end() || it2 != other.models.end())
+  {
+    if (it2 == other.models.end() ||
+        (it1 != this->models.end() && it1->first < it2->first))
+    {
+      names.push_back(it1->first);
+      ++it1;
+    }
+    else if (it1 == this->models.end() || it2->first < it1->first)
+    {
+      names.push_back(it2->first);
+      ++it2;
+    }
+    else
+    {
+      if (!ModelMatches(other, it1->first))
+        names.push_back(it1->first);
+      ++it1;
+      ++it2;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboStateFingerprint::Entry
+GazeboStateFingerprint::ComputeModel(const ModelState &s) const
+{
+  const GazeboStateCompare::Tolerances &t = this->tolerances;
+  Entry entry;
+
+  Hasher placement;
+  placement.Add(s.Pose(), t.Position, t.Orientation);
+  placement.Add(s.Scale(), t.Scale);
+  entry.placementHash = placement.hash;
+
+  Hasher h;
+  h.Add(s.GetName());
+  h.Add(placement.hash);
+  h.valid = placement.valid;
+
+  Hasher structure;
+  structure.Add(s.GetName());
+
+  h.Add(static_cast<uint64_t>(s.GetLinkStates().size()));
+  structure.Add(static_cast<uint64_t>(s.GetLinkStates().size()));
+  for (gazebo::physics::LinkState_M::const_iterator
+       it = s.GetLinkStates().begin(); it != s.GetLinkStates().end(); ++it)
+  {
+    const LinkState &l = it->second;
+    h.Add(it->first);
+    structure.Add(it->first);
+    h.Add(l.Pose(), t.Position, t.Orientation);
+    h.Add(l.Velocity(), t.Velocity, t.VelocityOrientation);
+    if (t.CheckDynamics)
+    {
+      h.Add(l.Acceleration(), t.Acceleration, t.AccelerationOrientation);
+      h.Add(l.Wrench().Pos(), t.Force);
+      h.Add(l.Wrench().Rot().Euler(), t.Torque);
+    }
+    if (t.CheckLinkCollisionStates)
+    {
+      h.Add(static_cast<uint64_t>(l.GetCollisionStates().size()));
+      for (std::vector<CollisionState>::const_iterator
+           cIt = l.GetCollisionStates().begin();
+           cIt != l.GetCollisionStates().end(); ++cIt)
+      {
+        h.Add(cIt->GetName());
+        h.Add(cIt->Pose(), t.Position, t.Orientation);
+      }
+    }
+  }
+
+  h.Add(static_cast<uint64_t>(s.GetJointStates().size()));
+  structure.Add(static_cast<uint64_t>(s.GetJointStates().size()));
+  for (gazebo::physics::JointState_M::const_iterator
+       it = s.GetJointStates().begin(); it != s.GetJointStates().end(); ++it)
+  {
+    h.Add(it->first);
+    structure.Add(it->first);
+    const std::vector<double> &positions = it->second.Positions();
+    h.Add(static_cast<uint64_t>(positions.size()));
+    for (std::vector<double>::const_iterator
+         pIt = positions.begin(); pIt != positions.end(); ++pIt)
+      h.Add(*pIt, t.JointAngle);
+  }
+
+  h.Add(static_cast<uint64_t>(s.NestedModelStates().size()));
+  structure.Add(static_cast<uint64_t>(s.NestedModelStates().size()));
+  for (gazebo::physics::ModelState_M::const_iterator
+       it = s.NestedModelStates().begin();
+       it != s.NestedModelStates().end(); ++it)
+  {
+    const Entry nested = ComputeModel(it->second);
+    h.Add(nested.hash);
+    h.valid = h.valid && nested.valid;
+    structure.Add(nested.structureHash);
+  }
+
+  entry.hash = h.hash;
+  entry.structureHash = structure.hash;
+  entry.valid = h.valid;
+  return entry;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboStateFingerprint::Entry
+GazeboStateFingerprint::ComputeLight(const LightState &s) const
+{
+  Hasher h;
+  h.Add(s.GetName());
+  h.Add(s.Pose(), this->tolerances.Position, this->tolerances.Orientation);
+  Hasher structure;
+  structure.Add(s.GetName());
+  Entry entry;
+  entry.hash = h.hash;
+  entry.structureHash = structure.hash;
+  entry.valid = h.valid;
+  return entry;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboStateFingerprint::SetEntry(EntryMap &map, const std::string &name,
+                                      const Entry &entry)
+{
+  std::pair<EntryMap::iterator, bool> ins =
+    map.insert(std::make_pair(name, entry));
+  if (!ins.second)
+  {
+    this->hash -= Contribution(name, ins.first->second.hash);
+    this->structureHash -=
+      Contribution(name, ins.first->second.structureHash);
+    if (!ins.first->second.valid) --this->numInvalid;
+    ins.first->second = entry;
+  }
+  this->hash += Contribution(name, entry.hash);
+  this->structureHash += Contribution(name, entry.structureHash);
+  if (!entry.valid) ++this->numInvalid;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+uint64_t GazeboStateFingerprint::Contribution(const std::string &name,
+                                              const uint64_t hash)
+{
+  Hasher h;
+  h.Add(name);
+  h.Add(hash);
+  return h.hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool GazeboStateFingerprint::SameTolerances
+                (const GazeboStateFingerprint &other) const
+{
+  const GazeboStateCompare::Tolerances &t1 = this->tolerances;
+  const GazeboStateCompare::Tolerances &t2 = other.tolerances;
+  return (this->checkLights == other.checkLights) &&
+         (t1.Scale == t2.Scale) &&
+         (t1.Position == t2.Position) &&
+         (t1.Orientation == t2.Orientation) &&
+         (t1.Force == t2.Force) &&
+         (t1.Torque == t2.Torque) &&
+         (t1.Velocity == t2.Velocity) &&
+         (t1.VelocityOrientation == t2.VelocityOrientation) &&
+         (t1.Acceleration == t2.Acceleration) &&
+         (t1.AccelerationOrientation == t2.AccelerationOrientation) &&
+         (t1.JointAngle == t2.JointAngle) &&
+         (t1.CheckLinkCollisionStates == t2.CheckLinkCollisionStates) &&
+         (t1.CheckDynamics == t2.CheckDynamics);
+}
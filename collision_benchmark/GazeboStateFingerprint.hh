@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_GAZEBOSTATE_FINGERPRINT_HH
+#define COLLISION_BENCHMARK_GAZEBOSTATE_FINGERPRINT_HH
+
+#include <collision_benchmark/GazeboStateCompare.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Quantized fingerprint of a Gazebo world state.
+ *
+ * All values which GazeboStateCompare::Equal() compares are quantized into
+ * buckets of the size of their tolerance and hashed, one hash per model
+ * and light, plus one for the insertions and deletions. If all values of
+ * two states fall into the same buckets, they differ by less than the
+ * tolerances, so two states with matching fingerprints are equal according
+ * to GazeboStateCompare::Equal() up to 64 bit hash collisions.
+ * The hashes are mixed with splitmix64, so for two states which differ,
+ * the fingerprints match by chance with a probability of about 2^-64
+ * (5e-20) per comparison. Even at a billion comparisons per second, this
+ * is expected to happen once in about 600 years, which is why
+ * GazeboStateCompare::Equal() accepts matching fingerprints as equal.
+ * Values which differ by less than the tolerance may still fall into
+ * neighbouring buckets, so different fingerprints only mean that the
+ * states have to be compared in detail.
+ *
+ * Additionally, the structure of the state (insertions, deletions and the
+ * names of all models, links, joints and lights) is hashed exactly. Equal
+ * structures always have equal structure hashes, so if the structure
+ * hashes differ, the states are known to be different without comparing
+ * them, see StructureDiffers().
+ *
+ * The hashes of the whole state are the sums of all individual hashes, so
+ * they can be updated incrementally when only single models change.
+ */
+class GazeboStateFingerprint
+{
+  /// \brief Constructor
+  /// \param[in] tolerances the tolerances which are used as bucket sizes.
+  ///   If any of the used tolerances is not positive, fingerprints never
+  ///   match, as GazeboStateCompare::Equal() never considers values equal.
+  /// \param[in] checkLights whether to include the light states
+  public: explicit GazeboStateFingerprint
+      (const GazeboStateCompare::Tolerances &tolerances =
+         GazeboStateCompare::Tolerances::Default,
+       const bool checkLights = true);
+
+  /// \brief Computes the fingerprint of the whole state \e s.
+  /// Replaces any previous fingerprint.
+  public: void Compute(const gazebo::physics::WorldState &s);
+
+  /// \brief Updates the fingerprint of a single model. If the model was
+  /// not part of the fingerprint yet, it is added.
+  public: void UpdateModel(const gazebo::physics::ModelState &s);
+
+  /// \brief Updates the fingerprint of a single light. If the light was
+  /// not part of the fingerprint yet, it is added.
+  public: void UpdateLight(const gazebo::physics::LightState &s);
+
+  /// \brief Removes a model from the fingerprint
+  /// \return false if the model was not part of the fingerprint
+  public: bool RemoveModel(const std::string &name);
+
+  /// \return true if Compute() has been called
+  public: bool IsComputed() const { return this->computed; }
+
+  /// \return the hash of the whole state
+  public: uint64_t GetHash() const { return this->hash; }
+
+  /// \return number of (top-level) models in the fingerprint
+  public: size_t GetNumModels() const { return this->models.size(); }
+
+  /// \return true if the model \e name is part of the fingerprint
+  public: bool HasModel(const std::string &name) const
+          { return this->models.count(name) > 0; }
+
+  /// \return the tolerances used as bucket sizes
+  public: const GazeboStateCompare::Tolerances &GetTolerances() const
+          { return this->tolerances; }
+
+  /// \return whether the light states are included
+  public: bool GetCheckLights() const { return this->checkLights; }
+
+  /// \brief Checks whether the fingerprints of the whole states match.
+  /// Fingerprints only match if they use the same tolerances.
+  /// \return true if the states are equal without further comparison,
+  ///   up to the hash collision probability given in the class description
+  public: bool Matches(const GazeboStateFingerprint &other) const;
+
+  /// \brief Checks whether the fingerprints of model \e name match.
+  /// \return true if the model states are equal without further
+  ///   comparison, up to the hash collision probability given in the
+  ///   class description
+  public: bool ModelMatches(const GazeboStateFingerprint &other,
+                            const std::string &name) const;
+
+  /// \brief Checks whether the structures of the states differ.
+  /// \return true if the states are known to be different according to
+  ///   GazeboStateCompare::Equal(). False if they may be equal, in which
+  ///   case they have to be compared in detail.
+  public: bool StructureDiffers(const GazeboStateFingerprint &other) const;
+
+  /// \brief Checks whether the pose and scale of model \e name fall into
+  /// the same buckets as when its fingerprint was computed. Allows to
+  /// cheaply skip the update of models which can't have moved otherwise,
+  /// like static models.
+  public: bool ModelPlacementMatches
+                (const std::string &name,
+                 const ignition::math::Pose3d &pose,
+                 const ignition::math::Vector3d &scale) const;
+
+  /// \brief Collects the names of all models of which the fingerprints
+  /// don't match, including models which are only in one of the
+  /// fingerprints. Those models have to be compared in detail.
+  public: void GetMismatchingModels(const GazeboStateFingerprint &other,
+                                    std::vector<std::string> &names) const;
+
+  // \brief Fingerprint of one model or light
+  private: struct Entry
+  {
+    Entry(): hash(0), placementHash(0), structureHash(0), valid(true) {}
+    uint64_t hash;
+    // hash of the model pose and scale only
+    uint64_t placementHash;
+    // hash of the names only, which is exact
+    uint64_t structureHash;
+    // false if a value could not be quantized (e.g. it was NaN),
+    // in which case the entry never matches.
+    bool valid;
+  };
+
+  private: typedef std::map<std::string, Entry> EntryMap;
+
+  // Helper class which accumulates quantized values into one hash
+  private: class Hasher;
+
+  // Computes the fingerprint of model state \e s
+  private: Entry ComputeModel(const gazebo::physics::ModelState &s) const;
+
+  // Computes the fingerprint of light state \e s
+  private: Entry ComputeLight(const gazebo::physics::LightState &s) const;
+
+  // Sets \e entry in \e map and updates the hash of the whole state
+  private: void SetEntry(EntryMap &map, const std::string &name,
+                         const Entry &entry);
+
+  // Returns the contribution of the hash \e hash of the entry with name
+  // \e name to the hash of the whole state
+  private: static uint64_t Contribution(const std::string &name,
+                                        const uint64_t hash);
+
+  // \brief true if \e other uses the same tolerances and settings
+  private: bool SameTolerances(const GazeboStateFingerprint &other) const;
+
+  // \brief tolerances used as bucket sizes
+  private: GazeboStateCompare::Tolerances tolerances;
+
+  // \brief whether to include the light states
+  private: bool checkLights;
+
+  // \brief false if any of the used tolerances is not positive
+  private: bool validTolerances;
+
+  // \brief true once Compute() was called
+  private: bool computed;
+
+  // \brief fingerprint of the insertions and deletions
+  private: uint64_t changesHash;
+
+  // \brief hash of the whole state
+  private: uint64_t hash;
+
+  // \brief hash of the structure of the whole state
+  private: uint64_t structureHash;
+
+  // \brief number of entries which are not valid
+  private: size_t numInvalid;
+
+  // \brief fingerprints of all top-level models (including their links,
+  // joints and nested models), by model name
+  private: EntryMap models;
+
+  // \brief fingerprints of all lights, by light name
+  private: EntryMap lights;
+};
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_GAZEBOSTATE_FINGERPRINT_HH
@@ -31,10 +31,15 @@
 #include <gazebo/transport/Publisher.hh>
 #include <gazebo/transport/Subscriber.hh>
 
+#include <chrono>
+#include <condition_variable>
 #include <string>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <list>
+#include <thread>
 
 namespace collision_benchmark
 {
@@ -62,6 +67,118 @@ class MessageFilter
           (const boost::shared_ptr<Msg const> &_msg) const = 0;
 };
 
+/**
+ * \brief Combines the messages which arrive in between two publications
+ * of a rate-limited GazeboTopicForwarder into one message.
+ *
+ * By default, a newer message replaces the pending one, which is suitable
+ * for messages which describe the complete current state (e.g. world
+ * statistics or contacts). Specializations can merge messages which only
+ * describe a part of the state.
+ */
+template<typename Msg_>
+class MessageCoalescer
+{
+  public: typedef Msg_ Msg;
+
+  public: MessageCoalescer(): hasPending(false) {}
+
+  // \brief Combines \e msg with the pending message
+  public: void Add(const Msg &msg)
+          {
+            this->pending.CopyFrom(msg);
+            this->hasPending = true;
+          }
+
+  // \brief Moves the pending message into \e msg
+  // \return false if there is no pending message
+  public: bool Take(Msg &msg)
+          {
+            if (!this->hasPending) return false;
+            msg.Swap(&this->pending);
+            this->Clear();
+            return true;
+          }
+
+  // \return true if a message was added since the last Take()
+  public: bool HasPending() const { return this->hasPending; }
+
+  // \brief Discards the pending message
+  public: void Clear()
+          {
+            this->pending.Clear();
+            this->hasPending = false;
+          }
+
+  private: Msg pending;
+  private: bool hasPending;
+};
+
+/**
+ * \brief Merges pose messages, so that the pending message has the
+ * latest pose of each entity.
+ *
+ * The entities are identified by the pose id, or by the pose name if
+ * there is no id. The time of the pending message is the time of the
+ * latest message.
+ */
+template<>
+class MessageCoalescer<gazebo::msgs::PosesStamped>
+{
+  public: typedef gazebo::msgs::PosesStamped Msg;
+
+  public: MessageCoalescer(): hasPending(false) {}
+
+  public: void Add(const Msg &msg)
+          {
+            this->pending.mutable_time()->CopyFrom(msg.time());
+            for (int i = 0; i < msg.pose_size(); ++i)
+            {
+              const gazebo::msgs::Pose &pose = msg.pose(i);
+              int &idx = pose.has_id() ? this->idIndex[pose.id()]
+                                       : this->nameIndex[pose.name()];
+              // indices are stored + 1, so that 0 is a new entity
+              if (idx == 0)
+              {
+                this->pending.add_pose()->CopyFrom(pose);
+                idx = this->pending.pose_size();
+              }
+              else
+              {
+                this->pending.mutable_pose(idx - 1)->CopyFrom(pose);
+              }
+            }
+            this->hasPending = true;
+          }
+
+  public: bool Take(Msg &msg)
+          {
+            if (!this->hasPending) return false;
+            msg.Swap(&this->pending);
+            this->Clear();
+            return true;
+          }
+
+  public: bool HasPending() const { return this->hasPending; }
+
+  public: void Clear()
+          {
+            this->pending.Clear();
+            this->idIndex.clear();
+            this->nameIndex.clear();
+            this->hasPending = false;
+          }
+
+  private: Msg pending;
+  private: bool hasPending;
+
+  // index + 1 of the poses in \e pending by pose id
+  private: std::map<unsigned int, int> idIndex;
+
+  // index + 1 of the poses without id in \e pending by pose name
+  private: std::map<std::string, int> nameIndex;
+};
+
 /**
  * \brief forwards messages from one topic to another
  * \author Jennifer Buehler
@@ -82,7 +199,8 @@ class GazeboTopicForwarder
   public: GazeboTopicForwarder(const MessageFilterConstPtr _filter = nullptr,
                                const bool _verbose = false):
           msgFilter(_filter),
-          verbose(_verbose)
+          verbose(_verbose),
+          coalescing(false)
           {
           }
 
@@ -100,16 +218,59 @@ class GazeboTopicForwarder
                               const MessageFilterConstPtr _filter = nullptr,
                               const bool _verbose = false):
           msgFilter(_filter),
-          verbose(_verbose)
+          verbose(_verbose),
+          coalescing(false)
           {
             ForwardTo(_to, _node, _pubQueueLimit, _pubHzRate);
           }
-  public: virtual ~GazeboTopicForwarder() {}
+  public: virtual ~GazeboTopicForwarder()
+          {
+            SetCoalescing(0);
+          }
 
-  // \brief Disconnects the subscribers
+  // \brief Enables or disables the coalescing mode.
+  // In coalescing mode, messages are not re-published as they arrive.
+  // Instead, the messages arriving in between two publications are
+  // combined with MessageCoalescer and published from a dedicated thread,
+  // at most \e rateHz times per second. Older messages are dropped instead
+  // of being queued, so the number of forwarded messages stays bounded no
+  // matter how fast messages arrive. This also applies to Publish().
+  // Must not be called concurrently with itself.
+  // \param rateHz maximum publishing rate. If <= 0, the coalescing mode
+  //    is disabled, discarding any message which was not published yet.
+  public: void SetCoalescing(const double rateHz)
+          {
+            {
+              std::lock_guard<std::mutex> lock(this->coalesceMutex);
+              this->coalescing = false;
+            }
+            this->coalesceCond.notify_all();
+            if (this->coalesceThread.joinable()) this->coalesceThread.join();
+
+            std::lock_guard<std::mutex> lock(this->coalesceMutex);
+            this->coalescer.Clear();
+            if (rateHz <= 0) return;
+            this->coalescePeriod =
+              std::chrono::duration<double>(1.0 / rateHz);
+            this->coalescing = true;
+            this->coalesceThread =
+              std::thread(&GazeboTopicForwarder::CoalesceLoop, this);
+          }
+
+  // \return true if the coalescing mode is enabled, see SetCoalescing()
+  public: bool IsCoalescing() const
+          {
+            std::lock_guard<std::mutex> lock(this->coalesceMutex);
+            return this->coalescing;
+          }
+
+  // \brief Disconnects the subscribers. In coalescing mode, messages which
+  // were not published yet are discarded.
   public: void DisconnectSubscriber()
           {
             if (this->sub) this->sub->Unsubscribe();
+            std::lock_guard<std::mutex> lock(this->coalesceMutex);
+            this->coalescer.Clear();
           }
 
   public: void Forward(const std::string &_from,
@@ -163,6 +324,16 @@ class GazeboTopicForwarder
             }
           }
 
+  // \brief Publishes \e msg on the topic which messages are forwarded to,
+  // which can be used to complement the forwarded messages.
+  // Does nothing if ForwardTo() was not called yet.
+  public: void Publish(const Msg &msg)
+          {
+            if (Coalesce(msg)) return;
+            std::lock_guard<std::mutex> lock(transportMutex);
+            if (this->pub) this->pub->Publish(msg);
+          }
+
 //  public: gazebo::transport::PublisherPtr GetPublisher() const
 //          { return this->pub; }
 //  public: gazebo::transport::SubscriberPtr GetSubscriber() const
@@ -237,10 +408,53 @@ class GazeboTopicForwarder
       return;
     }
 
+    if (Coalesce(*msgToFwd)) return;
+
     // this->pub->WaitForConnection();
     this->pub->Publish(*msgToFwd);
   }
 
+  // \brief Adds \e msg to the messages to be published by CoalesceLoop()
+  // \return false if the coalescing mode is disabled
+  private: bool Coalesce(const Msg &msg)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->coalesceMutex);
+      if (!this->coalescing) return false;
+      this->coalescer.Add(msg);
+    }
+    this->coalesceCond.notify_one();
+    return true;
+  }
+
+  // \brief Publishes the coalesced messages until the coalescing mode
+  // is disabled. A message which arrives after a break longer than the
+  // publishing period is published right away.
+  private: void CoalesceLoop()
+  {
+    std::chrono::steady_clock::time_point next =
+      std::chrono::steady_clock::now();
+    Msg msg;
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(this->coalesceMutex);
+        this->coalesceCond.wait(lock, [this]()
+          { return !this->coalescing || this->coalescer.HasPending(); });
+        // more messages may be added to the pending one while waiting
+        if (this->coalesceCond.wait_until(lock, next, [this]()
+              { return !this->coalescing; }))
+          return;
+        this->coalescer.Take(msg);
+      }
+      next = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>
+          (this->coalescePeriod);
+      std::lock_guard<std::mutex> lock(transportMutex);
+      if (this->pub) this->pub->Publish(msg);
+    }
+  }
+
   /// \brief Publisher for forwarding messages.
   private: gazebo::transport::PublisherPtr pub;
 
@@ -255,6 +469,24 @@ class GazeboTopicForwarder
 
   /// \brief for debugging
   private: bool verbose;
+
+  /// \brief Protects \e coalescing and \e coalescer
+  private: mutable std::mutex coalesceMutex;
+
+  /// \brief Signals new messages to the coalescing thread
+  private: std::condition_variable coalesceCond;
+
+  /// \brief Flag whether the coalescing mode is enabled
+  private: bool coalescing;
+
+  /// \brief Combines the messages to be published in coalescing mode
+  private: MessageCoalescer<Msg> coalescer;
+
+  /// \brief Minimum time in between two publications in coalescing mode
+  private: std::chrono::duration<double> coalescePeriod;
+
+  /// \brief Thread publishing the messages in coalescing mode
+  private: std::thread coalesceThread;
 };
 
 
@@ -30,6 +30,8 @@
 #include <gazebo/physics/PhysicsEngine.hh>
 #include <gazebo/physics/ContactManager.hh>
 #include <gazebo/physics/Model.hh>
+#include <gazebo/physics/Link.hh>
+#include <gazebo/msgs/msgs.hh>
 
 #include <gazebo/transport/TopicManager.hh>
 #include <gazebo/transport/TransportIface.hh>
@@ -125,11 +127,16 @@ class WorldStatMsgFilter
   private: MirrorWeakPtr mirror;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+constexpr double GazeboTopicForwardingMirror::DefaultDisplayRate;
+
 ///////////////////////////////////////////////////////////////////////////////
 GazeboTopicForwardingMirror::GazeboTopicForwardingMirror
-    (const std::string &worldname):
+    (const std::string &worldname, const double _displayRate):
       worldName(worldname),
-      initialized(false)
+      initialized(false),
+      displayRate(_displayRate),
+      detached(false)
 {
   // register the topic namespace first off, in order to allow gzclient
   // to connect to it. This should be done before Init(), which can only
@@ -348,6 +355,25 @@ void GazeboTopicForwardingMirror::Init()
   this->modelPub = this->node->Advertise<gazebo::msgs::Model>("~/model/info");
   // std::cout << "GazeboTopicForwardingMirror initialized." << std::endl;
   this->initialized = true;
+
+  SetDisplayRate(this->displayRate);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void GazeboTopicForwardingMirror::SetDisplayRate(const double rateHz)
+{
+  this->displayRate = rateHz;
+  // the forwarders are created in Init(), which applies the rate
+  if (!this->initialized) return;
+
+  // these are published by the original world in every update. All other
+  // messages (e.g. models and visuals) need to be forwarded in full.
+  assert(this->poseFwd);
+  this->poseFwd->SetCoalescing(rateHz);
+  assert(this->contactFwd);
+  this->contactFwd->SetCoalescing(rateHz);
+  assert(this->statFwd);
+  this->statFwd->SetCoalescing(rateHz);
 }
 
 
@@ -445,7 +471,7 @@ void GazeboTopicForwardingMirror::NotifyOriginalWorldChange
   OriginalWorldPtr oldWorld = GetOriginalWorld();
   GazeboPhysicsEngineWorld::Ptr gzNewWorld =
     std::dynamic_pointer_cast<GazeboPhysicsEngineWorld>(_newWorld);
-  if (!gzNewWorld)
+  if (_newWorld && !gzNewWorld)
   {
     THROW_EXCEPTION("Only Gazebo original worlds supported");
   }
@@ -477,7 +503,18 @@ void GazeboTopicForwardingMirror::NotifyOriginalWorldChange
       this->requestPub->Publish(*msg, true);
       delete msg;
     }
+  }
+
+  // the mirror is detached from the original world. Nothing is mirrored
+  // until the next original world is set.
+  if (!gzNewWorld)
+  {
+    this->detached = true;
+    return;
+  }
 
+  if (oldWorld || this->detached)
+  {
     // insert all new models
     gazebo::physics::Model_V newModels = gzNewWorld->GetWorld()->Models();
     for (gazebo::physics::Model_V::iterator it = newModels.begin();
@@ -489,6 +526,7 @@ void GazeboTopicForwardingMirror::NotifyOriginalWorldChange
       this->modelPub->Publish(insModelMsg);
     }
   }
+  this->detached = false;
 
   ConnectOriginalWorld(_newWorld->GetName());
 }
@@ -496,4 +534,42 @@ void GazeboTopicForwardingMirror::NotifyOriginalWorldChange
 ///////////////////////////////////////////////////////////////////////////////
 void GazeboTopicForwardingMirror::Sync()
 {
+  // Worlds in headless mode don't space out the setting of poses for the
+  // throttled pose publisher of gazebo::physics::World, so the latest poses
+  // may have been dropped. Publish the current poses of all models and
+  // their links, the same way gazebo::physics::World does.
+  collision_benchmark::GazeboPhysicsWorld::Ptr gzWorld =
+    std::dynamic_pointer_cast<collision_benchmark::GazeboPhysicsWorld>
+      (GetOriginalWorld());
+  if (!gzWorld || !this->poseFwd || !gzWorld->ConsumeHeadlessPoseChange())
+    return;
+
+  collision_benchmark::GazeboPhysicsWorld::WorldPtr
+    world = gzWorld->GetWorld();
+  gazebo::msgs::PosesStamped msg;
+  gazebo::msgs::Set(msg.mutable_time(), world->SimTime());
+  gazebo::physics::Model_V allModels = world->Models();
+  std::list<gazebo::physics::ModelPtr> models(allModels.begin(),
+                                              allModels.end());
+  while (!models.empty())
+  {
+    gazebo::physics::ModelPtr m = models.front();
+    models.pop_front();
+    gazebo::msgs::Pose *poseMsg = msg.add_pose();
+    poseMsg->set_name(m->GetScopedName());
+    poseMsg->set_id(m->GetId());
+    gazebo::msgs::Set(poseMsg, m->RelativePose());
+    gazebo::physics::Link_V links = m->GetLinks();
+    for (gazebo::physics::Link_V::iterator it = links.begin();
+         it != links.end(); ++it)
+    {
+      poseMsg = msg.add_pose();
+      poseMsg->set_name((*it)->GetScopedName());
+      poseMsg->set_id((*it)->GetId());
+      gazebo::msgs::Set(poseMsg, (*it)->RelativePose());
+    }
+    gazebo::physics::Model_V nested = m->NestedModels();
+    models.insert(models.end(), nested.begin(), nested.end());
+  }
+  this->poseFwd->Publish(msg);
 }
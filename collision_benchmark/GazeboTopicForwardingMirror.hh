@@ -61,9 +61,17 @@ class GazeboTopicForwardingMirror
                 gazebo::physics::PhysicsEngine,
                 gazebo::physics::World> GazeboPhysicsEngineWorld;
 
+    /// Default maximum rate (in Hz) at which poses, contacts and world
+    /// statistics are forwarded, see SetDisplayRate(). This is the rate at
+    /// which gazebo::physics::World publishes poses.
+    public: static constexpr double DefaultDisplayRate = 60;
+
     /// Constructor.
+    /// \param displayRate see SetDisplayRate()
     public:  GazeboTopicForwardingMirror(const std::string &worldname
-                                          = "default");
+                                          = "default",
+                                         const double displayRate
+                                          = DefaultDisplayRate);
     // prohibit copy constructor
     private: GazeboTopicForwardingMirror(const GazeboTopicForwardingMirror &o)
              {}
@@ -80,6 +88,19 @@ class GazeboTopicForwardingMirror
 
     public: virtual std::string GetName() const { return worldName; }
 
+    /// \brief Sets the maximum rate at which the pose, contact and world
+    /// statistics messages of the original world are forwarded.
+    /// Messages arriving faster are coalesced so that only the latest
+    /// message (and the latest pose of each entity) is forwarded, see
+    /// GazeboTopicForwarder::SetCoalescing(). This keeps the load of the
+    /// clients bounded, no matter how fast the original world is updated.
+    /// \param rateHz the rate. If <= 0, all messages are forwarded as they
+    ///   arrive.
+    public: void SetDisplayRate(const double rateHz);
+
+    /// \return the rate set with SetDisplayRate()
+    public: double GetDisplayRate() const { return displayRate; }
+
     private: void DisconnectFromOriginal();
 
     // Initializes the topic forwarder. Will be called
@@ -140,6 +161,14 @@ class GazeboTopicForwardingMirror
 
     private: std::string worldName;
     private: bool initialized;
+
+    /// \brief the rate set with SetDisplayRate()
+    private: double displayRate;
+
+    /// \brief true if the original world was set to NULL after the
+    /// mirror was connected to an original world, so the models of the
+    /// next original world have to be inserted in the clients.
+    private: bool detached;
 };
 }  // namespace collision_benchmark
 #endif
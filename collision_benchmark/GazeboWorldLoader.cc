@@ -23,6 +23,8 @@
 #include <collision_benchmark/GazeboWorldLoader.hh>
 #include <collision_benchmark/GazeboWorldState.hh>
 #include <collision_benchmark/GazeboHelpers.hh>
+#include <collision_benchmark/GazeboNamespaceNotifier.hh>
+#include <collision_benchmark/GazeboWorldTemplateCache.hh>
 #include <collision_benchmark/Exception.hh>
 #include <collision_benchmark/boost_std_conversion.hh>
 
@@ -35,6 +37,8 @@ using collision_benchmark::PhysicsWorldBaseInterface;
 using collision_benchmark::WorldLoader;
 using collision_benchmark::GazeboWorldLoader;
 using collision_benchmark::GazeboPhysicsWorld;
+using collision_benchmark::GazeboNamespaceNotifier;
+using collision_benchmark::GazeboWorldTemplateCache;
 
 // generates a world name consisting of \e baseName and \e engineName
 std::string generateWorldName(const std::string &baseName,
@@ -47,9 +51,11 @@ std::string generateWorldName(const std::string &baseName,
 }
 
 GazeboWorldLoader::GazeboWorldLoader(const std::string &_engine,
-                                     const bool _alwaysCalcContacts)
+                                     const bool _alwaysCalcContacts,
+                                     const bool _headless)
   : WorldLoader(_engine),
-    alwaysCalcContacts(_alwaysCalcContacts)
+    alwaysCalcContacts(_alwaysCalcContacts),
+    headless(_headless)
 {
   std::string physicsSDF =
     collision_benchmark::getPhysicsSettingsSdfFor(_engine);
@@ -60,7 +66,7 @@ GazeboWorldLoader::GazeboWorldLoader(const std::string &_engine,
   std::cout << "Loading physics from " << physicsSDF << std::endl;
   // Get the physics SDF element from the file.
   // This will only succeed if it is in the GAZEBO_RESOURCE_PATH
-  physics = collision_benchmark::GetPhysicsFromSDF(physicsSDF);
+  physics = GazeboWorldTemplateCache::Instance().GetPhysics(physicsSDF);
   if (!physics)
   {
     THROW_EXCEPTION("Could not get phyiscs engine from " << physicsSDF);
@@ -68,9 +74,11 @@ GazeboWorldLoader::GazeboWorldLoader(const std::string &_engine,
   // std::cout << "Physics: " << physics->ToString("") << std::endl;
 }
 
-GazeboWorldLoader::GazeboWorldLoader(const bool _alwaysCalcContacts)
+GazeboWorldLoader::GazeboWorldLoader(const bool _alwaysCalcContacts,
+                                     const bool _headless)
     : WorldLoader(""),
-      alwaysCalcContacts(_alwaysCalcContacts)
+      alwaysCalcContacts(_alwaysCalcContacts),
+      headless(_headless)
 {
 }
 
@@ -78,15 +86,17 @@ PhysicsWorldBaseInterface::Ptr
 GazeboWorldLoader::LoadFromSDF(const sdf::ElementPtr &sdf,
                                const std::string &worldname) const
 {
-  THROW_EXCEPTION("TODO: Implement GazeboWorldLoader::LoadFromSDF");
-/*  std::cout << "Loading world from SDF with physics engine '"
+  std::cout << "Loading world from SDF with physics engine '"
             << EngineName() << "' (named as '"
             << worldname << "')." << std::endl;
-  // std::cout << "Loading world from " << worldfile << std::endl;
-  // XXX TODO this function yet has to be written, using an SDF instead
-  // of a string and a physics engine to override
+  if (!sdf)
+  {
+    std::cerr << "No SDF given to load the world from." << std::endl;
+    return PhysicsWorldBaseInterface::Ptr();
+  }
+  if (physics) collision_benchmark::OverridePhysicsSDF(sdf, physics);
   gazebo::physics::WorldPtr gzworld =
-    collision_benchmark::LoadWorldFromSDF(sdf, worldname, physics);
+    collision_benchmark::LoadWorldFromSDF(sdf, worldname);
   if (!gzworld)
   {
     std::cout << "Error loading world from SDF." << std::endl;
@@ -94,11 +104,10 @@ GazeboWorldLoader::LoadFromSDF(const sdf::ElementPtr &sdf,
   }
   // Create the GazeboPhysicsWorld object
   GazeboPhysicsWorld::Ptr
-    gzPhysicsWorld(new GazeboPhysicsWorld(alwaysCalcContacts));
+    gzPhysicsWorld(new GazeboPhysicsWorld(alwaysCalcContacts, headless));
   gzPhysicsWorld->SetWorld
     (collision_benchmark::to_std_ptr<gazebo::physics::World>(gzworld));
   return gzPhysicsWorld;
-  */
 }
 
 PhysicsWorldBaseInterface::Ptr
@@ -118,7 +127,7 @@ GazeboWorldLoader::LoadFromFile(const std::string &worldfile,
   }
   // Create the GazeboPhysicsWorld object
   GazeboPhysicsWorld::Ptr
-    gzPhysicsWorld(new GazeboPhysicsWorld(alwaysCalcContacts));
+    gzPhysicsWorld(new GazeboPhysicsWorld(alwaysCalcContacts, headless));
   gzPhysicsWorld->SetWorld
     (collision_benchmark::to_std_ptr<gazebo::physics::World>(gzworld));
   return gzPhysicsWorld;
@@ -141,12 +150,20 @@ GazeboWorldLoader::LoadFromString(const std::string &str,
   }
   // Create the GazeboPhysicsWorld object
   GazeboPhysicsWorld::Ptr
-    gzPhysicsWorld(new GazeboPhysicsWorld(alwaysCalcContacts));
+    gzPhysicsWorld(new GazeboPhysicsWorld(alwaysCalcContacts, headless));
   gzPhysicsWorld->SetWorld
     (collision_benchmark::to_std_ptr<gazebo::physics::World>(gzworld));
   return gzPhysicsWorld;
 }
 
+sdf::ElementPtr
+GazeboWorldLoader::ReadFile(const std::string &filename,
+                            const std::string &worldname) const
+{
+  // the physics are overridden in LoadFromSDF()
+  return collision_benchmark::ReadWorldSDFFromFile(filename, worldname);
+}
+
 const std::string collision_benchmark::GetFirstNamespace()
 {
   gazebo::transport::TopicManager * topicManager =
@@ -164,69 +181,50 @@ const std::string collision_benchmark::GetFirstNamespace()
 
 bool collision_benchmark::WaitForNamespace(std::string worldNamespace,
                                            float maxWaitTime,
-                                           float sleepTime)
+                                           float /*sleepTime*/)
 {
-  gazebo::transport::TopicManager * topicManager =
-    gazebo::transport::TopicManager::Instance();
-  if (!topicManager)
-  {
-    std::cerr << "No topic manager instance" << std::endl;
-    return false;
-  }
-
-  gazebo::common::Timer timer;
-  timer.Start();
-
   std::cout << "Waiting for namespace '" << worldNamespace
             << " 'to be loaded." << std::endl;
 
-  bool found = false;
-  while (!found && (timer.GetElapsed().Float() < maxWaitTime))
-  {
-    // found at most 1 second for namespaces to appear.
-    if (gazebo::transport::waitForNamespaces(gazebo::common::Time(sleepTime,
-                                                                  0)))
-    {
-      std::list<std::string> namespaces;
-      topicManager->GetTopicNamespaces(namespaces);
-
-      /*std::cout << "Namespaces:" << std::endl;
-      for (std::list<std::string>::iterator it = namespaces.begin();
-           it!=namespaces.end(); ++it)
-        std::cout<<*it << std::endl;*/
-
-      std::list<std::string>::iterator ns =
-        std::find(namespaces.begin(), namespaces.end(), worldNamespace);
-      bool loaded = (ns != namespaces.end()) && (*ns == worldNamespace);
-      if (loaded)
-      {
-        std::cout << "Namespace '" << worldNamespace
-                  << "' received." << std::endl;
-        found = true;
-      }
-      /*else
-      {
-        std::cout << "Namespace '" << worldNamespace
-                  << "' not received yet." << std::endl;
-      }*/
-    }
-    /*else
-    {
-      std::cout << "No namespaces received yet.\n";
-    }*/
-  }
-  if (!found)
+  bool found = GazeboNamespaceNotifier::Instance().WaitFor(worldNamespace,
+                                                           maxWaitTime);
+  if (found)
+    std::cout << "Namespace '" << worldNamespace
+              << "' received." << std::endl;
+  else
     std::cerr << "Unsuccessful wait for namespace "
               << worldNamespace << "." << std::endl;
 
   return found;
 }
 
+bool collision_benchmark::WaitForNamespaces
+        (const std::vector<std::string> &worldNamespaces, float maxWaitTime)
+{
+  std::vector<std::string> missing;
+  bool found = GazeboNamespaceNotifier::Instance().WaitForAll
+                 (worldNamespaces, maxWaitTime, &missing);
+  for (std::vector<std::string>::const_iterator it = missing.begin();
+       it != missing.end(); ++it)
+  {
+    std::cerr << "Unsuccessful wait for namespace " << *it << "."
+              << std::endl;
+  }
+  return found;
+}
+
+std::mutex &collision_benchmark::GetSDFMutex()
+{
+  static std::mutex sdfMutex;
+  return sdfMutex;
+}
+
 sdf::ElementPtr
 collision_benchmark::GetSDFElementFromFile(const std::string &filename,
                                            const std::string &elemName,
                                            const std::string &name)
 {
+  std::lock_guard<std::mutex> lock(GetSDFMutex());
   sdf::ElementPtr sdfRoot;
 
   // Load the world file
@@ -292,6 +290,7 @@ collision_benchmark::GetSDFElementFromString(const std::string &xmlString,
                                              const std::string &elemName,
                                              const std::string &name)
 {
+  std::lock_guard<std::mutex> lock(GetSDFMutex());
   sdf::ElementPtr sdfRoot;
 
   // Load the world file
@@ -325,6 +324,7 @@ collision_benchmark::GetSDFElementFromString(const std::string &xmlString,
 sdf::ElementPtr
 collision_benchmark::GetPhysicsFromSDF(const std::string &filename)
 {
+  std::lock_guard<std::mutex> lock(GetSDFMutex());
   sdf::ElementPtr sdfRoot;
 
   // Load the world file
@@ -520,21 +520,44 @@ collision_benchmark::LoadModelFromSDFString(const std::string &sdfString,
   return LoadModelFromSDF(sdfRoot, w, name);
 }
 
+void collision_benchmark::OverridePhysicsSDF(const sdf::ElementPtr &worldSDF,
+                                             const sdf::ElementPtr &physics)
+{
+  if (!worldSDF->HasElement("physics"))
+  {
+#ifdef DEBUG
+    std::cout << "World in did not have physics, so adding the "
+              << "override physics: " << std::endl
+              << physics->ToString("") << std::endl;
+#endif
+    sdf::ElementPtr physicsCopy = physics->Clone();
+    physicsCopy->SetParent(worldSDF);
+    worldSDF->InsertElement(physicsCopy);
+  }
+  else
+  {
+    sdf::ElementPtr sdfPhysics = worldSDF->GetElement("physics");
+    // std::cout << "World has physics: " << std::endl
+    //           << sdfPhysics->ToString("") << "overriding with: "
+    //           << std::endl << physics->ToString("") << std::endl;
+    sdfPhysics->Copy(physics);
+  }
+}
+
 // Helper function which interprets the string \e str as file if \e isFile
-// is true, and as xml string otherwise
-gazebo::physics::WorldPtr
-LoadWorld_helper(const std::string &str,
+// is true, and as xml string otherwise, and returns the world SDF
+sdf::ElementPtr
+ReadWorld_helper(const std::string &str,
                  const bool isFile,
                  const std::string &name,
                  const sdf::ElementPtr &overridePhysics)
 {
-  gazebo::physics::WorldPtr world;
   sdf::ElementPtr sdfRoot;
   try
   {
+    // files are only parsed once and then copied from the template cache
     if (isFile)
-      sdfRoot =
-        collision_benchmark::GetSDFElementFromFile(str, "world", name);
+      sdfRoot = GazeboWorldTemplateCache::Instance().GetWorld(str, name);
     else
       sdfRoot =
         collision_benchmark::GetSDFElementFromString(str, "world", name);
@@ -543,38 +566,42 @@ LoadWorld_helper(const std::string &str,
   {
     std::cerr << " Exception ocurred when loading world. "
               << e.GetErrorStr() << std::endl;
-    return gazebo::physics::WorldPtr();
+    return sdf::ElementPtr();
   }
   if (!sdfRoot)
   {
     std::cerr << "Could not load world" << std::endl;
-    return world;
+    return sdfRoot;
   }
   if (overridePhysics)
   {
-    if (!sdfRoot->HasElement("physics"))
-    {
-#ifdef DEBUG
-      std::cout << "World in did not have physics, so adding the "
-                << "override physics: " << std::endl
-                << overridePhysics->ToString("") << std::endl;
-#endif
-      sdf::ElementPtr physics = overridePhysics->Clone();
-      physics->SetParent(sdfRoot);
-      sdfRoot->InsertElement(physics);
-    }
-    else
-    {
-      sdf::ElementPtr sdfPhysics = sdfRoot->GetElement("physics");
-      // std::cout << "World in " << worldfile << " has physics: " << std::endl
-      //           << sdfPhysics->ToString("") << "overriding with: "
-      //           << std::endl << overridePhysics->ToString("") << std::endl;
-      sdfPhysics->Copy(overridePhysics);
-    }
+    collision_benchmark::OverridePhysicsSDF(sdfRoot, overridePhysics);
   }
+  return sdfRoot;
+}
+
+// Helper function which interprets the string \e str as file if \e isFile
+// is true, and as xml string otherwise
+gazebo::physics::WorldPtr
+LoadWorld_helper(const std::string &str,
+                 const bool isFile,
+                 const std::string &name,
+                 const sdf::ElementPtr &overridePhysics)
+{
+  sdf::ElementPtr sdfRoot =
+    ReadWorld_helper(str, isFile, name, overridePhysics);
+  if (!sdfRoot) return gazebo::physics::WorldPtr();
   return collision_benchmark::LoadWorldFromSDF(sdfRoot, name);
 }
 
+sdf::ElementPtr
+collision_benchmark::ReadWorldSDFFromFile(const std::string &worldfile,
+                                          const std::string &name,
+                                          const sdf::ElementPtr &physics)
+{
+  return ReadWorld_helper(worldfile, true, name, physics);
+}
+
 gazebo::physics::WorldPtr
 collision_benchmark::LoadWorldFromFile(const std::string &worldfile,
                                        const std::string &name,
@@ -628,29 +655,74 @@ collision_benchmark::LoadWorld(const std::string &worldfile,
 
 std::vector<gazebo::physics::WorldPtr>
 collision_benchmark::LoadWorlds(const std::vector<Worldfile>& worldfiles)
+{
+  return LoadWorlds(worldfiles, NULL);
+}
+
+std::vector<gazebo::physics::WorldPtr>
+collision_benchmark::LoadWorlds(const std::vector<Worldfile>& worldfiles,
+                                std::vector<WorldLoadTiming> *timings)
 {
   std::vector<gazebo::physics::WorldPtr> worlds;
-  // -- load all worlds --
-  for (std::vector<Worldfile>::const_iterator w = worldfiles.begin();
-      w != worldfiles.end(); ++w)
-  {
-    // std::cout << "Loading world " << w->filename << " (named as '"
-    //          << w->worldname << "')" << std::endl;
-    gazebo::physics::WorldPtr world = LoadWorld(w->filename, w->worldname);
+  std::vector<WorldLoadTiming> localTimings;
+  std::vector<WorldLoadTiming> &times = timings ? *timings : localTimings;
+  times.assign(worldfiles.size(), WorldLoadTiming());
+
+  for (size_t i = 0; i < worldfiles.size(); ++i)
+  {
+    times[i].worldname = worldfiles[i].worldname;
+    gazebo::common::Timer timer;
+    timer.Start();
+    sdf::ElementPtr worldSDF = ReadWorldSDFFromFile(worldfiles[i].filename,
+                                                    worldfiles[i].worldname);
+    times[i].readTime = timer.GetElapsed().Double();
+    if (!worldSDF)
+    {
+      std::cerr << "Could not read world " << worldfiles[i].filename
+                << std::endl;
+      worlds.clear();
+      return worlds;
+    }
+    timer.Start();
+    gazebo::physics::WorldPtr world =
+      LoadWorldFromSDF(worldSDF, worldfiles[i].worldname);
+    times[i].createTime = timer.GetElapsed().Double();
     if (!world)
     {
-      std::cerr << "Could not load world " << w->filename << std::endl;
+      std::cerr << "Could not load world " << worldfiles[i].filename
+                << std::endl;
       worlds.clear();
       return worlds;
     }
+    times[i].worldname = world->Name();
     worlds.push_back(world);
+
+    // wait for the namespace before the next world is created, so that
+    // the order of the namespaces in the transport system is the same as
+    // the order of the worlds (the first one is the world gzclient
+    // connects to, see GetFirstNamespace())
+    timer.Start();
+    bool found = WaitForNamespace(world->Name());
+    times[i].waitTime = timer.GetElapsed().Double();
+    if (!found)
+    {
+      std::cerr << "Namespace of world '" << world->Name()
+                << "' was not loaded" << std::endl;
+      worlds.clear();
+      return worlds;
+    }
+  }
+
+  for (size_t i = 0; i < times.size(); ++i)
+  {
+    std::cout << "Loaded world " << times[i] << std::endl;
   }
   return worlds;
 }
 
 std::map<std::string, WorldLoader::ConstPtr>
 collision_benchmark::GetSupportedGazeboWorldLoaders
-  (const bool enforceContactCalc)
+  (const bool enforceContactCalc, const bool headless)
 {
   std::set<std::string> engines =
     collision_benchmark::GetSupportedPhysicsEngines();
@@ -663,7 +735,8 @@ collision_benchmark::GetSupportedGazeboWorldLoaders
     {
       loaders[engine] =
         WorldLoader::ConstPtr(new GazeboWorldLoader(engine,
-                                                    enforceContactCalc));
+                                                    enforceContactCalc,
+                                                    headless));
     }
     catch(collision_benchmark::Exception &e)
     {
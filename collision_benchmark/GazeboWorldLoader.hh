@@ -28,6 +28,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
 
 namespace collision_benchmark
 {
@@ -43,14 +44,18 @@ class GazeboWorldLoader: public WorldLoader
   // \param _engine the name of the physics engine
   // \param _alwaysCalcContacts constructor parameter for
   //        GazeboPhysicsWorld
+  // \param _headless constructor parameter for GazeboPhysicsWorld
   public: GazeboWorldLoader(const std::string &_engine,
-                            const bool _alwaysCalcContacts = true);
+                            const bool _alwaysCalcContacts = true,
+                            const bool _headless = false);
 
   // Creates a universal loader that loads up the world specified in
   // the SDF of the world.
   // \param _alwaysCalcContacts constructor parameter for
   //        GazeboPhysicsWorld
-  public: GazeboWorldLoader(const bool _alwaysCalcContacts = true);
+  // \param _headless constructor parameter for GazeboPhysicsWorld
+  public: GazeboWorldLoader(const bool _alwaysCalcContacts = true,
+                            const bool _headless = false);
 
   public: virtual PhysicsWorldBaseInterface::Ptr
           LoadFromSDF(const sdf::ElementPtr &sdf,
@@ -64,12 +69,27 @@ class GazeboWorldLoader: public WorldLoader
           LoadFromString(const std::string &str,
                          const std::string &worldname="") const;
 
+  public: virtual sdf::ElementPtr
+          ReadFile(const std::string &filename,
+                   const std::string &worldname="") const;
+
   // physics setting in SDF format
   private: sdf::ElementPtr physics;
   private: bool alwaysCalcContacts;
+  private: bool headless;
 };
 
 
+/// Returns the mutex which serializes the calls of sdformat's parsing
+/// functions (sdf::init(), sdf::readFile(), sdf::readString()) and of
+/// gazebo::common::find_file(). None of them are documented as
+/// thread-safe: they use global state such as the SDF search path
+/// callbacks, the sdformat console and the gazebo::common::SystemPaths
+/// singleton. The functions in this file which read SDF lock it, so they
+/// can be called from several threads. Other code calling these functions
+/// from more than one thread has to lock it as well.
+std::mutex &GetSDFMutex();
+
 /// returns the SDF root of the element with name \e elemName,
 /// reading it from a file,
 /// and replaces the name with \e name (if not empty)
@@ -126,6 +146,24 @@ LoadWorldFromSDFString(const std::string &xmlString,
                        const std::string &name="",
                        const sdf::ElementPtr &overridePhys = sdf::ElementPtr());
 
+/// reads the world SDF from a file without creating the world.
+/// This does not access the Gazebo world list. The world is parsed
+/// only once per file and then copied from the GazeboWorldTemplateCache.
+/// \param name if not empty string, then this name is used to override
+///        the name in \e worldfile
+/// \param overridePhys if not NULL, this SDF is used to override the
+///        physics in the SDF \e worldfile.
+/// \return the ``<world>`` element, or NULL if the file could not be read
+sdf::ElementPtr
+ReadWorldSDFFromFile(const std::string &worldfile,
+                     const std::string &name="",
+                     const sdf::ElementPtr &overridePhys = sdf::ElementPtr());
+
+/// replaces the ``<physics>`` of the ``<world>`` element \e worldSDF
+/// with a copy of \e physics, or adds it if the world has no physics.
+void OverridePhysicsSDF(const sdf::ElementPtr &worldSDF,
+                        const sdf::ElementPtr &physics);
+
 /// loads a model from an SDF element
 /// \param name if not empty string, then this name is used to override
 ///       the name in \e sdfRoot, which will change \e sdfRoot itself
@@ -189,22 +227,50 @@ class Worldfile
 std::vector<gazebo::physics::WorldPtr>
 LoadWorlds(const std::vector<Worldfile>& worldfiles);
 
+/// Like LoadWorlds(const std::vector<Worldfile>&), but also reports the
+/// time taken for each step of loading a world: reading the world file
+/// (see ReadWorldSDFFromFile()), creating the world in Gazebo and waiting
+/// for its namespace. The worlds are loaded one at a time, in the order
+/// given in \e worldfiles. After each world is created, its namespace is
+/// waited for before the next world is created, so that the order of the
+/// namespaces is the order of the worlds (the first one is the world
+/// gzclient connects to, see GetFirstNamespace()).
+///
+/// \param timings if not NULL, the time taken to load each of the worlds
+///        is returned in here, in the order of \e worldfiles.
+/// \return the loaded worlds, or an empty vector if any world could not
+///        be loaded.
+std::vector<gazebo::physics::WorldPtr>
+LoadWorlds(const std::vector<Worldfile>& worldfiles,
+           std::vector<WorldLoadTiming> *timings);
+
 
 // Returns a map of GazeboWorldLoader instances for all
 // supported physics engines
+// \param headless whether the loaded worlds use the headless mode,
+//    see GazeboPhysicsWorld::SetHeadless()
 std::map<std::string, WorldLoader::ConstPtr>
-GetSupportedGazeboWorldLoaders(const bool enforceContactCalc);
+GetSupportedGazeboWorldLoaders(const bool enforceContactCalc,
+                               const bool headless = false);
 
 
 /// Waits for the namespace \e worldNamespace to appear in the Gazebo
-/// list of namespaces.
-/// Repeatedly waits for new incoming namespaces (waiting *maximum*
-/// \e sleepTime seconds at each attempt)
-/// and checks whether the given \e worldNamespace is in the list of namespaces.
+/// list of namespaces. The waiting thread is woken up by the
+/// GazeboNamespaceNotifier as soon as the namespace has arrived.
 /// \param maxWaitTime waits for this maximum time (seconds)
+/// \param sleepTime not used any more, the namespaces are checked by the
+///   GazeboNamespaceNotifier.
 bool WaitForNamespace(std::string worldNamespace, float maxWaitTime = 10,
                       float sleepTime = 1);
 
+/// Waits until all of \e worldNamespaces appeared in the Gazebo list of
+/// namespaces.
+/// \param maxWaitTime waits for this maximum time (seconds) for all
+///   namespaces together.
+/// \return false if any of the namespaces did not appear in time
+bool WaitForNamespaces(const std::vector<std::string> &worldNamespaces,
+                       float maxWaitTime = 10);
+
 
 /// return the first namespace loaded on the gazebo server,
 /// or the empty string if currently none are loaded yet.
@@ -25,6 +25,10 @@
 #include <gazebo/common/common.hh>
 #include <gazebo/physics/physics.hh>
 
+#include <set>
+#include <string>
+#include <vector>
+
 
 /**
  * Returns new entities which were added in \e state2 when compared to _state1
@@ -193,6 +197,211 @@ void collision_benchmark::SetWorldState(gazebo::physics::WorldPtr &world,
   world->SetPaused(pauseState);
 }
 
+using collision_benchmark::GazeboWorldSnapshot;
+
+void GazeboWorldSnapshot::GetAllModels(const gazebo::physics::WorldPtr &world,
+                                       gazebo::physics::Model_V &allModels)
+{
+  allModels = world->Models();
+  // insert the nested models of each model right after it
+  for (size_t i = 0; i < allModels.size(); ++i)
+  {
+    const gazebo::physics::Model_V nested = allModels[i]->NestedModels();
+    allModels.insert(allModels.begin() + i + 1, nested.begin(), nested.end());
+  }
+}
+
+void GazeboWorldSnapshot::Capture(const gazebo::physics::WorldPtr &world)
+{
+  gazebo::physics::Model_V allModels;
+  GetAllModels(world, allModels);
+
+  // assign to existing entries where possible to re-use the string memory
+  this->models.resize(allModels.size());
+  this->buffer.clear();
+  size_t linkIdx = 0;
+  for (size_t i = 0; i < allModels.size(); ++i)
+  {
+    const gazebo::physics::ModelPtr &m = allModels[i];
+    ModelEntry &entry = this->models[i];
+    entry.name = m->GetScopedName();
+    const gazebo::physics::BasePtr parent = m->GetParent();
+    if (parent && parent->HasType(gazebo::physics::Base::MODEL))
+      entry.sdf.reset();
+    else
+      entry.sdf = m->GetSDF();
+
+    const ignition::math::Pose3d pose = m->WorldPose();
+    const ignition::math::Vector3d scale = m->Scale();
+    const double modelValues[ModelValues] =
+      { pose.Pos().X(), pose.Pos().Y(), pose.Pos().Z(),
+        pose.Rot().W(), pose.Rot().X(), pose.Rot().Y(), pose.Rot().Z(),
+        scale.X(), scale.Y(), scale.Z() };
+    this->buffer.insert(this->buffer.end(), modelValues,
+                        modelValues + ModelValues);
+
+    const gazebo::physics::Link_V &links = m->GetLinks();
+    entry.firstLink = linkIdx;
+    entry.numLinks = links.size();
+    for (gazebo::physics::Link_V::const_iterator it = links.begin();
+         it != links.end(); ++it, ++linkIdx)
+    {
+      const gazebo::physics::LinkPtr &l = *it;
+      if (linkIdx < this->linkNames.size())
+        this->linkNames[linkIdx] = l->GetScopedName();
+      else
+        this->linkNames.push_back(l->GetScopedName());
+
+      const ignition::math::Pose3d lPose = l->WorldPose();
+      const ignition::math::Vector3d linVel = l->WorldLinearVel();
+      const ignition::math::Vector3d angVel = l->WorldAngularVel();
+      const double linkValues[LinkValues] =
+        { lPose.Pos().X(), lPose.Pos().Y(), lPose.Pos().Z(),
+          lPose.Rot().W(), lPose.Rot().X(), lPose.Rot().Y(), lPose.Rot().Z(),
+          linVel.X(), linVel.Y(), linVel.Z(),
+          angVel.X(), angVel.Y(), angVel.Z() };
+      this->buffer.insert(this->buffer.end(), linkValues,
+                          linkValues + LinkValues);
+    }
+  }
+  this->linkNames.resize(linkIdx);
+  this->simTime = world->SimTime();
+  this->captured = true;
+}
+
+bool GazeboWorldSnapshot::SameModels
+                  (const gazebo::physics::Model_V &allModels) const
+{
+  if (allModels.size() != this->models.size()) return false;
+  for (size_t i = 0; i < allModels.size(); ++i)
+  {
+    const gazebo::physics::ModelPtr &m = allModels[i];
+    const ModelEntry &entry = this->models[i];
+    if (m->GetScopedName() != entry.name) return false;
+    const gazebo::physics::Link_V &links = m->GetLinks();
+    if (links.size() != entry.numLinks) return false;
+    for (size_t j = 0; j < links.size(); ++j)
+    {
+      if (links[j]->GetScopedName() != this->linkNames[entry.firstLink + j])
+        return false;
+    }
+  }
+  return true;
+}
+
+bool GazeboWorldSnapshot::ChangeModels
+                  (const gazebo::physics::WorldPtr &world) const
+{
+  std::set<std::string> snapshotModels;
+  std::vector<std::string> insertions;
+  for (std::vector<ModelEntry>::const_iterator it = this->models.begin();
+       it != this->models.end(); ++it)
+  {
+    // nested models are inserted along with their parent
+    if (!it->sdf) continue;
+    snapshotModels.insert(it->name);
+    if (!world->ModelByName(it->name))
+    {
+      insertions.push_back(it->sdf->ToString(""));
+    }
+  }
+
+  std::vector<std::string> deletions;
+  const gazebo::physics::Model_V worldModels = world->Models();
+  for (gazebo::physics::Model_V::const_iterator it = worldModels.begin();
+       it != worldModels.end(); ++it)
+  {
+    if (snapshotModels.find((*it)->GetScopedName()) == snapshotModels.end())
+    {
+      deletions.push_back((*it)->GetName());
+    }
+  }
+
+  if (insertions.empty() && deletions.empty()) return true;
+
+  // insert and delete the models the same way as SetWorldState() does
+  gazebo::physics::WorldState modelChangeState(world);
+  wrapSDF(insertions);
+  modelChangeState.SetInsertions(insertions);
+  modelChangeState.SetDeletions(deletions);
+  world->SetState(modelChangeState);
+  return true;
+}
+
+void GazeboWorldSnapshot::WriteBack
+                  (const gazebo::physics::Model_V &allModels) const
+{
+  const double *v = this->buffer.data();
+  for (size_t i = 0; i < allModels.size(); ++i)
+  {
+    const gazebo::physics::ModelPtr &m = allModels[i];
+    m->SetWorldPose(ignition::math::Pose3d(v[0], v[1], v[2],
+                                           v[3], v[4], v[5], v[6]));
+    m->SetScale(ignition::math::Vector3d(v[7], v[8], v[9]), true);
+    v += ModelValues;
+
+    // set the links after the model, as done in gazebo::physics::Model
+    const gazebo::physics::Link_V &links = m->GetLinks();
+    for (gazebo::physics::Link_V::const_iterator it = links.begin();
+         it != links.end(); ++it)
+    {
+      const gazebo::physics::LinkPtr &l = *it;
+      l->SetWorldPose(ignition::math::Pose3d(v[0], v[1], v[2],
+                                             v[3], v[4], v[5], v[6]));
+      l->SetLinearVel(ignition::math::Vector3d(v[7], v[8], v[9]));
+      l->SetAngularVel(ignition::math::Vector3d(v[10], v[11], v[12]));
+      v += LinkValues;
+    }
+  }
+}
+
+bool GazeboWorldSnapshot::Restore(const gazebo::physics::WorldPtr &world) const
+{
+  if (!this->captured) return false;
+
+  bool pauseState = world->IsPaused();
+  world->SetPaused(true);
+
+  gazebo::physics::Model_V allModels;
+  GetAllModels(world, allModels);
+  if (!SameModels(allModels))
+  {
+    // Models were inserted or deleted since the capture, or they are in
+    // a different order. Fall back to inserting/deleting models via SDF
+    // and look up all models by name.
+    if (!ChangeModels(world))
+    {
+      world->SetPaused(pauseState);
+      return false;
+    }
+    allModels.clear();
+    for (std::vector<ModelEntry>::const_iterator it = this->models.begin();
+         it != this->models.end(); ++it)
+    {
+      gazebo::physics::ModelPtr m = world->ModelByName(it->name);
+      if (!m)
+      {
+        std::cerr << "Model " << it->name << " could not be inserted."
+                  << std::endl;
+        world->SetPaused(pauseState);
+        return false;
+      }
+      allModels.push_back(m);
+    }
+    if (!SameModels(allModels))
+    {
+      std::cerr << "Models in world " << world->Name() << " have different "
+                << "links than in the snapshot." << std::endl;
+      world->SetPaused(pauseState);
+      return false;
+    }
+  }
+
+  WriteBack(allModels);
+  world->SetSimTime(this->simTime);
+  world->SetPaused(pauseState);
+  return true;
+}
 
 void collision_benchmark::PrintWorldState(const gazebo::physics::WorldPtr world)
 {
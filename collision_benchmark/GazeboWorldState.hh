@@ -23,6 +23,7 @@
 #include <collision_benchmark/PhysicsWorld.hh>
 #include <gazebo/physics/World.hh>
 
+#include <string>
 #include <vector>
 
 namespace collision_benchmark
@@ -33,6 +34,87 @@ namespace collision_benchmark
 void SetWorldState(gazebo::physics::WorldPtr &world,
                    const gazebo::physics::WorldState &targetState);
 
+/**
+ * \brief Lightweight snapshot of the dynamic state of a Gazebo world.
+ *
+ * Other than gazebo::physics::WorldState, this only keeps the poses and
+ * scales of all models and the poses and velocities of all their links,
+ * all in one flat buffer, along with the model and link names and the
+ * simulation time. Like in gazebo::physics::WorldState, joint states
+ * are not kept, as they follow from the link poses.
+ *
+ * Restoring the snapshot writes the values back to the models and links
+ * directly if the world has the same models as the snapshot, which may
+ * also be a different world loaded from the same file. Only if models were
+ * inserted or deleted since, this falls back to deleting and inserting
+ * models via their SDF, as done in SetWorldState().
+ */
+class GazeboWorldSnapshot
+{
+  /// Captures the state of \e world. Memory of a previous capture is
+  /// re-used, so snapshots should be kept for repeated captures.
+  public: void Capture(const gazebo::physics::WorldPtr &world);
+
+  /// Restores the state of the snapshot in \e world.
+  /// \return false if the snapshot is empty or models could
+  ///   not be inserted.
+  public: bool Restore(const gazebo::physics::WorldPtr &world) const;
+
+  /// \return true if nothing was captured yet
+  public: bool Empty() const { return !this->captured; }
+
+  /// \return number of models in the snapshot, including nested models
+  public: size_t GetNumModels() const { return this->models.size(); }
+
+  // Collects all models of \e world, with the nested models following
+  // each top-level model, in the order used for the snapshot.
+  private: static void GetAllModels(const gazebo::physics::WorldPtr &world,
+                                    gazebo::physics::Model_V &allModels);
+
+  // Returns true if \e allModels and their links have the same names, in
+  // the same order, as the models in the snapshot.
+  private: bool SameModels(const gazebo::physics::Model_V &allModels) const;
+
+  // Deletes and inserts top-level models in \e world so that it
+  // has the same models as the snapshot.
+  private: bool ChangeModels(const gazebo::physics::WorldPtr &world) const;
+
+  // Writes the buffer values back to \e allModels, which must
+  // have the same models as the snapshot (see SameModels()).
+  private: void WriteBack(const gazebo::physics::Model_V &allModels) const;
+
+  // \brief A model in the snapshot
+  private: struct ModelEntry
+  {
+    // scoped name of the model
+    std::string name;
+    // SDF of the model, used to insert it if it was deleted.
+    // NULL for nested models, which are inserted with their parent.
+    sdf::ElementPtr sdf;
+    // index of the first link of the model in \e linkNames
+    size_t firstLink;
+    // number of links of the model
+    size_t numLinks;
+  };
+
+  // all models, with the nested models following each top-level model
+  private: std::vector<ModelEntry> models;
+  // names of the links of all models
+  private: std::vector<std::string> linkNames;
+  // per model the pose and scale, followed by the pose and velocities of
+  // each of its links, see ModelValues and LinkValues.
+  private: std::vector<double> buffer;
+  // simulation time of the world
+  private: gazebo::common::Time simTime;
+  // whether a state was captured
+  private: bool captured = false;
+
+  // number of values for a model in the buffer
+  private: static const size_t ModelValues = 10;
+  // number of values for a link in the buffer
+  private: static const size_t LinkValues = 13;
+};
+
 /**
  * Print the world state. Can be used for testing.
  */
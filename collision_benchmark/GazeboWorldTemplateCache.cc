@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboWorldTemplateCache.hh>
+#include <collision_benchmark/GazeboWorldLoader.hh>
+
+#include <gazebo/common/CommonIface.hh>
+#include <gazebo/common/Exception.hh>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using collision_benchmark::GazeboWorldTemplateCache;
+
+namespace
+{
+//////////////////////////////////////////////////////////////////////////////
+// \brief Parses the world element in \e filename
+sdf::ElementPtr ParseWorldTemplate(const std::string &filename)
+{
+  return collision_benchmark::GetSDFElementFromFile(filename, "world");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// \brief Parses the physics element in \e filename
+sdf::ElementPtr ParsePhysicsTemplate(const std::string &filename)
+{
+  return collision_benchmark::GetPhysicsFromSDF(filename);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// \brief Makes the key of \e filename in the cache from its full path,
+// size and a hash of its contents. The modification time is not used
+// because it only has a resolution of one second, which would miss
+// changes made right after the file was parsed.
+// \return false if the file can't be found or read
+bool GetTemplateKey(const std::string &filename, std::string &key)
+{
+  std::string fullFile;
+  try
+  {
+    std::lock_guard<std::mutex> lock(collision_benchmark::GetSDFMutex());
+    fullFile = gazebo::common::find_file(filename);
+  }
+  catch(gazebo::common::Exception &)
+  {
+    return false;
+  }
+  if (fullFile.empty()) return false;
+
+  std::ifstream file(fullFile.c_str(), std::ios::in | std::ios::binary);
+  if (!file) return false;
+  std::stringstream contents;
+  contents << file.rdbuf();
+  if (file.bad()) return false;
+  const std::string data = contents.str();
+
+  std::stringstream str;
+  str << fullFile << "@" << data.size() << "@"
+      << std::hex << std::hash<std::string>()(data);
+  key = str.str();
+  return true;
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+GazeboWorldTemplateCache &GazeboWorldTemplateCache::Instance()
+{
+  static GazeboWorldTemplateCache instance;
+  return instance;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+sdf::ElementPtr
+GazeboWorldTemplateCache::Get(std::map<std::string, TemplatePtr> &templates,
+                              const std::string &filename,
+                              ParseFunc parse)
+{
+  std::string key;
+  if (!GetTemplateKey(filename, key))
+  {
+    // parse it anyway to get the error messages
+    return parse(filename);
+  }
+
+  TemplatePtr t;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    TemplatePtr &entry = templates[key];
+    if (!entry) entry.reset(new Template());
+    t = entry;
+  }
+
+  // the parsing itself is serialized by GetSDFMutex(), the lock of the
+  // template only makes sure that it is parsed once. The template is
+  // never modified after parsing, so it is copied without the lock.
+  sdf::ElementPtr elem;
+  {
+    std::lock_guard<std::mutex> lock(t->mutex);
+    if (!t->parsed)
+    {
+      t->elem = parse(filename);
+      // failures are not kept, so that the file is read again next time
+      if (!t->elem) return sdf::ElementPtr();
+      t->parsed = true;
+    }
+    elem = t->elem;
+  }
+  return elem->Clone();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+sdf::ElementPtr
+GazeboWorldTemplateCache::GetWorld(const std::string &filename,
+                                   const std::string &name,
+                                   const sdf::ElementPtr &physicsSDF)
+{
+  sdf::ElementPtr world = this->Get(this->worlds, filename,
+                                    ParseWorldTemplate);
+  if (!world) return world;
+
+  if (!name.empty())
+  {
+    world->GetAttribute("name")->SetFromString(name);
+  }
+  if (physicsSDF)
+  {
+    collision_benchmark::OverridePhysicsSDF(world, physicsSDF);
+  }
+  return world;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+sdf::ElementPtr
+GazeboWorldTemplateCache::GetPhysics(const std::string &filename)
+{
+  return this->Get(this->physics, filename, ParsePhysicsTemplate);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void GazeboWorldTemplateCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->worlds.clear();
+  this->physics.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+size_t GazeboWorldTemplateCache::GetNumTemplates() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->worlds.size() + this->physics.size();
+}
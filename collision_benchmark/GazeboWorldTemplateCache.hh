@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_GAZEBOWORLDTEMPLATECACHE_H
+#define COLLISION_BENCHMARK_GAZEBOWORLDTEMPLATECACHE_H
+
+#include <sdf/sdf.hh>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Keeps the parsed SDF of world files and physics settings files,
+ * so that each file is only parsed once per process.
+ *
+ * The first request for a file parses it and keeps the element as a
+ * template. All requests then get a copy of the template, which can be
+ * modified and used to create a world, e.g. with the name replaced and the
+ * physics of another engine swapped in. Copying an element is much faster
+ * than reading and parsing the file again, which can take seconds for
+ * large worlds.
+ *
+ * Files are identified by their full path, size and a hash of their
+ * contents, so changing a file makes it parsed again. Reading a file
+ * to compute the hash is still much faster than parsing it. Files which
+ * are included by a file are not checked for changes. If several threads
+ * request the same file at once, it is parsed only once. Parsing is
+ * serialized by GetSDFMutex(), only the copies of the templates are made
+ * concurrently.
+ */
+class GazeboWorldTemplateCache
+{
+  /// \return the instance of the cache
+  public: static GazeboWorldTemplateCache &Instance();
+
+  /// \brief Returns a copy of the ``<world>`` element in \e filename.
+  /// \param[in] filename the world file. Is looked up in the Gazebo
+  ///   resource paths if it is not an absolute path.
+  /// \param[in] name if not empty, the name of the world is replaced by it.
+  /// \param[in] physics if not NULL, the ``<physics>`` of the world is
+  ///   replaced by a copy of it.
+  /// \return the world, or NULL if the file can't be read
+  public: sdf::ElementPtr GetWorld(const std::string &filename,
+                                   const std::string &name = "",
+                                   const sdf::ElementPtr &physics =
+                                     sdf::ElementPtr());
+
+  /// \brief Returns a copy of the ``<physics>`` element of the
+  /// ``<world>`` in \e filename, see also GetPhysicsFromSDF().
+  /// \return the physics, or NULL if the file can't be read
+  public: sdf::ElementPtr GetPhysics(const std::string &filename);
+
+  /// \brief Removes all templates, so that all files are parsed again.
+  public: void Clear();
+
+  /// \return the number of different files which were requested
+  ///   since the last Clear().
+  public: size_t GetNumTemplates() const;
+
+  // \brief A parsed file
+  private: struct Template
+  {
+    // protects \e elem, which is parsed by the first thread
+    // requesting it. Once parsed, \e elem is not modified any more.
+    std::mutex mutex;
+    bool parsed = false;
+    sdf::ElementPtr elem;
+  };
+  private: typedef std::shared_ptr<Template> TemplatePtr;
+
+  // \brief Function which parses a file and returns the template element
+  private: typedef sdf::ElementPtr (*ParseFunc)(const std::string &filename);
+
+  private: GazeboWorldTemplateCache() {}
+  private: GazeboWorldTemplateCache(const GazeboWorldTemplateCache&);
+  private: GazeboWorldTemplateCache &operator=
+                (const GazeboWorldTemplateCache&);
+
+  // \brief Returns a copy of the template of \e filename in
+  // \e templates, parsing the file with \e parse if required.
+  private: sdf::ElementPtr Get(std::map<std::string, TemplatePtr> &templates,
+                               const std::string &filename,
+                               ParseFunc parse);
+
+  // \brief the world templates by full path, size and contents hash
+  private: std::map<std::string, TemplatePtr> worlds;
+
+  // \brief the physics templates by full path, size and contents hash
+  private: std::map<std::string, TemplatePtr> physics;
+
+  // \brief protects \e worlds and \e physics
+  private: mutable std::mutex mutex;
+};
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_GAZEBOWORLDTEMPLATECACHE_H
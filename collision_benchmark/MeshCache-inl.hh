@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHCACHE_INL_H
+#define COLLISION_BENCHMARK_MESHCACHE_INL_H
+
+#include <collision_benchmark/MeshCache.hh>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace collision_benchmark
+{
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, int FS, typename I>
+std::string MeshCache::MakeKey(const MeshData<VP, FS, I> &data)
+{
+  const std::vector<VP> &verts = data.GetVertexBuffer();
+  const std::vector<I> &indices = data.GetIndexBuffer();
+
+  // the header of the data distinguishes the keys from keys of
+  // parameter strings and of other precisions, face and index sizes.
+  const uint64_t header[5] = { MeshDataMagic, sizeof(VP),
+                               static_cast<uint64_t>(FS), sizeof(I),
+                               verts.size() };
+  uint64_t h = Hash(header, sizeof(header), HashSeed);
+  if (!verts.empty())
+    h = Hash(&verts[0], verts.size() * sizeof(VP), h);
+  if (!indices.empty())
+    h = Hash(&indices[0], indices.size() * sizeof(I), h);
+  return ToKey(h);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, int FS, typename I>
+typename MeshData<VP, FS, I>::Ptr
+MeshCache::LoadMeshData(const std::string &key) const
+{
+  typedef MeshData<VP, FS, I> MeshDataT;
+
+  std::string content;
+  if (!this->ReadEntry(key, MESH_DATA_EXT, content))
+    return typename MeshDataT::Ptr();
+
+  // header: magic number, vertex precision, face size, index size,
+  // number of vertices and number of faces
+  uint64_t header[6];
+  if (content.size() < sizeof(header))
+    return typename MeshDataT::Ptr();
+  std::memcpy(header, content.data(), sizeof(header));
+  const uint64_t numVerts = header[4];
+  const uint64_t numFaces = header[5];
+  if ((header[0] != MeshDataMagic) || (header[1] != sizeof(VP)) ||
+      (header[2] != static_cast<uint64_t>(FS)) || (header[3] != sizeof(I)) ||
+      (content.size() != sizeof(header) + numVerts * 3 * sizeof(VP) +
+                         numFaces * FS * sizeof(I)))
+  {
+    std::cerr << "Mesh cache entry " << key << " does not match the "
+              << "requested mesh data type or is corrupt." << std::endl;
+    return typename MeshDataT::Ptr();
+  }
+
+  typename MeshDataT::Ptr data(new MeshDataT());
+  std::vector<VP> &verts = data->GetVertexBuffer();
+  std::vector<I> &indices = data->GetIndexBuffer();
+  verts.resize(numVerts * 3);
+  indices.resize(numFaces * FS);
+
+  const char *pos = content.data() + sizeof(header);
+  if (!verts.empty())
+    std::memcpy(&verts[0], pos, verts.size() * sizeof(VP));
+  pos += verts.size() * sizeof(VP);
+  if (!indices.empty())
+    std::memcpy(&indices[0], pos, indices.size() * sizeof(I));
+  return data;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, int FS, typename I>
+bool MeshCache::StoreMeshData(const std::string &key,
+                              const MeshData<VP, FS, I> &data,
+                              const std::string &description)
+{
+  const std::vector<VP> &verts = data.GetVertexBuffer();
+  const std::vector<I> &indices = data.GetIndexBuffer();
+
+  const uint64_t header[6] = { MeshDataMagic, sizeof(VP),
+                               static_cast<uint64_t>(FS), sizeof(I),
+                               data.GetNumVertices(), data.GetNumFaces() };
+  std::string content(sizeof(header) + verts.size() * sizeof(VP) +
+                      indices.size() * sizeof(I), '\0');
+  char *pos = &content[0];
+  std::memcpy(pos, header, sizeof(header));
+  pos += sizeof(header);
+  if (!verts.empty())
+    std::memcpy(pos, &verts[0], verts.size() * sizeof(VP));
+  pos += verts.size() * sizeof(VP);
+  if (!indices.empty())
+    std::memcpy(pos, &indices[0], indices.size() * sizeof(I));
+  return this->WriteEntry(key, MESH_DATA_EXT, content, description);
+}
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_MESHCACHE_INL_H
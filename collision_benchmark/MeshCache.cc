@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/MeshCache.hh>
+#include <collision_benchmark/Helpers.hh>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using collision_benchmark::MeshCache;
+
+const std::string MeshCache::INDEX_FILE = "index.txt";
+const std::string MeshCache::MESH_DATA_EXT = "mesh";
+
+//////////////////////////////////////////////////////////////////////////////
+MeshCache::MeshCache(const std::string &directory_):
+  directory(directory_),
+  valid(false)
+{
+  this->valid = !this->directory.empty() &&
+                collision_benchmark::makeDirectoryIfNeeded(this->directory);
+  if (!this->valid)
+  {
+    std::cerr << "Could not create mesh cache directory '"
+              << this->directory << "'" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::string MeshCache::MakeKey(const std::string &id)
+{
+  return ToKey(Hash(id.data(), id.size(), HashSeed));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool MeshCache::GetFile(const std::string &key, const std::string &ext,
+                        const std::string &filename) const
+{
+  if (!this->HasEntry(key, ext)) return false;
+  boost::system::error_code ec;
+  boost::filesystem::copy_file(this->GetEntryPath(key, ext), filename,
+             boost::filesystem::copy_option::overwrite_if_exists, ec);
+  if (ec)
+  {
+    std::cerr << "Could not copy mesh cache entry " << key << "." << ext
+              << " to " << filename << ": " << ec.message() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool MeshCache::StoreFile(const std::string &key, const std::string &ext,
+                          const std::string &filename,
+                          const std::string &description)
+{
+  if (!this->valid) return false;
+  std::string tmpFile = this->GetTempPath();
+  boost::system::error_code ec;
+  boost::filesystem::copy_file(filename, tmpFile, ec);
+  if (ec)
+  {
+    std::cerr << "Could not copy " << filename << " to the mesh cache: "
+              << ec.message() << std::endl;
+    return false;
+  }
+  return this->CommitEntry(tmpFile, key, ext, description);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool MeshCache::HasEntry(const std::string &key, const std::string &ext) const
+{
+  if (!this->valid) return false;
+  boost::system::error_code ec;
+  return boost::filesystem::is_regular_file(this->GetEntryPath(key, ext), ec);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::map<std::string, std::string> MeshCache::GetIndex() const
+{
+  std::map<std::string, std::string> index;
+  std::lock_guard<std::mutex> lock(this->indexMutex);
+  std::ifstream in((boost::filesystem::path(this->directory) /
+                    INDEX_FILE).string().c_str());
+  std::string line;
+  while (std::getline(in, line))
+  {
+    size_t sep = line.find('\t');
+    if (sep == std::string::npos) continue;
+    index[line.substr(0, sep)] = line.substr(sep + 1);
+  }
+  return index;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::string MeshCache::GetEntryPath(const std::string &key,
+                                    const std::string &ext) const
+{
+  return (boost::filesystem::path(this->directory) /
+          (key + "." + ext)).string();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool MeshCache::ReadEntry(const std::string &key, const std::string &ext,
+                          std::string &content) const
+{
+  if (!this->valid) return false;
+  std::ifstream in(this->GetEntryPath(key, ext).c_str(),
+                   std::ios::in | std::ios::binary);
+  if (!in.is_open()) return false;
+  std::stringstream str;
+  str << in.rdbuf();
+  content = str.str();
+  return !in.bad();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool MeshCache::WriteEntry(const std::string &key, const std::string &ext,
+                           const std::string &content,
+                           const std::string &description)
+{
+  if (!this->valid) return false;
+  std::string tmpFile = this->GetTempPath();
+  std::ofstream out(tmpFile.c_str(), std::ios::out | std::ios::binary);
+  out.write(content.data(), content.size());
+  out.close();
+  if (!out)
+  {
+    std::cerr << "Could not write mesh cache entry " << key << "."
+              << ext << std::endl;
+    std::remove(tmpFile.c_str());
+    return false;
+  }
+  return this->CommitEntry(tmpFile, key, ext, description);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool MeshCache::CommitEntry(const std::string &tmpFile,
+                            const std::string &key, const std::string &ext,
+                            const std::string &description)
+{
+  // renaming is atomic, so other processes never read incomplete entries.
+  // If another process has stored the same entry in the meantime, it is
+  // replaced by equal content.
+  boost::system::error_code ec;
+  boost::filesystem::rename(tmpFile, this->GetEntryPath(key, ext), ec);
+  if (ec)
+  {
+    std::cerr << "Could not add mesh cache entry " << key << "." << ext
+              << ": " << ec.message() << std::endl;
+    std::remove(tmpFile.c_str());
+    return false;
+  }
+
+  // descriptions have to fit in one line of the index
+  std::string desc = description;
+  for (std::string::iterator it = desc.begin(); it != desc.end(); ++it)
+  {
+    if (*it == '\n' || *it == '\r' || *it == '\t') *it = ' ';
+  }
+
+  // each entry is appended with one write, so concurrent processes
+  // don't interleave their lines.
+  std::lock_guard<std::mutex> lock(this->indexMutex);
+  std::ofstream index((boost::filesystem::path(this->directory) /
+                       INDEX_FILE).string().c_str(), std::ios::app);
+  index << (key + "." + ext + "\t" + desc + "\n") << std::flush;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::string MeshCache::GetTempPath() const
+{
+  return (boost::filesystem::path(this->directory) /
+          boost::filesystem::unique_path(".tmp-%%%%-%%%%-%%%%-%%%%")).string();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+uint64_t MeshCache::Hash(const void *bytes, const size_t size, uint64_t h)
+{
+  const unsigned char *b = static_cast<const unsigned char*>(bytes);
+  for (size_t i = 0; i < size; ++i)
+  {
+    h ^= b[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+std::string MeshCache::ToKey(const uint64_t h)
+{
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx",
+                static_cast<unsigned long long>(h));
+  return std::string(buf);
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHCACHE_H
+#define COLLISION_BENCHMARK_MESHCACHE_H
+
+#include <collision_benchmark/MeshData.hh>
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Persistent, content-addressed cache for mesh data and mesh files.
+ *
+ * Entries are stored in a cache directory under a key, which is a hash
+ * either of the parameters the mesh was generated with (see MakeKey(const
+ * std::string&)) or of the vertex and face data (see MakeKey(const MeshData&)).
+ * Mesh data is stored in the file ``<key>.mesh`` in a raw binary format,
+ * exported mesh files are stored as ``<key>.<ext>``.
+ *
+ * An index file in the cache directory lists a description of each entry
+ * which was added. Entries are first written to a temporary file and then
+ * renamed, so several processes can share the same cache directory.
+ *
+ * The cache never evicts entries, delete the cache directory to clear it.
+ * For this reason there is no default cache: a cache is only used where
+ * one is passed explicitly, e.g. to MeshShapeGeneratorCached or
+ * SimpleTriMeshShape::SetExportCache(). The test frameworks use a cache
+ * if one is given with the option ``--mesh-cache <dir>``.
+ */
+class MeshCache
+{
+  public: typedef std::shared_ptr<MeshCache> Ptr;
+  public: typedef std::shared_ptr<const MeshCache> ConstPtr;
+
+  /// \brief Name of the index file in the cache directory
+  public: static const std::string INDEX_FILE;
+
+  /// \brief Constructor
+  /// \param[in] directory the cache directory. Is created if it does not
+  ///   exist yet.
+  public: explicit MeshCache(const std::string &directory);
+
+  /// \return false if the cache directory could not be created.
+  public: bool IsValid() const { return this->valid; }
+
+  /// \return the cache directory
+  public: const std::string &GetDirectory() const { return this->directory; }
+
+  /// \brief Makes the key for a mesh which is fully defined by \e id,
+  /// e.g. the name of the generator, the type of shape and all parameters.
+  public: static std::string MakeKey(const std::string &id);
+
+  /// \brief Makes the key for the vertex and face data of \e data
+  public: template<typename VP, int FS, typename I>
+          static std::string MakeKey(const MeshData<VP, FS, I> &data);
+
+  /// \brief Loads the mesh data stored under \e key
+  /// \return the mesh data, or NULL if there is no such entry, or the entry
+  ///   was stored with another vertex precision, face or index size.
+  public: template<typename VP, int FS, typename I>
+          typename MeshData<VP, FS, I>::Ptr LoadMeshData
+                                          (const std::string &key) const;
+
+  /// \brief Stores \e data under \e key
+  /// \param[in] description description of the entry for the index
+  /// \return false if the entry could not be written
+  public: template<typename VP, int FS, typename I>
+          bool StoreMeshData(const std::string &key,
+                             const MeshData<VP, FS, I> &data,
+                             const std::string &description);
+
+  /// \brief Copies the file stored under \e key with extension \e ext
+  /// to \e filename.
+  /// \return false if there is no such entry or it can't be copied
+  public: bool GetFile(const std::string &key, const std::string &ext,
+                       const std::string &filename) const;
+
+  /// \brief Stores a copy of \e filename under \e key with extension \e ext
+  /// \param[in] description description of the entry for the index
+  /// \return false if the entry could not be written
+  public: bool StoreFile(const std::string &key, const std::string &ext,
+                         const std::string &filename,
+                         const std::string &description);
+
+  /// \return true if there is an entry for \e key with extension \e ext
+  public: bool HasEntry(const std::string &key, const std::string &ext) const;
+
+  /// \brief Reads the index
+  /// \return descriptions of all entries in the index by their
+  ///   file name in the cache directory.
+  public: std::map<std::string, std::string> GetIndex() const;
+
+  // \brief Extension of the files for mesh data
+  private: static const std::string MESH_DATA_EXT;
+
+  // \return the full path of the entry for \e key with extension \e ext
+  private: std::string GetEntryPath(const std::string &key,
+                                    const std::string &ext) const;
+
+  // \brief Reads the entry for \e key with extension \e ext into \e content
+  private: bool ReadEntry(const std::string &key, const std::string &ext,
+                          std::string &content) const;
+
+  // \brief Writes \e content as entry for \e key with extension \e ext
+  // and adds it to the index.
+  private: bool WriteEntry(const std::string &key, const std::string &ext,
+                           const std::string &content,
+                           const std::string &description);
+
+  // \brief Moves the temporary file \e tmpFile to the entry for \e key
+  // with extension \e ext and adds it to the index.
+  private: bool CommitEntry(const std::string &tmpFile,
+                            const std::string &key, const std::string &ext,
+                            const std::string &description);
+
+  // \return a unique name for a temporary file in the cache directory
+  private: std::string GetTempPath() const;
+
+  // \brief Initial value for Hash()
+  private: static const uint64_t HashSeed = 14695981039346656037ULL;
+
+  // \brief Magic number at the start of mesh data files
+  private: static const uint64_t MeshDataMagic = 0x3230485345424343ULL;
+
+  // \brief 64 bit FNV-1a hash of \e size bytes at \e bytes, continuing
+  // from hash \e h.
+  private: static uint64_t Hash(const void *bytes, const size_t size,
+                                uint64_t h);
+
+  // \return \e h as hexadecimal string
+  private: static std::string ToKey(const uint64_t h);
+
+  // \brief the cache directory
+  private: std::string directory;
+
+  // \brief whether the cache directory exists
+  private: bool valid;
+
+  // \brief protects the index file
+  private: mutable std::mutex indexMutex;
+};
+}  // namespace collision_benchmark
+
+#include <collision_benchmark/MeshCache-inl.hh>
+
+#endif  // COLLISION_BENCHMARK_MESHCACHE_H
@@ -21,69 +21,111 @@
 
 #include <collision_benchmark/MeshData.hh>
 
+#include <cmath>
 #include <random>
 #include <vector>
 
-template<typename VP, int FS>
-void collision_benchmark::MeshData<VP, FS>::Perturb(const double min,
-                                                    const double max,
-                                                    const Vertex &center)
+template<typename VP, int FS, typename I>
+uint64_t collision_benchmark::MeshData<VP, FS, I>::Perturb(const double min,
+                                                           const double max,
+                                                           const Vertex &center)
 {
-  static std::random_device r;
-  static std::default_random_engine randEngine(r());
+  std::random_device r;
+  const uint64_t seed = (static_cast<uint64_t>(r()) << 32) | r();
+  Perturb(min, max, center, seed);
+  return seed;
+}
 
-  // to generate random doubles between min and max with a uniform distribution
-  std::uniform_real_distribution<double> dist(min, max);
+template<typename VP, int FS, typename I>
+uint64_t collision_benchmark::MeshData<VP, FS, I>::Perturb(const double min,
+                                                           const double max,
+                                                           const Vertex &center,
+                                                           const Vertex &dir)
+{
+  std::random_device r;
+  const uint64_t seed = (static_cast<uint64_t>(r()) << 32) | r();
+  Perturb(min, max, center, dir, seed);
+  return seed;
+}
 
-  for (typename std::vector<Vertex>::iterator it = verts.begin();
-       it != verts.end(); ++it)
-  {
-    Vertex &v = *it;
-    Vertex diff = v - center;
-    diff.Normalize();
-    double randDisplace = dist(randEngine);
-    v += diff * randDisplace;
-  }
+template<typename VP, int FS, typename I>
+void collision_benchmark::MeshData<VP, FS, I>::Perturb(const double min,
+                                                       const double max,
+                                                       const Vertex &center,
+                                                       const uint64_t seed)
+{
+  PerturbRange(0, GetNumVertices(), min, max, center, NULL, seed);
 }
 
-template<typename VP, int FS>
-void collision_benchmark::MeshData<VP, FS>::Perturb(const double min,
-                                                    const double max,
-                                                    const Vertex &center,
-                                                    const Vertex &dir)
+template<typename VP, int FS, typename I>
+void collision_benchmark::MeshData<VP, FS, I>::Perturb(const double min,
+                                                       const double max,
+                                                       const Vertex &center,
+                                                       const Vertex &dir,
+                                                       const uint64_t seed)
 {
   assert(dir.Length() > 1e-04);
 
-  static std::random_device r;
-  static std::default_random_engine randEngine(r());
-
   // normalized direction (just to be sure it is normal)
   Vertex dirNorm = dir;
   dirNorm.Normalize();
+  PerturbRange(0, GetNumVertices(), min, max, center, &dirNorm, seed);
+}
 
-  // to generate random doubles between min and max with a uniform distribution
-  std::uniform_real_distribution<double> dist(min, max);
-
-  for (typename std::vector<Vertex>::iterator it = verts.begin();
-       it != verts.end(); ++it)
+template<typename VP, int FS, typename I>
+double collision_benchmark::MeshData<VP, FS, I>::CounterRandom
+                              (const uint64_t seed, const uint64_t counter,
+                               const double min, const double max)
+{
+  // splitmix64 finalizer applied to the seed and then to the seed
+  // combined with the counter, so that neighbouring counters and
+  // seeds give uncorrelated values.
+  uint64_t z = seed;
+  for (int i = 0; i < 2; ++i)
   {
-    Vertex &v = *it;
+    z += (i == 0 ? 0 : counter) + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+  }
+  // the upper 53 bits as double in [0, 1)
+  const double u = (z >> 11) * (1.0 / 9007199254740992.0);
+  return min + u * (max - min);
+}
 
-    // determine move direction which is orthogonal to the given line
-    Vertex fromCenter = v - center;
-    Vertex proj = dirNorm * (dirNorm.Dot(fromCenter));
-    Vertex moveDir = fromCenter - proj;
-    if (moveDir.Length() < 1e-02) continue;
-    moveDir.Normalize();
+template<typename VP, int FS, typename I>
+void collision_benchmark::MeshData<VP, FS, I>::PerturbRange
+                              (const std::size_t begin, const std::size_t end,
+                               const double min, const double max,
+                               const Vertex &center, const Vertex *dir,
+                               const uint64_t seed)
+{
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    Vertex v = GetVertex(i);
+    Vertex moveDir = v - center;
+    if (dir)
+    {
+      // determine move direction which is orthogonal to the given line
+      Vertex proj = (*dir) * (dir->Dot(moveDir));
+      moveDir = moveDir - proj;
+      if (moveDir.Length() < 1e-02) continue;
+      moveDir.Normalize();
 
-    // if the move direction is not orthogonal to dir then it must
-    // be on the line itself, in which case we won't perturb it.
-    if (fabs(moveDir.Dot(dirNorm)) > 1e-04)
+      // if the move direction is not orthogonal to dir then it must
+      // be on the line itself, in which case we won't perturb it.
+      if (std::fabs(moveDir.Dot(*dir)) > 1e-04)
+      {
+        continue;
+      }
+    }
+    else
     {
-      continue;
+      moveDir.Normalize();
     }
 
-    double randDisplace = dist(randEngine);
+    double randDisplace = CounterRandom(seed, i, min, max);
     v += moveDir * randDisplace;
+    SetVertex(i, v);
   }
 }
@@ -21,8 +21,12 @@
 #define COLLISION_BENCHMARK_MESHDATA
 
 #include <ignition/math/Vector3.hh>
+#include <cassert>
+#include <cstddef>
+#include <limits>
 #include <vector>
 #include <memory>
+#include <stdint.h>
 #include <type_traits>
 
 namespace collision_benchmark
@@ -30,71 +34,185 @@ namespace collision_benchmark
 /**
  * Simple class for mesh data. Includes vertex and face index array.
  *
+ * The vertices and face indices are kept in flat, contiguous buffers
+ * (x, y, z of all vertices in GetVertexBuffer(), and the indices of all faces
+ * in GetIndexBuffer()), which can be handed to exporters or copied without
+ * converting each element.
+ *
  * \param VertexPrecision_ precision of the vertices, defaults to float.
  * \param FaceSize size of a face (3 for triangle meshes, which is the default).
  *        Must be at least 3.
+ * \param Index_ unsigned integer type of the face indices, which limits the
+ *        number of vertices. Defaults to 32 bit indices.
  *
  * \author Jennifer Buehler
  * \date December 2016
  */
-template<typename VertexPrecision_ = float, int FaceSize = 3>
+template<typename VertexPrecision_ = float, int FaceSize = 3,
+         typename Index_ = uint32_t>
 class MeshData
 {
   static_assert(FaceSize >= 3, "FaceSize must be at least 3");
+  static_assert(std::is_integral<Index_>::value &&
+                std::is_unsigned<Index_>::value,
+                "Index must be an unsigned integer type");
 
-  private: typedef MeshData<VertexPrecision_, FaceSize> Self;
+  private: typedef MeshData<VertexPrecision_, FaceSize, Index_> Self;
   public: typedef VertexPrecision_ VertexPrecision;
+  public: typedef Index_ Index;
   public: typedef ignition::math::Vector3<VertexPrecision> Vertex;
 
   public: typedef std::shared_ptr<Self> Ptr;
   public: typedef std::shared_ptr<const Self> ConstPtr;
 
+  /// \brief Number of indices per face
+  public: static const int FACE_SIZE = FaceSize;
+
   public: struct Face
           {
-            Face(const std::size_t &i1,
-                   const std::size_t &i2,
-                   const std::size_t &i3)
+            Face()
+            {
+              for (int i = 0; i < FaceSize; ++i) val[i] = 0;
+            }
+            Face(const Index &i1,
+                 const Index &i2,
+                 const Index &i3)
             {
               val[0]=i1;
               val[1]=i2;
               val[2]=i3;
+              for (int i = 3; i < FaceSize; ++i) val[i] = 0;
             }
 
-            const std::size_t &operator[](int i) const { return val[i]; }
-            std::size_t val[FaceSize];
+            const Index &operator[](int i) const { return val[i]; }
+            Index &operator[](int i) { return val[i]; }
+            Index val[FaceSize];
           };
 
   MeshData() {}
   public: MeshData(const std::vector<Vertex>& vertices,
-                   const std::vector<Face>& faces):
-            verts(vertices),
-            faces(faces) {}
+                   const std::vector<Face>& faces)
+          {
+            Reserve(vertices.size(), faces.size());
+            for (typename std::vector<Vertex>::const_iterator
+                 it = vertices.begin(); it != vertices.end(); ++it)
+              AddVertex(*it);
+            for (typename std::vector<Face>::const_iterator
+                 it = faces.begin(); it != faces.end(); ++it)
+              AddFace(*it);
+          }
   public: MeshData(const MeshData &o):
             verts(o.verts),
-            faces(o.faces) {}
+            indices(o.indices) {}
   public: ~MeshData() {}
 
-  public: inline std::vector<Vertex>& GetVertices() { return verts; }
-  public: inline const std::vector<Vertex>& GetVertices() const
+  public: inline std::size_t GetNumVertices() const
+          { return verts.size() / 3; }
+
+  public: inline std::size_t GetNumFaces() const
+          { return indices.size() / FaceSize; }
+
+  public: inline Vertex GetVertex(const std::size_t i) const
+          { return Vertex(verts[3*i], verts[3*i+1], verts[3*i+2]); }
+
+  public: inline void SetVertex(const std::size_t i, const Vertex &v)
+          {
+            verts[3*i] = v.X();
+            verts[3*i+1] = v.Y();
+            verts[3*i+2] = v.Z();
+          }
+
+  public: inline void AddVertex(const Vertex &v)
+          { AddVertex(v.X(), v.Y(), v.Z()); }
+
+  public: inline void AddVertex(const VertexPrecision x,
+                                const VertexPrecision y,
+                                const VertexPrecision z)
+          {
+            // the index of the new vertex has to fit into Index
+            assert(GetNumVertices() <=
+                   static_cast<std::size_t>(std::numeric_limits<Index>::max()));
+            verts.push_back(x);
+            verts.push_back(y);
+            verts.push_back(z);
+          }
+
+  public: inline Face GetFace(const std::size_t i) const
+          {
+            Face f;
+            for (int k = 0; k < FaceSize; ++k) f.val[k] = indices[i*FaceSize+k];
+            return f;
+          }
+
+  public: inline void AddFace(const Face &f)
+          { indices.insert(indices.end(), f.val, f.val + FaceSize); }
+
+  // Reserves memory for \e numVertices vertices and \e numFaces faces
+  public: inline void Reserve(const std::size_t numVertices,
+                              const std::size_t numFaces)
+          {
+            verts.reserve(numVertices * 3);
+            indices.reserve(numFaces * FaceSize);
+          }
+
+  // x, y and z of all vertices, vertex after vertex
+  public: inline std::vector<VertexPrecision>& GetVertexBuffer()
+                  { return verts; }
+  public: inline const std::vector<VertexPrecision>& GetVertexBuffer() const
                   { return verts; }
 
-  public: inline std::vector<Face>& GetFaces() { return faces; }
-  public: inline const std::vector<Face>& GetFaces() const { return faces; }
+  // FaceSize indices of all faces, face after face
+  public: inline std::vector<Index>& GetIndexBuffer() { return indices; }
+  public: inline const std::vector<Index>& GetIndexBuffer() const
+                  { return indices; }
 
   // Perturbs each vertex by a random value between \e min and \e max along
   // the line from the vertex to \e center.
-  public: void Perturb(const double min, const double max,
-                       const Vertex &center = Vertex(0, 0, 0));
+  // \return the random seed which was used, which can be passed to the
+  //    seeded version of this function to repeat the perturbation.
+  public: uint64_t Perturb(const double min, const double max,
+                           const Vertex &center = Vertex(0, 0, 0));
 
   // Perturbs each vertex by a random value between \e min and \e max *away
   // from the line* through \e center with direction \e dir.
   // This will move the vertex along the line orthogonal to the given line.
   // Vertices on the line will not be perturbed.
+  // \return the random seed which was used, which can be passed to the
+  //    seeded version of this function to repeat the perturbation.
+  public: uint64_t Perturb(const double min, const double max,
+                           const Vertex &center, const Vertex &dir);
+
+  // Like Perturb(min, max, center), but the random value of each vertex
+  // only depends on \e seed and the index of the vertex, so the result is
+  // reproducible and independent of how the vertices are distributed over
+  // threads (see PerturbParallel() in MeshDataParallel.hh).
+  public: void Perturb(const double min, const double max,
+                       const Vertex &center, const uint64_t seed);
+
+  // Like Perturb(min, max, center, dir), but with the random values
+  // depending only on \e seed and the vertex index.
+  // See Perturb(min, max, center, seed).
   public: void Perturb(const double min, const double max,
-                       const Vertex &center, const Vertex &dir);
+                       const Vertex &center, const Vertex &dir,
+                       const uint64_t seed);
+
+  // Perturbs only the vertices \e begin to \e end - 1, in the same way as
+  // the seeded versions of Perturb(). If \e dir is NULL, vertices are moved
+  // along the line to \e center, otherwise away from the line through
+  // \e center with the normalized direction \e dir.
+  public: void PerturbRange(const std::size_t begin, const std::size_t end,
+                            const double min, const double max,
+                            const Vertex &center, const Vertex *dir,
+                            const uint64_t seed);
+
+  // \brief Returns a random value between \e min and \e max, uniformly
+  // distributed, which only depends on \e seed and \e counter.
+  public: static double CounterRandom(const uint64_t seed,
+                                      const uint64_t counter,
+                                      const double min, const double max);
 
-  private: std::vector<Vertex> verts;
-  private:std::vector<Face> faces;
+  private: std::vector<VertexPrecision> verts;
+  private: std::vector<Index> indices;
 };
 }
 #include "MeshData-inl.hh"
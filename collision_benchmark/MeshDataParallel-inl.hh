@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHDATAPARALLEL_INL_H
+#define COLLISION_BENCHMARK_MESHDATAPARALLEL_INL_H
+
+#include <collision_benchmark/MeshDataParallel.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+namespace collision_benchmark
+{
+//////////////////////////////////////////////////////////////////////////
+// Perturbs all vertices with MeshData::PerturbRange(), split into
+// parallel jobs in \e pool if it is not NULL.
+template<typename VP, int FS, typename I>
+void PerturbAllParallel(MeshData<VP, FS, I> &mesh,
+                        const double min, const double max,
+                        const typename MeshData<VP, FS, I>::Vertex &center,
+                        const typename MeshData<VP, FS, I>::Vertex *dir,
+                        const uint64_t seed, ThreadPool *pool)
+{
+  typedef MeshData<VP, FS, I> MeshDataT;
+  const std::size_t numVertices = mesh.GetNumVertices();
+  if (!pool || (numVertices < MinParallelPerturbVertices) ||
+      pool->IsWorkerThread())
+  {
+    mesh.PerturbRange(0, numVertices, min, max, center, dir, seed);
+    return;
+  }
+
+  // the result does not depend on the split, because the random value
+  // of each vertex only depends on its index.
+  const std::size_t numJobs = pool->GetNumThreads() + 1;
+  const std::size_t chunk = (numVertices + numJobs - 1) / numJobs;
+  std::vector<ThreadPool::Job> jobs;
+  for (std::size_t begin = 0; begin < numVertices; begin += chunk)
+  {
+    const std::size_t end = std::min(numVertices, begin + chunk);
+    jobs.push_back(std::bind(&MeshDataT::PerturbRange, &mesh, begin, end,
+                             min, max, std::cref(center), dir, seed));
+  }
+  pool->RunAndWait(jobs);
+}
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, int FS, typename I>
+void PerturbParallel(MeshData<VP, FS, I> &mesh,
+                     const double min, const double max,
+                     const typename MeshData<VP, FS, I>::Vertex &center,
+                     const uint64_t seed, ThreadPool *pool)
+{
+  PerturbAllParallel(mesh, min, max, center, NULL, seed, pool);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, int FS, typename I>
+void PerturbParallel(MeshData<VP, FS, I> &mesh,
+                     const double min, const double max,
+                     const typename MeshData<VP, FS, I>::Vertex &center,
+                     const typename MeshData<VP, FS, I>::Vertex &dir,
+                     const uint64_t seed, ThreadPool *pool)
+{
+  assert(dir.Length() > 1e-04);
+
+  // normalized direction, as in MeshData::Perturb()
+  typename MeshData<VP, FS, I>::Vertex dirNorm = dir;
+  dirNorm.Normalize();
+  PerturbAllParallel(mesh, min, max, center, &dirNorm, seed, pool);
+}
+}  // namespace collision_benchmark
+
+#endif  // COLLISION_BENCHMARK_MESHDATAPARALLEL_INL_H
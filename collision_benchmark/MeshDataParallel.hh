@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHDATAPARALLEL_H
+#define COLLISION_BENCHMARK_MESHDATAPARALLEL_H
+
+#include <collision_benchmark/MeshData.hh>
+#include <collision_benchmark/ThreadPool.hh>
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace collision_benchmark
+{
+/// \brief Minimum number of vertices to perturb them in parallel
+static const std::size_t MinParallelPerturbVertices = 16384;
+
+/// \brief Perturbs \e mesh like MeshData::Perturb(min, max, center, seed),
+/// with large meshes split into parallel jobs in \e pool. The result is the
+/// same as the one of the serial version.
+/// \param[in] pool the pool to run the jobs in. If NULL, or if called from
+///   a worker thread of the pool, the mesh is perturbed in this thread.
+template<typename VP, int FS, typename I>
+void PerturbParallel(MeshData<VP, FS, I> &mesh,
+                     const double min, const double max,
+                     const typename MeshData<VP, FS, I>::Vertex &center,
+                     const uint64_t seed, ThreadPool *pool);
+
+/// \brief Perturbs \e mesh like
+/// MeshData::Perturb(min, max, center, dir, seed), with large meshes
+/// split into parallel jobs in \e pool.
+/// See PerturbParallel(mesh, min, max, center, seed, pool).
+template<typename VP, int FS, typename I>
+void PerturbParallel(MeshData<VP, FS, I> &mesh,
+                     const double min, const double max,
+                     const typename MeshData<VP, FS, I>::Vertex &center,
+                     const typename MeshData<VP, FS, I>::Vertex &dir,
+                     const uint64_t seed, ThreadPool *pool);
+}  // namespace collision_benchmark
+
+#include <collision_benchmark/MeshDataParallel-inl.hh>
+
+#endif  // COLLISION_BENCHMARK_MESHDATAPARALLEL_H
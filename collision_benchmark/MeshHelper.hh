@@ -28,20 +28,22 @@
 
 #include <boost/filesystem.hpp>
 
-#include <vector>
+#include <cstring>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace collision_benchmark
 {
-std::string SetOrReplaceFileExtension(const std::string &in,
-                                      const std::string &ext)
+inline std::string SetOrReplaceFileExtension(const std::string &in,
+                                             const std::string &ext)
 {
   boost::filesystem::path p(in);
   boost::filesystem::path swapped = p.replace_extension(ext);
   return swapped.string();
 }
 
-aiMaterial * GetDefaultMaterial()
+inline aiMaterial * GetDefaultMaterial()
 {
   aiMaterial* mat = new aiMaterial();
   /*mat->AddProperty(&srcMat.diffuse,  1,AI_MATKEY_COLOR_DIFFUSE);
@@ -82,37 +84,50 @@ CreateTrimeshScene(const typename
   assimpScene->mMaterials[0] = GetDefaultMaterial();
   assimpMesh->mMaterialIndex = 0;
 
-  int numVertices = meshData->GetVertices().size();
-  int numFaces = meshData->GetFaces().size();
+  typedef MeshData<Float, 3> MeshDataT;
+  typedef typename MeshDataT::Index Index;
+  // precision of the assimp vectors
+  typedef typename std::remove_reference<decltype(aiVector3D::x)>::type
+    AiFloat;
+
+  const std::vector<Float>& vertices = meshData->GetVertexBuffer();
+  const std::vector<Index>& indices = meshData->GetIndexBuffer();
+  unsigned int numVertices = meshData->GetNumVertices();
+  unsigned int numFaces = meshData->GetNumFaces();
 
   // Set vertices and normals
   assimpMesh->mNumVertices = numVertices;
   assimpMesh->mVertices = new aiVector3D[numVertices];
   assimpMesh->mNormals = new aiVector3D[numVertices];
-  aiVector3D itAIVector3d;
-
-  typedef MeshData<Float, 3> MeshDataT;
-  typedef typename MeshDataT::Vertex Vertex;
-  typedef typename MeshDataT::Face Face;
-
-  const std::vector<Vertex>& vertices = meshData->GetVertices();
-  const std::vector<Face>& faces = meshData->GetFaces();
 
-  for (unsigned int i = 0; i < numVertices; ++i)
+  if (std::is_same<Float, AiFloat>::value &&
+      sizeof(aiVector3D) == 3 * sizeof(AiFloat))
   {
-    itAIVector3d.Set(vertices[i].X(),
-                     vertices[i].Y(),
-                     vertices[i].Z());
-    assimpMesh->mVertices[i] = itAIVector3d;
-    // this normal has no meaning, it will have to be
-    // calculated in a postprocessing step. Unfortunately had
-    // problems doing it locally with
-    // aiApplyPostProcessing (assimpScene, aiProcess_GenNormals)
-    // so do it in the exporter instead.
-    assimpMesh->mNormals[i]  = itAIVector3d;
+    // the vertex buffer has the same layout as the assimp vertices
+    if (numVertices > 0)
+      std::memcpy(assimpMesh->mVertices, &vertices[0],
+                  numVertices * sizeof(aiVector3D));
   }
-
-  // Set faces
+  else
+  {
+    for (unsigned int i = 0; i < numVertices; ++i)
+    {
+      assimpMesh->mVertices[i].Set(vertices[3*i],
+                                   vertices[3*i+1],
+                                   vertices[3*i+2]);
+    }
+  }
+  // this normal has no meaning, it will have to be
+  // calculated in a postprocessing step. Unfortunately had
+  // problems doing it locally with
+  // aiApplyPostProcessing (assimpScene, aiProcess_GenNormals)
+  // so do it in the exporter instead.
+  if (numVertices > 0)
+    std::memcpy(assimpMesh->mNormals, assimpMesh->mVertices,
+                numVertices * sizeof(aiVector3D));
+
+  // Set faces. Each aiFace owns its index array, so the indices
+  // can't be shared in one buffer.
   assimpMesh->mNumFaces = numFaces;
   assimpMesh->mFaces = new aiFace[assimpMesh->mNumFaces];
   for (unsigned int i = 0; i < assimpMesh->mNumFaces; ++i)
@@ -120,9 +135,17 @@ CreateTrimeshScene(const typename
     aiFace* itAIFace = &assimpMesh->mFaces[i];
     itAIFace->mNumIndices = 3;
     itAIFace->mIndices = new unsigned int[3];
-    itAIFace->mIndices[0] = faces[i].val[0];
-    itAIFace->mIndices[1] = faces[i].val[1];
-    itAIFace->mIndices[2] = faces[i].val[2];
+    if (std::is_same<Index, unsigned int>::value)
+    {
+      std::memcpy(itAIFace->mIndices, &indices[3*i],
+                  3 * sizeof(unsigned int));
+    }
+    else
+    {
+      itAIFace->mIndices[0] = indices[3*i];
+      itAIFace->mIndices[1] = indices[3*i+1];
+      itAIFace->mIndices[2] = indices[3*i+2];
+    }
   }
 
   return assimpScene;
@@ -25,6 +25,7 @@
 #include <collision_benchmark/MeshData.hh>
 
 #include <memory>
+#include <string>
 
 namespace collision_benchmark
 {
@@ -50,6 +51,16 @@ class MeshShapeGenerator
 
   public: virtual ~MeshShapeGenerator() {}
 
+  /**
+   * \brief Returns the identifier of the generator for cache keys
+   * (see MeshShapeGeneratorCached). The identifier includes the version
+   * of the tessellation, so it changes whenever the generator produces
+   * other meshes for the same parameters.
+   * \return the identifier, or an empty string if the generator is not
+   *    deterministic, in which case its meshes must not be cached.
+   */
+  public: virtual std::string GetCacheId() const { return ""; }
+
   /**
    * \brief Makes a sphere.
    * \param[in] radius radius of sphere
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHSHAPEGENERATORCACHED_INL_H
+#define COLLISION_BENCHMARK_MESHSHAPEGENERATORCACHED_INL_H
+
+#include <collision_benchmark/MeshShapeGeneratorCached.hh>
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace collision_benchmark
+{
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::Load(const std::string &params,
+                                   std::string &id) const
+{
+  id.clear();
+  const std::string generatorId = this->generator->GetCacheId();
+  if (!this->cache || generatorId.empty()) return TriMeshDataPtr();
+  std::stringstream str;
+  str << generatorId << " " << sizeof(VP) << " " << params;
+  id = str.str();
+  return this->cache->template LoadMeshData
+    <VP, 3, typename TriMeshData::Index>(MeshCache::MakeKey(id));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::Store(const std::string &id,
+                                    const TriMeshDataPtr &mesh) const
+{
+  if (this->cache && mesh && !id.empty())
+  {
+    this->cache->StoreMeshData(MeshCache::MakeKey(id), *mesh, id);
+  }
+  return mesh;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeSphere(const double radius,
+                                         const unsigned int theta,
+                                         const unsigned int phi,
+                                         const bool latLongTessel) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "sphere " << radius << " " << theta
+         << " " << phi << " " << latLongTessel;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeSphere(radius, theta, phi,
+                                                     latLongTessel));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeCylinder(const double radius,
+                                           const double height,
+                                           const unsigned int resolution,
+                                           const bool capping) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "cylinder " << radius << " " << height
+         << " " << resolution << " " << capping;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeCylinder(radius, height,
+                                                       resolution, capping));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeBox(const double x,
+                                      const double y,
+                                      const double z) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "box " << x << " " << y << " " << z;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeBox(x, y, z));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeBox(const double xMin, const double xMax,
+                                      const double yMin, const double yMax,
+                                      const double zMin,
+                                      const double zMax) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "aabb " << xMin << " " << xMax << " "
+         << yMin << " " << yMax << " " << zMin << " " << zMax;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeBox(xMin, xMax, yMin, yMax,
+                                                  zMin, zMax));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeCone(const double radius,
+                                       const double height,
+                                       const unsigned int resolution,
+                                       const double angle_deg,
+                                       const bool capping,
+                                       const double dir_x,
+                                       const double dir_y,
+                                       const double dir_z) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "cone " << radius << " " << height
+         << " " << resolution << " " << angle_deg << " " << capping << " "
+         << dir_x << " " << dir_y << " " << dir_z;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeCone(radius, height, resolution,
+                                                   angle_deg, capping,
+                                                   dir_x, dir_y, dir_z));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeDisk(const double innerRadius,
+                                       const double outerRadius,
+                                       const unsigned int radialRes,
+                                       const unsigned int circumRes) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "disk " << innerRadius << " "
+         << outerRadius << " " << radialRes << " " << circumRes;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeDisk(innerRadius, outerRadius,
+                                                   radialRes, circumRes));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeEllipsoid(const double xRad,
+                                            const double yRad,
+                                            const double zRad,
+                                            const unsigned int uRes,
+                                            const unsigned int vRes) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "ellipsoid " << xRad << " " << yRad
+         << " " << zRad << " " << uRes << " " << vRes;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeEllipsoid(xRad, yRad, zRad,
+                                                        uRes, vRes));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorCached<VP>::TriMeshDataPtr
+MeshShapeGeneratorCached<VP>::MakeTorus(const double ringRadius,
+                                        const double crossRadius,
+                                        const unsigned int uRes,
+                                        const unsigned int vRes) const
+{
+  std::stringstream params;
+  params << std::setprecision(17) << "torus " << ringRadius << " "
+         << crossRadius << " " << uRes << " " << vRes;
+  std::string id;
+  TriMeshDataPtr mesh = this->Load(params.str(), id);
+  if (mesh) return mesh;
+  return this->Store(id, this->generator->MakeTorus(ringRadius, crossRadius,
+                                                    uRes, vRes));
+}
+
+}  // namespace
+#endif  // COLLISION_BENCHMARK_MESHSHAPEGENERATORCACHED_INL_H
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHSHAPEGENERATORCACHED_H
+#define COLLISION_BENCHMARK_MESHSHAPEGENERATORCACHED_H
+
+#include <collision_benchmark/MeshShapeGenerator.hh>
+#include <collision_benchmark/MeshCache.hh>
+
+#include <string>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Generates meshes with another MeshShapeGenerator and keeps them
+ * in a MeshCache, so that meshes with the same shape type and parameters
+ * are generated only once, also across processes.
+ *
+ * The meshes are stored under a key made of the identifier of the generator
+ * (see MeshShapeGenerator::GetCacheId()), which includes its version, and
+ * all parameters. Meshes of generators which are not deterministic (which
+ * have no identifier) are not cached.
+ *
+ * Each call returns a new copy of the mesh data, which can be modified
+ * (e.g. with MeshData::Perturb()) without affecting the cache.
+ */
+template<typename VertexPrecision_ = float>
+class MeshShapeGeneratorCached
+  : public MeshShapeGenerator<VertexPrecision_>
+{
+  public: typedef VertexPrecision_ VertexPrecision;
+  private: typedef MeshShapeGeneratorCached<VertexPrecision> Self;
+  private: typedef MeshShapeGenerator<VertexPrecision> Super;
+  public: typedef std::shared_ptr<Self> Ptr;
+  public: typedef std::shared_ptr<const Self> ConstPtr;
+
+  public: typedef typename Super::TriMeshData TriMeshData;
+  public: typedef typename Super::TriMeshDataPtr TriMeshDataPtr;
+
+  /// \brief Constructor
+  /// \param[in] generator the generator to create the meshes which
+  ///   are not in the cache yet
+  /// \param[in] cache the cache. If NULL, all meshes are generated
+  ///   with \e generator.
+  public: MeshShapeGeneratorCached(const typename Super::Ptr &generator,
+                                   const MeshCache::Ptr &cache):
+            generator(generator),
+            cache(cache) {}
+
+  // Documentation inherited from parent class.
+  // Returns the identifier of the wrapped generator.
+  public: virtual std::string GetCacheId() const
+          { return this->generator->GetCacheId(); }
+
+  public: virtual TriMeshDataPtr MakeSphere(const double radius,
+                                            const unsigned int theta,
+                                            const unsigned int phi,
+                                            const bool latLongTessel) const;
+
+  public: virtual TriMeshDataPtr MakeCylinder(const double radius,
+                                              const double height,
+                                              const unsigned int resolution,
+                                              const bool capping) const;
+
+  public: virtual TriMeshDataPtr MakeBox(const double x,
+                                         const double y,
+                                         const double z) const;
+
+  public: virtual TriMeshDataPtr MakeBox(const double xMin, const double xMax,
+                                         const double yMin, const double yMax,
+                                         const double zMin,
+                                         const double zMax) const;
+
+  public: virtual TriMeshDataPtr MakeCone(const double radius,
+                                          const double height,
+                                          const unsigned int resolution,
+                                          const double angle_deg,
+                                          const bool capping,
+                                          const double dir_x = 0,
+                                          const double dir_y = 0,
+                                          const double dir_z = 1) const;
+
+  public: virtual TriMeshDataPtr MakeDisk(const double innerRadius,
+                                          const double outerRadius,
+                                          const unsigned int radialRes,
+                                          const unsigned int circumRes) const;
+
+  public: virtual TriMeshDataPtr MakeEllipsoid(const double xRad,
+                                               const double yRad,
+                                               const double zRad,
+                                               const unsigned int uRes,
+                                               const unsigned int vRes) const;
+
+  public: virtual TriMeshDataPtr MakeTorus(const double ringRadius,
+                                           const double crossRadius,
+                                           const unsigned int uRes,
+                                           const unsigned int vRes) const;
+
+  /// \return the cache, or NULL if no cache is used
+  public: MeshCache::Ptr GetCache() const { return this->cache; }
+
+  // \brief Loads the mesh for the parameters \e params from the cache.
+  // \param[out] id the full identifier of the mesh, or an empty string if
+  //    the mesh must not be cached.
+  // \return the mesh, or NULL if it is not in the cache
+  private: TriMeshDataPtr Load(const std::string &params,
+                               std::string &id) const;
+
+  // \brief Stores \e mesh in the cache under identifier \e id.
+  // \return \e mesh
+  private: TriMeshDataPtr Store(const std::string &id,
+                                const TriMeshDataPtr &mesh) const;
+
+  // \brief the generator for meshes which are not in the cache
+  private: typename Super::Ptr generator;
+
+  // \brief the cache
+  private: MeshCache::Ptr cache;
+};  // class
+}  // namespace
+
+#include <collision_benchmark/MeshShapeGeneratorCached-inl.hh>
+
+#endif  // COLLISION_BENCHMARK_MESHSHAPEGENERATORCACHED_H
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHSHAPEGENERATORNATIVE_INL_H
+#define COLLISION_BENCHMARK_MESHSHAPEGENERATORNATIVE_INL_H
+
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+namespace collision_benchmark
+{
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+std::string MeshShapeGeneratorNative<VP>::GetCacheId() const
+{
+  std::stringstream str;
+  str << "native " << Version;
+  return str.str();
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+void MeshShapeGeneratorNative<VP>::AddQuad(TriMeshData &mesh,
+                                    const typename TriMeshData::Index a,
+                                    const typename TriMeshData::Index b,
+                                    const typename TriMeshData::Index c,
+                                    const typename TriMeshData::Index d,
+                                    const bool shortDiagonal)
+{
+  typedef typename TriMeshData::Face Face;
+  if (shortDiagonal &&
+      (mesh.GetVertex(b) - mesh.GetVertex(d)).Length() <
+      (mesh.GetVertex(a) - mesh.GetVertex(c)).Length())
+  {
+    mesh.AddFace(Face(a, b, d));
+    mesh.AddFace(Face(b, c, d));
+    return;
+  }
+  mesh.AddFace(Face(a, b, c));
+  mesh.AddFace(Face(a, c, d));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeLatLong(const double xRad,
+                                          const double yRad,
+                                          const double zRad,
+                                          const unsigned int _sectors,
+                                          const unsigned int _stacks,
+                                          const bool shortDiagonal)
+{
+  typedef typename TriMeshData::Face Face;
+  typedef typename TriMeshData::Index Index;
+  const unsigned int sectors = std::max(_sectors, 3u);
+  const unsigned int stacks = std::max(_stacks, 2u);
+  const unsigned int rings = stacks - 1;
+
+  TriMeshDataPtr mesh(new TriMeshData());
+  mesh->Reserve(2 + sectors * rings, 2 * sectors * rings);
+
+  // vertex 0 is the north pole, vertex 1 the south pole, followed by the
+  // rings of each sector from north to south.
+  mesh->AddVertex(0, 0, zRad);
+  mesh->AddVertex(0, 0, -zRad);
+  for (unsigned int i = 0; i < sectors; ++i)
+  {
+    const double u = 2 * M_PI * i / sectors;
+    for (unsigned int j = 1; j <= rings; ++j)
+    {
+      const double v = M_PI * j / stacks;
+      mesh->AddVertex(xRad * sin(v) * cos(u), yRad * sin(v) * sin(u),
+                      zRad * cos(v));
+    }
+  }
+
+  for (unsigned int i = 0; i < sectors; ++i)
+  {
+    const Index s1 = 2 + i * rings;
+    const Index s2 = 2 + ((i + 1) % sectors) * rings;
+    mesh->AddFace(Face(0, s1, s2));
+    for (unsigned int j = 0; j + 1 < rings; ++j)
+    {
+      AddQuad(*mesh, s1 + j, s1 + j + 1, s2 + j + 1, s2 + j, shortDiagonal);
+    }
+    mesh->AddFace(Face(1, s2 + rings - 1, s1 + rings - 1));
+  }
+  return mesh;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeSphere(const double radius,
+                                         const unsigned int theta,
+                                         const unsigned int phi,
+                                         const bool latLongTessel) const
+{
+  // VTK triangulates the quads of a lat-long tessellation along the
+  // shorter diagonal, and otherwise generates triangles along a-c.
+  return MakeLatLong(radius, radius, radius, theta, std::max(phi, 3u) - 1,
+                     latLongTessel);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeCylinder(const double radius,
+                                           const double height,
+                                           const unsigned int _resolution,
+                                           const bool capping) const
+{
+  typedef typename TriMeshData::Face Face;
+  typedef typename TriMeshData::Index Index;
+  const Index res = std::max(_resolution, 3u);
+
+  TriMeshDataPtr mesh(new TriMeshData());
+  mesh->Reserve(2 * res, capping ? 4 * res - 4 : 2 * res);
+
+  // vertices 0..res-1 are on the top (+y), res..2*res-1 on the bottom
+  for (int k = 0; k < 2; ++k)
+  {
+    const double y = (k == 0 ? height : -height) / 2;
+    for (Index i = 0; i < res; ++i)
+    {
+      const double angle = 2 * M_PI * i / res;
+      mesh->AddVertex(radius * cos(angle), y, -radius * sin(angle));
+    }
+  }
+
+  for (Index i = 0; i < res; ++i)
+  {
+    const Index next = (i + 1) % res;
+    AddQuad(*mesh, i, res + i, res + next, next);
+  }
+
+  if (capping)
+  {
+    for (Index i = 1; i + 1 < res; ++i)
+    {
+      mesh->AddFace(Face(0, i, i + 1));
+      mesh->AddFace(Face(res, res + i + 1, res + i));
+    }
+  }
+  return mesh;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeBox(const double x,
+                                      const double y,
+                                      const double z) const
+{
+  return MakeBox(-x / 2, x / 2, -y / 2, y / 2, -z / 2, z / 2);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeBox(const double xMin, const double xMax,
+                                      const double yMin, const double yMax,
+                                      const double zMin,
+                                      const double zMax) const
+{
+  TriMeshDataPtr mesh(new TriMeshData());
+  mesh->Reserve(8, 12);
+
+  // bit 0 of the vertex index selects the x coordinate, bit 1 the y
+  // coordinate and bit 2 the z coordinate
+  for (int i = 0; i < 8; ++i)
+  {
+    mesh->AddVertex((i & 1) ? xMax : xMin,
+                    (i & 2) ? yMax : yMin,
+                    (i & 4) ? zMax : zMin);
+  }
+
+  AddQuad(*mesh, 0, 4, 6, 2);  // -x
+  AddQuad(*mesh, 1, 3, 7, 5);  // +x
+  AddQuad(*mesh, 0, 1, 5, 4);  // -y
+  AddQuad(*mesh, 2, 6, 7, 3);  // +y
+  AddQuad(*mesh, 0, 2, 3, 1);  // -z
+  AddQuad(*mesh, 4, 5, 7, 6);  // +z
+  return mesh;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeCone(const double _radius,
+                                       const double height,
+                                       const unsigned int _resolution,
+                                       const double angle_deg,
+                                       const bool capping,
+                                       const double dir_x,
+                                       const double dir_y,
+                                       const double dir_z) const
+{
+  typedef typename TriMeshData::Face Face;
+  typedef typename TriMeshData::Index Index;
+  typedef ignition::math::Vector3<double> Vector3;
+  const Index res = std::max(_resolution, 3u);
+  const double radius = angle_deg > 0 ?
+    height * tan(angle_deg * M_PI / 180.0) : _radius;
+
+  Vector3 axis(dir_x, dir_y, dir_z);
+  if (axis.Length() < 1e-12) axis = Vector3(1, 0, 0);
+  axis.Normalize();
+  // two unit vectors perpendicular to the axis, with u x w = axis
+  Vector3 u = std::fabs(axis.X()) < 0.9 ?
+    Vector3(1, 0, 0).Cross(axis) : Vector3(0, 1, 0).Cross(axis);
+  u.Normalize();
+  const Vector3 w = axis.Cross(u);
+
+  TriMeshDataPtr mesh(new TriMeshData());
+  mesh->Reserve(res + 1, capping ? 2 * res - 2 : res);
+
+  // vertex 0 is the apex, followed by the vertices of the base
+  const Vector3 apex = axis * (height / 2);
+  mesh->AddVertex(apex.X(), apex.Y(), apex.Z());
+  for (Index i = 0; i < res; ++i)
+  {
+    const double angle = 2 * M_PI * i / res;
+    const Vector3 p = axis * (-height / 2) +
+                      u * (radius * cos(angle)) + w * (radius * sin(angle));
+    mesh->AddVertex(p.X(), p.Y(), p.Z());
+  }
+
+  for (Index i = 0; i < res; ++i)
+  {
+    mesh->AddFace(Face(0, 1 + i, 1 + (i + 1) % res));
+  }
+
+  if (capping)
+  {
+    for (Index i = 2; i < res; ++i)
+    {
+      mesh->AddFace(Face(1, 1 + i, i));
+    }
+  }
+  return mesh;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeDisk(const double innerRadius,
+                                       const double outerRadius,
+                                       const unsigned int _radialRes,
+                                       const unsigned int _circumRes) const
+{
+  typedef typename TriMeshData::Face Face;
+  typedef typename TriMeshData::Index Index;
+  const Index radialRes = std::max(_radialRes, 1u);
+  const Index circumRes = std::max(_circumRes, 3u);
+
+  // with no inner radius, the innermost ring collapses to one
+  // vertex at the center (index 0)
+  const bool center = innerRadius <= 0;
+  const Index first = center ? 1 : 0;
+  const Index ringSize = radialRes + 1 - first;
+
+  TriMeshDataPtr mesh(new TriMeshData());
+  mesh->Reserve(first + circumRes * ringSize,
+                circumRes * (2 * radialRes - first));
+
+  if (center) mesh->AddVertex(0, 0, 0);
+  for (Index i = 0; i < circumRes; ++i)
+  {
+    const double angle = 2 * M_PI * i / circumRes;
+    for (Index j = first; j <= radialRes; ++j)
+    {
+      const double r = innerRadius +
+        (outerRadius - innerRadius) * j / radialRes;
+      mesh->AddVertex(r * cos(angle), r * sin(angle), 0);
+    }
+  }
+
+  for (Index i = 0; i < circumRes; ++i)
+  {
+    const Index s1 = first + i * ringSize;
+    const Index s2 = first + ((i + 1) % circumRes) * ringSize;
+    if (center) mesh->AddFace(Face(0, s1, s2));
+    for (Index j = 0; j + 1 < ringSize; ++j)
+    {
+      AddQuad(*mesh, s1 + j, s1 + j + 1, s2 + j + 1, s2 + j);
+    }
+  }
+  return mesh;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeEllipsoid(const double xRad,
+                                            const double yRad,
+                                            const double zRad,
+                                            const unsigned int uRes,
+                                            const unsigned int vRes) const
+{
+  return MakeLatLong(xRad, yRad, zRad, std::max(uRes, 4u) - 1,
+                     std::max(vRes, 3u) - 1, false);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+typename MeshShapeGeneratorNative<VP>::TriMeshDataPtr
+MeshShapeGeneratorNative<VP>::MakeTorus(const double ringRadius,
+                                        const double crossRadius,
+                                        const unsigned int uRes,
+                                        const unsigned int vRes) const
+{
+  typedef typename TriMeshData::Index Index;
+  const Index uSections = std::max(uRes, 4u) - 1;
+  const Index vSections = std::max(vRes, 4u) - 1;
+
+  TriMeshDataPtr mesh(new TriMeshData());
+  mesh->Reserve(uSections * vSections, 2 * uSections * vSections);
+
+  for (Index i = 0; i < uSections; ++i)
+  {
+    const double u = 2 * M_PI * i / uSections;
+    for (Index j = 0; j < vSections; ++j)
+    {
+      const double v = 2 * M_PI * j / vSections;
+      const double r = ringRadius + crossRadius * cos(v);
+      mesh->AddVertex(r * cos(u), r * sin(u), crossRadius * sin(v));
+    }
+  }
+
+  for (Index i = 0; i < uSections; ++i)
+  {
+    const Index s1 = i * vSections;
+    const Index s2 = ((i + 1) % uSections) * vSections;
+    for (Index j = 0; j < vSections; ++j)
+    {
+      const Index next = (j + 1) % vSections;
+      AddQuad(*mesh, s1 + j, s2 + j, s2 + next, s1 + next);
+    }
+  }
+  return mesh;
+}
+
+}  // namespace
+#endif  // COLLISION_BENCHMARK_MESHSHAPEGENERATORNATIVE_INL_H
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHSHAPEGENERATORNATIVE_H
+#define COLLISION_BENCHMARK_MESHSHAPEGENERATORNATIVE_H
+
+#include <collision_benchmark/MeshShapeGenerator.hh>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Generates triangle meshes of shapes by tessellating them directly,
+ * without any external library.
+ *
+ * The parameters have the same meaning as for MeshShapeGeneratorVtk, and
+ * the meshes have the same vertices and number of faces as the cleaned
+ * VTK meshes: there are no duplicate vertices, and the poles of spheres and
+ * ellipsoids are single vertices. Faces of closed shapes are oriented
+ * counter-clockwise seen from outside. Resolutions which are too low to make
+ * a valid shape are raised to the minimum (e.g. 3 facets for a cylinder).
+ */
+template<typename VertexPrecision_ = float>
+class MeshShapeGeneratorNative
+  : public MeshShapeGenerator<VertexPrecision_>
+{
+  public: typedef VertexPrecision_ VertexPrecision;
+  private: typedef MeshShapeGeneratorNative<VertexPrecision> Self;
+  private: typedef MeshShapeGenerator<VertexPrecision> Super;
+  public: typedef std::shared_ptr<Self> Ptr;
+  public: typedef std::shared_ptr<const Self> ConstPtr;
+
+  public: typedef typename Super::TriMeshData TriMeshData;
+  public: typedef typename Super::TriMeshDataPtr TriMeshDataPtr;
+
+  // Documentation inherited from parent class.
+  public: virtual std::string GetCacheId() const;
+
+  public: virtual TriMeshDataPtr MakeSphere(const double radius,
+                                            const unsigned int theta,
+                                            const unsigned int phi,
+                                            const bool latLongTessel) const;
+
+  public: virtual TriMeshDataPtr MakeCylinder(const double radius,
+                                              const double height,
+                                              const unsigned int resolution,
+                                              const bool capping) const;
+
+  public: virtual TriMeshDataPtr MakeBox(const double x,
+                                         const double y,
+                                         const double z) const;
+
+  public: virtual TriMeshDataPtr MakeBox(const double xMin, const double xMax,
+                                         const double yMin, const double yMax,
+                                         const double zMin,
+                                         const double zMax) const;
+
+  /// As for MeshShapeGeneratorVtk, the cone is centered at the origin, and
+  /// \e angle_deg overrides \e radius. \e radius is only used if
+  /// \e angle_deg is not positive.
+  public: virtual TriMeshDataPtr MakeCone(const double radius,
+                                          const double height,
+                                          const unsigned int resolution,
+                                          const double angle_deg,
+                                          const bool capping,
+                                          const double dir_x = 0,
+                                          const double dir_y = 0,
+                                          const double dir_z = 1) const;
+
+  public: virtual TriMeshDataPtr MakeDisk(const double innerRadius,
+                                          const double outerRadius,
+                                          const unsigned int radialRes,
+                                          const unsigned int circumRes) const;
+
+  /// As for the torus, \e uRes - 1 sections are created around the z axis,
+  /// and \e vRes - 1 sections from pole to pole.
+  public: virtual TriMeshDataPtr MakeEllipsoid(const double xRad,
+                                               const double yRad,
+                                               const double zRad,
+                                               const unsigned int uRes,
+                                               const unsigned int vRes) const;
+
+  /// \e vRes - 1 sections are created around the cross section.
+  public: virtual TriMeshDataPtr MakeTorus(const double ringRadius,
+                                           const double crossRadius,
+                                           const unsigned int uRes,
+                                           const unsigned int vRes) const;
+
+  // \brief Version of the tessellation. Has to be increased whenever
+  // the generated meshes change, so that cached meshes are not used.
+  private: static const int Version = 1;
+
+  // \brief Makes an ellipsoid with vertices on latitude and longitude lines.
+  // \param[in] sectors number of sections around the z axis
+  // \param[in] stacks number of sections from the north to the south pole
+  // \param[in] shortDiagonal split the quads along the shorter diagonal.
+  //    If false, all quads are split along the same diagonal.
+  private: static TriMeshDataPtr MakeLatLong(const double xRad,
+                                             const double yRad,
+                                             const double zRad,
+                                             const unsigned int sectors,
+                                             const unsigned int stacks,
+                                             const bool shortDiagonal);
+
+  // \brief Adds the quad (\e a, \e b, \e c, \e d), given counter-clockwise,
+  // as two triangles. The quad is split along a-c, unless \e shortDiagonal
+  // is true and b-d is shorter.
+  private: static void AddQuad(TriMeshData &mesh,
+                               const typename TriMeshData::Index a,
+                               const typename TriMeshData::Index b,
+                               const typename TriMeshData::Index c,
+                               const typename TriMeshData::Index d,
+                               const bool shortDiagonal = false);
+};  // class
+}  // namespace
+
+#include <collision_benchmark/MeshShapeGeneratorNative-inl.hh>
+
+#endif  // COLLISION_BENCHMARK_MESHSHAPEGENERATORNATIVE_H
@@ -23,6 +23,8 @@
 #define COLLISION_BENCHMARK_MESHSHAPEGENERATORVTK_INL_H
 
 #include <collision_benchmark/MeshShapeGenerationVtk.hh>
+#include <vtkVersion.h>
+#include <string>
 #include <vector>
 
 namespace collision_benchmark
@@ -34,32 +36,35 @@ GetTriMeshFromVtkPoly(const vtkSmartPointer<vtkPolyData>& poly)
 {
   typedef typename MeshShapeGeneratorVtk<VP>::TriMeshData TriMeshData;
   typedef typename TriMeshData::Ptr TriMeshDataPtr;
-  typedef std::vector<typename TriMeshData::Vertex> TriMeshVerts_V;
-  typedef std::vector<typename TriMeshData::Face> TriMeshFaces_V;
 
   std::vector<collision_benchmark::vPoint> vtkPoints;
   std::vector<collision_benchmark::vTriIdx> vtkFaces;
   collision_benchmark::getTriangleSoup(poly, vtkPoints, vtkFaces);
 
   TriMeshDataPtr ret(new TriMeshData());
-  TriMeshVerts_V &verts = ret->GetVertices();
+  ret->Reserve(vtkPoints.size(), vtkFaces.size());
   for (std::vector<collision_benchmark::vPoint>::const_iterator
        it = vtkPoints.begin(); it != vtkPoints.end(); ++it)
   {
     const collision_benchmark::vPoint &p = *it;
-    verts.push_back(typename TriMeshData::Vertex(p.x, p.y, p.z));
+    ret->AddVertex(p.x, p.y, p.z);
   }
 
-  TriMeshFaces_V &faces = ret->GetFaces();
   for (std::vector<collision_benchmark::vTriIdx>::const_iterator
        it = vtkFaces.begin(); it != vtkFaces.end(); ++it)
   {
     const collision_benchmark::vTriIdx &f = *it;
-    faces.push_back(typename TriMeshData::Face(f.v1, f.v2, f.v3));
+    ret->AddFace(typename TriMeshData::Face(f.v1, f.v2, f.v3));
   }
   return ret;
 }
 
+//////////////////////////////////////////////////////////////////////////
+template<typename VP>
+std::string MeshShapeGeneratorVtk<VP>::GetCacheId() const
+{
+  return std::string("vtk ") + vtkVersion::GetVTKVersion();
+}
 
 //////////////////////////////////////////////////////////////////////////
 template<typename VP>
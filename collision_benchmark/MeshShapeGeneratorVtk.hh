@@ -44,6 +44,10 @@ class MeshShapeGeneratorVtk
   public: typedef typename Super::TriMeshData TriMeshData;
   public: typedef typename Super::TriMeshDataPtr TriMeshDataPtr;
 
+  // Documentation inherited from parent class.
+  // The identifier includes the VTK version.
+  public: virtual std::string GetCacheId() const;
+
   public: virtual TriMeshDataPtr MakeSphere(const double radius,
                                             const unsigned int theta,
                                             const unsigned int phi,
@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHSIMPLIFIER_INL_H
+#define COLLISION_BENCHMARK_MESHSIMPLIFIER_INL_H
+
+#include <collision_benchmark/MeshSimplifier.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace collision_benchmark
+{
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+typename MeshSimplifier<VP, I>::MeshDataPtr
+MeshSimplifier<VP, I>::Simplify(const MeshDataT &mesh,
+                                const std::size_t targetFaces)
+{
+  MeshSimplifier simplifier(mesh);
+  simplifier.Run(targetFaces);
+  return simplifier.GetResult();
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+std::vector<typename MeshSimplifier<VP, I>::MeshDataPtr>
+MeshSimplifier<VP, I>::MakeLODs(const MeshDataT &mesh,
+                                const std::vector<double> &ratios)
+{
+  std::vector<MeshDataPtr> lods;
+  const double numFaces = mesh.GetNumFaces();
+  for (std::vector<double>::const_iterator it = ratios.begin();
+       it != ratios.end(); ++it)
+  {
+    const std::size_t target =
+      static_cast<std::size_t>(std::ceil(std::max(0.0, *it) * numFaces));
+    // start from the previous level if it has more faces than the target
+    const MeshDataT &src = (!lods.empty() &&
+                            lods.back()->GetNumFaces() >= target) ?
+                           *lods.back() : mesh;
+    lods.push_back(Simplify(src, target));
+  }
+  return lods;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+void MeshSimplifier<VP, I>::Quadric::AddPlane(const Vector3 &n,
+                                              const double d,
+                                              const double w)
+{
+  const double p[4] = { n.X(), n.Y(), n.Z(), d };
+  int k = 0;
+  for (int i = 0; i < 4; ++i)
+    for (int j = i; j < 4; ++j)
+      q[k++] += w * p[i] * p[j];
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+double MeshSimplifier<VP, I>::Quadric::Error(const Vector3 &v) const
+{
+  const double x = v.X(), y = v.Y(), z = v.Z();
+  return q[0]*x*x + 2*q[1]*x*y + 2*q[2]*x*z + 2*q[3]*x
+       + q[4]*y*y + 2*q[5]*y*z + 2*q[6]*y
+       + q[7]*z*z + 2*q[8]*z
+       + q[9];
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+bool MeshSimplifier<VP, I>::Quadric::Optimum(Vector3 &v) const
+{
+  // solve A v = -b with Cramer's rule, where A is the upper left 3x3
+  // matrix and b the last column of the quadric.
+  const double a00 = q[0], a01 = q[1], a02 = q[2];
+  const double a11 = q[4], a12 = q[5], a22 = q[7];
+  const double b0 = -q[3], b1 = -q[6], b2 = -q[8];
+
+  const double c00 = a11 * a22 - a12 * a12;
+  const double c01 = a02 * a12 - a01 * a22;
+  const double c02 = a01 * a12 - a02 * a11;
+  const double det = a00 * c00 + a01 * c01 + a02 * c02;
+
+  // the matrix is close to singular if the planes meeting at the vertex
+  // are (nearly) parallel, e.g. on flat regions.
+  const double scale = std::fabs(a00) + std::fabs(a11) + std::fabs(a22);
+  if (std::fabs(det) <= 1e-10 * scale * scale * scale) return false;
+
+  const double c11 = a00 * a22 - a02 * a02;
+  const double c12 = a01 * a02 - a00 * a12;
+  const double c22 = a00 * a11 - a01 * a01;
+  v = Vector3((c00 * b0 + c01 * b1 + c02 * b2) / det,
+              (c01 * b0 + c11 * b1 + c12 * b2) / det,
+              (c02 * b0 + c12 * b1 + c22 * b2) / det);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+MeshSimplifier<VP, I>::MeshSimplifier(const MeshDataT &mesh):
+  numFaces(0)
+{
+  const std::size_t numVerts = mesh.GetNumVertices();
+  const std::vector<VP> &verts = mesh.GetVertexBuffer();
+  positions.reserve(numVerts);
+  for (std::size_t i = 0; i < numVerts; ++i)
+  {
+    positions.push_back(Vector3(verts[3*i], verts[3*i+1], verts[3*i+2]));
+    if (i == 0)
+    {
+      aabbMin = aabbMax = positions.back();
+    }
+    else
+    {
+      aabbMin.Min(positions.back());
+      aabbMax.Max(positions.back());
+    }
+  }
+
+  quadrics.resize(numVerts);
+  removedVertices.resize(numVerts, false);
+  stamps.resize(numVerts, 0);
+  vertexFaces.resize(numVerts);
+
+  const std::vector<I> &indices = mesh.GetIndexBuffer();
+  faces.assign(indices.begin(), indices.end());
+  removedFaces.resize(mesh.GetNumFaces(), false);
+  for (std::size_t f = 0; f < mesh.GetNumFaces(); ++f)
+  {
+    const std::size_t *idx = &faces[3*f];
+    if (idx[0] == idx[1] || idx[1] == idx[2] || idx[0] == idx[2])
+    {
+      removedFaces[f] = true;
+      continue;
+    }
+    ++numFaces;
+    for (int k = 0; k < 3; ++k) vertexFaces[idx[k]].push_back(f);
+
+    // quadric of the plane of the face, weighted by the face area
+    Vector3 n = (positions[idx[1]] - positions[idx[0]]).Cross
+                (positions[idx[2]] - positions[idx[0]]);
+    const double len = n.Length();
+    if (len <= std::numeric_limits<double>::epsilon()) continue;
+    n /= len;
+    Quadric q;
+    q.AddPlane(n, -n.Dot(positions[idx[0]]), len / 2);
+    for (int k = 0; k < 3; ++k) quadrics[idx[k]] += q;
+  }
+
+  // one candidate for each edge
+  std::set<std::pair<std::size_t, std::size_t> > edges;
+  for (std::size_t f = 0; f < removedFaces.size(); ++f)
+  {
+    if (removedFaces[f]) continue;
+    for (int k = 0; k < 3; ++k)
+    {
+      std::size_t v1 = faces[3*f + k];
+      std::size_t v2 = faces[3*f + (k + 1) % 3];
+      if (v1 > v2) std::swap(v1, v2);
+      if (!edges.insert(std::make_pair(v1, v2)).second) continue;
+      Candidate c;
+      if (MakeCandidate(v1, v2, c)) queue.push(c);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+void MeshSimplifier<VP, I>::Run(const std::size_t targetFaces)
+{
+  while ((numFaces > targetFaces) && !queue.empty())
+  {
+    Candidate c = queue.top();
+    queue.pop();
+    // skip candidates of vertices which changed since they were made
+    if (removedVertices[c.v1] || removedVertices[c.v2] ||
+        (stamps[c.v1] != c.stamp1) || (stamps[c.v2] != c.stamp2))
+      continue;
+    // the neighbours may have moved or been collapsed since the
+    // candidate was made
+    if (FlipsFaces(c.v1, c.v2, c.pos) || FlipsFaces(c.v2, c.v1, c.pos) ||
+        !SatisfiesLinkCondition(c.v1, c.v2))
+      continue;
+    Collapse(c);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+typename MeshSimplifier<VP, I>::MeshDataPtr
+MeshSimplifier<VP, I>::GetResult() const
+{
+  MeshDataPtr result(new MeshDataT());
+  result->Reserve(positions.size(), numFaces);
+  std::vector<std::size_t> newIdx(positions.size(),
+                                  std::numeric_limits<std::size_t>::max());
+  for (std::size_t f = 0; f < removedFaces.size(); ++f)
+  {
+    if (removedFaces[f]) continue;
+    typename MeshDataT::Face face;
+    for (int k = 0; k < 3; ++k)
+    {
+      const std::size_t v = faces[3*f + k];
+      if (newIdx[v] == std::numeric_limits<std::size_t>::max())
+      {
+        newIdx[v] = result->GetNumVertices();
+        result->AddVertex(positions[v].X(), positions[v].Y(),
+                          positions[v].Z());
+      }
+      face.val[k] = newIdx[v];
+    }
+    result->AddFace(face);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+bool MeshSimplifier<VP, I>::MakeCandidate(const std::size_t v1,
+                                          const std::size_t v2,
+                                          Candidate &c) const
+{
+  if (!SatisfiesLinkCondition(v1, v2)) return false;
+
+  Quadric q = quadrics[v1];
+  q += quadrics[v2];
+
+  // try the optimal position first, then the end points and the middle
+  std::vector<Vector3> options;
+  Vector3 opt;
+  if (q.Optimum(opt))
+  {
+    // new vertices must not grow the bounding box
+    opt.Max(aabbMin);
+    opt.Min(aabbMax);
+    options.push_back(opt);
+  }
+  options.push_back(positions[v1]);
+  options.push_back(positions[v2]);
+  options.push_back((positions[v1] + positions[v2]) / 2);
+
+  bool found = false;
+  for (typename std::vector<Vector3>::const_iterator it = options.begin();
+       it != options.end(); ++it)
+  {
+    if (!KeepsAABB(v1, v2, *it)) continue;
+    const double cost = q.Error(*it);
+    if (!found || (cost < c.cost))
+    {
+      c.cost = cost;
+      c.pos = *it;
+      found = true;
+    }
+  }
+  if (!found) return false;
+  c.v1 = v1;
+  c.v2 = v2;
+  c.stamp1 = stamps[v1];
+  c.stamp2 = stamps[v2];
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+bool MeshSimplifier<VP, I>::KeepsAABB(const std::size_t v1,
+                                      const std::size_t v2,
+                                      const Vector3 &pos) const
+{
+  const std::size_t verts[2] = { v1, v2 };
+  for (int i = 0; i < 2; ++i)
+  {
+    const Vector3 &p = positions[verts[i]];
+    for (int k = 0; k < 3; ++k)
+    {
+      if ((p[k] == aabbMin[k]) && (pos[k] != aabbMin[k])) return false;
+      if ((p[k] == aabbMax[k]) && (pos[k] != aabbMax[k])) return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+bool MeshSimplifier<VP, I>::SatisfiesLinkCondition(const std::size_t v1,
+                                                   const std::size_t v2) const
+{
+  typedef std::pair<std::size_t, std::size_t> Edge;
+  std::set<std::size_t> neighbours1, neighbours2, opposite;
+  // edges opposite to v1 in the faces of v1 which don't contain v2
+  std::set<Edge> edges1;
+
+  const std::size_t verts[2] = { v1, v2 };
+  for (int i = 0; i < 2; ++i)
+  {
+    const std::size_t v = verts[i];
+    const std::size_t other = verts[1 - i];
+    std::set<std::size_t> &neighbours = (i == 0) ? neighbours1 : neighbours2;
+    const std::vector<std::size_t> &vFaces = vertexFaces[v];
+    for (std::vector<std::size_t>::const_iterator it = vFaces.begin();
+         it != vFaces.end(); ++it)
+    {
+      if (removedFaces[*it]) continue;
+      const std::size_t *idx = &faces[3*(*it)];
+      std::size_t a = idx[0], b = idx[1];
+      if (idx[0] == v) a = idx[2];
+      else if (idx[1] == v) b = idx[2];
+      if (a == other || b == other)
+      {
+        // face of the edge, removed by the collapse
+        if (i == 0) opposite.insert(a == other ? b : a);
+        continue;
+      }
+      neighbours.insert(a);
+      neighbours.insert(b);
+      const Edge e(std::min(a, b), std::max(a, b));
+      if (i == 0) edges1.insert(e);
+      else if (edges1.count(e)) return false;
+    }
+  }
+
+  // (v1, v2) is not an edge any more
+  if (opposite.empty()) return false;
+
+  std::set<std::size_t> common;
+  std::set_intersection(neighbours1.begin(), neighbours1.end(),
+                        neighbours2.begin(), neighbours2.end(),
+                        std::inserter(common, common.begin()));
+  // the opposite vertices are neighbours of both, unless they are only
+  // connected to v1 and v2 by the faces of the edge itself
+  common.insert(opposite.begin(), opposite.end());
+  return common == opposite;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+bool MeshSimplifier<VP, I>::FlipsFaces(const std::size_t v,
+                                       const std::size_t other,
+                                       const Vector3 &pos) const
+{
+  const std::vector<std::size_t> &vFaces = vertexFaces[v];
+  for (std::vector<std::size_t>::const_iterator it = vFaces.begin();
+       it != vFaces.end(); ++it)
+  {
+    const std::size_t f = *it;
+    if (removedFaces[f]) continue;
+    const std::size_t *idx = &faces[3*f];
+    // faces with both vertices are removed by the collapse
+    if (idx[0] == other || idx[1] == other || idx[2] == other) continue;
+
+    Vector3 p[3], pNew[3];
+    for (int k = 0; k < 3; ++k)
+    {
+      p[k] = positions[idx[k]];
+      pNew[k] = (idx[k] == v) ? pos : p[k];
+    }
+    const Vector3 n = (p[1] - p[0]).Cross(p[2] - p[0]);
+    const Vector3 nNew = (pNew[1] - pNew[0]).Cross(pNew[2] - pNew[0]);
+    if (n.Dot(nNew) <= 0) return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+void MeshSimplifier<VP, I>::Collapse(const Candidate &c)
+{
+  const std::size_t v1 = c.v1;
+  const std::size_t v2 = c.v2;
+  positions[v1] = c.pos;
+  quadrics[v1] += quadrics[v2];
+  removedVertices[v2] = true;
+  ++stamps[v1];
+  ++stamps[v2];
+
+  // move the faces of v2 to v1 and remove the faces with both
+  const std::vector<std::size_t> &v2Faces = vertexFaces[v2];
+  for (std::vector<std::size_t>::const_iterator it = v2Faces.begin();
+       it != v2Faces.end(); ++it)
+  {
+    const std::size_t f = *it;
+    if (removedFaces[f]) continue;
+    std::size_t *idx = &faces[3*f];
+    if (idx[0] == v1 || idx[1] == v1 || idx[2] == v1)
+    {
+      removedFaces[f] = true;
+      --numFaces;
+      continue;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      if (idx[k] == v2) idx[k] = v1;
+    }
+    vertexFaces[v1].push_back(f);
+  }
+  vertexFaces[v2].clear();
+
+  // drop the removed faces from the faces of v1
+  std::vector<std::size_t> &v1Faces = vertexFaces[v1];
+  std::vector<std::size_t> keep;
+  keep.reserve(v1Faces.size());
+  for (std::vector<std::size_t>::const_iterator it = v1Faces.begin();
+       it != v1Faces.end(); ++it)
+  {
+    if (!removedFaces[*it]) keep.push_back(*it);
+  }
+  v1Faces.swap(keep);
+
+  AddCandidates(v1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template<typename VP, typename I>
+void MeshSimplifier<VP, I>::AddCandidates(const std::size_t v)
+{
+  std::set<std::size_t> neighbours;
+  const std::vector<std::size_t> &vFaces = vertexFaces[v];
+  for (std::vector<std::size_t>::const_iterator it = vFaces.begin();
+       it != vFaces.end(); ++it)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      const std::size_t n = faces[3*(*it) + k];
+      if (n != v) neighbours.insert(n);
+    }
+  }
+  for (std::set<std::size_t>::const_iterator it = neighbours.begin();
+       it != neighbours.end(); ++it)
+  {
+    Candidate c;
+    if (MakeCandidate(v, *it, c)) queue.push(c);
+  }
+}
+}  // namespace collision_benchmark
+#endif  // COLLISION_BENCHMARK_MESHSIMPLIFIER_INL_H
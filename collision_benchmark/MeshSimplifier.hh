@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_MESHSIMPLIFIER_H
+#define COLLISION_BENCHMARK_MESHSIMPLIFIER_H
+
+#include <collision_benchmark/MeshData.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <queue>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Creates decimated versions (levels of detail) of triangle meshes
+ * by quadric edge collapse.
+ *
+ * Edges are collapsed in order of the quadric error of the resulting vertex
+ * (Garland and Heckbert, "Surface Simplification Using Quadric Error
+ * Metrics", 1997), until the mesh has the requested number of faces or no
+ * more edges can be collapsed.
+ *
+ * The axis-aligned bounding box of the mesh is preserved exactly: new
+ * vertices are kept within the box, and vertices which lie on the box are
+ * only removed if the vertex replacing them lies on the same sides of the
+ * box. Collapses which would flip the orientation of a face are rejected,
+ * as well as collapses which don't satisfy the link condition (Dey et al.,
+ * "Topology Preserving Edge Contraction", 1999), so that a manifold mesh
+ * stays manifold and no duplicate faces are created.
+ *
+ * \param VertexPrecision_ precision of the vertices of the mesh
+ * \param Index_ index type of the mesh
+ */
+template<typename VertexPrecision_ = float, typename Index_ = uint32_t>
+class MeshSimplifier
+{
+  public: typedef VertexPrecision_ VertexPrecision;
+  public: typedef Index_ Index;
+  public: typedef MeshData<VertexPrecision, 3, Index> MeshDataT;
+  public: typedef typename MeshDataT::Ptr MeshDataPtr;
+
+  /// \brief Simplifies \e mesh.
+  /// \param[in] mesh the triangle mesh
+  /// \param[in] targetFaces the number of faces to reduce the mesh to.
+  ///   The result may have more faces if no more edges can be collapsed
+  ///   without changing the bounding box or flipping faces.
+  /// \return the simplified mesh, which only contains the vertices which
+  ///   are still used by faces.
+  public: static MeshDataPtr Simplify(const MeshDataT &mesh,
+                                      const std::size_t targetFaces);
+
+  /// \brief Makes levels of detail of \e mesh.
+  /// \param[in] mesh the triangle mesh
+  /// \param[in] ratios for each level, the fraction of faces of \e mesh
+  ///   to keep, in the range ]0..1]. Levels are computed from the previous
+  ///   level if the ratios are decreasing, so they should be given from
+  ///   high to low detail.
+  /// \return one mesh for each of \e ratios
+  public: static std::vector<MeshDataPtr>
+          MakeLODs(const MeshDataT &mesh, const std::vector<double> &ratios);
+
+  private: typedef ignition::math::Vector3<double> Vector3;
+
+  // \brief Symmetric 4x4 matrix of a quadric error metric, stored as the
+  // upper triangle: aa ab ac ad bb bc bd cc cd dd
+  private: struct Quadric
+  {
+    Quadric() { for (int i = 0; i < 10; ++i) q[i] = 0; }
+
+    // adds the squared distance to plane n * x + d = 0, weighted by w
+    void AddPlane(const Vector3 &n, const double d, const double w);
+
+    Quadric &operator+=(const Quadric &o)
+    {
+      for (int i = 0; i < 10; ++i) q[i] += o.q[i];
+      return *this;
+    }
+
+    // \return the error of position \e v
+    double Error(const Vector3 &v) const;
+
+    // \brief computes the position with minimal error
+    // \return false if the position is not well defined
+    bool Optimum(Vector3 &v) const;
+
+    double q[10];
+  };
+
+  // \brief Collapse of vertex \e v2 into \e v1, which is moved to \e pos
+  private: struct Candidate
+  {
+    double cost;
+    std::size_t v1, v2;
+    unsigned int stamp1, stamp2;
+    Vector3 pos;
+
+    // lowest cost first in the priority queue
+    bool operator<(const Candidate &o) const { return cost > o.cost; }
+  };
+
+  private: explicit MeshSimplifier(const MeshDataT &mesh);
+
+  // \brief collapses edges until there are \e targetFaces faces left
+  private: void Run(const std::size_t targetFaces);
+
+  // \return the mesh made of all faces which were not removed
+  private: MeshDataPtr GetResult() const;
+
+  // \brief Makes the cheapest valid collapse of edge (\e v1, \e v2).
+  // \return false if the edge can't be collapsed
+  private: bool MakeCandidate(const std::size_t v1, const std::size_t v2,
+                              Candidate &c) const;
+
+  // \return true if a vertex at \e pos replacing \e v1 and \e v2 keeps all
+  //   sides of the bounding box which \e v1 and \e v2 lie on.
+  private: bool KeepsAABB(const std::size_t v1, const std::size_t v2,
+                          const Vector3 &pos) const;
+
+  // \return true if the edge (\e v1, \e v2) satisfies the link condition:
+  //   the vertices adjacent to both \e v1 and \e v2 are exactly the
+  //   vertices opposite to the edge in its faces, and there are no two
+  //   faces (v1, a, b) and (v2, a, b), which would become duplicates.
+  private: bool SatisfiesLinkCondition(const std::size_t v1,
+                                       const std::size_t v2) const;
+
+  // \return true if moving \e v to \e pos flips any face of \e v which
+  //   does not contain \e other.
+  private: bool FlipsFaces(const std::size_t v, const std::size_t other,
+                           const Vector3 &pos) const;
+
+  // \brief Executes the collapse \e c
+  private: void Collapse(const Candidate &c);
+
+  // \brief Adds collapse candidates for all edges of vertex \e v
+  private: void AddCandidates(const std::size_t v);
+
+  // \brief position of each vertex
+  private: std::vector<Vector3> positions;
+
+  // \brief quadric of each vertex
+  private: std::vector<Quadric> quadrics;
+
+  // \brief whether each vertex was removed
+  private: std::vector<bool> removedVertices;
+
+  // \brief incremented each time a vertex changes, to detect outdated
+  //   candidates in the queue
+  private: std::vector<unsigned int> stamps;
+
+  // \brief indices of all faces, 3 per face
+  private: std::vector<std::size_t> faces;
+
+  // \brief whether each face was removed
+  private: std::vector<bool> removedFaces;
+
+  // \brief indices of the faces of each vertex
+  private: std::vector<std::vector<std::size_t> > vertexFaces;
+
+  // \brief number of faces which were not removed
+  private: std::size_t numFaces;
+
+  // \brief bounding box of the mesh
+  private: Vector3 aabbMin, aabbMax;
+
+  // \brief collapse candidates, cheapest first
+  private: std::priority_queue<Candidate> queue;
+};
+}  // namespace collision_benchmark
+
+#include <collision_benchmark/MeshSimplifier-inl.hh>
+
+#endif  // COLLISION_BENCHMARK_MESHSIMPLIFIER_H
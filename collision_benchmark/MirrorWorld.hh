@@ -56,7 +56,8 @@ class MirrorWorld
 
   public:  virtual ~MirrorWorld() {}
 
-  /// Sets the original world to be mirrored by this MirrorWorld
+  /// Sets the original world to be mirrored by this MirrorWorld.
+  /// If NULL, no world is mirrored until the next world is set.
   public:  void SetOriginalWorld(const OriginalWorldPtr &_originalWorld)
            {
              NotifyOriginalWorldChange(_originalWorld);
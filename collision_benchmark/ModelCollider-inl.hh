@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <collision_benchmark/ContactsClusterer.hh>
 #include <collision_benchmark/MathHelpers.hh>
 #include <gazebo/common/Timer.hh>
 #include "ModelCollider.hh"
@@ -91,10 +92,11 @@ bool ModelCollider<WM>::PlaceModels(const float modelsGap,
   modelState1.SetPosition(0, 0, 0);
   modelState1.SetRotation(0, 0, 0, 1);
   modelState2 = BasicState(modelState1);
-  if ((this->worldManager->SetBasicModelState(modelNames[0], modelState1)
-       != this->worldManager->GetNumWorlds()) ||
-      (this->worldManager->SetBasicModelState(modelNames[1], modelState2)
-       != this->worldManager->GetNumWorlds()))
+  std::vector<typename WorldManagerT::ModelStateEntry> states;
+  states.push_back(std::make_pair(modelNames[0], modelState1));
+  states.push_back(std::make_pair(modelNames[1], modelState2));
+  if (this->worldManager->SetBasicModelStates(states)
+      != this->worldManager->GetNumWorlds())
   {
     std::cerr << "Could not set all model poses to origin" << std::endl;
     return false;
@@ -251,13 +253,13 @@ bool ModelCollider<WM>::ModelsCollide(bool allWorlds) const
 
   typedef typename WorldManagerT::PhysicsWorldContactInterfacePtr
           PhysicsWorldContactInterfacePtr;
-  std::vector<PhysicsWorldContactInterfacePtr>
-    contactWorlds = this->worldManager->GetContactPhysicsWorlds();
-
-  assert(contactWorlds.size() == this->worldManager->GetNumWorlds());
+  typename WorldManagerT::WorldRegistryConstPtr
+    registry = this->worldManager->GetWorldRegistry();
+  const std::vector<PhysicsWorldContactInterfacePtr>
+    &contactWorlds = registry->contactWorlds;
 
   int modelsColliding = 0;
-  for (typename std::vector<PhysicsWorldContactInterfacePtr>::iterator
+  for (typename std::vector<PhysicsWorldContactInterfacePtr>::const_iterator
        it = contactWorlds.begin(); it != contactWorlds.end(); ++it)
   {
     PhysicsWorldContactInterfacePtr world = *it;
@@ -279,98 +281,51 @@ bool ModelCollider<WM>::ModelsCollide(bool allWorlds) const
   return modelsColliding > 0;
 }
 
-
-namespace collision_benchmark
-{
-/**
- * Simple implementation of a contacts cluster based on the average
- * vector of all the contacts.
- */
-template<class Contact>
-class ContactsCluster
+//////////////////////////////////////////////////////////////////////////////
+template<class WM>
+void ModelCollider<WM>::ModelsCollidePerWorld(std::vector<bool> &colliding)
+  const
 {
-  typedef typename Contact::Vector3 ContVec3;
-  typedef ignition::math::Vector3d IgnVec;
-  typedef std::pair<Contact, IgnVec> Pair;
-  // constructs a cluster with only one point
-  public: ContactsCluster(const Contact& c)
-          {
-            add(c);
-          }
-  public: ContactsCluster(const ContactsCluster& o):
-          contacts(o.contacts),
-          avg(o.avg) {}
-
-  // cluster size (radius of the cluster)
-  public: static double ToleranceRadius;
-
-  // checks whether the contact is less than the cluster radius
-  // tolerance away from the current center point. If the cluster is empty,
-  // this always returns true.
-  public: bool inside(const Contact& c) const
-  {
-    if (contacts.empty()) return true;
-    IgnVec v = collision_benchmark::ConvIgn<double>(c.position);
-    return inside(v);
-  }
-  // Helper, checks whether \e v is less than ToleranceRadius from avg
-  private: bool inside(const IgnVec& v) const
-  {
-    if (contacts.empty()) return true;
-    IgnVec diff = avg - v;
-    // std::cout << "Dist: " << diff.Length() << std::endl;
-    return diff.Length() <= ToleranceRadius;
-  }
-
-  public: void add(const Contact& c)
-  {
-    IgnVec v = collision_benchmark::ConvIgn<double>(c.position);
-    // add point and recompute average
-    contacts.push_back(std::make_pair(c, v));
-    IgnVec accum(0,0,0);
-    for (typename std::vector<Pair>::const_iterator it = contacts.begin();
-         it != contacts.end(); ++it)
-    {
-      const Pair cPair = *it;
-      accum += cPair.second;
-    }
-    avg = accum / contacts.size();
-  }
-/*  public: void merge(const ContactsCluster& c)
-  {
-    for (typename std::vector<Pair>::const_iterator it = c.contacts.begin();
-         it != c.contacts.end(); ++it)
-    {
-      const Pair cPair = *it;
-      // not the most efficient because the average is being re-computed
-      // all the time, but for now we don't emphasise efficiency
-      add(cPair->first);
-    }
-  }
-  // operator returns < if \e c may be merged with this cluster
-  // without exceeding ToleranceRadius. The center point may change however.
-  public: bool operator<(const ContactsCluster& c) const
-  {
-    std::cout << "YEEEAH" << std::endl;
-    for (typename std::vector<Pair>::const_iterator it = c.contacts.begin();
-         it != c.contacts.end(); ++it)
-    {
-      const Pair cPair = *it;
-      if (!inside(cPair.second)) return false;
-    }
-    std::cout << "Can merge clusters!!" << std::endl;
-    return true;
-  }*/
-  private: std::vector<Pair> contacts;
-  public: IgnVec avg;
+  assert(this->worldManager);
 
-}; // end class ContactCluster
+  typedef typename WorldManagerT::PhysicsWorldContactInterfacePtr
+          PhysicsWorldContactInterfacePtr;
+  typename WorldManagerT::WorldRegistryConstPtr
+    registry = this->worldManager->GetWorldRegistry();
+  const std::vector<PhysicsWorldContactInterfacePtr>
+    &contactWorlds = registry->contactWorlds;
 
+  colliding.resize(contactWorlds.size());
+  for (unsigned int i = 0; i < contactWorlds.size(); ++i)
+  {
+    // worlds without contact interface never report a collision
+    colliding[i] = contactWorlds[i] &&
+                   !contactWorlds[i]->GetContactInfo().empty();
+  }
+}
 
-template<class Contact>
-double ContactsCluster<Contact>::ToleranceRadius = 0.0;
+//////////////////////////////////////////////////////////////////////////////
+template<class WM>
+bool ModelCollider<WM>::GetAABBOnAxis(const std::string &modelName,
+                                      double &min, double &max) const
+{
+  Vector3 aabbMin, aabbMax;
+  bool local;
+  if ((GetAABB(modelName, this->worldManager, aabbMin, aabbMax, local) != 0) ||
+      !GetAABBInFrame(ignition::math::Quaterniond::Identity, modelName,
+                      aabbMin, aabbMax, local, aabbMin, aabbMax))
+  {
+    return false;
+  }
+  const ignition::math::Vector3d
+    ignMin(collision_benchmark::ConvIgn<double>(aabbMin));
+  const ignition::math::Vector3d
+    ignMax(collision_benchmark::ConvIgn<double>(aabbMax));
+  collision_benchmark::ProjectAABBOnAxis(ignMin, ignMax, this->collisionAxis,
+                                         min, max);
+  return true;
+}
 
-} // end namespace
 
 //////////////////////////////////////////////////////////////////////////////
 template<class WM>
@@ -379,7 +334,9 @@ ModelCollider<WM>::GetClusteredContacts(const size_t worldIdx,
                                         double clusterSize) const
 {
   assert(this->worldManager);
-  if (worldIdx >= this->worldManager->GetNumWorlds())
+  typename WorldManagerT::WorldRegistryConstPtr
+    registry = this->worldManager->GetWorldRegistry();
+  if (worldIdx >= registry->contactWorlds.size())
     throw new std::runtime_error("World index out of bounds");
 
   typedef typename WorldManagerT::PhysicsWorldContactInterfacePtr
@@ -390,12 +347,7 @@ ModelCollider<WM>::GetClusteredContacts(const size_t worldIdx,
           Contact;
   typedef typename Contact::Ptr ContactPtr;
 
-  std::vector<PhysicsWorldContactInterfacePtr>
-    contactWorlds = this->worldManager->GetContactPhysicsWorlds();
-
-  assert(contactWorlds.size() == this->worldManager->GetNumWorlds());
-
-  PhysicsWorldContactInterfacePtr world = contactWorlds[worldIdx];
+  PhysicsWorldContactInterfacePtr world = registry->contactWorlds[worldIdx];
   std::vector<ContactInfoPtr> contactInfo = world->GetContactInfo();
   if (contactInfo.empty())
   {
@@ -407,48 +359,18 @@ ModelCollider<WM>::GetClusteredContacts(const size_t worldIdx,
   if (contactInfo.size() != 1)
     throw std::runtime_error("Consistency: All contacts between models should be in one ContactInfo");
 
-  std::vector<Contact> contacts = contactInfo.front()->contacts;
+  const std::vector<Contact> &contacts = contactInfo.front()->contacts;
 
   // std::cout << "Number of contacts: " << contacts.size() << std::endl;
 
-  typedef ContactsCluster<Contact> ContactsClusterT;
-  ContactsClusterT::ToleranceRadius = clusterSize;
-  std::vector<ContactsClusterT> clusteredContacts;
+  collision_benchmark::ContactsClusterer<ignition::math::Vector3d>
+    clusterer(clusterSize);
   for (typename std::vector<Contact>::const_iterator it = contacts.begin();
        it != contacts.end(); ++it)
   {
-    // add contact to the first cluster in which it fits (this can be
-    // optimized later!). Create a new cluster if it doesn't fit in any.
-    const Contact &contact = *it;
-    bool added = false;
-    for (typename std::vector<ContactsClusterT>::iterator
-         cit = clusteredContacts.begin(); cit != clusteredContacts.end(); ++cit)
-    {
-      ContactsClusterT& cluster = *cit;
-      if (cluster.inside(contact))
-      {
-        // std::cout << "Adding contact " << contact << " to cluster" << std::endl;
-        cluster.add(contact);
-        added = true;
-        break;
-      }
-    }
-    if (!added)
-    {
-      // std::cout << "Making new cluster with " << contact << "." << std::endl;
-      ContactsClusterT single(contact);
-      clusteredContacts.push_back(single);
-    }
-  }
-  std::vector<ignition::math::Vector3d> ret;
-  for (typename std::vector<ContactsClusterT>::iterator
-       cit = clusteredContacts.begin(); cit != clusteredContacts.end(); ++cit)
-  {
-    ContactsClusterT& cluster = *cit;
-    ret.push_back(cluster.avg);
+    clusterer.Add(collision_benchmark::ConvIgn<double>(it->position));
   }
-//  std::cout << "Number of clusters: " << clusteredContacts.size() << std::endl;
-  return ret;
+  return clusterer.GetCenters();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -497,6 +419,206 @@ double ModelCollider<WM>::AutoCollide(const bool allWorlds,
   return moved;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+template<class WM>
+double ModelCollider<WM>::AutoCollideBisect(const bool allWorlds,
+                                            const bool moveBoth,
+                                            const double tolerance,
+                                            const double maxStepSize,
+                                            const bool stopWhenPassed,
+                                            BasicState *ms1,
+                                            BasicState *ms2,
+                                            std::vector<double> *worldDists)
+{
+  assert(this->worldManager);
+  if (worldDists) worldDists->clear();
+  if (tolerance <= 0)
+  {
+    std::cerr << "Tolerance for auto-collide has to be positive" << std::endl;
+    return -1;
+  }
+
+  BasicState startState1, startState2;
+  if ((GetBasicModelState(modelNames[0], this->worldManager, startState1) != 0)
+      || (GetBasicModelState(modelNames[1], this->worldManager, startState2)
+          != 0))
+  {
+    std::cerr << "Could not get BasicModelState." << std::endl;
+    return -1;
+  }
+
+  double min1, max1, min2, max2;
+  if (!GetAABBOnAxis(modelNames[0], min1, max1) ||
+      !GetAABBOnAxis(modelNames[1], min2, max2))
+  {
+    std::cerr << "Could not get AABBs of models" << std::endl;
+    return -1;
+  }
+
+  // distance the models get closer to each other per moved distance
+  const double relMove = moveBoth ? 2 : 1;
+
+  // Once the AABB of model 2 has passed the AABB of model 1, the models
+  // can't collide any more, so there is no need to search further.
+  double maxDist = (max2 - min1) / relMove;
+  if (stopWhenPassed)
+  {
+    ignition::math::Vector3d
+      pos1(collision_benchmark::ConvIgn<double>(startState1.position));
+    ignition::math::Vector3d
+      pos2(collision_benchmark::ConvIgn<double>(startState2.position));
+    const double centersDist = pos2.Dot(this->collisionAxis) -
+                               pos1.Dot(this->collisionAxis);
+    maxDist = std::min(maxDist, centersDist / relMove);
+  }
+
+  double maxStride = maxStepSize;
+  if (maxStride <= 0)
+    maxStride = std::min(max1 - min1, max2 - min2) / relMove;
+  maxStride = std::max(maxStride, tolerance);
+
+  // the interval in which the first contact lies, for each world. The
+  // intervals and the collision status are both indexed like the contact
+  // worlds of the registry, which is the index of the world.
+  const double noContact = std::numeric_limits<double>::max();
+  const unsigned int numWorlds =
+    this->worldManager->GetWorldRegistry()->contactWorlds.size();
+  std::vector<double> worldsLo(numWorlds, 0);
+  std::vector<double> worldsHi(numWorlds, noContact);
+  std::vector<bool> colliding;
+
+  // updates the intervals of the worlds with the collision status
+  // of the models at distance \e dist
+  std::function<void(double)> updateIntervals = [&](const double dist)
+  {
+    ModelsCollidePerWorld(colliding);
+    // worlds added while searching are not considered
+    colliding.resize(numWorlds, false);
+    for (unsigned int i = 0; i < colliding.size(); ++i)
+    {
+      if (colliding[i]) worldsHi[i] = std::min(worldsHi[i], dist);
+      else if (dist < worldsHi[i]) worldsLo[i] = std::max(worldsLo[i], dist);
+    }
+  };
+
+  // moves the models to distance \e dist and updates the worlds
+  std::function<bool(double)> probe = [&](const double dist)
+  {
+    if (!PlaceModelsAlongAxis(startState1, startState2, dist, moveBoth))
+    {
+      std::cerr << "Could not set all model poses" << std::endl;
+      return false;
+    }
+    this->worldManager->Update(1);
+    updateIntervals(dist);
+    return true;
+  };
+
+  // Brackets and bisects the first contact interval [lo, hi] for the
+  // collision criteria \e isColliding.
+  // Returns 0 if contact was found, 1 if not, and -1 on error.
+  std::function<int(const std::function<bool()>&, double&, double&)> search =
+    [&](const std::function<bool()> &isColliding, double &lo, double &hi)
+  {
+    double stride = tolerance;
+    while (hi == noContact)
+    {
+      if (lo >= maxDist) return 1;
+      const double dist = std::min(lo + stride, maxDist);
+      if (!probe(dist)) return -1;
+      if (isColliding()) hi = dist;
+      else lo = dist;
+      stride = std::min(stride * 2, maxStride);
+    }
+    while (hi - lo > tolerance)
+    {
+      const double dist = (lo + hi) / 2;
+      if (!probe(dist)) return -1;
+      if (isColliding()) hi = dist;
+      else lo = dist;
+    }
+    return 0;
+  };
+
+  std::function<bool()> criteriaMet = [&]()
+  {
+    int numColliding = 0;
+    for (unsigned int i = 0; i < colliding.size(); ++i)
+      if (colliding[i]) ++numColliding;
+    if (allWorlds) return numColliding == static_cast<int>(colliding.size());
+    return numColliding > 0;
+  };
+
+  // collision status at the start states, the worlds have been updated
+  // already after the models were put there.
+  updateIntervals(0);
+  double lo = 0;
+  double hi = criteriaMet() ? 0 : noContact;
+  int ret = search(criteriaMet, lo, hi);
+  if (ret < 0) return -1;
+  const double moved = (ret == 0) ? hi : lo;
+
+  if (worldDists)
+  {
+    worldDists->assign(numWorlds, -1);
+    for (unsigned int w = 0; w < numWorlds; ++w)
+    {
+      std::function<bool()> worldColliding = [&colliding, w]()
+      {
+        return static_cast<bool>(colliding[w]);
+      };
+      ret = search(worldColliding, worldsLo[w], worldsHi[w]);
+      if (ret < 0) return -1;
+      if (ret == 0) (*worldDists)[w] = worldsHi[w];
+    }
+  }
+
+  // leave the models at the first contact found, or at the farthest
+  // distance searched if there was none.
+  if (!PlaceModelsAlongAxis(startState1, startState2, moved, moveBoth,
+                            ms1, ms2))
+  {
+    std::cerr << "Could not set all model poses" << std::endl;
+    return -1;
+  }
+  this->worldManager->Update(1);
+  return moved;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+template<class WM>
+bool ModelCollider<WM>::PlaceModelsAlongAxis(const BasicState &fromState1,
+                                             const BasicState &fromState2,
+                                             const double moveDist,
+                                             const bool moveBoth,
+                                             BasicState *ms1,
+                                             BasicState *ms2)
+{
+  assert(this->worldManager);
+  const ignition::math::Vector3d mv = this->collisionAxis * moveDist;
+
+  BasicState modelState1(fromState1);
+  BasicState modelState2(fromState2);
+  if (moveBoth)
+  {
+    modelState1.SetPosition(modelState1.position.x + mv.X(),
+                            modelState1.position.y + mv.Y(),
+                            modelState1.position.z + mv.Z());
+    if (ms1) *ms1 = modelState1;
+  }
+
+  modelState2.SetPosition(modelState2.position.x - mv.X(),
+                          modelState2.position.y - mv.Y(),
+                          modelState2.position.z - mv.Z());
+  if (ms2) *ms2 = modelState2;
+
+  std::vector<typename WorldManagerT::ModelStateEntry> states;
+  if (moveBoth) states.push_back(std::make_pair(modelNames[0], modelState1));
+  states.push_back(std::make_pair(modelNames[1], modelState2));
+  return this->worldManager->SetBasicModelStates(states)
+         == this->worldManager->GetNumWorlds();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 template<class WM>
 int ModelCollider<WM>::MoveModelsAlongAxis(const double moveDist,
@@ -543,26 +665,8 @@ int ModelCollider<WM>::MoveModelsAlongAxis(const double moveDist,
     }
   }
 
-  const ignition::math::Vector3d mv = this->collisionAxis * moveDist;
-
-  if (moveBoth)
-  {
-    modelState1.SetPosition(modelState1.position.x + mv.X(),
-                            modelState1.position.y + mv.Y(),
-                            modelState1.position.z + mv.Z());
-    if (ms1) *ms1 = modelState1;
-  }
-
-  modelState2.SetPosition(modelState2.position.x - mv.X(),
-                          modelState2.position.y - mv.Y(),
-                          modelState2.position.z - mv.Z());
-  if (ms2) *ms2 = modelState2;
-
-  if ((moveBoth &&
-       (this->worldManager->SetBasicModelState(modelNames[0], modelState1)
-        != this->worldManager->GetNumWorlds())) ||
-      (this->worldManager->SetBasicModelState(modelNames[1], modelState2)
-       != this->worldManager->GetNumWorlds()))
+  if (!PlaceModelsAlongAxis(modelState1, modelState2, moveDist, moveBoth,
+                            ms1, ms2))
   {
     std::cerr << "Could not set all model poses" << std::endl;
     return -1;
@@ -742,8 +846,10 @@ int ModelCollider<WM>::GetAABB(const std::string &modelName,
             const typename WM::Ptr &worldManager,
             Vector3 &min, Vector3 &max, bool &inLocalFrame)
 {
-  std::vector<typename WM::PhysicsWorldModelInterfacePtr >
-    worlds = worldManager->GetModelPhysicsWorlds();
+  typename WM::WorldRegistryConstPtr
+    registry = worldManager->GetWorldRegistry();
+  const std::vector<typename WM::PhysicsWorldModelInterfacePtr >
+    &worlds = registry->modelWorlds;
 
   if (worlds.empty() || (worlds.size() <= idxWorld)) return -1;
 
@@ -818,8 +924,10 @@ int ModelCollider<WM>::GetBasicModelState
      const typename WM::Ptr &worldManager,
      BasicState &state)
 {
-  std::vector<typename WM::PhysicsWorldModelInterfacePtr >
-    worlds = worldManager->GetModelPhysicsWorlds();
+  typename WM::WorldRegistryConstPtr
+    registry = worldManager->GetWorldRegistry();
+  const std::vector<typename WM::PhysicsWorldModelInterfacePtr >
+    &worlds = registry->modelWorlds;
 
   if (worlds.empty() || (worlds.size() <= idxWorld)) return -2;
 
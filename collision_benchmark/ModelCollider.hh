@@ -23,6 +23,8 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <functional>
+#include <limits>
 #include <string>
 #include <vector>
 #include <unistd.h>
@@ -163,6 +165,51 @@ class ModelCollider
                              BasicState *ms1 = NULL,
                              BasicState *ms2 = NULL);
 
+  // \brief Moves models along collision axis until they collide, like
+  // AutoCollide(), but searches for the first contact instead of moving
+  // the models at a fixed step size.
+  // The contact interval is first bracketed by moving the models at a
+  // stride which is doubled after every step that did not lead to a
+  // collision, and then bisected until its length is below \e tolerance.
+  // This needs only O(log(distance/tolerance)) world updates instead of
+  // the distance/stepSize updates of AutoCollide(). The models end up
+  // at the first colliding distance found, as with AutoCollide().
+  // The search assumes that once the models collide, they keep colliding
+  // when moved further within the search range, which is the case for
+  // convex shapes. Contacts with thin features which are shorter than the
+  // stride along the axis may be skipped.
+  // \param[in] allWorlds collision criteria is only met if all physics
+  //    engines report collision between the objects
+  // \param[in] moveBoth if true, both models are moved towards each other.
+  //    If false, only model 2 is moved towards model 1.
+  // \param[in] tolerance the maximum distance between the returned
+  //    distance and the actual first contact distance.
+  // \param[in] maxStepSize the maximum stride used to bracket the contact.
+  //    If negative, the smaller extent of the models AABBs along the
+  //    collision axis is used so that the models cannot be moved through
+  //    each other in one stride.
+  // \param[in] stopWhenPassed see ModeModelsAlongAxis parameter stopWhenPassed
+  // \param[out] ms1 if set to not NULL, this is going to be the state
+  //    of model1 after the move, or left unchanged if \e moveBoth is false.
+  // \param[out] ms2 if set to not NULL, this is going to be the state
+  //    of model2 after the move
+  // \param[out] worldDists if not NULL, the first contact distance is
+  //    also searched for each world separately. The vector is resized to
+  //    the number of worlds and the distance of each world is written at
+  //    the index of the world in the world manager. It is -1 for worlds in
+  //    which no contact was found within the searched distance, including
+  //    worlds which don't support contacts.
+  // \return the distance the shape(s) have moved along the axis, see
+  //  return value of AutoCollide(), or a negative value on error.
+  public: double AutoCollideBisect(const bool allWorlds = false,
+                                   const bool moveBoth = false,
+                                   const double tolerance = 1e-03,
+                                   const double maxStepSize = -1,
+                                   const bool stopWhenPassed = false,
+                                   BasicState *ms1 = NULL,
+                                   BasicState *ms2 = NULL,
+                                   std::vector<double> *worldDists = NULL);
+
   // \brief Helper fuction which returns the AABB of the model from the first
   // world in \e worldManager.
   // Presumes that the model exists in all worlds and the AABB would be
@@ -266,6 +313,37 @@ class ModelCollider
   //    engines report collision between the objects
   public: bool ModelsCollide(bool allWorlds) const;
 
+  // \brief Checks for each world whether the models collide in it
+  // \param[out] colliding collision status of the models, at the index
+  //    of the world. False for worlds which don't support contacts.
+  private: void ModelsCollidePerWorld(std::vector<bool> &colliding) const;
+
+  // \brief Helper which places the models at distance \e moveDist along
+  // the collision axis from the given start states, as described for
+  // MoveModelsAlongAxis(). Does not update the worlds.
+  // \param[in] fromState1 start state of model 1
+  // \param[in] fromState2 start state of model 2
+  // \param[in] moveDist distance to move each model along axis
+  // \param[in] moveBoth if true, model 1 is moved as well.
+  // \param[out] ms1 if set to not NULL, the new state of model1.
+  // \param[out] ms2 if set to not NULL, the new state of model2.
+  // \return false if the model states could not be set
+  private: bool PlaceModelsAlongAxis(const BasicState &fromState1,
+                                     const BasicState &fromState2,
+                                     const double moveDist,
+                                     const bool moveBoth,
+                                     BasicState *ms1 = NULL,
+                                     BasicState *ms2 = NULL);
+
+  // \brief Helper which gets the AABB of the model in global frame,
+  // projected onto the collision axis.
+  // \param[in] modelName name of the model
+  // \param[out] min minimum of the AABB on the axis
+  // \param[out] max maximum of the AABB on the axis
+  // \return false if the AABB could not be retrieved
+  private: bool GetAABBOnAxis(const std::string &modelName,
+                              double &min, double &max) const;
+
   // \brief Checks if collision of models along the collision axis is excluded.
   // This is only an approximate test because the AABBs of the models are
   // used to check for impossible collision. So even if this function returns
@@ -334,7 +412,7 @@ class ModelCollider
 
   // \brief Clusters all the contacts currently happening between the models
   // into clusters of max size \e clusterSize. This is only done for the
-  // world at index \e worldIdx.
+  // world at index \e worldIdx. See also ContactsClusterer.
   // \return the center points of all contact clusters
   public: std::vector<ignition::math::Vector3d>
           GetClusteredContacts(const size_t worldIdx,
@@ -27,6 +27,7 @@
 #include <collision_benchmark/WorldLoader.hh>
 #include <collision_benchmark/ControlServer.hh>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -107,6 +108,13 @@ class MultipleWorldsServer
     worldManager.reset();
   }
 
+  // \return the time taken to load each of the worlds which were
+  //    successfully loaded so far, in the order they were loaded.
+  public: const std::vector<WorldLoadTiming> &GetLoadTimings() const
+  {
+    return loadTimings;
+  }
+
   // \brief Loads the world file with the different engines.
   // Generates a world name based on the prefix \e namePrefix.
   // This will create several worlds (one for each engine) which are
@@ -124,20 +132,49 @@ class MultipleWorldsServer
     assert(worldManager);
     assert(!namePrefix.empty());
 
+    std::vector<std::string> worldnames;
+    std::vector<WorldLoader::ConstPtr> loaders;
     int i = 1;
     for (std::vector<std::string>::const_iterator
          it = engines.begin(); it != engines.end(); ++it, ++i)
     {
       std::string engine = *it;
+      WorldLoader_M::iterator wlIt = worldLoaders.find(engine);
+      if (wlIt == worldLoaders.end())
+      {
+        std::cerr << "Could not load world " << worldfile << " with engine "
+                  << engine << ", skipping it." << std::endl;
+        continue;
+      }
       std::stringstream _worldname;
       _worldname << namePrefix << "_engine_" << i << "_" << engine;
-      std::string worldname = _worldname.str();
-      if (Load(worldfile, engine, worldname) < 0)
+      worldnames.push_back(_worldname.str());
+      loaders.push_back(wlIt->second);
+    }
+
+    // The world file is read separately from creating the world, so that
+    // the time of both is reported. The worlds of loaders which don't
+    // support ReadFile() are loaded with LoadFromFile().
+    for (size_t k = 0; k < loaders.size(); ++k)
+    {
+      std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+      sdf::ElementPtr worldSDF =
+        loaders[k]->ReadFile(worldfile, worldnames[k]);
+      const double readTime = SecondsSince(start);
+      start = std::chrono::steady_clock::now();
+      PhysicsWorldBaseInterface::Ptr world = worldSDF ?
+        loaders[k]->LoadFromSDF(worldSDF, worldnames[k]) :
+        loaders[k]->LoadFromFile(worldfile, worldnames[k]);
+      const double createTime = SecondsSince(start);
+      if (!world || (worldManager->AddPhysicsWorld(world) < 0))
       {
         std::cerr << "Could not load world " << worldfile << " with engine "
-                  << engine << ", skipping it." << std::endl;
+                  << loaders[k]->EngineName() << ", skipping it."
+                  << std::endl;
         continue;
       }
+      AddLoadTiming(world, readTime, createTime);
     }
     return worldManager->GetNumWorlds();
   }
@@ -170,6 +207,8 @@ class MultipleWorldsServer
     // std::cout << "Loading with physics engine " << engine
     //          << " (named as '" << worldname << "')" << std::endl;
 
+    std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
     PhysicsWorldBaseInterface::Ptr world =
       loader->LoadFromFile(worldfile, worldname);
 
@@ -177,6 +216,7 @@ class MultipleWorldsServer
 
     int ret = worldManager->AddPhysicsWorld(world);
     if (ret < 0) return -3;
+    AddLoadTiming(world, 0, SecondsSince(start));
     return ret;
   }
 
@@ -200,6 +240,8 @@ class MultipleWorldsServer
     std::cout << "Auto-loading world (named as '"
               << worldname << "')" << std::endl;
 
+    std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
     PhysicsWorldBaseInterface::Ptr world =
       universalLoader->LoadFromFile(worldfile, worldname);
 
@@ -207,6 +249,7 @@ class MultipleWorldsServer
 
     int ret = worldManager->AddPhysicsWorld(world);
     if (ret < 0) return -3;
+    AddLoadTiming(world, 0, SecondsSince(start));
     return ret;
   }
 
@@ -222,6 +265,27 @@ class MultipleWorldsServer
              createWorldManager(const std::string &mirror_name = "",
                                 const bool allowMirrorControl = false) = 0;
 
+  // \return the seconds passed since \e start
+  private: static double SecondsSince
+                (const std::chrono::steady_clock::time_point &start)
+  {
+    return std::chrono::duration<double>
+      (std::chrono::steady_clock::now() - start).count();
+  }
+
+  // \brief Adds the timing of a loaded world to \e loadTimings and
+  // prints it.
+  private: void AddLoadTiming(const PhysicsWorldBaseInterface::Ptr &world,
+                              const double readTime, const double createTime)
+  {
+    WorldLoadTiming timing;
+    timing.worldname = world->GetName();
+    timing.readTime = readTime;
+    timing.createTime = createTime;
+    loadTimings.push_back(timing);
+    std::cout << "Loaded world " << timing << std::endl;
+  }
+
   // world loaders for all the physics engines.
   protected: WorldLoader_M worldLoaders;
 
@@ -230,6 +294,9 @@ class MultipleWorldsServer
   protected: WorldLoader::ConstPtr universalLoader;
 
   protected: WorldManagerPtr worldManager;
+
+  // the time taken to load each world
+  private: std::vector<WorldLoadTiming> loadTimings;
 };  // class MultipleWorldsServer
 }  // namespace
 #endif  // COLLISION_BENCHMARK_MULTIPLEWORLDSSERVER_H
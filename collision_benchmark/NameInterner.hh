@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_NAMEINTERNER_H
+#define COLLISION_BENCHMARK_NAMEINTERNER_H
+
+#include <collision_benchmark/Exception.hh>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Table which maps names to dense integer IDs.
+ *
+ * Each distinct name gets the next free ID, starting at 0, the first time
+ * it is interned. IDs are never re-used, so two names are equal if and only
+ * if their IDs are equal, which allows to replace string comparisons with
+ * integer comparisons.
+ *
+ * This class is not thread safe.
+ */
+class NameInterner
+{
+  public: typedef int ID;
+
+  /// ID returned for names which have not been interned
+  public: static constexpr ID InvalidID = -1;
+
+  /// \return the ID of \e name, adding it to the table if it was not
+  ///   interned yet.
+  public: ID Intern(const std::string &name)
+  {
+    std::unordered_map<std::string, ID>::const_iterator it =
+      this->ids.find(name);
+    if (it != this->ids.end()) return it->second;
+    ID id = this->names.size();
+    this->ids[name] = id;
+    this->names.push_back(name);
+    return id;
+  }
+
+  /// \return the ID of \e name or InvalidID if it was not interned yet
+  public: ID GetID(const std::string &name) const
+  {
+    std::unordered_map<std::string, ID>::const_iterator it =
+      this->ids.find(name);
+    if (it == this->ids.end()) return InvalidID;
+    return it->second;
+  }
+
+  /// \return the name with this \e id. Throws an exception if there is
+  ///   no name with this ID.
+  public: const std::string &GetName(const ID id) const
+  {
+    if (id < 0 || id >= static_cast<ID>(this->names.size()))
+    {
+      THROW_EXCEPTION("No name with ID " << id << " was interned");
+    }
+    return this->names[id];
+  }
+
+  /// \return number of interned names
+  public: std::size_t Size() const
+  {
+    return this->names.size();
+  }
+
+  // map of name to its ID
+  private: std::unordered_map<std::string, ID> ids;
+  // all names, at the index of their ID
+  private: std::vector<std::string> names;
+};
+}  // namespace collision_benchmark
+
+#endif  // COLLISION_BENCHMARK_NAMEINTERNER_H
@@ -384,6 +384,9 @@ class PhysicsWorldContactInterface
                                                    ModelPartID> ContactInfo;
   public: typedef typename ContactInfo::Ptr ContactInfoPtr;
 
+  public: typedef collision_benchmark::ContactBuffer<Vector3, Wrench, ModelID,
+                                                     ModelPartID> ContactBuffer;
+
   public: PhysicsWorldContactInterface() {}
   public: virtual ~PhysicsWorldContactInterface() {}
 
@@ -403,6 +406,30 @@ class PhysicsWorldContactInterface
   public: virtual std::vector<ContactInfoPtr>
                   GetContactInfo(const ModelID &m1,
                                  const ModelID &m2) const = 0;
+
+  /// Works as GetContactInfo() but fills the caller-owned \e buffer instead
+  /// of returning newly allocated ContactInfo objects. The buffer is cleared
+  /// first. When the same buffer is re-used for subsequent queries,
+  /// implementations should not need any heap allocations once the buffer
+  /// has grown large enough.
+  ///
+  /// The default implementation adapts GetContactInfo() and therefore does
+  /// not have this advantage. It should be overridden by implementations.
+  public: virtual void GetContactInfo(ContactBuffer &buffer) const
+  {
+    buffer.Clear();
+    buffer.Append(GetContactInfo());
+  }
+
+  /// Works as GetContactInfo(ContactBuffer&) but only gets the contact points
+  /// between models \e m1 and \e m2.
+  public: virtual void GetContactInfo(const ModelID &m1,
+                                      const ModelID &m2,
+                                      ContactBuffer &buffer) const
+  {
+    buffer.Clear();
+    buffer.Append(GetContactInfo(m1, m2));
+  }
 };
 
 /**
@@ -557,6 +584,9 @@ class PhysicsWorld
 
   public: typedef typename PhysicsWorldContactParent::ContactInfo ContactInfo;
   public: typedef typename ContactInfo::Ptr ContactInfoPtr;
+
+  public: typedef typename PhysicsWorldContactParent::ContactBuffer
+                  ContactBuffer;
 };
 
 
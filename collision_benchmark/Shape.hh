@@ -94,6 +94,16 @@ class Shape
                               const std::string &resourceSubDir = "",
                               const bool useFullPath = false) const = 0;
 
+  /// Like GetShapeSDF(), but data which GetShapeSDF() would write to file
+  /// is kept in memory instead, if the implementation supports this. Such
+  /// data is referenced with URIs which are only valid within this process
+  /// (see GazeboMeshRegistry), so the SDF can't be used in other processes
+  /// like gzclient. The default implementation returns GetShapeSDF().
+  /// \param detailed see GetShapeSDF()
+  public: virtual sdf::ElementPtr
+                  GetShapeSDFInMemory(bool detailed = true) const
+          { return GetShapeSDF(detailed); }
+
   /// returns true if GetShapeSDF() returns a different mesh with parameter
   /// \e detailed set to false, in which case there is a low-res representation
   /// of the shape. If this returns false, there is only one (the detailed)
@@ -20,10 +20,17 @@
  */
 
 #include <collision_benchmark/SimpleTriMeshShape.hh>
+#include <collision_benchmark/GazeboMeshRegistry.hh>
+#include <collision_benchmark/MeshCache.hh>
 #include <collision_benchmark/MeshHelper.hh>
+#include <collision_benchmark/MeshSimplifier.hh>
 #include <collision_benchmark/Helpers.hh>
 
+#include <cmath>
+
 using collision_benchmark::SimpleTriMeshShape;
+using collision_benchmark::MeshCache;
+using collision_benchmark::MeshSimplifier;
 
 const std::string SimpleTriMeshShape::MESH_EXT="stl";
 
@@ -63,6 +70,9 @@ SimpleTriMeshShape::GetShapeSDF(bool detailed,
     return sdf::ElementPtr();
   }
 
+  // the mesh to write
+  MeshDataPtr meshData = (!detailed && lowResData) ? lowResData : data;
+
   std::string useURI;
 
   if (useFullPath)
@@ -74,12 +84,64 @@ SimpleTriMeshShape::GetShapeSDF(bool detailed,
     useURI="file://"+subname;
   }
 
-  if (!collision_benchmark::WriteTrimesh(fullname, MESH_EXT, data))
+  // exporting is expensive, so re-use the file exported for the same
+  // mesh data before, if there is one in the cache.
+  MeshCache::Ptr cache = exportCache;
+  std::string key;
+  if (cache) key = MeshCache::MakeKey(*meshData);
+  if (!cache || !cache->GetFile(key, MESH_EXT, fullname))
+  {
+    if (!collision_benchmark::WriteTrimesh(fullname, MESH_EXT, meshData))
+    {
+      std::cerr << "Could not write mesh data!" << std::endl;
+      return sdf::ElementPtr();
+    }
+    if (cache) cache->StoreFile(key, MESH_EXT, fullname, name);
+  }
+
+  return GetMeshGeometrySDF(useURI);
+}
+
+sdf::ElementPtr
+SimpleTriMeshShape::GetShapeSDFInMemory(bool detailed) const
+{
+  MeshDataPtr meshData = (!detailed && lowResData) ? lowResData : data;
+  std::string uri = GazeboMeshRegistry::Instance().Register
+                        (name + (detailed ? "" : "_lowres"), meshData,
+                         MESH_EXT);
+  if (uri.empty())
   {
-    std::cerr << "Could not write mesh data!" << std::endl;
+    std::cerr << "Could not register mesh data!" << std::endl;
     return sdf::ElementPtr();
   }
+  return GetMeshGeometrySDF(uri);
+}
 
+bool SimpleTriMeshShape::MakeLowResMesh(const double ratio)
+{
+  if (!data || (ratio <= 0) || (ratio > 1))
+  {
+    std::cerr << "Cannot make low resolution mesh with ratio "
+              << ratio << std::endl;
+    return false;
+  }
+  const std::size_t targetFaces =
+    static_cast<std::size_t>(std::ceil(ratio * data->GetNumFaces()));
+  MeshDataPtr lowRes =
+    MeshSimplifier<MeshDataT::VertexPrecision, MeshDataT::Index>::Simplify
+      (*data, targetFaces);
+  if (!lowRes || (lowRes->GetNumFaces() == 0))
+  {
+    std::cerr << "Could not simplify mesh " << name << std::endl;
+    return false;
+  }
+  lowResData = lowRes;
+  return true;
+}
+
+sdf::ElementPtr
+SimpleTriMeshShape::GetMeshGeometrySDF(const std::string &uri)
+{
   sdf::ElementPtr geometry(new sdf::Element());
   geometry->SetName("geometry");
   sdf::ElementPtr meshElem(new sdf::Element());
@@ -89,7 +151,7 @@ SimpleTriMeshShape::GetShapeSDF(bool detailed,
   sdf::ElementPtr uriElem(new sdf::Element());
   meshElem->InsertElement(uriElem);
   uriElem->SetName("uri");
-  uriElem->AddValue("string", useURI, true, "URI to mesh file");
+  uriElem->AddValue("string", uri, true, "URI to mesh file");
 
   sdf::ElementPtr scaleElem(new sdf::Element());
   meshElem->InsertElement(scaleElem);
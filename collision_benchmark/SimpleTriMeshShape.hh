@@ -23,6 +23,7 @@
 
 #include <collision_benchmark/Shape.hh>
 #include <collision_benchmark/MeshData.hh>
+#include <collision_benchmark/MeshCache.hh>
 
 #include <memory>
 #include <string>
@@ -70,21 +71,66 @@ class SimpleTriMeshShape: public Shape
 
   public: SimpleTriMeshShape(const SimpleTriMeshShape &o):
             Shape(o),
-            data(o.data) {}
+            data(o.data),
+            lowResData(o.lowResData),
+            name(o.name),
+            exportCache(o.exportCache) {}
 
   public: virtual ~SimpleTriMeshShape() {}
 
-  // Documentation inherited from parent class
+  // Documentation inherited from parent class.
+  // If a cache was set with SetExportCache(), the exported mesh file is
+  // kept in it, so the same mesh data is exported only once.
   public: virtual sdf::ElementPtr
                   GetShapeSDF(bool detailed = true,
                               const std::string &resourceDir = "/tmp/",
                               const std::string &resourceSubDir = "",
                               const bool useFullPath = false) const;
 
+  // Documentation inherited from parent class.
+  // The mesh data is registered in the GazeboMeshRegistry.
+  public: virtual sdf::ElementPtr
+                  GetShapeSDFInMemory(bool detailed = true) const;
+
+  // Documentation inherited from parent class.
+  // Returns true if a low resolution mesh was set with SetLowResMesh()
+  // or MakeLowResMesh().
+  public: virtual bool SupportLowRes() const { return lowResData != nullptr; }
+
+  // Sets the mesh which GetShapeSDF() returns with \e detailed = false.
+  // Set to NULL to use the detailed mesh for both.
+  public: void SetLowResMesh(const MeshDataPtr &lowRes) { lowResData = lowRes; }
+
+  // Makes the low resolution mesh by simplifying the mesh data with
+  // MeshSimplifier, which keeps the bounding box of the mesh.
+  // \param ratio fraction of the faces to keep, in the range ]0..1]
+  // \return false if the mesh can't be simplified
+  public: bool MakeLowResMesh(const double ratio);
+
+  // Returns the low resolution mesh, or NULL if there is none
+  public: MeshDataPtr GetLowResMesh() const { return lowResData; }
+
+  // Sets the cache for the mesh files exported in GetShapeSDF().
+  // Set to NULL (the default) to always export the mesh data.
+  public: void SetExportCache(const MeshCache::Ptr &cache)
+          { exportCache = cache; }
+
+  // Returns the cache for exported mesh files, or NULL if there is none
+  public: MeshCache::Ptr GetExportCache() const { return exportCache; }
+
+  // Returns the ``<geometry>`` element for a mesh with \e uri
+  private: static sdf::ElementPtr GetMeshGeometrySDF(const std::string &uri);
+
   private: MeshDataT::Ptr data;
 
+  // low resolution version of \e data, may be NULL
+  private: MeshDataT::Ptr lowResData;
+
   // unique name for this mesh data. Important for calls of GetShapeSDF().
   private: std::string name;
+
+  // cache for exported mesh files, may be NULL
+  private: MeshCache::Ptr exportCache;
 };
 
 }  // namespace
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/ThreadPool.hh>
+
+#include <algorithm>
+#include <iostream>
+
+using collision_benchmark::ThreadPool;
+
+// the pool the current thread is a worker of, NULL if it isn't a worker.
+static thread_local const ThreadPool *t_workerOf = nullptr;
+
+/////////////////////////////////////////////////
+struct ThreadPool::Batch
+{
+  Batch(): remaining(0) {}
+
+  // number of jobs of this batch which have not finished yet
+  std::size_t remaining;
+  // first exception thrown by a job of this batch
+  std::exception_ptr error;
+  // protects \e remaining and \e error
+  std::mutex mutex;
+  // notified when \e remaining reaches 0
+  std::condition_variable done;
+};
+
+/////////////////////////////////////////////////
+struct ThreadPool::Queue
+{
+  Queue(): stop(false) {}
+
+  // jobs waiting to be picked up
+  std::deque<QueuedJob> jobs;
+  // protects \e jobs and \e stop
+  std::mutex mutex;
+  // signals the workers that there are new jobs or that they have to stop
+  std::condition_variable condition;
+  // set to true in the destructor to terminate the workers
+  bool stop;
+};
+
+/////////////////////////////////////////////////
+ThreadPool::ThreadPool(const unsigned int _numThreads)
+  : queue(new Queue())
+{
+  unsigned int numThreads = _numThreads;
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  this->workers.reserve(numThreads);
+  for (unsigned int i = 0; i < numThreads; ++i)
+  {
+    this->workers.push_back(std::thread(&ThreadPool::WorkerLoop,
+                                        this, this->queue));
+  }
+}
+
+/////////////////////////////////////////////////
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->queue->mutex);
+    this->queue->stop = true;
+  }
+  this->queue->condition.notify_all();
+
+  const bool fromWorker = IsWorkerThread();
+  if (fromWorker)
+  {
+    std::cerr << "ThreadPool destroyed from one of its own worker threads. "
+              << "This thread is detached instead of joined." << std::endl;
+    // this thread is not a worker of any pool any more
+    t_workerOf = nullptr;
+  }
+
+  const std::thread::id self = std::this_thread::get_id();
+  for (std::vector<std::thread>::iterator it = this->workers.begin();
+       it != this->workers.end(); ++it)
+  {
+    if (!it->joinable()) continue;
+    if (fromWorker && (it->get_id() == self))
+      it->detach();
+    else
+      it->join();
+  }
+}
+
+/////////////////////////////////////////////////
+unsigned int ThreadPool::GetNumThreads() const
+{
+  return this->workers.size();
+}
+
+/////////////////////////////////////////////////
+bool ThreadPool::IsWorkerThread() const
+{
+  return t_workerOf == this;
+}
+
+/////////////////////////////////////////////////
+void ThreadPool::RunAndWait(const std::vector<Job> &jobs)
+{
+  if (jobs.empty()) return;
+
+  std::shared_ptr<Batch> batch(new Batch());
+  batch->remaining = jobs.size();
+  {
+    std::lock_guard<std::mutex> lock(this->queue->mutex);
+    for (std::vector<Job>::const_iterator it = jobs.begin();
+         it != jobs.end(); ++it)
+    {
+      this->queue->jobs.push_back(QueuedJob(*it, batch));
+    }
+  }
+  this->queue->condition.notify_all();
+
+  // help with our own batch while the workers are busy
+  QueuedJob job;
+  while (PopJob(job, batch))
+  {
+    Execute(job);
+  }
+
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->done.wait(lock, [batch]{ return batch->remaining == 0; });
+  if (batch->error)
+    std::rethrow_exception(batch->error);
+}
+
+/////////////////////////////////////////////////
+bool ThreadPool::PopJob(QueuedJob &job, const std::shared_ptr<Batch> &batch)
+{
+  std::lock_guard<std::mutex> lock(this->queue->mutex);
+  std::deque<QueuedJob> &jobs = this->queue->jobs;
+  std::deque<QueuedJob>::iterator it = jobs.begin();
+  if (batch)
+  {
+    while (it != jobs.end() && it->second != batch) ++it;
+  }
+  if (it == jobs.end()) return false;
+  job = *it;
+  jobs.erase(it);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void ThreadPool::Execute(const QueuedJob &job)
+{
+  std::exception_ptr error;
+  try
+  {
+    job.first();
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+
+  const std::shared_ptr<Batch> &batch = job.second;
+  std::lock_guard<std::mutex> lock(batch->mutex);
+  if (error && !batch->error) batch->error = error;
+  if (--batch->remaining == 0) batch->done.notify_all();
+}
+
+/////////////////////////////////////////////////
+void ThreadPool::WorkerLoop(const ThreadPool *pool,
+                            const std::shared_ptr<Queue> queue)
+{
+  t_workerOf = pool;
+  while (true)
+  {
+    QueuedJob job;
+    {
+      std::unique_lock<std::mutex> lock(queue->mutex);
+      queue->condition.wait(lock, [&queue]
+                            { return queue->stop || !queue->jobs.empty(); });
+      if (queue->jobs.empty())
+      {
+        // stop was requested and there is nothing left to do
+        return;
+      }
+      job = queue->jobs.front();
+      queue->jobs.pop_front();
+    }
+    Execute(job);
+  }
+}
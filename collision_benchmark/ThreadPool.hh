@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_THREADPOOL_H
+#define COLLISION_BENCHMARK_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Persistent pool of worker threads which runs batches of jobs.
+ *
+ * The threads are created once in the constructor and kept alive until
+ * the pool is destroyed, so that running a batch of jobs does not incur
+ * the cost of creating and joining threads.
+ *
+ * Several threads may call RunAndWait() at the same time, each call waits
+ * only for its own jobs. The calling thread takes part in executing its
+ * own batch, so a batch will always make progress even if all workers
+ * are busy with other batches.
+ */
+class ThreadPool
+{
+  public: typedef std::shared_ptr<ThreadPool> Ptr;
+  public: typedef std::shared_ptr<const ThreadPool> ConstPtr;
+
+  public: typedef std::function<void(void)> Job;
+
+  /// Constructor.
+  /// \param[in] numThreads number of worker threads. If 0, the number of
+  ///   hardware threads is used.
+  public: explicit ThreadPool(const unsigned int numThreads = 0);
+
+  /// Destructor. Waits for all queued jobs to finish and joins the workers.
+  /// If the pool is destroyed from within one of its own jobs, the worker
+  /// thread running this job cannot be joined without deadlocking. In this
+  /// case, an error is printed and this thread is detached instead. It
+  /// terminates after the job has returned.
+  public: ~ThreadPool();
+
+  /// \return number of worker threads in the pool
+  public: unsigned int GetNumThreads() const;
+
+  /// Runs all \e jobs and blocks until all of them have finished.
+  /// If any of the jobs throws an exception, the remaining jobs of this
+  /// batch are still executed, and the first exception caught is re-thrown
+  /// in the calling thread once the batch has finished.
+  public: void RunAndWait(const std::vector<Job> &jobs);
+
+  /// \return true if the calling thread is one of the worker threads of
+  ///   this pool. Can be used to detect re-entrant calls from within a job,
+  ///   which should then run their work directly instead of queueing it.
+  public: bool IsWorkerThread() const;
+
+  // the state of one call to RunAndWait()
+  private: struct Batch;
+
+  // the queue shared between the pool and its workers. Kept in a shared
+  // pointer so that a detached worker can still access it after the pool
+  // has been destroyed (see ~ThreadPool()).
+  private: struct Queue;
+
+  // a job queued for execution along with the batch it belongs to
+  private: typedef std::pair<Job, std::shared_ptr<Batch>> QueuedJob;
+
+  // main loop of each worker thread
+  // \param[in] pool the pool the worker belongs to. Only used to identify
+  //    the worker threads in IsWorkerThread(), never dereferenced.
+  // \param[in] queue the queue of the pool
+  private: static void WorkerLoop(const ThreadPool *pool,
+                                  const std::shared_ptr<Queue> queue);
+
+  // pops the next job from the queue. If \e batch is not NULL, only
+  // jobs belonging to this batch are considered.
+  // \return false if there was no job to pop
+  private: bool PopJob(QueuedJob &job,
+                       const std::shared_ptr<Batch> &batch = nullptr);
+
+  // executes the job and notifies its batch
+  private: static void Execute(const QueuedJob &job);
+
+  // all worker threads
+  private: std::vector<std::thread> workers;
+
+  // jobs waiting to be picked up
+  private: std::shared_ptr<Queue> queue;
+};
+}  // namespace collision_benchmark
+
+#endif  // COLLISION_BENCHMARK_THREADPOOL_H
@@ -21,6 +21,7 @@
 #define COLLISION_BENCHMARK_GAZEBOWORLDLOADER_H
 
 #include <collision_benchmark/PhysicsWorld.hh>
+#include <ostream>
 #include <string>
 
 namespace collision_benchmark
@@ -59,10 +60,54 @@ class WorldLoader
           LoadFromString(const std::string &str,
                          const std::string &worldname="") const = 0;
 
+  // \brief Reads the world in \e filename without creating it. This is the
+  // first part of LoadFromFile(), so that the time taken to read and to
+  // create a world can be measured separately (see WorldLoadTiming).
+  // The world is then created by passing the result to LoadFromSDF().
+  // \return the world SDF, or NULL if the file could not be read or this
+  //    loader can only load worlds with LoadFromFile().
+  public: virtual sdf::ElementPtr
+          ReadFile(const std::string &/*filename*/,
+                   const std::string &/*worldname*/="") const
+          { return sdf::ElementPtr(); }
+
   public: std::string EngineName() const { return engine; }
   private: std::string engine;
 };
 
+/**
+ * \brief Time taken to load one world, in seconds.
+ */
+class WorldLoadTiming
+{
+  public: WorldLoadTiming():
+            readTime(0),
+            createTime(0),
+            waitTime(0) {}
+
+  // \return the total time taken to load the world
+  public: double Total() const { return readTime + createTime + waitTime; }
+
+  public: friend std::ostream &operator<<(std::ostream &o,
+                                          const WorldLoadTiming &t)
+          {
+            o << "'" << t.worldname << "': " << t.Total() << "s (read "
+              << t.readTime << "s, create " << t.createTime << "s, wait "
+              << t.waitTime << "s)";
+            return o;
+          }
+
+  // name of the world
+  public: std::string worldname;
+  // time to read and parse the world file
+  public: double readTime;
+  // time to create the world in the physics engine
+  public: double createTime;
+  // time spent waiting for the world to be announced to the transport
+  // system, or 0 if there was no need to wait.
+  public: double waitTime;
+};
+
 }  // namespace
 
 #endif  // COLLISION_BENCHMARK_GAZEBOWORLDLOADER_H
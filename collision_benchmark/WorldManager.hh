@@ -26,6 +26,7 @@
 #include <collision_benchmark/ControlServer.hh>
 #include <collision_benchmark/BasicTypes.hh>
 #include <collision_benchmark/TypeHelper.hh>
+#include <collision_benchmark/ThreadPool.hh>
 
 #include <gazebo/gazebo.hh>
 #include <gazebo/transport/transport.hh>
@@ -34,8 +35,11 @@
 #include <boost/filesystem.hpp>
 
 #include <string>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 namespace collision_benchmark
@@ -56,6 +60,11 @@ namespace collision_benchmark
  * Each time a message is received, the current world name is sent back in
  * a gazebo::Any message with type STRING.
  *
+ * The worlds are kept in an immutable WorldRegistry which is replaced
+ * as a whole (copy-on-write) when a world is added. Readers obtain the
+ * current registry with GetWorldRegistry() without locking, and the
+ * worlds in it are already cast to all supported interfaces.
+ *
  * \param _WorldState describes the state of a world.
  * \param _ModelID the identifier for a specific model
  * \param _ModelPartID the identifier for a part of a model
@@ -105,6 +114,26 @@ class WorldManager
             PhysicsWorldPtr;
 
 
+  /// \brief Immutable snapshot of all worlds in the WorldManager.
+  /// All vectors have the same size and contain the same worlds in the
+  /// same order, cast to the respective interface. An entry of a typed
+  /// view is NULL if the world does not support this interface.
+  public: struct WorldRegistry
+  {
+    // all the worlds
+    std::vector<PhysicsWorldBaseInterface::Ptr> worlds;
+    // the worlds cast to PhysicsWorldModelInterfaceT
+    std::vector<PhysicsWorldModelInterfacePtr> modelWorlds;
+    // the worlds cast to PhysicsWorldContactInterfaceT
+    std::vector<PhysicsWorldContactInterfacePtr> contactWorlds;
+    // the worlds cast to PhysicsWorldT
+    std::vector<PhysicsWorldPtr> physicsWorlds;
+  };
+  public: typedef std::shared_ptr<const WorldRegistry> WorldRegistryConstPtr;
+
+  /// A model and the state to set it to, see SetBasicModelStates()
+  public: typedef std::pair<ModelID, BasicState> ModelStateEntry;
+
   public: typedef typename MirrorWorld::Ptr MirrorWorldPtr;
   public: typedef typename MirrorWorld::ConstPtr MirrorWorldConstPtr;
   public: typedef typename ControlServer<ModelID>::Ptr ControlServerPtr;
@@ -125,6 +154,7 @@ class WorldManager
                        const ControlServerPtr &_controlServer
                            = ControlServerPtr(),
                        const bool _activeControl = true):
+            registry(std::make_shared<const WorldRegistry>()),
             mirroredWorldIdx(-1),
             controlServer(_controlServer)
   {
@@ -173,9 +203,58 @@ class WorldManager
 
   public: void Fini()
   {
-    worlds.clear();
+    {
+      std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
+      std::atomic_store(&this->registry,
+                        std::make_shared<const WorldRegistry>());
+    }
     this->mirrorWorld.reset();
     this->controlServer.reset();
+    this->SetParallelUpdate(false);
+  }
+
+  /// Enables or disables the parallel update mode. In parallel mode,
+  /// Update() steps all worlds concurrently on a persistent pool of worker
+  /// threads, and waits for all of them to finish before the mirror world
+  /// is synchronized. The parallel mode is disabled by default and has to
+  /// be enabled explicitly with this function, otherwise the worlds are
+  /// updated one after another in the calling thread.
+  ///
+  /// \warning EXPERIMENTAL, NOT SAFE FOR GAZEBO WORLDS. The worlds must be
+  /// completely independent of each other, including all global state
+  /// which is accessed while they are updated. This is not the case for
+  /// Gazebo worlds in one process: gazebo::event signals and physics
+  /// singletons are shared and not thread-safe, and ODE requires
+  /// dAllocateODEDataForThread() in every thread which steps a world,
+  /// which the worker threads don't call. Use separate processes to update
+  /// Gazebo worlds in parallel. This mode is only meant for
+  /// PhysicsWorld implementations which are known to be thread-safe.
+  /// \param[in] enable true to enable parallel updates, false to go back
+  ///   to updating the worlds one after another.
+  /// \param[in] numThreads number of worker threads. If 0, the number of
+  ///   hardware threads is used.
+  public: void SetParallelUpdate(const bool enable,
+                                 const unsigned int numThreads = 0)
+  {
+    ThreadPool::Ptr oldPool;
+    {
+      std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
+      oldPool = this->updatePool;
+      if (enable)
+        this->updatePool.reset(new ThreadPool(numThreads));
+      else
+        this->updatePool.reset();
+    }
+    // oldPool is destroyed here (if no Update() still uses it), which joins
+    // its threads. This must not happen while the worldsMutex is locked.
+  }
+
+  /// \return true if the parallel update mode is enabled
+  ///   (see SetParallelUpdate())
+  public: bool IsParallelUpdate() const
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
+    return this->updatePool != nullptr;
   }
 
   /// Sets the mirror world. This world can be set to mirror any of the worlds,
@@ -199,9 +278,10 @@ class WorldManager
     this->mirrorWorld = _mirrorWorld;
     {
       std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-      if (!this->worlds.empty())
+      WorldRegistryConstPtr reg = GetWorldRegistry();
+      if (!reg->worlds.empty())
       {
-        this->mirrorWorld->SetOriginalWorld(worlds.front());
+        this->mirrorWorld->SetOriginalWorld(reg->worlds.front());
         this->mirroredWorldIdx = 0;
       }
     }
@@ -217,30 +297,69 @@ class WorldManager
     return this->mirrorWorld->GetOriginalWorld();
   }
 
-  /// Adds this world and returns the index this world can be accessed at
+  /// Adds this world and returns the index this world can be accessed at.
+  /// The world is cast to all interfaces supported by the WorldManager
+  /// once here, and a new WorldRegistry including the world is published.
+  /// Registries obtained with GetWorldRegistry() earlier are not changed.
   /// \return positive int or zero on success (index this world
   ///         can be accessed at). Negative if a world with this name
   ///         already exists.
   public: int AddPhysicsWorld(const PhysicsWorldBaseInterface::Ptr &_world)
   {
+    // writers are serialized by the mutex, readers don't need it
     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
     if (GetWorld(_world->GetName()))
     {
       std::cerr << "World with this name already exists! " << std::endl;
       return -1;
     }
-    if (this->worlds.empty() && this->mirrorWorld)
+    WorldRegistryConstPtr oldReg = GetWorldRegistry();
+    std::shared_ptr<WorldRegistry> newReg(new WorldRegistry(*oldReg));
+    newReg->worlds.push_back(_world);
+    newReg->modelWorlds.push_back(ToWorldWithModel(_world));
+    newReg->contactWorlds.push_back(ToWorldWithContact(_world));
+    newReg->physicsWorlds.push_back(ToPhysicsWorld(_world));
+    if (oldReg->worlds.empty() && this->mirrorWorld)
     {
       this->mirrorWorld->SetOriginalWorld(_world);
       this->mirroredWorldIdx = 0;
     }
-    this->worlds.push_back(_world);
-    return this->worlds.size()-1;
+    std::atomic_store(&this->registry, WorldRegistryConstPtr(newReg));
+    return newReg->worlds.size()-1;
+  }
+
+  /// Removes all worlds, so that the manager can be re-used with
+  /// other worlds. The worlds themselves are not changed.
+  /// The mirror world doesn't mirror any world until the next world is
+  /// added with AddPhysicsWorld().
+  /// Registries obtained with GetWorldRegistry() earlier are not changed.
+  public: void RemoveAllWorlds()
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
+    std::atomic_store(&this->registry,
+                      std::make_shared<const WorldRegistry>());
+    if (this->mirrorWorld && this->mirrorWorld->GetOriginalWorld())
+    {
+      this->mirrorWorld->SetOriginalWorld(PhysicsWorldBaseInterface::Ptr());
+    }
+    this->mirroredWorldIdx = -1;
+  }
+
+  /// Returns the current registry of all worlds. This does not lock
+  /// any mutex and does not copy or cast any worlds, so it is suitable
+  /// for frequent calls. The returned registry is never modified: worlds
+  /// added later are only contained in registries returned by later calls.
+  /// Note that accessing the worlds asynchronously may lead to
+  /// thread safety issues. It is recommended to access the
+  /// worlds only in-between calls of Update().
+  public: WorldRegistryConstPtr GetWorldRegistry() const
+  {
+    return std::atomic_load(&this->registry);
   }
 
   public: bool SetMirroredWorld(const int _index)
   {
-    if (_index < 0 ||  _index >= this->worlds.size())
+    if (_index < 0 ||  _index >= GetNumWorlds())
       return false;
 
     // std::cout << "Getting world at idx " << _index << std::endl;
@@ -258,30 +377,29 @@ class WorldManager
   /// Returns the original world which is mirrored by this class
   public: size_t GetNumWorlds() const
   {
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    return this->worlds.size();
+    return GetWorldRegistry()->worlds.size();
   }
 
 
   /// Returns the original world which is mirrored by this class
   public: PhysicsWorldBaseInterface::Ptr GetWorld(unsigned int _index) const
   {
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    GZ_ASSERT(_index >=0 && _index < this->worlds.size(),
+    WorldRegistryConstPtr reg = GetWorldRegistry();
+    GZ_ASSERT(_index >=0 && _index < reg->worlds.size(),
               "Index out of range");
-    if (_index >= this->worlds.size())
+    if (_index >= reg->worlds.size())
     {
       return PhysicsWorldBaseInterface::Ptr();
     }
-    return this->worlds.at(_index);
+    return reg->worlds.at(_index);
   }
 
   public: PhysicsWorldBaseInterface::Ptr GetWorld(const std::string &name) const
   {
-     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
+     WorldRegistryConstPtr reg = GetWorldRegistry();
      for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
-          it = this->worlds.begin();
-          it != this->worlds.end(); ++it)
+          it = reg->worlds.begin();
+          it != reg->worlds.end(); ++it)
      {
        PhysicsWorldBaseInterface::Ptr w = *it;
        assert(w);
@@ -290,34 +408,29 @@ class WorldManager
      return PhysicsWorldBaseInterface::Ptr();
   }
 
-  /// Returns all worlds.
+  /// Returns all worlds. Use GetWorldRegistry() instead to avoid
+  /// copying the vector.
   /// Note that accessing the returned worlds asynchronously may lead to
   /// thread safety issues. It is recommended to access the returned
   /// worlds only in-between calls of Update().
   public: std::vector<PhysicsWorldBaseInterface::Ptr> GetWorlds() const
   {
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    std::vector<PhysicsWorldBaseInterface::Ptr> ret(this->worlds.begin(),
-                                                    this->worlds.end());
-    return ret;
+    return GetWorldRegistry()->worlds;
   }
 
   /// Returns all worlds which could be casted to PhysicsWorldModelInterfaceT.
+  /// Use GetWorldRegistry() instead to avoid copying the vector.
   /// Note that accessing the returned worlds asynchronously may lead to
   /// thread safety issues. It is recommended to access the returned
   /// worlds only in-between calls of Update().
   public: std::vector<PhysicsWorldModelInterfacePtr>
           GetModelPhysicsWorlds() const
   {
-     std::vector<PhysicsWorldModelInterfacePtr> ret;
-     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-     int i = 0;
-     for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
-          it = this->worlds.begin();
-          it != this->worlds.end(); ++it, ++i)
+     const std::vector<PhysicsWorldModelInterfacePtr> &ret =
+       GetWorldRegistry()->modelWorlds;
+     for (size_t i = 0; i < ret.size(); ++i)
      {
-       PhysicsWorldModelInterfacePtr w = ToWorldWithModel(*it);
-       if (!w)
+       if (!ret[i])
        {
          std::cerr << "Cannot cast world " << i << " to "
                   << "interface PhysicsWorldModelInterface<"
@@ -325,28 +438,23 @@ class WorldManager
                   << ", " << GetTypeName<ModelPartID>()
                   << ", " << GetTypeName<Vector3>() << ">" << std::endl;
        }
-       ret.push_back(w);
      }
      return ret;
   }
 
   /// Returns all worlds which could be casted to PhysicsWorldContactInterfaceT.
+  /// Use GetWorldRegistry() instead to avoid copying the vector.
   /// Note that accessing the returned worlds asynchronously may lead to
   /// thread safety issues. It is recommended to access the returned
   /// worlds only in-between calls of Update().
   public: std::vector<PhysicsWorldContactInterfacePtr>
           GetContactPhysicsWorlds() const
   {
-     std::vector<PhysicsWorldContactInterfacePtr> ret;
-     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-     int i = 0;
-     for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
-          it = this->worlds.begin();
-          it != this->worlds.end(); ++it, ++i)
+     const std::vector<PhysicsWorldContactInterfacePtr> &ret =
+       GetWorldRegistry()->contactWorlds;
+     for (size_t i = 0; i < ret.size(); ++i)
      {
-       PhysicsWorldContactInterfacePtr
-         w = ToWorldWithContact(*it);
-       if (!w)
+       if (!ret[i])
        {
          std::cerr << "Cannot cast world " << i << " to "
                   << "interface PhysicsWorldContactInterface<"
@@ -355,26 +463,22 @@ class WorldManager
                   << ", " << GetTypeName<Vector3>()
                   << ", " << GetTypeName<Wrench>() << ">" << std::endl;
        }
-       ret.push_back(w);
      }
      return ret;
   }
 
   /// Returns all worlds which could be casted to PhysicsWorldT.
+  /// Use GetWorldRegistry() instead to avoid copying the vector.
   /// Note that accessing the returned worlds asynchronously may lead to
   /// thread safety issues. It is recommended to access the returned
   /// worlds only in-between calls of Update().
   public: std::vector<PhysicsWorldPtr> GetPhysicsWorlds() const
   {
-     std::vector<PhysicsWorldPtr> ret;
-     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-     int i = 0;
-     for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
-          it = this->worlds.begin();
-          it != this->worlds.end(); ++it, ++i)
+     const std::vector<PhysicsWorldPtr> &ret =
+       GetWorldRegistry()->physicsWorlds;
+     for (size_t i = 0; i < ret.size(); ++i)
      {
-       PhysicsWorldPtr w = ToPhysicsWorld(*it);
-       if (!w)
+       if (!ret[i])
        {
          std::cerr << "Cannot cast world " << i << " to "
                   << "interface PhysicsWorld<"
@@ -384,7 +488,6 @@ class WorldManager
                   << ", " << GetTypeName<Vector3>()
                   << ", " << GetTypeName<Wrench>() << ">" << std::endl;
        }
-       ret.push_back(w);
      }
      return ret;
   }
@@ -467,6 +570,90 @@ class WorldManager
     return cnt;
   }
 
+  /// Calls PhysicsWorldModelInterface::SetBasicModelState for all models
+  /// in \e states on all worlds, handling one world after the other in a
+  /// single pass. Assumes that all worlds use the same model names.
+  /// If \e update is true, each world is updated by one iteration right
+  /// after its states were set, and MirrorWorld::Sync() is called at the
+  /// end, so the call is equivalent to setting all states and calling
+  /// Update(1). In the experimental parallel update mode (see
+  /// SetParallelUpdate()), setting the states and updating is then done
+  /// concurrently for all worlds.
+  /// \param[in] states the models and the states to set them to
+  /// \param[out] numSetPerWorld if not NULL, this is set to the number of
+  ///   states which were successfully set in each world. The vector is
+  ///   only re-allocated if its capacity is smaller than the number of
+  ///   worlds, so re-using it for subsequent calls avoids allocations.
+  /// \param[in] update whether to update all worlds by one iteration
+  /// \return number of worlds in which all states were successfully set.
+  public: int SetBasicModelStates(const std::vector<ModelStateEntry> &states,
+                                  std::vector<int> *numSetPerWorld = NULL,
+                                  const bool update = false)
+  {
+    WorldRegistryConstPtr reg = GetWorldRegistry();
+    const std::vector<PhysicsWorldModelInterfacePtr>
+      &modelWorlds = reg->modelWorlds;
+    for (typename std::vector<PhysicsWorldModelInterfacePtr>::const_iterator
+         it = modelWorlds.begin(); it != modelWorlds.end(); ++it)
+    {
+      if (!*it)
+      {
+        THROW_EXCEPTION("Only support worlds which have the "
+                        << "interface PhysicsWorldModelInterface<"
+                        << GetTypeName<ModelID>()
+                        << ", " << GetTypeName<ModelPartID>() << ">");
+      }
+    }
+
+    std::vector<int> localNumSet;
+    std::vector<int> &numSet = numSetPerWorld ? *numSetPerWorld : localNumSet;
+    numSet.assign(modelWorlds.size(), 0);
+
+    ThreadPool::Ptr pool;
+    if (update)
+    {
+      std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
+      pool = this->updatePool;
+    }
+
+    // see Update() for why the parallel mode is not used from worker threads
+    if (pool && (modelWorlds.size() > 1) && !pool->IsWorkerThread())
+    {
+      std::vector<ThreadPool::Job> jobs;
+      jobs.reserve(modelWorlds.size());
+      for (size_t i = 0; i < modelWorlds.size(); ++i)
+      {
+        jobs.push_back([&reg, &states, &numSet, i]()
+        {
+          numSet[i] = SetBasicModelStatesInWorld(*reg->modelWorlds[i], states);
+          reg->worlds[i]->Update(1, false);
+        });
+      }
+      pool->RunAndWait(jobs);
+    }
+    else
+    {
+      for (size_t i = 0; i < modelWorlds.size(); ++i)
+      {
+        numSet[i] = SetBasicModelStatesInWorld(*modelWorlds[i], states);
+        if (update) reg->worlds[i]->Update(1, false);
+      }
+    }
+
+    if (update && this->mirrorWorld)
+    {
+      this->mirrorWorld->Sync();
+    }
+
+    int cnt = 0;
+    for (std::vector<int>::const_iterator it = numSet.begin();
+         it != numSet.end(); ++it)
+    {
+      if (*it == static_cast<int>(states.size())) ++cnt;
+    }
+    return cnt;
+  }
+
   /// Calls PhysicsWorldModelInterface::HasModel on
   /// all worlds. Assumes that all worlds use the same model name.
   public: bool ModelInAllWorlds(const ModelID &id)
@@ -478,8 +665,7 @@ class WorldManager
     {
       if (*it) ++cnt;
     }
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    return cnt == this->worlds.size();
+    return cnt == ret.size();
   }
 
   // Convenience method which casts the world \e w to a
@@ -515,10 +701,10 @@ class WorldManager
 
   public: void SetPaused(bool flag)
   {
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    for (std::vector<PhysicsWorldBaseInterface::Ptr>::iterator
-         it = this->worlds.begin();
-         it != this->worlds.end(); ++it)
+    WorldRegistryConstPtr reg = GetWorldRegistry();
+    for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
+         it = reg->worlds.begin();
+         it != reg->worlds.end(); ++it)
     {
       PhysicsWorldBaseInterface::Ptr w=*it;
       w->SetPaused(flag);
@@ -533,10 +719,10 @@ class WorldManager
   {
     // std::cout << "WorldManager received request to set dynamics "
     //          << "enable to " << flag << std::endl;
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    for (std::vector<PhysicsWorldBaseInterface::Ptr>::iterator
-         it = this->worlds.begin();
-         it != this->worlds.end(); ++it)
+    WorldRegistryConstPtr reg = GetWorldRegistry();
+    for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
+         it = reg->worlds.begin();
+         it != reg->worlds.end(); ++it)
     {
       PhysicsWorldBaseInterface::Ptr w=*it;
       w->SetDynamicsEnabled(flag);
@@ -545,6 +731,8 @@ class WorldManager
 
   /// Calls PhysicsWorld::Update(iter, force) on all worlds and subsequently
   /// calls MirrorWorld::Sync() and MirrorWorld::Update().
+  /// If the experimental parallel update mode is enabled (see
+  /// SetParallelUpdate()), the worlds are updated concurrently.
   public: void Update(int iter = 1, bool force = false)
   {
     // we cannot just lock the worldMutex in the whole function, because
@@ -552,26 +740,26 @@ class WorldManager
     // class, called by the ControlServer. ControlServer implementations
     // may trigger the call of the callbacks from a different thread,
     // therefore there will be a deadlock for accessing the worlds in
-    // the callback functions of this class. Only block the worlds
-    // vector while absolutey necessary.
+    // the callback functions of this class. The worlds are taken from
+    // the current registry, which needs no lock. Worlds added
+    // asynchronously during this call will be updated in the next call.
+    WorldRegistryConstPtr reg = GetWorldRegistry();
     this->worldsMutex.lock();
-    int numWorlds = this->worlds.size();
+    ThreadPool::Ptr pool = this->updatePool;
     this->worldsMutex.unlock();
-    for (int i = 0; i< numWorlds; ++i)
+
+    // Updates which are triggered from within a world update running on
+    // the pool (e.g. by a ControlServer callback) must not wait for the pool
+    // they are running on, so they fall back to the sequential update.
+    if (pool && (reg->worlds.size() > 1) && !pool->IsWorkerThread())
     {
-      PhysicsWorldBaseInterface::Ptr world;
-      {
-        // get the i'th world
-        std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-        // update vector size in case more worlds were
-        // added asynchronously
-        numWorlds = this->worlds.size();
-        // break loop if size of worlds has decreased
-        if (i >= numWorlds) break;
-        world = worlds[i];
-      }
-      world->Update(iter, force);
+      UpdateParallel(*pool, reg->worlds, iter, force);
     }
+    else
+    {
+      UpdateSequential(reg->worlds, iter, force);
+    }
+
     if (this->mirrorWorld)
     {
       this->mirrorWorld->Sync();
@@ -606,10 +794,10 @@ class WorldManager
                             const bool copyResources = true)
   {
     int fail = 0;
-    std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-    for (std::vector<PhysicsWorldBaseInterface::Ptr>::iterator
-         it = this->worlds.begin();
-         it != this->worlds.end(); ++it)
+    WorldRegistryConstPtr reg = GetWorldRegistry();
+    for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
+         it = reg->worlds.begin();
+         it != reg->worlds.end(); ++it)
     {
       PhysicsWorldBaseInterface::Ptr w=*it;
       boost::filesystem::path filename =
@@ -664,13 +852,12 @@ class WorldManager
   {
      std::cout << "WorldManager received SDF MODEL command"
                << std::endl;
-     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-     for (std::vector<PhysicsWorldBaseInterface::Ptr>::iterator
-          it = this->worlds.begin();
-          it != this->worlds.end(); ++it)
+     WorldRegistryConstPtr reg = GetWorldRegistry();
+     for (typename std::vector<PhysicsWorldModelInterfacePtr>::const_iterator
+          it = reg->modelWorlds.begin();
+          it != reg->modelWorlds.end(); ++it)
      {
-       PhysicsWorldModelInterfacePtr
-         w =ToWorldWithModel(*it);
+       PhysicsWorldModelInterfacePtr w = *it;
        if (!w)
        {
          THROW_EXCEPTION("Only support worlds which have the "
@@ -700,7 +887,8 @@ class WorldManager
   private: std::string ChangeMirrorWorld(const int ctrl)
   {
      std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-       if (worlds.empty())
+     const size_t numWorlds = GetNumWorlds();
+       if (numWorlds == 0)
        {
          std::cerr << "There are no worlds to be mirrored." << std::endl;
          return "";
@@ -714,13 +902,13 @@ class WorldManager
        if (mirroredWorldIdx > 0)
          --mirroredWorldIdx;
        else
-         mirroredWorldIdx = worlds.size() - 1;  // go back to last world
+         mirroredWorldIdx = numWorlds - 1;  // go back to last world
      }
      else if (ctrl > 0)
      {
        // Switch to next world
        std::cout << "WorldManager: Switching to next world" << std::endl;
-       if (mirroredWorldIdx < (worlds.size()-1))
+       if (mirroredWorldIdx < (numWorlds-1))
          ++mirroredWorldIdx;
        else
          mirroredWorldIdx = 0;  // go back to first world
@@ -807,6 +995,21 @@ class WorldManager
     return w.SetBasicModelState(id, state);
   }
 
+  // Helper for SetBasicModelStates() which sets all \e states in the world.
+  // Returns the number of states which were successfully set.
+  private: static int SetBasicModelStatesInWorld
+              (PhysicsWorldModelInterfaceT &w,
+               const std::vector<ModelStateEntry> &states)
+  {
+    int cnt = 0;
+    for (typename std::vector<ModelStateEntry>::const_iterator
+         it = states.begin(); it != states.end(); ++it)
+    {
+      if (w.SetBasicModelState(it->first, it->second)) ++cnt;
+    }
+    return cnt;
+  }
+
   // Helper callback to call ModelInAllWorlds on the world
   private: static bool ModelInAllWorldsCB
               (PhysicsWorldModelInterfaceT &w,
@@ -816,20 +1019,21 @@ class WorldManager
   }
 
   // Helper function which calls a callback function on each of the worlds
-  // after casting it to PhysicsWorldModelInterfaceT. Accumulates all return
+  // as PhysicsWorldModelInterfaceT. Accumulates all return
   // values in a vector and returns it.
   private: template<typename RetVal, typename ... Params>
   std::vector<RetVal> CallOnAllWorldsWithModel
       (RetVal(*callback)(PhysicsWorldModelInterfaceT&, Params...),
        Params... params)
   {
+     WorldRegistryConstPtr reg = GetWorldRegistry();
      std::vector<RetVal> ret;
-     std::lock_guard<std::recursive_mutex> lock(this->worldsMutex);
-     for (std::vector<PhysicsWorldBaseInterface::Ptr>::iterator
-          it = this->worlds.begin();
-          it != this->worlds.end(); ++it)
+     ret.reserve(reg->modelWorlds.size());
+     for (typename std::vector<PhysicsWorldModelInterfacePtr>::const_iterator
+          it = reg->modelWorlds.begin();
+          it != reg->modelWorlds.end(); ++it)
      {
-       PhysicsWorldModelInterfacePtr w = ToWorldWithModel(*it);
+       PhysicsWorldModelInterfacePtr w = *it;
        if (!w)
        {
          THROW_EXCEPTION("Only support worlds which have the "
@@ -843,15 +1047,52 @@ class WorldManager
      return ret;
   }
 
-  // all the worlds
-  private: std::vector<PhysicsWorldBaseInterface::Ptr> worlds;
-  // mutex protecting the worlds vector (not the worlds itself!)
+  // Helper for Update() which updates \e updateWorlds one after another
+  private: void UpdateSequential
+              (const std::vector<PhysicsWorldBaseInterface::Ptr> &updateWorlds,
+               int iter, bool force)
+  {
+    for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
+         it = updateWorlds.begin(); it != updateWorlds.end(); ++it)
+    {
+      (*it)->Update(iter, force);
+    }
+  }
+
+  // Helper for Update() which updates \e updateWorlds concurrently on
+  // \e pool and returns when all worlds are updated.
+  private: void UpdateParallel
+              (ThreadPool &pool,
+               const std::vector<PhysicsWorldBaseInterface::Ptr> &updateWorlds,
+               int iter, bool force)
+  {
+    std::vector<ThreadPool::Job> jobs;
+    jobs.reserve(updateWorlds.size());
+    for (std::vector<PhysicsWorldBaseInterface::Ptr>::const_iterator
+         it = updateWorlds.begin(); it != updateWorlds.end(); ++it)
+    {
+      PhysicsWorldBaseInterface::Ptr world = *it;
+      jobs.push_back([world, iter, force]() { world->Update(iter, force); });
+    }
+    pool.RunAndWait(jobs);
+  }
+
+  // registry of all the worlds. Never modified, but replaced with
+  // std::atomic_store by writers, who have to lock the worldsMutex.
+  // Readers only use std::atomic_load.
+  private: WorldRegistryConstPtr registry;
+  // mutex serializing the replacement of the registry (not protecting
+  // the worlds itself!), and protecting mirroredWorldIdx and updatePool.
   private: mutable std::recursive_mutex worldsMutex;
 
   private: MirrorWorldPtr mirrorWorld;
   private: int mirroredWorldIdx;
 
   private: ControlServerPtr controlServer;
+
+  // pool of threads used to update the worlds in parallel. NULL if the
+  // parallel update mode is disabled. Protected by worldsMutex.
+  private: ThreadPool::Ptr updatePool;
 };
 
 }  // namespace collision_benchmark
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/ContactsClusterer.hh>
+
+#include <ignition/math/Vector3.hh>
+
+#include <gtest/gtest.h>
+
+typedef collision_benchmark::ContactsClusterer<ignition::math::Vector3d>
+  Clusterer;
+
+TEST(ContactsClustererTest, Empty)
+{
+  Clusterer clusterer(0.1);
+  ASSERT_EQ(clusterer.GetNumClusters(), 0u);
+  ASSERT_TRUE(clusterer.GetCenters().empty());
+  ASSERT_TRUE(clusterer.GetSizes().empty());
+}
+
+TEST(ContactsClustererTest, SingleContact)
+{
+  Clusterer clusterer(0.1);
+  const ignition::math::Vector3d p(1, -2, 3);
+  ASSERT_EQ(clusterer.Add(p), 0u);
+  ASSERT_EQ(clusterer.GetNumClusters(), 1u);
+  // the only point is the representative of its cluster
+  ASSERT_EQ(clusterer.GetCenters()[0], p);
+  ASSERT_EQ(clusterer.GetSizes()[0], 1u);
+}
+
+TEST(ContactsClustererTest, MergeRadius)
+{
+  const double tolerance = 0.1;
+  Clusterer clusterer(tolerance);
+  const ignition::math::Vector3d p(0, 0, 0);
+  ASSERT_EQ(clusterer.Add(p), 0u);
+  // a point exactly on the radius is merged
+  ASSERT_EQ(clusterer.Add(p + ignition::math::Vector3d(tolerance, 0, 0)), 0u);
+  // the center is now at p + (tolerance/2, 0, 0), so this point
+  // is just outside the radius
+  const ignition::math::Vector3d outside =
+    p + ignition::math::Vector3d(-tolerance / 2 - 1e-06, 0, 0);
+  ASSERT_EQ(clusterer.Add(outside), 1u);
+  ASSERT_EQ(clusterer.GetNumClusters(), 2u);
+  ASSERT_EQ(clusterer.GetSizes()[0], 2u);
+  ASSERT_EQ(clusterer.GetSizes()[1], 1u);
+}
+
+TEST(ContactsClustererTest, ZeroRadius)
+{
+  Clusterer clusterer(0);
+  const ignition::math::Vector3d p(0.5, 0.5, 0.5);
+  ASSERT_EQ(clusterer.Add(p), 0u);
+  ASSERT_EQ(clusterer.Add(p), 0u);
+  ASSERT_EQ(clusterer.Add(p + ignition::math::Vector3d(1e-09, 0, 0)), 1u);
+  ASSERT_EQ(clusterer.GetNumClusters(), 2u);
+  ASSERT_EQ(clusterer.GetSizes()[0], 2u);
+}
+
+TEST(ContactsClustererTest, RepresentativePoint)
+{
+  Clusterer clusterer(1);
+  const std::vector<ignition::math::Vector3d> points =
+  {
+    ignition::math::Vector3d(0, 0, 0),
+    ignition::math::Vector3d(0.4, 0, 0),
+    ignition::math::Vector3d(0, 0.4, 0),
+    ignition::math::Vector3d(0, 0, 0.4)
+  };
+  ignition::math::Vector3d average;
+  for (const ignition::math::Vector3d &p : points)
+  {
+    ASSERT_EQ(clusterer.Add(p), 0u);
+    average += p;
+  }
+  average /= points.size();
+  // the representative of a cluster is the average of its points
+  ASSERT_EQ(clusterer.GetNumClusters(), 1u);
+  ASSERT_TRUE(clusterer.GetCenters()[0].Equal(average, 1e-09));
+  ASSERT_EQ(clusterer.GetSizes()[0], points.size());
+}
+
+TEST(ContactsClustererTest, FirstClusterWins)
+{
+  Clusterer clusterer(1);
+  ASSERT_EQ(clusterer.Add(ignition::math::Vector3d(0, 0, 0)), 0u);
+  ASSERT_EQ(clusterer.Add(ignition::math::Vector3d(1.5, 0, 0)), 1u);
+  // within the radius of both clusters, the one created first is used
+  ASSERT_EQ(clusterer.Add(ignition::math::Vector3d(0.75, 0, 0)), 0u);
+  ASSERT_EQ(clusterer.GetSizes()[0], 2u);
+  ASSERT_EQ(clusterer.GetSizes()[1], 1u);
+}
+
+TEST(ContactsClustererTest, CenterMovesToOtherCell)
+{
+  // points along a line: the center of the cluster moves across
+  // several cells of the spatial hash and has to be found there
+  const double tolerance = 0.1;
+  Clusterer clusterer(tolerance);
+  for (int i = 0; i < 100; ++i)
+  {
+    const ignition::math::Vector3d p(i * tolerance / 2, 0, 0);
+    const std::size_t idx = clusterer.Add(p);
+    ASSERT_TRUE((clusterer.GetCenters()[idx] - p).Length() <= tolerance)
+      << "Point " << p << " added to a cluster too far away";
+  }
+  size_t numPoints = 0;
+  for (size_t s : clusterer.GetSizes()) numPoints += s;
+  ASSERT_EQ(numPoints, 100u);
+  // with the running average, each cluster takes more than one point
+  ASSERT_LT(clusterer.GetNumClusters(), 100u);
+}
+
+TEST(ContactsClustererTest, Clear)
+{
+  Clusterer clusterer(0.1);
+  clusterer.Add(ignition::math::Vector3d(0, 0, 0));
+  clusterer.Add(ignition::math::Vector3d(1, 0, 0));
+  ASSERT_EQ(clusterer.GetNumClusters(), 2u);
+  clusterer.Clear(2);
+  ASSERT_EQ(clusterer.GetNumClusters(), 0u);
+  // the new radius is used after clearing
+  ASSERT_EQ(clusterer.Add(ignition::math::Vector3d(0, 0, 0)), 0u);
+  ASSERT_EQ(clusterer.Add(ignition::math::Vector3d(1, 0, 0)), 0u);
+  ASSERT_EQ(clusterer.GetNumClusters(), 1u);
+}
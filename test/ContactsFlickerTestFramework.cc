@@ -257,12 +257,13 @@ void ContactsFlickerTestFramework::FlickerTest(const std::string &modelName1,
   // Auto-collide parameters
   // ----------------
   const bool acAllWorlds = false;
+  // step size in interactive mode, or tolerance of the first contact search
   const double acStepSize = 1e-03;
   ASSERT_LT(acStepSize, modelsGap)
     << "Test setup inconsistency: gap should be > auto-collide step size";
   const bool acStopWhenPassed = true;
-  float acMaxMovePerSec = 0.4;
-  if (!interactive) acMaxMovePerSec = -1;
+  // only used in interactive mode
+  const float acMaxMovePerSec = 0.4;
 
   // Circle parameters
   // ----------------
@@ -346,9 +347,16 @@ void ContactsFlickerTestFramework::FlickerTest(const std::string &modelName1,
 
       // auto-collide models
       // std::cout << "Auto-collide at angle " << outerAngle << std::endl;
-      this->modelCollider.AutoCollide(acAllWorlds, false, acStepSize,
-                                      acMaxMovePerSec, acStopWhenPassed,
-                                      NULL, &tmp);
+      // Animate the movement only in interactive mode, otherwise search
+      // for the first contact with as few world updates as possible.
+      if (interactive)
+        this->modelCollider.AutoCollide(acAllWorlds, false, acStepSize,
+                                        acMaxMovePerSec, acStopWhenPassed,
+                                        NULL, &tmp);
+      else
+        this->modelCollider.AutoCollideBisect(acAllWorlds, false, acStepSize,
+                                              -1, acStopWhenPassed,
+                                              NULL, &tmp);
 
       if (!this->modelCollider.ModelsCollide(acAllWorlds))
       {
@@ -504,10 +512,11 @@ void ContactsFlickerTestFramework::FlickerTest(const std::string &modelName1,
 
           BasicState oriState = outerCurrMs2;
           oriState.rotation = collision_benchmark::Conv(q);
-          ASSERT_EQ(worldManager->SetBasicModelState(modelName2, oriState),
+          std::vector<GzWorldManager::ModelStateEntry>
+            oriStates(1, std::make_pair(modelName2, oriState));
+          ASSERT_EQ(worldManager->SetBasicModelStates(oriStates, NULL, true),
                     worldManager->GetNumWorlds())
               << "Could not set model pose to required pose";
-          worldManager->Update(1);
           if (interactive && slowDown)
             gazebo::common::Time::MSleep(slowDownMS);
 
@@ -20,7 +20,9 @@
 #include <collision_benchmark/BasicTypes.hh>
 #include <collision_benchmark/GazeboModelLoader.hh>
 
+#ifdef HAVE_VTK
 #include <collision_benchmark/MeshShapeGeneratorVtk.hh>
+#endif
 
 #include <gazebo/gazebo.hh>
 #include <gazebo/test/helper_physics_generator.hh>
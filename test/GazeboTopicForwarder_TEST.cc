@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboTopicForwarder.hh>
+
+#include <gazebo/msgs/msgs.hh>
+
+#include <gtest/gtest.h>
+
+TEST(MessageCoalescerTest, Poses)
+{
+  collision_benchmark::MessageCoalescer<gazebo::msgs::PosesStamped> coalescer;
+  gazebo::msgs::PosesStamped msg;
+  ASSERT_FALSE(coalescer.Take(msg));
+
+  // poses of two entities, one of them only identified by name
+  gazebo::msgs::PosesStamped msg1;
+  gazebo::msgs::Set(msg1.mutable_time(), gazebo::common::Time(1));
+  gazebo::msgs::Pose *pose = msg1.add_pose();
+  gazebo::msgs::Set(pose, ignition::math::Pose3d(1, 0, 0, 0, 0, 0));
+  pose->set_name("box");
+  pose->set_id(1);
+  pose = msg1.add_pose();
+  gazebo::msgs::Set(pose, ignition::math::Pose3d(2, 0, 0, 0, 0, 0));
+  pose->set_name("sphere");
+  coalescer.Add(msg1);
+
+  // newer pose of the first entity and a new entity
+  gazebo::msgs::PosesStamped msg2;
+  gazebo::msgs::Set(msg2.mutable_time(), gazebo::common::Time(2));
+  pose = msg2.add_pose();
+  gazebo::msgs::Set(pose, ignition::math::Pose3d(3, 0, 0, 0, 0, 0));
+  pose->set_name("box");
+  pose->set_id(1);
+  pose = msg2.add_pose();
+  gazebo::msgs::Set(pose, ignition::math::Pose3d(4, 0, 0, 0, 0, 0));
+  pose->set_name("cylinder");
+  pose->set_id(2);
+  coalescer.Add(msg2);
+
+  ASSERT_TRUE(coalescer.Take(msg));
+  ASSERT_FALSE(coalescer.HasPending());
+  ASSERT_EQ(msg.time().sec(), 2);
+  ASSERT_EQ(msg.pose_size(), 3);
+  ASSERT_EQ(msg.pose(0).name(), "box");
+  ASSERT_DOUBLE_EQ(msg.pose(0).position().x(), 3);
+  ASSERT_EQ(msg.pose(1).name(), "sphere");
+  ASSERT_DOUBLE_EQ(msg.pose(1).position().x(), 2);
+  ASSERT_EQ(msg.pose(2).name(), "cylinder");
+  ASSERT_DOUBLE_EQ(msg.pose(2).position().x(), 4);
+}
+
+TEST(MessageCoalescerTest, OtherMessages)
+{
+  // other messages are replaced by the latest one
+  collision_benchmark::MessageCoalescer<gazebo::msgs::Contacts> contacts;
+  gazebo::msgs::Contacts contactsMsg;
+  contactsMsg.add_contact()->set_collision1("a");
+  contacts.Add(contactsMsg);
+  contacts.Add(gazebo::msgs::Contacts());
+  ASSERT_TRUE(contacts.Take(contactsMsg));
+  ASSERT_EQ(contactsMsg.contact_size(), 0);
+}
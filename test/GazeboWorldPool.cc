@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <test/GazeboWorldPool.hh>
+#include <collision_benchmark/GazeboWorldLoader.hh>
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <list>
+#include <set>
+#include <sstream>
+
+using collision_benchmark::GazeboWorldPool;
+using collision_benchmark::GazeboMultipleWorlds;
+using collision_benchmark::GazeboPhysicsWorld;
+using collision_benchmark::PhysicsWorldBaseInterface;
+
+namespace
+{
+// Collects the names of all elements without child elements in \e elem,
+// which are the names of the parameters of the physics engine (e.g.
+// "max_step_size" or "iters"), see gazebo::physics::PhysicsEngine::GetParam()
+void GetPhysicsParamNames(const sdf::ElementPtr &elem,
+                          std::set<std::string> &names)
+{
+  std::list<sdf::ElementPtr> elems(1, elem);
+  while (!elems.empty())
+  {
+    sdf::ElementPtr e = elems.front();
+    elems.pop_front();
+    sdf::ElementPtr child = e->GetFirstElement();
+    if (!child)
+    {
+      // the type of the engine can't be changed
+      if (e->GetName() != "type") names.insert(e->GetName());
+      continue;
+    }
+    for (; child; child = child->GetNextElement())
+      elems.push_back(child);
+  }
+}
+
+// Shuts down the pooled server after all tests have run, while gazebo
+// can still be shut down properly (which is not the case any more when
+// the static pool instance is destroyed).
+class GazeboWorldPoolEnvironment : public ::testing::Environment
+{
+  public: virtual void TearDown()
+  {
+    GazeboWorldPool::Instance().Shutdown();
+  }
+};
+
+::testing::Environment *const poolEnvironment =
+  ::testing::AddGlobalTestEnvironment(new GazeboWorldPoolEnvironment());
+}
+
+////////////////////////////////////////////////////////////////
+GazeboWorldPool &GazeboWorldPool::Instance()
+{
+  static GazeboWorldPool instance;
+  return instance;
+}
+
+////////////////////////////////////////////////////////////////
+GazeboMultipleWorlds::Ptr GazeboWorldPool::GetServer()
+{
+  if (this->server) return this->server;
+
+  const bool loadMirror = true;
+  const bool enforceContactCalc = true;
+  const bool allowControlViaMirror = false;
+  const bool interactiveMode = false;
+  // without gzclient, model poses don't need to be spaced apart for
+  // visualization
+  const bool headless = true;
+  GazeboMultipleWorlds::Ptr newServer(new GazeboMultipleWorlds());
+  newServer->SetHeadless(headless);
+  if (!newServer->Init(loadMirror, enforceContactCalc,
+                       allowControlViaMirror, interactiveMode)
+      || !newServer->GetWorldManager())
+  {
+    std::cerr << "Could not start the pooled server" << std::endl;
+    return GazeboMultipleWorlds::Ptr();
+  }
+  this->server = newServer;
+  // same loaders as the ones of the server
+  this->loaders =
+    collision_benchmark::GetSupportedGazeboWorldLoaders(enforceContactCalc,
+                                                        headless);
+  return this->server;
+}
+
+////////////////////////////////////////////////////////////////
+int GazeboWorldPool::Lease(const std::string &engine)
+{
+  if (!GetServer()) return -2;
+  if (!this->loaders.count(engine)) return -1;
+
+  PooledWorld pooled;
+  std::vector<PooledWorld> &idleWorlds = this->idle[engine];
+  if (!idleWorlds.empty())
+  {
+    pooled = idleWorlds.back();
+    idleWorlds.pop_back();
+  }
+  else if (!LoadWorld(engine, pooled))
+  {
+    return -2;
+  }
+
+  int ret = this->server->GetWorldManager()->AddPhysicsWorld(pooled.world);
+  if (ret < 0)
+  {
+    idleWorlds.push_back(pooled);
+    return -3;
+  }
+  this->leased.push_back(pooled);
+  return ret;
+}
+
+////////////////////////////////////////////////////////////////
+void GazeboWorldPool::ReleaseAll()
+{
+  if (this->server && this->server->GetWorldManager())
+  {
+    GazeboMultipleWorlds::GzWorldManager::Ptr worldManager =
+      this->server->GetWorldManager();
+    worldManager->RemoveAllWorlds();
+    worldManager->SetParallelUpdate(false);
+  }
+  for (std::vector<PooledWorld>::iterator it = this->leased.begin();
+       it != this->leased.end(); ++it)
+  {
+    Reset(*it);
+    this->idle[it->engine].push_back(*it);
+  }
+  this->leased.clear();
+}
+
+////////////////////////////////////////////////////////////////
+void GazeboWorldPool::Shutdown()
+{
+  this->leased.clear();
+  this->idle.clear();
+  this->loaders.clear();
+  if (this->server) this->server->Stop();
+  this->server.reset();
+}
+
+////////////////////////////////////////////////////////////////
+size_t GazeboWorldPool::GetNumIdle(const std::string &engine) const
+{
+  std::map<std::string, std::vector<PooledWorld>>::const_iterator it =
+    this->idle.find(engine);
+  return it == this->idle.end() ? 0 : it->second.size();
+}
+
+////////////////////////////////////////////////////////////////
+bool GazeboWorldPool::LoadWorld(const std::string &engine,
+                                PooledWorld &pooled)
+{
+  std::stringstream worldname;
+  worldname << "world_" << this->numLoaded[engine] << "_" << engine;
+  PhysicsWorldBaseInterface::Ptr world =
+    this->loaders[engine]->LoadFromFile("test_worlds/void.world",
+                                        worldname.str());
+  pooled.world = std::dynamic_pointer_cast<GazeboPhysicsWorld>(world);
+  if (!pooled.world)
+  {
+    std::cerr << "Could not load pooled world " << worldname.str()
+              << std::endl;
+    return false;
+  }
+  ++this->numLoaded[engine];
+  pooled.engine = engine;
+  pooled.initialState = pooled.world->GetWorldState();
+  pooled.paused = pooled.world->IsPaused();
+
+  gazebo::physics::WorldPtr gzWorld = pooled.world->GetWorld();
+  pooled.physicsEnabled = gzWorld->PhysicsEnabled();
+  pooled.gravity = gzWorld->Gravity();
+  pooled.magneticField = gzWorld->MagneticField();
+  gazebo::physics::Model_V models = gzWorld->Models();
+  for (gazebo::physics::Model_V::iterator it = models.begin();
+       it != models.end(); ++it)
+  {
+    pooled.models.push_back((*it)->UnscaledSDF()->Clone());
+  }
+  gazebo::physics::PhysicsEnginePtr physics = gzWorld->Physics();
+  std::set<std::string> paramNames;
+  GetPhysicsParamNames(physics->GetSDF(), paramNames);
+  for (std::set<std::string>::const_iterator it = paramNames.begin();
+       it != paramNames.end(); ++it)
+  {
+    boost::any value;
+    // not all elements of the SDF are parameters of the engine
+    if (physics->GetParam(*it, value))
+      pooled.physicsParams[*it] = value;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+void GazeboWorldPool::Reset(PooledWorld &pooled)
+{
+  GazeboPhysicsWorld::Ptr world = pooled.world;
+  gazebo::physics::WorldPtr gzWorld = world->GetWorld();
+  world->Clear();
+  // The world state can't re-insert models which were removed from the
+  // world, because it takes their SDF from the world. Insert the models
+  // of the loaded world again, then restore their state.
+  for (std::vector<sdf::ElementPtr>::const_iterator
+       it = pooled.models.begin(); it != pooled.models.end(); ++it)
+  {
+    collision_benchmark::LoadModelFromSDF((*it)->Clone(), gzWorld, "");
+  }
+  world->SetWorldState(pooled.initialState, false);
+
+  gazebo::physics::PhysicsEnginePtr physics = gzWorld->Physics();
+  for (std::map<std::string, boost::any>::const_iterator
+       it = pooled.physicsParams.begin(); it != pooled.physicsParams.end();
+       ++it)
+  {
+    physics->SetParam(it->first, it->second);
+  }
+  gzWorld->SetGravity(pooled.gravity);
+  gzWorld->SetMagneticField(pooled.magneticField);
+
+  gzWorld->ResetTime();
+  world->SetPaused(pooled.paused);
+  world->SetDynamicsEnabled(pooled.physicsEnabled);
+}
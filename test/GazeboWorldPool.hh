@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef COLLISION_BENCHMARK_TEST_GAZEBOWORLDPOOL_H
+#define COLLISION_BENCHMARK_TEST_GAZEBOWORLDPOOL_H
+
+#include <collision_benchmark/GazeboMultipleWorlds.hh>
+#include <collision_benchmark/GazeboPhysicsWorld.hh>
+#include <collision_benchmark/WorldLoader.hh>
+
+#include <boost/any.hpp>
+#include <ignition/math/Vector3.hh>
+#include <sdf/sdf.hh>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace collision_benchmark
+{
+/**
+ * \brief Keeps a non-interactive GazeboMultipleWorlds server and empty
+ * worlds of each engine alive for all tests of a process.
+ *
+ * Starting the server and loading the empty worlds takes much longer than
+ * most tests themselves. Instead of creating them for every test, tests
+ * lease worlds from the pool, which adds them to the world manager of the
+ * pooled server. After the test, ReleaseAll() clears the worlds of all
+ * models, restores the models, physics parameters and state they had
+ * after loading and takes them back, so that the next test can lease them
+ * again.
+ *
+ * The server is initialized with a mirror world, contact computation is
+ * enforced and the worlds are loaded in headless mode (see
+ * GazeboMultipleWorlds::SetHeadless()). The server is shut
+ * down after all tests have run. The pool is meant to be used from the
+ * test thread only.
+ */
+class GazeboWorldPool
+{
+  /// \return the instance of the pool
+  public: static GazeboWorldPool &Instance();
+
+  /// \brief Returns the pooled server. Starts the server if it's not
+  /// running yet.
+  /// \return the server, or NULL if it could not be started
+  public: GazeboMultipleWorlds::Ptr GetServer();
+
+  /// \brief Adds an empty world with the engine \e engine to the world
+  /// manager of the pooled server. If there is no idle world of this engine
+  /// in the pool, a new one is loaded from test_worlds/void.world.
+  /// \retval >= 0 on success, the index of the world in the world manager.
+  /// \retval -1 no world loader exists for this engine
+  /// \retval -2 world with this engine cannot be loaded
+  /// \retval -3 the world could not be added to the world manager
+  public: int Lease(const std::string &engine);
+
+  /// \brief Removes all leased worlds from the world manager, resets them
+  /// to the models, physics parameters and state they had after loading
+  /// and returns them to the pool. The mirror world of the server doesn't
+  /// mirror any world until the next world is leased.
+  public: void ReleaseAll();
+
+  /// \brief Shuts down the pooled server and destroys all worlds.
+  /// The next call of GetServer() starts a new server.
+  public: void Shutdown();
+
+  /// \return true if the pooled server is running
+  public: bool IsRunning() const { return server != nullptr; }
+
+  /// \return the number of worlds of \e engine which are currently
+  ///   not leased
+  public: size_t GetNumIdle(const std::string &engine) const;
+
+  // \brief A world in the pool and the state to restore after a test
+  private: struct PooledWorld
+  {
+    // the world
+    GazeboPhysicsWorld::Ptr world;
+    // the engine of the world
+    std::string engine;
+    // state of the world after it was loaded
+    GazeboPhysicsWorld::WorldState initialState;
+    // SDF of the models in the world after it was loaded
+    std::vector<sdf::ElementPtr> models;
+    // parameters of the physics engine after the world was loaded,
+    // see gazebo::physics::PhysicsEngine::GetParam()
+    std::map<std::string, boost::any> physicsParams;
+    // gravity of the world after it was loaded
+    ignition::math::Vector3d gravity;
+    // magnetic field of the world after it was loaded
+    ignition::math::Vector3d magneticField;
+    // paused flag of the world after it was loaded
+    bool paused;
+    // physics enabled flag of the world after it was loaded
+    bool physicsEnabled;
+  };
+
+  private: GazeboWorldPool() {}
+  private: GazeboWorldPool(const GazeboWorldPool&);
+  private: GazeboWorldPool &operator=(const GazeboWorldPool&);
+
+  // \brief Loads a new empty world with \e engine.
+  // \return false if the world could not be loaded
+  private: bool LoadWorld(const std::string &engine, PooledWorld &pooled);
+
+  // \brief Resets the world to the models, physics parameters and state
+  // it had after loading
+  private: static void Reset(PooledWorld &pooled);
+
+  // \brief the pooled server
+  private: GazeboMultipleWorlds::Ptr server;
+
+  // \brief loaders of the engines, set when the server is started
+  private: std::map<std::string, WorldLoader::ConstPtr> loaders;
+
+  // \brief worlds which can be leased, by engine
+  private: std::map<std::string, std::vector<PooledWorld>> idle;
+
+  // \brief worlds which are currently added to the world manager
+  private: std::vector<PooledWorld> leased;
+
+  // \brief number of worlds loaded per engine, used to name the worlds
+  private: std::map<std::string, int> numLoaded;
+};
+}  // namespace collision_benchmark
+
+#endif  // COLLISION_BENCHMARK_TEST_GAZEBOWORLDPOOL_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/GazeboWorldTemplateCache.hh>
+#include <collision_benchmark/GazeboHelpers.hh>
+
+#include <boost/filesystem.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+using collision_benchmark::GazeboWorldTemplateCache;
+
+namespace
+{
+// Writes a world file with an empty world named \e name
+void WriteWorld(const std::string &filename, const std::string &name)
+{
+  std::ofstream file(filename.c_str());
+  file << "<?xml version=\"1.0\" ?>" << std::endl
+       << "<sdf version=\"1.5\">" << std::endl
+       << "  <world name=\"" << name << "\"></world>" << std::endl
+       << "</sdf>" << std::endl;
+}
+}  // namespace
+
+TEST(GazeboWorldTemplateCacheTest, CopiesOfTemplates)
+{
+  GazeboWorldTemplateCache &cache = GazeboWorldTemplateCache::Instance();
+  cache.Clear();
+  std::string worldfile = "../test_worlds/cube.world";
+  std::string physicsfile =
+    collision_benchmark::getPhysicsSettingsSdfFor("bullet");
+  ASSERT_FALSE(physicsfile.empty()) << "No physics settings for bullet";
+
+  sdf::ElementPtr physics = cache.GetPhysics(physicsfile);
+  ASSERT_NE(physics, nullptr) << "Could not read physics";
+  ASSERT_EQ(physics->Get<std::string>("type"), "bullet");
+
+  // both worlds are copies of the same template
+  sdf::ElementPtr world1 = cache.GetWorld(worldfile, "cached_world_1");
+  sdf::ElementPtr world2 = cache.GetWorld(worldfile, "cached_world_2",
+                                          physics);
+  ASSERT_NE(world1, nullptr) << "Could not read world";
+  ASSERT_NE(world2, nullptr) << "Could not read world";
+  ASSERT_NE(world1, world2);
+  ASSERT_EQ(cache.GetNumTemplates(), 2u);
+  ASSERT_EQ(world1->Get<std::string>("name"), "cached_world_1");
+  ASSERT_EQ(world2->Get<std::string>("name"), "cached_world_2");
+  ASSERT_EQ(world2->GetElement("physics")->Get<std::string>("type"),
+            "bullet");
+  // modifying a copy doesn't affect the template
+  ASSERT_EQ(cache.GetWorld(worldfile)->GetElement("physics")
+            ->Get<std::string>("type"),
+            world1->GetElement("physics")->Get<std::string>("type"));
+  ASSERT_EQ(cache.GetNumTemplates(), 2u);
+}
+
+TEST(GazeboWorldTemplateCacheTest, NonexistentFile)
+{
+  GazeboWorldTemplateCache &cache = GazeboWorldTemplateCache::Instance();
+  cache.Clear();
+  ASSERT_EQ(cache.GetWorld("nonexistent.world"), nullptr);
+  ASSERT_EQ(cache.GetPhysics("nonexistent.sdf"), nullptr);
+  // failures are not kept in the cache
+  ASSERT_EQ(cache.GetNumTemplates(), 0u);
+}
+
+TEST(GazeboWorldTemplateCacheTest, ChangedFile)
+{
+  GazeboWorldTemplateCache &cache = GazeboWorldTemplateCache::Instance();
+  cache.Clear();
+  const boost::filesystem::path file =
+    boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("template_cache_test_%%%%-%%%%.world");
+  const std::string filename = file.string();
+
+  WriteWorld(filename, "world_a");
+  sdf::ElementPtr world = cache.GetWorld(filename);
+  ASSERT_NE(world, nullptr) << "Could not read world";
+  ASSERT_EQ(world->Get<std::string>("name"), "world_a");
+
+  // a change of the same size within the same second as the first
+  // version has to be detected as well
+  const std::time_t mtime = boost::filesystem::last_write_time(file);
+  WriteWorld(filename, "world_b");
+  boost::filesystem::last_write_time(file, mtime);
+  world = cache.GetWorld(filename);
+  ASSERT_NE(world, nullptr) << "Could not read world";
+  ASSERT_EQ(world->Get<std::string>("name"), "world_b");
+  ASSERT_EQ(cache.GetNumTemplates(), 2u);
+
+  // the unchanged file uses the template again
+  world = cache.GetWorld(filename);
+  ASSERT_EQ(world->Get<std::string>("name"), "world_b");
+  ASSERT_EQ(cache.GetNumTemplates(), 2u);
+
+  boost::system::error_code ec;
+  boost::filesystem::remove(file, ec);
+}
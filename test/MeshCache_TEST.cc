@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/MeshCache.hh>
+#include <collision_benchmark/MeshHelper.hh>
+#include <collision_benchmark/MeshShapeGeneratorCached.hh>
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
+
+#include <boost/filesystem.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using collision_benchmark::MeshCache;
+using collision_benchmark::MeshData;
+
+typedef collision_benchmark::MeshShapeGenerator<float> Generator;
+typedef collision_benchmark::MeshShapeGeneratorNative<float> NativeGenerator;
+typedef collision_benchmark::MeshShapeGeneratorCached<float> CachedGenerator;
+
+namespace
+{
+// Cache in a new temporary directory, which is removed again
+// when the test ends.
+class TempCache
+{
+  public: TempCache():
+    directory((boost::filesystem::temp_directory_path() /
+               boost::filesystem::unique_path("mesh_cache_test_%%%%-%%%%"))
+              .string()),
+    cache(new MeshCache(directory)) {}
+
+  public: ~TempCache()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(directory, ec);
+  }
+
+  public: std::string directory;
+  public: MeshCache::Ptr cache;
+};
+
+// Native generator with another identifier for the cache
+class IdGenerator : public NativeGenerator
+{
+  public: explicit IdGenerator(const std::string &id_): id(id_) {}
+  public: virtual std::string GetCacheId() const { return id; }
+  private: std::string id;
+};
+}
+
+TEST(MeshCacheTest, GeneratedMeshes)
+{
+  TempCache tmp;
+  ASSERT_TRUE(tmp.cache->IsValid()) << "Could not create cache directory";
+
+  Generator::Ptr generator(new CachedGenerator
+                             (Generator::Ptr(new NativeGenerator()),
+                              tmp.cache));
+
+  Generator::TriMeshDataPtr sphere1 = generator->MakeSphere(1, 20, 20);
+  ASSERT_NE(sphere1, nullptr);
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 1u) << "Sphere was not cached";
+
+  // the same sphere has to be loaded from the cache
+  Generator::TriMeshDataPtr sphere2 = generator->MakeSphere(1, 20, 20);
+  ASSERT_NE(sphere2, nullptr);
+  ASSERT_NE(sphere1, sphere2) << "Cached meshes have to be copies";
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 1u) << "Sphere was cached twice";
+  ASSERT_EQ(sphere1->GetNumVertices(), sphere2->GetNumVertices());
+  ASSERT_EQ(sphere1->GetNumFaces(), sphere2->GetNumFaces());
+  ASSERT_EQ(MeshCache::MakeKey(*sphere1), MeshCache::MakeKey(*sphere2))
+    << "Cached mesh data differs from the generated mesh";
+
+  // another resolution is another mesh
+  Generator::TriMeshDataPtr sphere3 = generator->MakeSphere(1, 10, 10);
+  ASSERT_NE(sphere3, nullptr);
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 2u);
+  ASSERT_NE(MeshCache::MakeKey(*sphere1), MeshCache::MakeKey(*sphere3));
+}
+
+TEST(MeshCacheTest, GeneratorVersion)
+{
+  TempCache tmp;
+  ASSERT_TRUE(tmp.cache->IsValid()) << "Could not create cache directory";
+
+  Generator::Ptr version1(new CachedGenerator
+                            (Generator::Ptr(new IdGenerator("test 1")),
+                             tmp.cache));
+  Generator::Ptr version2(new CachedGenerator
+                            (Generator::Ptr(new IdGenerator("test 2")),
+                             tmp.cache));
+  ASSERT_EQ(version1->GetCacheId(), "test 1");
+
+  ASSERT_NE(version1->MakeBox(1, 2, 3), nullptr);
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 1u);
+  // another version of the generator must not use the cached mesh
+  ASSERT_NE(version2->MakeBox(1, 2, 3), nullptr);
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 2u);
+  ASSERT_NE(version1->MakeBox(1, 2, 3), nullptr);
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 2u);
+
+  // meshes of generators which are not deterministic are not cached
+  Generator::Ptr noId(new CachedGenerator
+                        (Generator::Ptr(new IdGenerator("")), tmp.cache));
+  ASSERT_NE(noId->MakeBox(1, 2, 3), nullptr);
+  ASSERT_EQ(tmp.cache->GetIndex().size(), 2u);
+}
+
+TEST(MeshCacheTest, ExportedFiles)
+{
+  TempCache tmp;
+  ASSERT_TRUE(tmp.cache->IsValid()) << "Could not create cache directory";
+
+  Generator::Ptr generator(new NativeGenerator());
+  Generator::TriMeshDataPtr sphere = generator->MakeSphere(1, 20, 20);
+  ASSERT_NE(sphere, nullptr);
+
+  // exported files are cached by mesh data
+  std::string key = MeshCache::MakeKey(*sphere);
+  std::string exported = tmp.directory + "/exported.stl";
+  ASSERT_FALSE(tmp.cache->GetFile(key, "stl", exported));
+  ASSERT_TRUE(collision_benchmark::WriteTrimesh(exported, "stl", sphere));
+  ASSERT_TRUE(tmp.cache->StoreFile(key, "stl", exported, "sphere"));
+  ASSERT_TRUE(tmp.cache->HasEntry(key, "stl"));
+  std::string copied = tmp.directory + "/copied.stl";
+  ASSERT_TRUE(tmp.cache->GetFile(key, "stl", copied));
+  ASSERT_EQ(boost::filesystem::file_size(exported),
+            boost::filesystem::file_size(copied));
+}
+
+TEST(MeshCacheTest, IndexWidth)
+{
+  TempCache tmp;
+  ASSERT_TRUE(tmp.cache->IsValid()) << "Could not create cache directory";
+
+  // meshes with 16 bit indices are stored with their index width
+  typedef MeshData<float, 3, uint16_t> SmallMeshData;
+  SmallMeshData small;
+  small.AddVertex(0, 0, 0);
+  small.AddVertex(1, 0, 0);
+  small.AddVertex(0, 1, 0);
+  small.AddFace(SmallMeshData::Face(0, 1, 2));
+  ASSERT_EQ(small.GetIndexBuffer().size(), 3u);
+  std::string smallKey = MeshCache::MakeKey(small);
+  ASSERT_TRUE(tmp.cache->StoreMeshData(smallKey, small, "small"));
+  ASSERT_EQ((tmp.cache->LoadMeshData<float, 3, uint32_t>(smallKey)), nullptr)
+    << "Mesh with 16 bit indices must not be loaded with 32 bit indices";
+  SmallMeshData::Ptr smallLoaded =
+    tmp.cache->LoadMeshData<float, 3, uint16_t>(smallKey);
+  ASSERT_NE(smallLoaded, nullptr);
+  ASSERT_EQ(smallLoaded->GetNumFaces(), 1u);
+  ASSERT_EQ(smallLoaded->GetFace(0)[2], 2);
+  ASSERT_EQ(smallLoaded->GetVertex(2).Y(), 1);
+}
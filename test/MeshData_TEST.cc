@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/MeshData.hh>
+#include <collision_benchmark/MeshDataParallel.hh>
+#include <collision_benchmark/ThreadPool.hh>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+typedef collision_benchmark::MeshData<float, 3> MeshDataT;
+typedef MeshDataT::Vertex Vertex;
+
+// Makes a mesh which is large enough to be perturbed in parallel
+static MeshDataT MakeLargeMesh()
+{
+  MeshDataT mesh;
+  for (int i = 0; i < 50000; ++i)
+  {
+    mesh.AddVertex(3 * sin(i), 2 * cos(i), i * 1e-03);
+  }
+  return mesh;
+}
+
+TEST(MeshDataTest, SeededPerturb)
+{
+  const MeshDataT mesh = MakeLargeMesh();
+  const uint64_t seed = 42;
+  MeshDataT perturbed(mesh);
+  perturbed.Perturb(-0.2, 0.2, Vertex(0, 0, 0), seed);
+  MeshDataT sameSeed(mesh);
+  sameSeed.Perturb(-0.2, 0.2, Vertex(0, 0, 0), seed);
+  ASSERT_EQ(perturbed.GetVertexBuffer(), sameSeed.GetVertexBuffer())
+    << "Perturbation with the same seed differs";
+
+  MeshDataT otherSeed(mesh);
+  otherSeed.Perturb(-0.2, 0.2, Vertex(0, 0, 0), seed + 1);
+  ASSERT_NE(perturbed.GetVertexBuffer(), otherSeed.GetVertexBuffer());
+
+  for (size_t i = 0; i < mesh.GetNumVertices(); ++i)
+  {
+    double dist = (perturbed.GetVertex(i) - mesh.GetVertex(i)).Length();
+    ASSERT_LE(dist, 0.2 + 1e-05) << "Vertex " << i << " moved too far";
+  }
+
+  // the seed returned by the random perturbation repeats it
+  MeshDataT random(mesh);
+  uint64_t usedSeed = random.Perturb(-0.2, 0.2, Vertex(0, 0, 0),
+                                     Vertex(0, 0, 1));
+  MeshDataT repeated(mesh);
+  repeated.Perturb(-0.2, 0.2, Vertex(0, 0, 0), Vertex(0, 0, 1), usedSeed);
+  ASSERT_EQ(random.GetVertexBuffer(), repeated.GetVertexBuffer())
+    << "Perturbation with the returned seed differs";
+}
+
+TEST(MeshDataTest, ParallelPerturb)
+{
+  const MeshDataT mesh = MakeLargeMesh();
+  const uint64_t seed = 42;
+  collision_benchmark::ThreadPool pool(4);
+
+  MeshDataT serial(mesh);
+  serial.Perturb(-0.2, 0.2, Vertex(0, 0, 0), seed);
+  MeshDataT parallel(mesh);
+  collision_benchmark::PerturbParallel(parallel, -0.2, 0.2, Vertex(0, 0, 0),
+                                       seed, &pool);
+  ASSERT_EQ(serial.GetVertexBuffer(), parallel.GetVertexBuffer())
+    << "Parallel perturbation differs from serial perturbation";
+
+  MeshDataT serialDir(mesh);
+  serialDir.Perturb(-0.2, 0.2, Vertex(0, 0, 0), Vertex(0, 0, 1), seed);
+  MeshDataT parallelDir(mesh);
+  collision_benchmark::PerturbParallel(parallelDir, -0.2, 0.2,
+                                       Vertex(0, 0, 0), Vertex(0, 0, 1),
+                                       seed, &pool);
+  ASSERT_EQ(serialDir.GetVertexBuffer(), parallelDir.GetVertexBuffer())
+    << "Parallel perturbation differs from serial perturbation";
+}
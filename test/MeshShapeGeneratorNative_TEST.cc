@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
+#ifdef HAVE_VTK
+#include <collision_benchmark/MeshShapeGeneratorVtk.hh>
+#endif
+
+#include <ignition/math/Vector3.hh>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+#include <utility>
+#include <vector>
+
+typedef collision_benchmark::MeshShapeGenerator<double> Generator;
+
+// \brief Computes the volume enclosed by \e mesh, which is negative if the
+// faces are oriented towards the inside.
+// \return false if \e mesh is not closed, i.e. not each edge is shared by
+//  exactly two faces with opposite orientation.
+template<class MeshDataT>
+static bool GetClosedMeshVolume(const MeshDataT &mesh, double &volume)
+{
+  std::set<std::pair<size_t, size_t> > edges;
+  volume = 0;
+  for (size_t f = 0; f < mesh.GetNumFaces(); ++f)
+  {
+    const typename MeshDataT::Face face = mesh.GetFace(f);
+    for (int k = 0; k < 3; ++k)
+    {
+      if (!edges.insert(std::make_pair(face[k], face[(k + 1) % 3])).second)
+        return false;
+    }
+    ignition::math::Vector3d v[3];
+    for (int k = 0; k < 3; ++k)
+    {
+      const typename MeshDataT::Vertex vert = mesh.GetVertex(face[k]);
+      v[k].Set(vert.X(), vert.Y(), vert.Z());
+    }
+    volume += v[0].Dot(v[1].Cross(v[2])) / 6;
+  }
+  for (std::set<std::pair<size_t, size_t> >::const_iterator
+       it = edges.begin(); it != edges.end(); ++it)
+  {
+    if (!edges.count(std::make_pair(it->second, it->first))) return false;
+  }
+  return true;
+}
+
+TEST(MeshShapeGeneratorNativeTest, ClosedShapes)
+{
+  collision_benchmark::MeshShapeGeneratorNative<double> generator;
+
+  std::vector<std::pair<Generator::TriMeshDataPtr, double> > closed;
+  closed.push_back(std::make_pair(generator.MakeSphere(1, 64, 64, true),
+                                  4 * M_PI / 3));
+  closed.push_back(std::make_pair(generator.MakeSphere(1, 64, 64, false),
+                                  4 * M_PI / 3));
+  closed.push_back(std::make_pair(generator.MakeCylinder(1, 2, 64, true),
+                                  2 * M_PI));
+  closed.push_back(std::make_pair(generator.MakeBox(1, 2, 3), 6));
+  closed.push_back(std::make_pair(generator.MakeBox(-1, 0, 0, 1, 1, 3), 2));
+  closed.push_back(std::make_pair(generator.MakeCone(1, 2, 64, 0, true,
+                                                     1, 1, 0),
+                                  2 * M_PI / 3));
+  closed.push_back(std::make_pair(generator.MakeEllipsoid(1, 2, 3, 65, 65),
+                                  8 * M_PI));
+  closed.push_back(std::make_pair(generator.MakeTorus(2, 0.5, 65, 65),
+                                  M_PI * M_PI));
+  for (size_t i = 0; i < closed.size(); ++i)
+  {
+    ASSERT_NE(closed[i].first, nullptr);
+    double volume;
+    ASSERT_TRUE(GetClosedMeshVolume(*closed[i].first, volume))
+      << "Mesh " << i << " is not closed";
+    // tessellation makes the volume slightly smaller
+    ASSERT_GT(volume, 0.98 * closed[i].second) << "Mesh " << i;
+    ASSERT_LE(volume, closed[i].second + 1e-09) << "Mesh " << i;
+  }
+}
+
+TEST(MeshShapeGeneratorNativeTest, ConeAndDisk)
+{
+  collision_benchmark::MeshShapeGeneratorNative<double> generator;
+
+  // angle overrides the radius of the cone
+  Generator::TriMeshDataPtr cone = generator.MakeCone(5, 1, 4, 45, true);
+  ASSERT_NEAR(cone->GetVertex(1).Length(), std::sqrt(1.25), 1e-09);
+
+  Generator::TriMeshDataPtr disk = generator.MakeDisk(0, 1, 2, 16);
+  ASSERT_EQ(disk->GetNumVertices(), 1 + 2 * 16);
+  ASSERT_EQ(disk->GetNumFaces(), 3 * 16);
+  disk = generator.MakeDisk(0.5, 1, 2, 16);
+  ASSERT_EQ(disk->GetNumVertices(), 3 * 16);
+  ASSERT_EQ(disk->GetNumFaces(), 4 * 16);
+}
+
+#ifdef HAVE_VTK
+TEST(MeshShapeGeneratorNativeTest, SameTopologyAsVtk)
+{
+  // the same number of vertices and faces as the VTK meshes, after
+  // vtkCleanPolyData has merged the points on the seams, the poles of
+  // the ellipsoid and the center of the disk, and removed the degenerate
+  // triangles at the poles and the center.
+  collision_benchmark::MeshShapeGeneratorNative<double> generator;
+  collision_benchmark::MeshShapeGeneratorVtk<double> vtkGenerator;
+  std::vector<std::pair<Generator::TriMeshDataPtr,
+                        Generator::TriMeshDataPtr> > pairs;
+  pairs.push_back(std::make_pair(generator.MakeSphere(1, 20, 10),
+                                 vtkGenerator.MakeSphere(1, 20, 10)));
+  pairs.push_back(std::make_pair(generator.MakeCylinder(1, 2, 20, true),
+                                 vtkGenerator.MakeCylinder(1, 2, 20, true)));
+  pairs.push_back(std::make_pair(generator.MakeBox(1, 2, 3),
+                                 vtkGenerator.MakeBox(1, 2, 3)));
+  pairs.push_back(std::make_pair(generator.MakeCone(1, 2, 20, 30, true),
+                                 vtkGenerator.MakeCone(1, 2, 20, 30, true)));
+  pairs.push_back(std::make_pair(generator.MakeDisk(0, 1, 3, 20),
+                                 vtkGenerator.MakeDisk(0, 1, 3, 20)));
+  pairs.push_back(std::make_pair(generator.MakeDisk(0.5, 1, 3, 20),
+                                 vtkGenerator.MakeDisk(0.5, 1, 3, 20)));
+  pairs.push_back(std::make_pair(generator.MakeEllipsoid(1, 2, 3, 20, 10),
+                                 vtkGenerator.MakeEllipsoid(1, 2, 3,
+                                                            20, 10)));
+  pairs.push_back(std::make_pair(generator.MakeTorus(2, 0.5, 20, 10),
+                                 vtkGenerator.MakeTorus(2, 0.5, 20, 10)));
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    ASSERT_EQ(pairs[i].first->GetNumVertices(),
+              pairs[i].second->GetNumVertices()) << "Mesh " << i;
+    ASSERT_EQ(pairs[i].first->GetNumFaces(),
+              pairs[i].second->GetNumFaces()) << "Mesh " << i;
+  }
+}
+#endif
+
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <collision_benchmark/MeshSimplifier.hh>
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+typedef collision_benchmark::MeshShapeGenerator<float> Generator;
+typedef Generator::TriMeshData MeshDataT;
+typedef collision_benchmark::MeshSimplifier<float> Simplifier;
+
+// Checks that \e mesh is a closed manifold: each edge is shared by exactly
+// two faces with opposite orientation, there are no degenerate and no
+// duplicate faces, and the faces around each vertex form a single fan.
+static void AssertClosedManifold(const MeshDataT &mesh)
+{
+  typedef std::pair<size_t, size_t> Edge;
+  std::set<Edge> edges;
+  std::set<std::vector<size_t> > faces;
+  // for each vertex, the edges opposite to it in its faces
+  std::vector<std::vector<Edge> > fans(mesh.GetNumVertices());
+  for (size_t f = 0; f < mesh.GetNumFaces(); ++f)
+  {
+    const MeshDataT::Face face = mesh.GetFace(f);
+    ASSERT_TRUE(face[0] != face[1] && face[1] != face[2] &&
+                face[0] != face[2]) << "Face " << f << " is degenerate";
+    std::vector<size_t> sorted(face.val, face.val + 3);
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_TRUE(faces.insert(sorted).second)
+      << "Face " << f << " is a duplicate";
+    for (int k = 0; k < 3; ++k)
+    {
+      ASSERT_TRUE(edges.insert(Edge(face[k], face[(k + 1) % 3])).second)
+        << "Edge of face " << f << " is shared by more than two faces";
+      fans[face[k]].push_back(Edge(face[(k + 1) % 3], face[(k + 2) % 3]));
+    }
+  }
+  for (std::set<Edge>::const_iterator it = edges.begin();
+       it != edges.end(); ++it)
+  {
+    ASSERT_TRUE(edges.count(Edge(it->second, it->first)))
+      << "Edge " << it->first << " " << it->second << " is a border";
+  }
+  for (size_t v = 0; v < fans.size(); ++v)
+  {
+    const std::vector<Edge> &fan = fans[v];
+    if (fan.empty()) continue;
+    // walk around the vertex, which has to visit all of its faces
+    size_t visited = 1;
+    size_t current = fan[0].second;
+    while (current != fan[0].first)
+    {
+      std::vector<Edge>::const_iterator next = fan.begin();
+      while ((next != fan.end()) && (next->first != current)) ++next;
+      ASSERT_TRUE(next != fan.end()) << "Fan of vertex " << v << " is open";
+      current = next->second;
+      ASSERT_LE(++visited, fan.size())
+        << "Faces of vertex " << v << " form more than one fan";
+    }
+    ASSERT_EQ(visited, fan.size())
+      << "Faces of vertex " << v << " form more than one fan";
+  }
+}
+
+TEST(MeshSimplifierTest, LevelsOfDetail)
+{
+  collision_benchmark::MeshShapeGeneratorNative<float> nativeGenerator;
+  const Generator &generator = nativeGenerator;
+  MeshDataT::Ptr sphere = generator.MakeSphere(1, 40, 40);
+  ASSERT_NE(sphere, nullptr);
+
+  std::vector<double> ratios;
+  ratios.push_back(0.5);
+  ratios.push_back(0.1);
+  std::vector<MeshDataT::Ptr> lods = Simplifier::MakeLODs(*sphere, ratios);
+  ASSERT_EQ(lods.size(), ratios.size());
+  for (size_t i = 0; i < lods.size(); ++i)
+  {
+    ASSERT_LE(lods[i]->GetNumFaces(),
+              std::ceil(ratios[i] * sphere->GetNumFaces()));
+    ASSERT_GT(lods[i]->GetNumFaces(), 0u);
+    // the bounding box must be preserved
+    for (int k = 0; k < 3; ++k)
+    {
+      float minOrig = std::numeric_limits<float>::max();
+      float maxOrig = -minOrig;
+      float minLod = minOrig;
+      float maxLod = maxOrig;
+      for (size_t v = 0; v < sphere->GetNumVertices(); ++v)
+      {
+        minOrig = std::min(minOrig, sphere->GetVertexBuffer()[3*v + k]);
+        maxOrig = std::max(maxOrig, sphere->GetVertexBuffer()[3*v + k]);
+      }
+      for (size_t v = 0; v < lods[i]->GetNumVertices(); ++v)
+      {
+        minLod = std::min(minLod, lods[i]->GetVertexBuffer()[3*v + k]);
+        maxLod = std::max(maxLod, lods[i]->GetVertexBuffer()[3*v + k]);
+      }
+      ASSERT_EQ(minOrig, minLod) << "Bounding box changed in level " << i;
+      ASSERT_EQ(maxOrig, maxLod) << "Bounding box changed in level " << i;
+    }
+  }
+}
+
+TEST(MeshSimplifierTest, KeepsManifold)
+{
+  collision_benchmark::MeshShapeGeneratorNative<float> nativeGenerator;
+  const Generator &generator = nativeGenerator;
+  std::vector<MeshDataT::Ptr> meshes;
+  meshes.push_back(generator.MakeSphere(1, 40, 40));
+  meshes.push_back(generator.MakeTorus(2, 0.5, 33, 17));
+  meshes.push_back(generator.MakeCylinder(1, 3, 32, true));
+  meshes.push_back(generator.MakeBox(1, 2, 3));
+
+  std::vector<double> ratios;
+  ratios.push_back(0.5);
+  ratios.push_back(0.1);
+  ratios.push_back(0.01);
+  for (size_t i = 0; i < meshes.size(); ++i)
+  {
+    ASSERT_NE(meshes[i], nullptr);
+    SCOPED_TRACE(i);
+    AssertClosedManifold(*meshes[i]);
+    for (size_t r = 0; r < ratios.size(); ++r)
+    {
+      const size_t target = static_cast<size_t>
+        (std::ceil(ratios[r] * meshes[i]->GetNumFaces()));
+      MeshDataT::Ptr simplified = Simplifier::Simplify(*meshes[i], target);
+      ASSERT_NE(simplified, nullptr);
+      ASSERT_GT(simplified->GetNumFaces(), 0u);
+      AssertClosedManifold(*simplified);
+    }
+    // as far as possible, which must not collapse the mesh to
+    // overlapping faces
+    MeshDataT::Ptr minimal = Simplifier::Simplify(*meshes[i], 0);
+    ASSERT_GE(minimal->GetNumFaces(), 4u);
+    AssertClosedManifold(*minimal);
+  }
+}
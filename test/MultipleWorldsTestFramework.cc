@@ -15,26 +15,38 @@
  *
  */
 #include <test/MultipleWorldsTestFramework.hh>
+#include <test/GazeboWorldPool.hh>
 #include <collision_benchmark/PhysicsWorld.hh>
 #include <collision_benchmark/MirrorWorld.hh>
 #include <collision_benchmark/BasicTypes.hh>
+#include <collision_benchmark/SimpleTriMeshShape.hh>
 
 using collision_benchmark::MirrorWorld;
 using collision_benchmark::PhysicsWorldBaseInterface;
 using collision_benchmark::BasicState;
 using collision_benchmark::Shape;
 using collision_benchmark::GazeboMultipleWorlds;
+using collision_benchmark::GazeboWorldPool;
+using collision_benchmark::SimpleTriMeshShape;
+using collision_benchmark::MeshCache;
+
+MeshCache::Ptr MultipleWorldsTestFramework::meshCache;
 
 ////////////////////////////////////////////////////////////////
 void MultipleWorldsTestFramework::SetUp()
 {
-  server.reset(new GazeboMultipleWorlds());
+  server.reset();
+  pooled = false;
 }
 
 ////////////////////////////////////////////////////////////////
 void MultipleWorldsTestFramework::TearDown()
 {
-  if (server) server->Stop();
+  // the worlds of the pool are reset and kept for the next test
+  if (pooled) GazeboWorldPool::Instance().ReleaseAll();
+  else if (server) server->Stop();
+  server.reset();
+  pooled = false;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -42,7 +54,24 @@ void
 MultipleWorldsTestFramework::Init(const bool interactiveMode,
                                 const std::vector<std::string> &additionalGuis)
 {
-  ASSERT_NE(server, nullptr) << "server must have been created";
+  if (!interactiveMode)
+  {
+    // use the server and worlds of the pool, which uses the same
+    // settings as below
+    server = GazeboWorldPool::Instance().GetServer();
+    ASSERT_NE(server, nullptr) << "Could not create and start server";
+    pooled = true;
+    GzMultipleWorldsServer::Ptr mServer = GetServer();
+    ASSERT_NE(mServer.get(), nullptr) << "Could not create and start server";
+    ASSERT_EQ(mServer->GetWorldManager()->GetNumWorlds(), 0)
+      << "Worlds of the previous test were not released";
+    return;
+  }
+
+  // gzclient needs a server of its own, which can't be started while the
+  // server of the pool is running.
+  GazeboWorldPool::Instance().Shutdown();
+  server.reset(new GazeboMultipleWorlds());
   bool loadMirror = true;
   bool allowControlViaMirror = false;
   bool enforceContactCalc = true;
@@ -68,10 +97,23 @@ void MultipleWorldsTestFramework::InitMultipleEngines
   GzWorldManager::Ptr worldManager = mServer->GetWorldManager();
   ASSERT_NE(worldManager.get(), nullptr) << "No valid world manager created";
 
+  if (pooled)
+  {
+    for (std::vector<std::string>::const_iterator it = engines.begin();
+         it != engines.end(); ++it)
+    {
+      ASSERT_GE(GazeboWorldPool::Instance().Lease(*it), 0)
+        << "Could not prepare engine " << *it;
+    }
+    return;
+  }
+
   // world to load
   std::string worldfile = "test_worlds/void.world";
   int numWorlds = mServer->Load(worldfile, engines);
   ASSERT_EQ(numWorlds, engines.size()) << "Could not prepare all engines";
+  ASSERT_EQ(mServer->GetLoadTimings().size(), engines.size())
+    << "Load timings missing";
 }
 
 ////////////////////////////////////////////////////////////////
@@ -109,6 +151,12 @@ void MultipleWorldsTestFramework::LoadOneEngine(const std::string &engine,
   std::string worldfile = "test_worlds/void.world";
   for (int i = 0; i < numWorlds; ++i)
   {
+    if (pooled)
+    {
+      ASSERT_GE(GazeboWorldPool::Instance().Lease(engine), 0)
+        << "Could not prepare engine " << engine;
+      continue;
+    }
     std::stringstream _worldname;
     _worldname << "world_" << i << "_" << engine;
     std::string worldname = _worldname.str();
@@ -130,6 +178,8 @@ void MultipleWorldsTestFramework::LoadShape(const Shape::Ptr &shape,
 
   int numWorlds = worldManager->GetNumWorlds();
 
+  UseMeshCache(shape);
+
   // Load model
   typedef GzWorldManager::ModelLoadResult ModelLoadResult;
   std::vector<ModelLoadResult> res
@@ -168,6 +218,8 @@ void MultipleWorldsTestFramework::LoadShape(const Shape::Ptr &shape,
     GzWorldManager::ToWorldWithModel(world);
   ASSERT_NE(mWorld.get(), nullptr) << "Cast failure";
 
+  UseMeshCache(shape);
+
   // Load model
   typedef GzWorldManager::ModelLoadResult ModelLoadResult;
   ModelLoadResult res =
@@ -180,6 +232,15 @@ void MultipleWorldsTestFramework::LoadShape(const Shape::Ptr &shape,
     << "Model names should be equal";
 }
 
+////////////////////////////////////////////////////////////////
+void MultipleWorldsTestFramework::UseMeshCache(const Shape::Ptr &shape)
+{
+  if (!meshCache) return;
+  SimpleTriMeshShape::Ptr mesh =
+    std::dynamic_pointer_cast<SimpleTriMeshShape>(shape);
+  if (mesh && !mesh->GetExportCache()) mesh->SetExportCache(meshCache);
+}
+
 ////////////////////////////////////////////////////////////////
 void MultipleWorldsTestFramework::LoadModel(const std::string &modelFile,
                                             const std::string &modelName)
@@ -20,6 +20,8 @@
 #include <collision_benchmark/GazeboMultipleWorlds.hh>
 #include <collision_benchmark/GazeboWorldLoader.hh>
 #include <collision_benchmark/GazeboHelpers.hh>
+#include <collision_benchmark/MeshCache.hh>
+#include <collision_benchmark/MeshShapeGeneratorCached.hh>
 
 #include <test/TestUtils.hh>
 
@@ -62,9 +64,29 @@ class MultipleWorldsTestFramework : public ::testing::Test
     return server;
   }
 
+  // \brief Sets the cache for the meshes of all tests, see
+  // GetCachedGenerator() and LoadShape(). NULL (the default) disables it.
+  // Test executables set it with the option ``--mesh-cache <dir>``.
+  //
+  // The tests never clean up the cache directory, so that later runs can
+  // re-use the meshes. Entries are keyed by the generator version and the
+  // mesh parameters or data, so outdated entries are not used any more,
+  // but they still take up space: delete the directory to clear the cache.
+  static void SetMeshCache(const collision_benchmark::MeshCache::Ptr &cache)
+  {
+    meshCache = cache;
+  }
+
+  // \return the cache set with SetMeshCache(), or NULL if there is none
+  static collision_benchmark::MeshCache::Ptr GetMeshCache()
+  {
+    return meshCache;
+  }
+
   protected:
 
   MultipleWorldsTestFramework()
+    :pooled(false)
   {
   }
   virtual ~MultipleWorldsTestFramework()
@@ -92,6 +114,10 @@ class MultipleWorldsTestFramework : public ::testing::Test
 
   // \brief Initializes the framework and creates the world manager, but no
   // worlds are added to it.
+  // In non-interactive mode, the server and the worlds loaded with
+  // InitMultipleEngines(), InitOneEngine() and LoadOneEngine() are leased
+  // from collision_benchmark::GazeboWorldPool and are reset in TearDown()
+  // instead of being destroyed.
   // \param[in] interactiveMode load up gzclient or not
   // \param[in] additionalGuis additional GUI plugins to load with gzclient
   // Throws gtest assertions so needs to be called from top-level
@@ -134,7 +160,22 @@ class MultipleWorldsTestFramework : public ::testing::Test
   void LoadOneEngine(const std::string &engine,
                      const unsigned int numWorlds);
 
+  // \return \e generator wrapped in a MeshShapeGeneratorCached if a mesh
+  //    cache was set with SetMeshCache(), otherwise \e generator.
+  template<typename VP>
+  static typename collision_benchmark::MeshShapeGenerator<VP>::Ptr
+  GetCachedGenerator
+    (const typename collision_benchmark::MeshShapeGenerator<VP>::Ptr &generator)
+  {
+    if (!meshCache) return generator;
+    return typename collision_benchmark::MeshShapeGenerator<VP>::Ptr
+      (new collision_benchmark::MeshShapeGeneratorCached<VP>(generator,
+                                                            meshCache));
+  }
+
   // \brief Loads a shape into *all* worlds.
+  // If a mesh cache was set with SetMeshCache(), mesh shapes export their
+  // mesh files through it (see SimpleTriMeshShape::SetExportCache()).
   // You must call Init(), InitMultipleEngines() or InitOneEngine()
   // before you can use this.
   //
@@ -145,6 +186,7 @@ class MultipleWorldsTestFramework : public ::testing::Test
 
 
   // \brief Loads a shape into the worlds at the given index \e worldIdx.
+  // Uses the mesh cache like the other LoadShape().
   // You must call Init(), InitMultipleEngines() or InitOneEngine()
   // before you can use this.
   //
@@ -185,10 +227,20 @@ class MultipleWorldsTestFramework : public ::testing::Test
                 collision_benchmark::GzAABB &m2);
   private:
 
+  // Sets the mesh cache as export cache of \e shape if it is a mesh shape
+  // which does not have an export cache yet.
+  static void UseMeshCache(const collision_benchmark::Shape::Ptr &shape);
+
+  // the cache for the meshes of all tests, see SetMeshCache()
+  static collision_benchmark::MeshCache::Ptr meshCache;
+
   // the multiple worlds server which can use a client in case of interactive
   // testing with gzclient
   collision_benchmark::GazeboMultipleWorlds::Ptr server;
 
+  // true if \e server is the server of collision_benchmark::GazeboWorldPool
+  bool pooled;
+
   // node needed in RefreshClient()
   gazebo::transport::NodePtr node;
   // publisher needed in RefreshClient()
@@ -15,6 +15,7 @@
  *
  */
 #include <test/StaticTestFramework.hh>
+#include <test/GazeboWorldPool.hh>
 
 #include <collision_benchmark/PrimitiveShape.hh>
 #include <collision_benchmark/SimpleTriMeshShape.hh>
@@ -27,6 +28,19 @@
 #include <gazebo/msgs/msgs.hh>
 
 
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
 #include <sstream>
 #include <thread>
 #include <atomic>
@@ -37,22 +51,409 @@ using collision_benchmark::Vector3;
 using collision_benchmark::Quaternion;
 using collision_benchmark::PhysicsWorldBaseInterface;
 
+// exit code of a shard process whose Gazebo master could not be started,
+// e.g. because another process took its port (EX_TEMPFAIL)
+const int ShardMasterFailed = 75;
+
+// maximum number of times a shard is started again with a new port
+const unsigned int MaxShardRetries = 3;
+
+unsigned int StaticTestFramework::shardIdx = 0;
+unsigned int StaticTestFramework::numShards = 1;
+std::string StaticTestFramework::shardResultDir;
+
 ////////////////////////////////////////////////////////////////
-void StaticTestFramework::AABBTestWorldsAgreement(const std::string &modelName1,
-                                   const std::string &modelName2,
-                                   const float cellSizeFactor,
-                                   const double minAgree,
-                                   const double bbTol,
-                                   const double zeroDepthTol,
-                                   const bool interactive,
-                                   const std::string &outputBasePath,
-                                   const std::string &outputSubdir)
+// \return the name of the result file of the shard
+std::string GetShardResultFile(const std::string &dir,
+                               const unsigned int shard)
 {
-  ASSERT_GT(cellSizeFactor, 1e-07) << "Cell size factor too small";
+  std::stringstream file;
+  file << dir << "/shard_" << shard << ".txt";
+  return file.str();
+}
+
+////////////////////////////////////////////////////////////////
+// Binds a socket to a port which is free on the local host. The socket
+// has to be closed with close() right before the port is used, which
+// keeps the port from being returned again by a subsequent call and from
+// being taken by other processes in the meantime.
+// \param[out] fd the socket bound to the port
+// \return the port, or 0 if no port could be found
+unsigned short BindFreePort(int &fd)
+{
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return 0;
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  // port 0 lets the system pick a free port
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if ((bind(fd, reinterpret_cast<struct sockaddr*>(&addr), len) != 0) ||
+      (getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) != 0))
+  {
+    close(fd);
+    fd = -1;
+    return 0;
+  }
+  return ntohs(addr.sin_port);
+}
+
+////////////////////////////////////////////////////////////////
+// \return a hash of \e str which is the same in all processes
+uint64_t StableHash(const std::string &str)
+{
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+  {
+    hash ^= static_cast<unsigned char>(*it);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////
+// \return the name of the current test, or \e fallback if no test is running
+std::string GetCurrentTestName(const std::string &fallback)
+{
+  const ::testing::TestInfo *testInfo =
+    ::testing::UnitTest::GetInstance()->current_test_info();
+  if (!testInfo) return fallback;
+  return std::string(testInfo->test_case_name()) + "." + testInfo->name();
+}
+
+////////////////////////////////////////////////////////////////
+double StaticTestFramework::SweepResult::AgreementRatio() const
+{
+  const uint64_t numEvaluated = numCells - numZeroDepth - numCulled;
+  if (numEvaluated == 0) return 1;
+  return numAgree / static_cast<double>(numEvaluated);
+}
+
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::SweepResult::Merge(const SweepResult &o)
+{
+  numCells += o.numCells;
+  numZeroDepth += o.numZeroDepth;
+  numCulled += o.numCulled;
+  numAgree += o.numAgree;
+  maxContactDepth = std::max(maxContactDepth, o.maxContactDepth);
+  failures.insert(failures.end(), o.failures.begin(), o.failures.end());
+  std::stable_sort(failures.begin(), failures.end(),
+                   [](const SweepFailure &f1, const SweepFailure &f2)
+                   {
+                     return f1.cellIdx < f2.cellIdx;
+                   });
+}
+
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::SweepResult::Print(const std::string &sweepName,
+                                             std::ostream &out) const
+{
+  out << "Sweep " << sweepName << ": " << numCells << " cells, "
+      << numCulled << " culled by bounds, "
+      << numZeroDepth << " skipped as touching contacts, agreement reached in "
+      << numAgree << " (ratio " << AgreementRatio() << "), "
+      << failures.size() << " failures, max. contact depth "
+      << maxContactDepth << std::endl;
+  for (std::vector<SweepFailure>::const_iterator it = failures.begin();
+       it != failures.end(); ++it)
+  {
+    out << "  FAIL cell " << it->cellIdx << " at (" << it->x << ", "
+        << it->y << ", " << it->z << "). Agreement: " << it->positive
+        << ", " << it->negative << std::endl;
+  }
+}
+
+////////////////////////////////////////////////////////////////
+bool StaticTestFramework::IsTestOfThisShard()
+{
+  if (numShards <= 1) return true;
+  return StableHash(GetCurrentTestName("")) % numShards == shardIdx;
+}
+
+////////////////////////////////////////////////////////////////
+bool StaticTestFramework::WriteShardResult(const std::string &sweepName,
+                                           const uint64_t sliceStart,
+                                           const uint64_t sliceEnd,
+                                           const SweepResult &result)
+{
+  std::ofstream file(GetShardResultFile(shardResultDir, shardIdx).c_str(),
+                     std::ios::app);
+  if (!file.is_open()) return false;
+  file << std::setprecision(17);
+  file << "sweep " << sweepName << " " << sliceStart << " " << sliceEnd
+       << " " << result.numCells << " "
+       << result.numZeroDepth << " " << result.numCulled << " "
+       << result.numAgree << " "
+       << result.maxContactDepth << std::endl;
+  for (std::vector<SweepFailure>::const_iterator
+       it = result.failures.begin(); it != result.failures.end(); ++it)
+  {
+    file << "fail " << sweepName << " " << sliceStart << " " << sliceEnd
+         << " " << it->cellIdx << " "
+         << it->x << " " << it->y << " " << it->z << " "
+         << it->positive << " " << it->negative << std::endl;
+  }
+  return file.good();
+}
+
+////////////////////////////////////////////////////////////////
+// A sweep and the range of cells visited by a shard, which identifies
+// the result of one shard in the result files.
+struct SweepSlice
+{
+  SweepSlice(const std::string &_sweepName, const uint64_t _start,
+             const uint64_t _end)
+    : sweepName(_sweepName), start(_start), end(_end) {}
+  bool operator<(const SweepSlice &o) const
+  {
+    if (sweepName != o.sweepName) return sweepName < o.sweepName;
+    if (start != o.start) return start < o.start;
+    return end < o.end;
+  }
+  std::string sweepName;
+  uint64_t start, end;
+};
+
+////////////////////////////////////////////////////////////////
+// Reads all results written with WriteShardResult() from \e fileName
+// and adds them to \e slices. If a slice of a sweep is written more
+// than once (e.g. when the tests are repeated), the last result is used.
+bool ReadShardResults(const std::string &fileName,
+                      std::map<SweepSlice,
+                               StaticTestFramework::SweepResult> &slices)
+{
+  std::ifstream file(fileName.c_str());
+  // a shard which did not run any sweep does not write a file
+  if (!file.is_open()) return true;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.empty()) continue;
+    std::stringstream str(line);
+    std::string type;
+    SweepSlice slice("", 0, 0);
+    str >> type >> slice.sweepName >> slice.start >> slice.end;
+    if (type == "sweep")
+    {
+      // the failures of this slice follow this line
+      StaticTestFramework::SweepResult r;
+      str >> r.numCells >> r.numZeroDepth >> r.numCulled >> r.numAgree
+          >> r.maxContactDepth;
+      slices[slice] = r;
+    }
+    else if (type == "fail")
+    {
+      std::map<SweepSlice, StaticTestFramework::SweepResult>::iterator
+        it = slices.find(slice);
+      if (it == slices.end())
+      {
+        std::cerr << "Failure without result in " << fileName << ": "
+                  << line << std::endl;
+        return false;
+      }
+      StaticTestFramework::SweepFailure f;
+      str >> f.cellIdx >> f.x >> f.y >> f.z >> f.positive >> f.negative;
+      it->second.failures.push_back(f);
+    }
+    else
+    {
+      std::cerr << "Unknown entry in " << fileName << ": " << line
+                << std::endl;
+      return false;
+    }
+    if (str.fail())
+    {
+      std::cerr << "Could not parse line in " << fileName << ": " << line
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+int StaticTestFramework::RunShards(const unsigned int _numShards,
+                                   const std::function<int(void)> &runTests)
+{
+  if (_numShards <= 1) return runTests();
+
+  char dirTemplate[] = "/tmp/static_test_shards_XXXXXX";
+  if (!mkdtemp(dirTemplate))
+  {
+    std::cerr << "Could not create directory for shard results" << std::endl;
+    return 1;
+  }
+  const std::string resultDir(dirTemplate);
+
+  // flush before forking so that buffered output is not printed twice
+  std::cout << std::flush;
+  std::cerr << std::flush;
+
+  // Each shard needs its own Gazebo master. The ports are picked by the
+  // system, so that several test runs on the same host don't collide.
+  // All sockets are kept open until all shards are started, so that each
+  // shard gets a different port. Each shard keeps the socket bound to its
+  // port until right before its master starts. If another process takes
+  // the port in between anyway, the shard is started again with a new port.
+  std::vector<unsigned short> ports(_numShards, 0);
+  std::vector<int> portSockets(_numShards, -1);
+  bool portsFound = true;
+  for (unsigned int i = 0; i < _numShards; ++i)
+  {
+    ports[i] = BindFreePort(portSockets[i]);
+    if (ports[i] == 0) portsFound = false;
+  }
+  if (!portsFound)
+  {
+    std::cerr << "Could not find free ports for the shards" << std::endl;
+    for (unsigned int i = 0; i < _numShards; ++i)
+    {
+      if (portSockets[i] >= 0) close(portSockets[i]);
+    }
+    rmdir(resultDir.c_str());
+    return 1;
+  }
+
+  // starts the process of shard \e shard with its master on ports[shard]
+  std::function<pid_t(unsigned int)> startShard =
+    [&](const unsigned int shard)
+    {
+      pid_t pid = fork();
+      if (pid != 0) return pid;
+
+      // child process
+      for (unsigned int i = 0; i < _numShards; ++i)
+      {
+        if ((i != shard) && (portSockets[i] >= 0)) close(portSockets[i]);
+      }
+      std::stringstream masterUri;
+      masterUri << "http://localhost:" << ports[shard];
+      setenv("GAZEBO_MASTER_URI", masterUri.str().c_str(), 1);
+      shardIdx = shard;
+      numShards = _numShards;
+      shardResultDir = resultDir;
+      // release the port right before the master is started on it
+      close(portSockets[shard]);
+      if (!collision_benchmark::GazeboWorldPool::Instance().GetServer())
+      {
+        std::cerr << "Could not start the Gazebo master of shard " << shard
+                  << " on port " << ports[shard] << std::endl;
+        // no static destructors, gazebo may be partially initialized
+        _exit(ShardMasterFailed);
+      }
+      std::exit(runTests());
+    };
+
+  std::map<pid_t, unsigned int> running;
+  std::vector<unsigned int> numRetries(_numShards, 0);
+  int exitCode = 0;
+  for (unsigned int i = 0; i < _numShards; ++i)
+  {
+    pid_t pid = startShard(i);
+    if (pid < 0)
+    {
+      std::cerr << "Failed to fork process for shard " << i << std::endl;
+      exitCode = 1;
+      break;
+    }
+    running[pid] = i;
+  }
+  for (unsigned int i = 0; i < _numShards; ++i)
+  {
+    if (portSockets[i] >= 0) close(portSockets[i]);
+    portSockets[i] = -1;
+  }
+
+  while (!running.empty())
+  {
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0)
+    {
+      std::cerr << "Failed to wait for the shards" << std::endl;
+      exitCode = 1;
+      break;
+    }
+    std::map<pid_t, unsigned int>::iterator it = running.find(pid);
+    if (it == running.end()) continue;
+    const unsigned int shard = it->second;
+    running.erase(it);
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) continue;
+
+    if (WIFEXITED(status) && (WEXITSTATUS(status) == ShardMasterFailed) &&
+        (numRetries[shard] < MaxShardRetries))
+    {
+      ++numRetries[shard];
+      // the ports of the other shards are in use by their masters, so
+      // this is a new port
+      ports[shard] = BindFreePort(portSockets[shard]);
+      if (ports[shard] != 0)
+      {
+        std::cout << "Restarting shard " << shard << " on port "
+                  << ports[shard] << std::endl;
+        pid_t newPid = startShard(shard);
+        close(portSockets[shard]);
+        portSockets[shard] = -1;
+        if (newPid > 0)
+        {
+          running[newPid] = shard;
+          continue;
+        }
+      }
+    }
+    exitCode = 1;
+  }
+
+  // merge the results of all shards. The slices are merged in order of
+  // the sweep and the cell range, and failures are sorted by cell, so the
+  // report is deterministic.
+  std::map<SweepSlice, SweepResult> slices;
+  for (unsigned int i = 0; i < _numShards; ++i)
+  {
+    const std::string fileName = GetShardResultFile(resultDir, i);
+    if (!ReadShardResults(fileName, slices))
+    {
+      exitCode = 1;
+    }
+    std::remove(fileName.c_str());
+  }
+  rmdir(resultDir.c_str());
+
+  std::map<std::string, SweepResult> results;
+  for (std::map<SweepSlice, SweepResult>::const_iterator
+       it = slices.begin(); it != slices.end(); ++it)
+  {
+    results[it->first.sweepName].Merge(it->second);
+  }
+
+  std::cout << "Merged results of " << _numShards << " shards:"
+            << std::endl;
+  for (std::map<std::string, SweepResult>::iterator it = results.begin();
+       it != results.end(); ++it)
+  {
+    it->second.Print(it->first, std::cout);
+  }
+  return exitCode;
+}
 
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::PrepareSweep(const std::string &modelName1,
+                                       const std::string &modelName2,
+                                       const double bbTol,
+                                       const bool interactive,
+                                       GzWorldManager::Ptr &worldManager,
+                                       collision_benchmark::GzAABB &aabb1,
+                                       collision_benchmark::GzAABB &aabb2,
+                          collision_benchmark::GzBoundingSphere &sphere1,
+                          collision_benchmark::GzBoundingSphere &sphere2,
+                                       collision_benchmark::GzAABB &grid)
+{
   GzMultipleWorldsServer::Ptr mServer = GetServer();
   ASSERT_NE(mServer.get(), nullptr) << "Could not create and start server";
-  GzWorldManager::Ptr worldManager = mServer->GetWorldManager();
+  worldManager = mServer->GetWorldManager();
   ASSERT_NE(worldManager.get(), nullptr) << "No valid world manager created";
 
   worldManager->SetDynamicsEnabled(false);
@@ -68,37 +469,34 @@ void StaticTestFramework::AABBTestWorldsAgreement(const std::string &modelName1,
   BasicState originPose;
   originPose.SetPosition(Vector3(0, 0, 0));
   originPose.SetRotation(Quaternion(0, 0, 0, 1));
-  int cnt1 = worldManager->SetBasicModelState(modelName1, originPose);
-  ASSERT_EQ(cnt1, numWorlds) << "All worlds should have been updated";
-  int cnt2 = worldManager->SetBasicModelState(modelName2, originPose);
-  ASSERT_EQ(cnt2, numWorlds) << "All worlds should have been updated";
+  std::vector<GzWorldManager::ModelStateEntry> originStates;
+  originStates.push_back(std::make_pair(modelName1, originPose));
+  originStates.push_back(std::make_pair(modelName2, originPose));
+  int cnt = worldManager->SetBasicModelStates(originStates);
+  ASSERT_EQ(cnt, numWorlds) << "All worlds should have been updated";
 
   // now, get the model AABBs and displace model 2 relative to model 1
-  collision_benchmark::GzAABB aabb1, aabb2;
   ASSERT_TRUE(GetAABBs(modelName1, modelName2, bbTol, aabb1, aabb2));
+  ASSERT_TRUE(collision_benchmark::GetBoundingSphere(modelName1,
+                                                     worldManager, sphere1));
+  ASSERT_TRUE(collision_benchmark::GetBoundingSphere(modelName2,
+                                                     worldManager, sphere2));
 
   // std::cout << "Got AABB 1: " <<  aabb1.min << ", "
   //           << aabb1.max << std::endl;
   // std::cout << "Got AABB 2: " <<  aabb2.min << ", "
   //           << aabb2.max << std::endl;
 
-  collision_benchmark::GzAABB grid = aabb1;
+  grid = aabb1;
   grid.min -= aabb2.size() / 2;
   grid.max += aabb2.size() / 2;
 
   // place model 2 at start position
   BasicState bstate2;
   bstate2.SetPosition(Vector3(grid.min.X(), grid.min.Y(), grid.min.Z()));
-  int cnt = worldManager->SetBasicModelState(modelName2, bstate2);
+  cnt = worldManager->SetBasicModelState(modelName2, bstate2);
   ASSERT_EQ(cnt, numWorlds) << "All worlds should have been updated";
 
-  const float cellSizeX = grid.size().X() * cellSizeFactor;
-  const float cellSizeY = grid.size().Y() * cellSizeFactor;
-  const float cellSizeZ = grid.size().Z() * cellSizeFactor;
-  /* std::cout << "GRID : " <<  grid.min << ", " << grid.max << std::endl;
-  std::cout << "cell size : " <<  cellSizeX << ", " <<cellSizeY << ", "
-            << cellSizeZ << std::endl; */
-
   if (interactive)
   {
     std::cout << "Check that gzclient is up and then press [Enter] to continue." << std::endl;
@@ -107,138 +505,447 @@ void StaticTestFramework::AABBTestWorldsAgreement(const std::string &modelName1,
 
   // start the update loop
   std::cout << "Now starting to update worlds." << std::endl;
+}
 
-  int msSleep = 0;  // delay for running the test
-  double eps = 1e-07;
-  unsigned int itCnt = 0;
-  unsigned int failCnt = 0;
-  for (double x = grid.min.X(); x < grid.max.X()+eps; x += cellSizeX)
-  for (double y = grid.min.Y(); y < grid.max.Y()+eps; y += cellSizeY)
-  for (double z = grid.min.Z(); z < grid.max.Z()+eps; z += cellSizeZ)
+////////////////////////////////////////////////////////////////
+bool StaticTestFramework::BoundsMayCollide(
+                      const collision_benchmark::GzAABB &aabb1,
+                      const collision_benchmark::GzAABB &aabb2,
+                      const collision_benchmark::GzBoundingSphere &sphere1,
+                      const collision_benchmark::GzBoundingSphere &sphere2,
+                      const double x,
+                      const double y,
+                      const double z,
+                      const double tolerance)
+{
+  // The models can only collide if their AABBs overlap along all axes
+  // and their bounding spheres overlap. The bounds are only known up to
+  // the tolerance, so a gap of up to the tolerance between them is still
+  // treated as overlapping.
+  const ignition::math::Vector3d pos(x, y, z);
+  const double centerDist =
+    (sphere1.center - (sphere2.center + pos)).Length();
+  if (centerDist > sphere1.radius + sphere2.radius + tolerance)
+    return false;
+  const ignition::math::Vector3d min2 = aabb2.min + pos;
+  const ignition::math::Vector3d max2 = aabb2.max + pos;
+  for (unsigned int i = 0; i < 3; ++i)
   {
-    ++itCnt;
-    // std::cout << "Placing model 2 at " << x<<", " << y<<", " << z<<std::endl;
-    bstate2.position.x = x;
-    bstate2.position.y = y;
-    bstate2.position.z = z;
-    cnt = worldManager->SetBasicModelState(modelName2, bstate2);
-    ASSERT_EQ(cnt, numWorlds) << "All worlds should have been updated";
-
-    int numSteps = 1;
-    worldManager->Update(numSteps);
-    if (msSleep > 0) gazebo::common::Time::MSleep(msSleep);
-
-    std::vector<std::string> colliding, notColliding;
-    double maxContactDepth;
-    ASSERT_TRUE(collision_benchmark::CollisionState(modelName1, modelName2,
-                                                    worldManager, colliding,
-                                                    notColliding,
-                                                    maxContactDepth));
+    const double overlap = std::min(aabb1.max[i], max2[i]) -
+                           std::max(aabb1.min[i], min2[i]);
+    if (overlap < -tolerance) return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::EvaluateCell(const std::string &modelName1,
+                                       const std::string &modelName2,
+                                       const GzWorldManager::Ptr &worldManager,
+                                       const double x,
+                                       const double y,
+                                       const double z,
+                                       const uint64_t cellIdx,
+                                       const double minAgree,
+                                       const double zeroDepthTol,
+                                       const bool interactive,
+                                       const std::string &outputBasePath,
+                                       const std::string &outputSubdir,
+                                       SweepResult &result,
+                                       CellState &state)
+{
+  int msSleep = 0;  // delay for running the test
+  int numWorlds = worldManager->GetNumWorlds();
+  ++result.numCells;
+
+  // std::cout << "Placing model 2 at " << x<<", " << y<<", " << z<<std::endl;
+  // set the pose and update the worlds by one step in one pass
+  std::vector<GzWorldManager::ModelStateEntry> states(1);
+  states[0].first = modelName2;
+  states[0].second.SetPosition(Vector3(x, y, z));
+  int cnt = worldManager->SetBasicModelStates(states, NULL, true);
+  ASSERT_EQ(cnt, numWorlds) << "All worlds should have been updated";
+  if (msSleep > 0) gazebo::common::Time::MSleep(msSleep);
+
+  std::vector<std::string> colliding, notColliding;
+  double maxContactDepth;
+  ASSERT_TRUE(collision_benchmark::CollisionState(modelName1, modelName2,
+                                                  worldManager, colliding,
+                                                  notColliding,
+                                                  maxContactDepth));
 # if 0
-    // For TESTING: stop at every colliding state
-    int stopX = 5;
-    if (!colliding.empty()&& ((itCnt % stopX) == 0))
-    {
-      std::stringstream str;
-      str << std::endl << "Colliding: " << std::endl << " ------ " << std::endl;
-      for (std::vector<std::string>::iterator it = colliding.begin();
-           it != colliding.end(); ++it)
-      {
-        if (it != colliding.begin()) str << std::endl;
-        std::vector<GzContactInfoPtr> contacts =
-          collision_benchmark::GetContactInfo(modelName1, modelName2,
-                                              *it, worldManager);
-        str << *it << ": " << VectorPtrToString(contacts);
-      }
-      RefreshClient(5);
-      collision_benchmark::UpdateUntilEnter(worldManager);
+  // For TESTING: stop at every colliding state
+  int stopX = 5;
+  if (!colliding.empty()&& ((result.numCells % stopX) == 0))
+  {
+    std::stringstream str;
+    str << std::endl << "Colliding: " << std::endl << " ------ " << std::endl;
+    for (std::vector<std::string>::iterator it = colliding.begin();
+         it != colliding.end(); ++it)
+    {
+      if (it != colliding.begin()) str << std::endl;
+      std::vector<GzContactInfoPtr> contacts =
+        collision_benchmark::GetContactInfo(modelName1, modelName2,
+                                            *it, worldManager);
+      str << *it << ": " << VectorPtrToString(contacts);
     }
+    RefreshClient(5);
+    collision_benchmark::UpdateUntilEnter(worldManager);
+  }
 #endif
 
-    if (!colliding.empty() && (fabs(maxContactDepth) < zeroDepthTol))
+  if (!colliding.empty() && (fabs(maxContactDepth) < zeroDepthTol))
+  {
+    // if contacts were found but they are just surface contacts,
+    // skip this because engines are actually allowed to disagree.
+    // std::cout << "DEBUG-INFO: Not considering case of maximum depth 0 "
+    //          << "because this is a borderline case" << std::endl;
+    ++result.numZeroDepth;
+    state = CELL_TOUCHING;
+    return;
+  }
+
+  if (!colliding.empty())
+    result.maxContactDepth = std::max(result.maxContactDepth,
+                                      maxContactDepth);
+
+  size_t total = colliding.size() + notColliding.size();
+
+  ASSERT_EQ(numWorlds, total) << "All worlds must have voted";
+  ASSERT_GT(total, 0) << "This should have been caught before";
+
+  double negative = notColliding.size() / static_cast<double>(total);
+  double positive= colliding.size() / static_cast<double>(total);
+
+  if (((positive > negative) && (positive < minAgree)) ||
+      ((positive <= negative) && (negative < minAgree)))
+  {
+    state = CELL_DISAGREE;
+    const unsigned int failCnt = result.failures.size();
+    SweepFailure failure;
+    failure.cellIdx = cellIdx;
+    failure.x = x;
+    failure.y = y;
+    failure.z = z;
+    failure.positive = positive;
+    failure.negative = negative;
+    result.failures.push_back(failure);
+
+    std::stringstream str;
+    std::cout << "FAIL " << failCnt << ": Minimum agreement not reached. "
+              << "Agreement: " << positive << ", " << negative << std::endl;
+
+    // str << " Collision: "<< VectorToString(colliding) << ", no collision: "
+    //     << VectorToString(notColliding) << ".";
+
+    str << "------ " << std::endl;
+    str << "Colliding: " << std::endl
+        << "------ " << std::endl;
+    for (std::vector<std::string>::iterator it = colliding.begin();
+         it != colliding.end(); ++it)
     {
-      // if contacts were found but they are just surface contacts,
-      // skip this because engines are actually allowed to disagree.
-      // std::cout << "DEBUG-INFO: Not considering case of maximum depth 0 "
-      //          << "because this is a borderline case" << std::endl;
-      continue;
+      if (it != colliding.begin()) str << std::endl;
+      std::vector<GzContactInfoPtr> contacts =
+        collision_benchmark::GetContactInfo(modelName1, modelName2,
+                                            *it, worldManager);
+      str << *it << ": " << VectorPtrToString(contacts);
     }
 
-    size_t total = colliding.size() + notColliding.size();
-
-    ASSERT_EQ(numWorlds, total) << "All worlds must have voted";
-    ASSERT_GT(total, 0) << "This should have been caught before";
+    str << std::endl;
+    str << "------ " << std::endl;
+    str << "Not colliding: " << std::endl
+        << "------ " << std::endl;
+    for (std::vector<std::string>::iterator it = notColliding.begin();
+         it != notColliding.end(); ++it)
+    {
+      if (it != notColliding.begin()) str << std::endl;
+      std::vector<GzContactInfoPtr> contacts =
+        collision_benchmark::GetContactInfo(modelName1, modelName2,
+                                            *it, worldManager);
+      str << *it << ": " << VectorPtrToString(contacts);
+    }
+    str << std::endl;
 
-    double negative = notColliding.size() / static_cast<double>(total);
-    double positive= colliding.size() / static_cast<double>(total);
+    if (!outputBasePath.empty() &&
+        collision_benchmark::makeDirectoryIfNeeded(outputBasePath+
+                                                   "/"+outputSubdir))
+    {
+      std::stringstream namePrefix;
+      namePrefix << "STest_";
+      if (numShards > 1) namePrefix << "shard" << shardIdx << "_";
+      namePrefix << "fail_" << failCnt << "_";
+      int nFails = worldManager->SaveAllWorlds(outputBasePath,
+                                               outputSubdir,
+                                               namePrefix.str(),
+                                               "world", true);
+      std::cout << "Worlds written to " << outputBasePath
+                << "/" << outputSubdir
+                << " (failed: "<< nFails << ")" <<std::endl;
+    }
 
-    if (((positive > negative) && (positive < minAgree)) ||
-        ((positive <= negative) && (negative < minAgree)))
+    if (interactive)
+    {
+      std::cout << str.str() << std::endl
+                << "Press [Enter] to continue." << std::endl;
+      RefreshClient(5);
+      collision_benchmark::UpdateUntilEnter(worldManager);
+    }
+    else
     {
-      std::stringstream str;
-      std::cout << "FAIL " << failCnt << ": Minimum agreement not reached. "
-                << "Agreement: " << positive << ", " << negative << std::endl;
+      // trigger a test failure
+      EXPECT_TRUE(false) << str.str();
+    }
+  }
+  else
+  {
+    state = (positive > negative) ? CELL_COLLIDING : CELL_NOT_COLLIDING;
+    ++result.numAgree;
+  }
+}
+
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::FinishSweep(const std::string &modelName1,
+                                      const std::string &modelName2,
+                                      const uint64_t sliceStart,
+                                      const uint64_t sliceEnd,
+                                      const SweepResult &result)
+{
+  const std::string sweepName =
+    GetCurrentTestName(modelName1 + "_" + modelName2);
+  result.Print(sweepName, std::cout);
+  lastSweepResult = result;
+  if (numShards > 1)
+  {
+    ASSERT_TRUE(WriteShardResult(sweepName, sliceStart, sliceEnd, result))
+      << "Could not write result of shard " << shardIdx;
+  }
+}
 
-      // str << " Collision: "<< VectorToString(colliding) << ", no collision: "
-      //     << VectorToString(notColliding) << ".";
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::AABBTestWorldsAgreement(const std::string &modelName1,
+                                   const std::string &modelName2,
+                                   const float cellSizeFactor,
+                                   const double minAgree,
+                                   const double bbTol,
+                                   const double zeroDepthTol,
+                                   const bool interactive,
+                                   const std::string &outputBasePath,
+                                   const std::string &outputSubdir)
+{
+  ASSERT_GT(cellSizeFactor, 1e-07) << "Cell size factor too small";
 
-      str << "------ " << std::endl;
-      str << "Colliding: " << std::endl
-          << "------ " << std::endl;
-      for (std::vector<std::string>::iterator it = colliding.begin();
-           it != colliding.end(); ++it)
-      {
-        if (it != colliding.begin()) str << std::endl;
-        std::vector<GzContactInfoPtr> contacts =
-          collision_benchmark::GetContactInfo(modelName1, modelName2,
-                                              *it, worldManager);
-        str << *it << ": " << VectorPtrToString(contacts);
-      }
+  GzWorldManager::Ptr worldManager;
+  collision_benchmark::GzAABB aabb1, aabb2, grid;
+  collision_benchmark::GzBoundingSphere sphere1, sphere2;
+  ASSERT_NO_FATAL_FAILURE(PrepareSweep(modelName1, modelName2, bbTol,
+                                       interactive, worldManager,
+                                       aabb1, aabb2, sphere1, sphere2,
+                                       grid));
 
-      str << std::endl;
-      str << "------ " << std::endl;
-      str << "Not colliding: " << std::endl
-          << "------ " << std::endl;
-      for (std::vector<std::string>::iterator it = notColliding.begin();
-           it != notColliding.end(); ++it)
-      {
-        if (it != notColliding.begin()) str << std::endl;
-        std::vector<GzContactInfoPtr> contacts =
-          collision_benchmark::GetContactInfo(modelName1, modelName2,
-                                              *it, worldManager);
-        str << *it << ": " << VectorPtrToString(contacts);
-      }
-      str << std::endl;
+  const float cellSizeX = grid.size().X() * cellSizeFactor;
+  const float cellSizeY = grid.size().Y() * cellSizeFactor;
+  const float cellSizeZ = grid.size().Z() * cellSizeFactor;
+  /* std::cout << "GRID : " <<  grid.min << ", " << grid.max << std::endl;
+  std::cout << "cell size : " <<  cellSizeX << ", " <<cellSizeY << ", "
+            << cellSizeZ << std::endl; */
 
-      if (!outputBasePath.empty() &&
-          collision_benchmark::makeDirectoryIfNeeded(outputBasePath+
-                                                     "/"+outputSubdir))
+  double eps = 1e-07;
+
+  // The grid coordinates along each axis. They are computed by stepping
+  // through the grid, so that each cell can be addressed by its index.
+  std::vector<double> gridX, gridY, gridZ;
+  for (double x = grid.min.X(); x < grid.max.X()+eps; x += cellSizeX)
+    gridX.push_back(x);
+  for (double y = grid.min.Y(); y < grid.max.Y()+eps; y += cellSizeY)
+    gridY.push_back(y);
+  for (double z = grid.min.Z(); z < grid.max.Z()+eps; z += cellSizeZ)
+    gridZ.push_back(z);
+
+  // the range of cells to visit, which is a share of all cells if the
+  // test runs in shards.
+  const uint64_t numCells = gridX.size() * gridY.size() * gridZ.size();
+  const uint64_t cellStart = numCells * shardIdx / numShards;
+  const uint64_t cellEnd = numCells * (shardIdx + 1) / numShards;
+  if (numShards > 1)
+  {
+    std::cout << "Shard " << shardIdx << " of " << numShards
+              << " visiting cells " << cellStart << " to " << cellEnd
+              << " of " << numCells << std::endl;
+  }
+
+  SweepResult result;
+  for (uint64_t cellIdx = cellStart; cellIdx < cellEnd; ++cellIdx)
+  {
+    const double x = gridX[cellIdx / (gridY.size() * gridZ.size())];
+    const double y = gridY[(cellIdx / gridZ.size()) % gridY.size()];
+    const double z = gridZ[cellIdx % gridZ.size()];
+    if (!BoundsMayCollide(aabb1, aabb2, sphere1, sphere2,
+                          x, y, z, bbTol))
+    {
+      ++result.numCells;
+      ++result.numCulled;
+      continue;
+    }
+    CellState state;
+    ASSERT_NO_FATAL_FAILURE(EvaluateCell(modelName1, modelName2, worldManager,
+                                         x, y, z, cellIdx, minAgree,
+                                         zeroDepthTol, interactive,
+                                         outputBasePath, outputSubdir,
+                                         result, state));
+  }
+  ASSERT_NO_FATAL_FAILURE(FinishSweep(modelName1, modelName2,
+                                      cellStart, cellEnd, result));
+  std::cout << "TwoModels test finished. " << std::endl;
+}
+
+////////////////////////////////////////////////////////////////
+void StaticTestFramework::AABBTestWorldsAgreementAdaptive(
+                                   const std::string &modelName1,
+                                   const std::string &modelName2,
+                                   const float coarseCellSizeFactor,
+                                   const float minCellSizeFactor,
+                                   const double minAgree,
+                                   const double bbTol,
+                                   const double zeroDepthTol,
+                                   const bool interactive,
+                                   const std::string &outputBasePath,
+                                   const std::string &outputSubdir)
+{
+  // The lattice points are indexed with a 64 bit integer, so there may be
+  // at most 2^21 points along each axis.
+  const uint64_t maxPointsPerAxis = 1ull << 21;
+  ASSERT_GE(minCellSizeFactor, 1.0 / (maxPointsPerAxis - 1))
+    << "Minimum cell size factor too small, the grid points can't be indexed";
+  ASSERT_LE(minCellSizeFactor, 1) << "Minimum cell size factor too large";
+  ASSERT_GE(coarseCellSizeFactor, minCellSizeFactor)
+    << "Coarse cells can't be smaller than the minimum cell size";
+
+  if (!IsTestOfThisShard())
+  {
+    // the refinement depends on the results of neighbouring cells,
+    // so the adaptive sweep is not split into shards but runs as a
+    // whole in one of them.
+    std::cout << "Adaptive sweep runs in another shard." << std::endl;
+    return;
+  }
+
+  GzWorldManager::Ptr worldManager;
+  collision_benchmark::GzAABB aabb1, aabb2, grid;
+  collision_benchmark::GzBoundingSphere sphere1, sphere2;
+  ASSERT_NO_FATAL_FAILURE(PrepareSweep(modelName1, modelName2, bbTol,
+                                       interactive, worldManager,
+                                       aabb1, aabb2, sphere1, sphere2,
+                                       grid));
+
+  const double eps = 1e-07;
+  // number of coarse cells along each axis
+  const uint64_t numCoarse = std::max(static_cast<uint64_t>(1),
+    static_cast<uint64_t>(std::ceil(1.0 / coarseCellSizeFactor - eps)));
+  // number of times a coarse cell may be split in halves until the
+  // minimum cell size is reached. The number of points along an axis is
+  // kept within maxPointsPerAxis, so the minimum cell size may end up
+  // slightly larger than requested if it's close to this limit.
+  unsigned int maxLevel = 0;
+  while (((numCoarse << (maxLevel + 1)) < maxPointsPerAxis) &&
+         (1.0 / (numCoarse << maxLevel) > minCellSizeFactor + eps))
+    ++maxLevel;
+
+  // All cell corners are points on the lattice of the smallest cells,
+  // and they are addressed by their integer coordinates on this lattice.
+  const uint64_t fineUnits = static_cast<uint64_t>(1) << maxLevel;
+  const uint64_t numPoints = numCoarse * fineUnits + 1;
+  const ignition::math::Vector3d fineCellSize =
+    grid.size() / static_cast<double>(numCoarse * fineUnits);
+
+  // states of all lattice points evaluated so far, by their index
+  std::map<uint64_t, CellState> visited;
+  SweepResult result;
+
+  // a cell of the octree, given by its minimum corner and its edge
+  // length in units of the smallest cells
+  struct OctreeCell
+  {
+    uint64_t x, y, z, size;
+  };
+  std::vector<OctreeCell> cells;
+  for (uint64_t cx = numCoarse; cx-- > 0;)
+    for (uint64_t cy = numCoarse; cy-- > 0;)
+      for (uint64_t cz = numCoarse; cz-- > 0;)
       {
-        std::stringstream namePrefix;
-        namePrefix << "STest_fail_" << failCnt << "_";
-        int nFails = worldManager->SaveAllWorlds(outputBasePath,
-                                                 outputSubdir,
-                                                 namePrefix.str(),
-                                                 "world", true);
-        std::cout << "Worlds written to " << outputBasePath
-                  << "/" << outputSubdir
-                  << " (failed: "<< nFails << ")" <<std::endl;
+        OctreeCell c = {cx * fineUnits, cy * fineUnits, cz * fineUnits,
+                        fineUnits};
+        cells.push_back(c);
       }
 
-      if (interactive)
+  // Depth-first traversal, cells are split as long as their corners
+  // don't all agree on the same collision state.
+  while (!cells.empty())
+  {
+    const OctreeCell cell = cells.back();
+    cells.pop_back();
+
+    bool uniform = true;
+    CellState firstState = CELL_DISAGREE;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+      const uint64_t ix = cell.x + ((i & 4) ? cell.size : 0);
+      const uint64_t iy = cell.y + ((i & 2) ? cell.size : 0);
+      const uint64_t iz = cell.z + ((i & 1) ? cell.size : 0);
+      const uint64_t pointIdx = (ix * numPoints + iy) * numPoints + iz;
+      std::map<uint64_t, CellState>::const_iterator it =
+        visited.find(pointIdx);
+      CellState state;
+      if (it != visited.end())
       {
-        std::cout << str.str() << std::endl
-                  << "Press [Enter] to continue." << std::endl;
-        RefreshClient(5);
-        collision_benchmark::UpdateUntilEnter(worldManager);
+        state = it->second;
       }
       else
       {
-        // trigger a test failure
-        EXPECT_TRUE(false) << str.str();
+        const double x = grid.min.X() + ix * fineCellSize.X();
+        const double y = grid.min.Y() + iy * fineCellSize.Y();
+        const double z = grid.min.Z() + iz * fineCellSize.Z();
+        if (!BoundsMayCollide(aabb1, aabb2, sphere1, sphere2,
+                              x, y, z, bbTol))
+        {
+          ++result.numCells;
+          ++result.numCulled;
+          state = CELL_NOT_COLLIDING;
+        }
+        else
+        {
+          ASSERT_NO_FATAL_FAILURE(EvaluateCell(modelName1, modelName2,
+                                      worldManager, x, y, z,
+                                      pointIdx, minAgree, zeroDepthTol,
+                                      interactive, outputBasePath,
+                                      outputSubdir, result, state));
+        }
+        visited[pointIdx] = state;
       }
-      ++failCnt;
+      if (i == 0) firstState = state;
+      // touching contacts and disagreements are on the contact boundary,
+      // so cells with such corners are always refined.
+      if ((state != firstState) ||
+          ((state != CELL_COLLIDING) && (state != CELL_NOT_COLLIDING)))
+        uniform = false;
+    }
+
+    if (uniform || (cell.size <= 1)) continue;
+
+    const uint64_t half = cell.size / 2;
+    for (unsigned int i = 8; i-- > 0;)
+    {
+      OctreeCell child = {cell.x + ((i & 4) ? half : 0),
+                          cell.y + ((i & 2) ? half : 0),
+                          cell.z + ((i & 1) ? half : 0), half};
+      cells.push_back(child);
     }
   }
+
+  std::cout << "Adaptive sweep visited " << result.numCells << " of "
+            << numPoints * numPoints * numPoints
+            << " grid points at the minimum cell size." << std::endl;
+  ASSERT_NO_FATAL_FAILURE(FinishSweep(modelName1, modelName2, 0,
+                                      numPoints * numPoints * numPoints,
+                                      result));
   std::cout << "TwoModels test finished. " << std::endl;
 }
@@ -21,6 +21,9 @@
 #include <test/TestUtils.hh>
 #include <collision_benchmark/Shape.hh>
 
+#include <cstdint>
+#include <functional>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -35,6 +38,77 @@
  */
 class StaticTestFramework : public MultipleWorldsTestFramework
 {
+ public:
+  // A grid cell at which the engines did not reach the minimum agreement
+  struct SweepFailure
+  {
+    SweepFailure(): cellIdx(0), x(0), y(0), z(0), positive(0), negative(0) {}
+    // index of the cell in the grid, in order of the x/y/z loop
+    uint64_t cellIdx;
+    // position of model 2
+    double x, y, z;
+    // proportion of engines which found collision / no collision
+    double positive, negative;
+  };
+
+  // Statistics of a run of AABBTestWorldsAgreement(), or a part of it
+  // when the grid is split into shards.
+  struct SweepResult
+  {
+    SweepResult(): numCells(0), numZeroDepth(0), numCulled(0), numAgree(0),
+                   maxContactDepth(0) {}
+    // number of grid cells visited
+    uint64_t numCells;
+    // number of cells skipped because the contacts were just touching
+    uint64_t numZeroDepth;
+    // number of cells which were not evaluated because the bounds of the
+    // models are disjoint, so they can't collide
+    uint64_t numCulled;
+    // number of cells at which the minimum agreement was reached
+    uint64_t numAgree;
+    // largest contact depth found in any world at any cell
+    double maxContactDepth;
+    // all cells which failed, sorted by cell index
+    std::vector<SweepFailure> failures;
+
+    // \return proportion of the evaluated cells (which were neither
+    //    skipped nor culled) in which the minimum agreement was reached
+    double AgreementRatio() const;
+
+    // Adds the statistics of \e o to this result. The failures are kept
+    // sorted by cell index, so the merged result does not depend on the
+    // order in which results are merged.
+    void Merge(const SweepResult &o);
+
+    // Prints a summary of the result
+    void Print(const std::string &sweepName, std::ostream &out) const;
+  };
+
+  // Runs the tests in \e numShards processes. Each grid sweep done with
+  // AABBTestWorldsAgreement() in these processes only visits its share of
+  // the grid cells. Tests which can't be split this way should check
+  // IsTestOfThisShard() and only run in one of the processes. Each process
+  // uses its own Gazebo master on a free port picked by the system, so the
+  // processes don't interfere with each other or with other test runs.
+  // Each process starts the server of the GazeboWorldPool before running
+  // the tests. If its master can't be started because another process
+  // took the port, the process is started again with a new port.
+  // After all processes have finished, the results of all shards are
+  // merged by sweep and cell range and printed.
+  // Has to be called before any Gazebo server is started, because the
+  // processes are created with fork().
+  // \param[in] numShards number of processes to split the sweeps into
+  // \param[in] runTests function which runs the tests, e.g. RUN_ALL_TESTS.
+  //    It is called in each of the child processes.
+  // \return exit code: 0 if all tests succeeded in all processes.
+  static int RunShards(const unsigned int numShards,
+                       const std::function<int(void)> &runTests);
+
+  // \return true if the current test, as a whole, is run by this process
+  //    when the tests run in shards (see RunShards()). Each test belongs to
+  //    exactly one shard. Always true if the tests don't run in shards.
+  static bool IsTestOfThisShard();
+
  protected:
   typedef GzWorldManager::PhysicsWorldContactInterfaceT::ContactInfo
             GzContactInfo;
@@ -54,6 +128,15 @@ class StaticTestFramework : public MultipleWorldsTestFramework
   // Model 1 will remain stationary, while model 2 will
   // be moved along the 3D grid which is formed by the AABB of model 1,
   // expanded by half the dimensions of the AABB of model 2.
+  // Cells at which the bounds of the models are disjoint by more than
+  // \e bbTol are culled without updating the worlds, the models can't
+  // collide there. The bounds are the AABBs and the bounding spheres
+  // (see collision_benchmark::GetBoundingSphere()). Because the grid
+  // is made from the AABBs, they overlap at almost all cells; the spheres
+  // cull the cells towards the corners of the grid. This presumes
+  // the bounds reported by the engines enclose the shapes.
+  // If the test runs in one of the processes started by RunShards(), only
+  // this process's share of the grid cells is visited.
   //
   // Throws gtest assertions so needs to be called from top-level
   // test function (nested function calls will not work correctly)
@@ -93,6 +176,140 @@ class StaticTestFramework : public MultipleWorldsTestFramework
                 const bool interactive = false,
                 const std::string &outputBasePath = "",
                 const std::string &outputSubdir = "");
+
+  // Like AABBTestWorldsAgreement(), but instead of visiting all cells
+  // of a grid with a fixed cell size, the grid is refined adaptively.
+  // The sweep starts with coarse cells, and each cell is split into
+  // eight until it reaches the minimum cell size, unless all of its
+  // corners agree on the collision state. This concentrates the
+  // evaluated positions at the contact boundary.
+  // Features of the shapes which are smaller than the coarse cells may
+  // be missed if all corners of the cells around them agree.
+  // The result statistics are those of AABBTestWorldsAgreement(), with
+  // the cell index referring to the grid of smallest cells.
+  // If the test runs in shards (see RunShards()), the sweep is not split
+  // and only runs in the shard given by IsTestOfThisShard().
+  //
+  // Throws gtest assertions so needs to be called from top-level
+  // test function (nested function calls will not work correctly)
+  //
+  // \param[in] coarseCellSizeFactor the proportion of the 3D grid used
+  //    to determine the size of the initial coarse cells.
+  // \param[in] minCellSizeFactor the proportion of the 3D grid used
+  //    to determine the minimum cell size. Must be at least 1/(2^21 - 1),
+  //    so that all points of the grid can be indexed with 64 bit.
+  // For all other parameters see AABBTestWorldsAgreement().
+  void AABBTestWorldsAgreementAdaptive(const std::string &modelName1,
+                const std::string &modelName2,
+                const float coarseCellSizeFactor = 0.2,
+                const float minCellSizeFactor = 0.025,
+                const double minAgree = 0.999,
+                const double bbTol = 5e-02,
+                const double zeroDepthTol = 5e-02,
+                const bool interactive = false,
+                const std::string &outputBasePath = "",
+                const std::string &outputSubdir = "");
+
+  // \return the result of the last sweep done by this process. If the
+  //    test runs in shards, this is only the share of this shard.
+  const SweepResult &GetLastSweepResult() const
+  {
+    return lastSweepResult;
+  }
+
+ private:
+  // Collision state of a cell, as determined by the majority of engines
+  enum CellState
+  {
+    CELL_COLLIDING,
+    CELL_NOT_COLLIDING,
+    // contacts were found, but they are only touching contacts
+    CELL_TOUCHING,
+    // the engines did not reach the minimum agreement
+    CELL_DISAGREE
+  };
+
+  // Sets up the models for a grid sweep and computes the grid which
+  // model 2 is moved along, see AABBTestWorldsAgreement().
+  // Throws gtest assertions.
+  // \param[out] worldManager the world manager of the server
+  // \param[out] aabb1 AABB of model 1 at the origin
+  // \param[out] aabb2 AABB of model 2 at the origin
+  // \param[out] sphere1 bounding sphere of model 1 at the origin
+  // \param[out] sphere2 bounding sphere of model 2 at the origin
+  // \param[out] grid the grid
+  void PrepareSweep(const std::string &modelName1,
+                    const std::string &modelName2,
+                    const double bbTol,
+                    const bool interactive,
+                    GzWorldManager::Ptr &worldManager,
+                    collision_benchmark::GzAABB &aabb1,
+                    collision_benchmark::GzAABB &aabb2,
+                    collision_benchmark::GzBoundingSphere &sphere1,
+                    collision_benchmark::GzBoundingSphere &sphere2,
+                    collision_benchmark::GzAABB &grid);
+
+  // Checks whether the models may collide when model 2 is at
+  // (\e x, \e y, \e z), given their bounds at the origin.
+  // \return false if the AABBs are disjoint by more than \e tolerance
+  //    along any axis, or if the bounding spheres are.
+  static bool BoundsMayCollide(const collision_benchmark::GzAABB &aabb1,
+                       const collision_benchmark::GzAABB &aabb2,
+                       const collision_benchmark::GzBoundingSphere &sphere1,
+                       const collision_benchmark::GzBoundingSphere &sphere2,
+                       const double x,
+                       const double y,
+                       const double z,
+                       const double tolerance);
+
+  // Places model 2 at (\e x, \e y, \e z), updates the worlds, checks the
+  // engines agreement and adds it to \e result. Failures are reported as
+  // in AABBTestWorldsAgreement(). Throws gtest assertions.
+  // \param[in] cellIdx index of the cell, used in the failure report
+  // \param[out] state the collision state at this cell
+  void EvaluateCell(const std::string &modelName1,
+                    const std::string &modelName2,
+                    const GzWorldManager::Ptr &worldManager,
+                    const double x,
+                    const double y,
+                    const double z,
+                    const uint64_t cellIdx,
+                    const double minAgree,
+                    const double zeroDepthTol,
+                    const bool interactive,
+                    const std::string &outputBasePath,
+                    const std::string &outputSubdir,
+                    SweepResult &result,
+                    CellState &state);
+
+  // Prints \e result, keeps it as the last result (see
+  // GetLastSweepResult()) and writes it to the shard result file if the
+  // test runs in shards. Throws gtest assertions.
+  // \param[in] sliceStart first cell visited by this shard
+  // \param[in] sliceEnd one past the last cell visited by this shard
+  void FinishSweep(const std::string &modelName1,
+                   const std::string &modelName2,
+                   const uint64_t sliceStart,
+                   const uint64_t sliceEnd,
+                   const SweepResult &result);
+
+  // Writes \e result of the cells [\e sliceStart, \e sliceEnd) of the
+  // sweep \e sweepName to the result file of this shard.
+  // \return false if the file could not be written
+  static bool WriteShardResult(const std::string &sweepName,
+                               const uint64_t sliceStart,
+                               const uint64_t sliceEnd,
+                               const SweepResult &result);
+
+  // result of the last sweep, set in FinishSweep()
+  SweepResult lastSweepResult;
+
+  // index of the shard this process handles
+  static unsigned int shardIdx;
+  // number of shards, 1 if the tests are not run in shards
+  static unsigned int numShards;
+  // directory into which the shard results are written
+  static std::string shardResultDir;
 };
 
 #endif  // COLLISION_BENCHMARK_TEST_STATICTESTFRAMEWORK_H
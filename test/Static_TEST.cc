@@ -18,11 +18,18 @@
 #include <collision_benchmark/PrimitiveShape.hh>
 #include <collision_benchmark/SimpleTriMeshShape.hh>
 #include <collision_benchmark/BasicTypes.hh>
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
+#ifdef HAVE_VTK
 #include <collision_benchmark/MeshShapeGeneratorVtk.hh>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
 
 #include <gazebo/gazebo.hh>
 #include <gazebo/test/helper_physics_generator.hh>
 
+#include "GazeboWorldPool.hh"
 #include "StaticTestFramework.hh"
 
 using collision_benchmark::Shape;
@@ -75,14 +82,12 @@ Shape::Ptr GetSimpleTestTriangle(const std::string &modelName)
   SimpleTriMeshShape::MeshDataPtr meshData(new SimpleTriMeshShape::MeshDataT());
   typedef SimpleTriMeshShape::Vertex Vertex;
   typedef SimpleTriMeshShape::Face Face;
-  std::vector<Vertex>& vertices = meshData->GetVertices();
-  std::vector<Face>& triangles = meshData->GetFaces();
-  vertices.push_back(Vertex(-1, 0, 0));
-  vertices.push_back(Vertex(0, 0, -1));
-  vertices.push_back(Vertex(1, 0, 0));
-  vertices.push_back(Vertex(0, 1, 0));
-  triangles.push_back(Face(0, 1, 2));
-  triangles.push_back(Face(0, 2, 3));
+  meshData->AddVertex(Vertex(-1, 0, 0));
+  meshData->AddVertex(Vertex(0, 0, -1));
+  meshData->AddVertex(Vertex(1, 0, 0));
+  meshData->AddVertex(Vertex(0, 1, 0));
+  meshData->AddFace(Face(0, 1, 2));
+  meshData->AddFace(Face(0, 2, 3));
   Shape::Ptr shape(new SimpleTriMeshShape(meshData, modelName1));
   return shape;
 }
@@ -126,6 +131,82 @@ TEST_F(StaticTest, BoxCylinderTest)
            defaultOutputPath, "BoxCylinderTest");
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// AABBTestWorldsAgreementAdaptive with one cylinder primitive and one
+// box primitive
+TEST_F(StaticTest, BoxCylinderAdaptiveTest)
+{
+  // the adaptive sweep is not split into shards
+  if (!IsTestOfThisShard()) GTEST_SKIP() << "Test runs in another shard";
+
+  std::vector<std::string> selectedEngines;
+  std::set<std::string> engines =
+    collision_benchmark::GetSupportedPhysicsEngines();
+  // run test on all engines
+  selectedEngines.insert(selectedEngines.end(), engines.begin(), engines.end());
+
+  ASSERT_GE(selectedEngines.size(), 2)
+    << "Need at least two physics engines";
+
+  // Model 1
+  std::string modelName1 = "model1";
+  Shape::Ptr shape1(PrimitiveShape::CreateBox(2, 2, 2));
+  // Model 2
+  std::string modelName2 = "model2";
+  Shape::Ptr shape2(PrimitiveShape::CreateCylinder(1, 3));
+
+  InitMultipleEngines(selectedEngines, defaultInteractive);
+  LoadShape(shape1, modelName1);
+  LoadShape(shape2, modelName2);
+  static const bool interactive = defaultInteractive;
+  static const float coarseCellSizeFactor = 0.2;
+  static const float minCellSizeFactor = 0.025;
+  AABBTestWorldsAgreementAdaptive(modelName1, modelName2,
+           coarseCellSizeFactor, minCellSizeFactor, minAgree,
+           bbTol, zeroDepthTol, interactive,
+           defaultOutputPath, "BoxCylinderAdaptiveTest");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Tests that the cells at the corners of the grid are culled by the bounding
+// spheres in a sweep of a box primitive and a sphere primitive
+TEST_F(StaticTest, BoxSphereCullingTest)
+{
+  // the adaptive sweep is not split into shards
+  if (!IsTestOfThisShard()) GTEST_SKIP() << "Test runs in another shard";
+
+  std::vector<std::string> selectedEngines;
+  std::set<std::string> engines =
+    collision_benchmark::GetSupportedPhysicsEngines();
+  selectedEngines.insert(selectedEngines.end(), engines.begin(), engines.end());
+
+  ASSERT_GE(selectedEngines.size(), 2)
+    << "Need at least two physics engines";
+
+  // Model 1
+  std::string modelName1 = "model1";
+  Shape::Ptr shape1(PrimitiveShape::CreateBox(2, 2, 2));
+  // Model 2
+  std::string modelName2 = "model2";
+  Shape::Ptr shape2(PrimitiveShape::CreateSphere(1));
+
+  InitMultipleEngines(selectedEngines, defaultInteractive);
+  LoadShape(shape1, modelName1);
+  LoadShape(shape2, modelName2);
+  static const bool interactive = defaultInteractive;
+  static const float coarseCellSizeFactor = 0.25;
+  static const float minCellSizeFactor = 0.125;
+  AABBTestWorldsAgreementAdaptive(modelName1, modelName2,
+           coarseCellSizeFactor, minCellSizeFactor, minAgree,
+           bbTol, zeroDepthTol, interactive);
+
+  // the AABBs overlap everywhere in the grid, but the sphere can't reach
+  // the box at the corners of the grid
+  const SweepResult &result = GetLastSweepResult();
+  ASSERT_GT(result.numCulled, 0) << "No cells were culled";
+  ASSERT_LT(result.numCulled, result.numCells) << "All cells were culled";
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // AABBTestWorldsAgreement with one cylinder primitive and a simple
 // triangle (GetSimpleTestTriangle)
@@ -170,6 +251,7 @@ TEST_F(StaticTest, CylinderAndTwoTriangles)
                           defaultOutputPath, "CylinderAndTwoTriangles");
 }
 
+#ifdef HAVE_VTK
 //////////////////////////////////////////////////////////////////////////////
 // AABBTestWorldsAgreement with one sphere primitive and one sphere mesh
 TEST_F(StaticTest, SpherePrimMesh)
@@ -195,8 +277,9 @@ TEST_F(StaticTest, SpherePrimMesh)
     << "Need at least two physics engines";
 
   typedef SimpleTriMeshShape::MeshDataT::VertexPrecision Precision;
-  collision_benchmark::MeshShapeGenerator<Precision>::Ptr generator
-      (new collision_benchmark::MeshShapeGeneratorVtk<Precision>());
+  typedef collision_benchmark::MeshShapeGenerator<Precision> Generator;
+  Generator::Ptr generator = GetCachedGenerator<Precision>(Generator::Ptr
+      (new collision_benchmark::MeshShapeGeneratorVtk<Precision>()));
 
   double radius = 2;
 
@@ -228,8 +311,9 @@ TEST_F(StaticTest, SpherePrimMesh)
 TEST_P(StaticTestWithParam, SphereEquivalentsTest)
 {
   typedef SimpleTriMeshShape::MeshDataT::VertexPrecision Precision;
-  collision_benchmark::MeshShapeGenerator<Precision>::Ptr generator
-      (new collision_benchmark::MeshShapeGeneratorVtk<Precision>());
+  typedef collision_benchmark::MeshShapeGenerator<Precision> Generator;
+  Generator::Ptr generator = GetCachedGenerator<Precision>(Generator::Ptr
+      (new collision_benchmark::MeshShapeGeneratorVtk<Precision>()));
 
   double radius = 2;
 
@@ -262,6 +346,153 @@ TEST_P(StaticTestWithParam, SphereEquivalentsTest)
                           _bbTol, zeroDepthTol, interactive,
                           defaultOutputPath, "SphereEquivalentTest");
 }
+#endif  // HAVE_VTK
+
+//////////////////////////////////////////////////////////////////////////////
+// Same as SpherePrimMesh, with the sphere mesh made by
+// MeshShapeGeneratorNative
+TEST_F(StaticTest, SpherePrimMeshNative)
+{
+  std::vector<std::string> selectedEngines;
+
+/*#ifdef BULLET_SUPPORT
+  selectedEngines.push_back("bullet");
+#endif
+  selectedEngines.push_back("ode");
+#ifdef DART_SUPPORT
+  selectedEngines.push_back("dart");
+#endif
+  // selectedEngines.push_back("simbody");
+*/
+  std::set<std::string> engines =
+    collision_benchmark::GetSupportedPhysicsEngines();
+  // run test on all engines
+  selectedEngines.insert(selectedEngines.end(),
+                         engines.begin(), engines.end());
+
+  ASSERT_GE(selectedEngines.size(), 2)
+    << "Need at least two physics engines";
+
+  typedef SimpleTriMeshShape::MeshDataT::VertexPrecision Precision;
+  typedef collision_benchmark::MeshShapeGenerator<Precision> Generator;
+  Generator::Ptr generator = GetCachedGenerator<Precision>(Generator::Ptr
+      (new collision_benchmark::MeshShapeGeneratorNative<Precision>()));
+
+  double radius = 2;
+
+  // sphere as mesh
+  std::string meshName = "SphereMesh";
+  SimpleTriMeshShape::MeshDataT::Ptr sphereMeshData =
+    generator->MakeSphere(radius, 10, 10);
+  Shape::Ptr sphereMesh(new SimpleTriMeshShape(sphereMeshData, meshName));
+
+  // sphere as a primitive
+  std::string primName = "SpherePrimitive";
+  Shape::Ptr spherePrimitive(PrimitiveShape::CreateSphere(radius));
+
+  // load up the worlds
+  InitMultipleEngines(selectedEngines, defaultInteractive);
+  LoadShape(sphereMesh, meshName);
+  LoadShape(spherePrimitive, primName);
+  static const bool interactive = defaultInteractive;
+  static const float cellSizeFactor = 0.1;
+  AABBTestWorldsAgreement(meshName, primName, cellSizeFactor, minAgree,
+                          bbTol, zeroDepthTol, interactive,
+                          defaultOutputPath, "SpherePrimMeshNative");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Same as SphereEquivalentsTest, with the sphere mesh made by
+// MeshShapeGeneratorNative
+TEST_P(StaticTestWithParam, SphereEquivalentsNativeTest)
+{
+  typedef SimpleTriMeshShape::MeshDataT::VertexPrecision Precision;
+  typedef collision_benchmark::MeshShapeGenerator<Precision> Generator;
+  Generator::Ptr generator = GetCachedGenerator<Precision>(Generator::Ptr
+      (new collision_benchmark::MeshShapeGeneratorNative<Precision>()));
+
+  double radius = 2;
+
+  // sphere as mesh
+  std::string modelName2 = "SphereMesh";
+  SimpleTriMeshShape::MeshDataT::Ptr sphereMeshData =
+    generator->MakeSphere(radius, 10, 10);
+  Shape::Ptr sphereMesh(new SimpleTriMeshShape(sphereMeshData, modelName2));
+
+  // sphere as a primitive
+  std::string modelName1 = "SpherePrimitive";
+  Shape::Ptr spherePrimitive(PrimitiveShape::CreateSphere(radius));
+
+  // load up the worlds
+  InitOneEngine(GetParam(), 2, defaultInteractive);
+
+  // as a first shape, load the primitive into both worlds
+  LoadShape(spherePrimitive, modelName1);
+  // as the second shape, load the primitive into the
+  // first world, and the mesh into the second
+  LoadShape(spherePrimitive, modelName2, 0);
+  LoadShape(sphereMesh, modelName2, 1);
+  static const bool interactive = defaultInteractive;
+  static const float cellSizeFactor = 0.1;
+  const double _bbTol = 0.15;
+  AABBTestWorldsAgreement(modelName1, modelName2, cellSizeFactor, minAgree,
+                          _bbTol, zeroDepthTol, interactive,
+                          defaultOutputPath, "SphereEquivalentNativeTest");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Tests that the worlds of the pool are re-used and reset after a test
+TEST_F(StaticTest, WorldPoolReuse)
+{
+  if (!IsTestOfThisShard()) GTEST_SKIP() << "Test runs in another shard";
+
+  collision_benchmark::GazeboWorldPool &pool =
+    collision_benchmark::GazeboWorldPool::Instance();
+  collision_benchmark::GazeboMultipleWorlds::Ptr server = pool.GetServer();
+  ASSERT_NE(server, nullptr) << "Could not start the pooled server";
+  GzWorldManager::Ptr worldManager = server->GetWorldManager();
+  ASSERT_EQ(worldManager->GetNumWorlds(), 0)
+    << "Worlds of the previous test were not released";
+
+  int idx = pool.Lease("ode");
+  ASSERT_GE(idx, 0) << "Could not lease world";
+  collision_benchmark::PhysicsWorldBaseInterface::Ptr leased =
+    worldManager->GetWorld(idx);
+  collision_benchmark::GazeboPhysicsWorld::Ptr world =
+    std::dynamic_pointer_cast<collision_benchmark::GazeboPhysicsWorld>
+      (leased);
+  ASSERT_NE(world, nullptr) << "No Gazebo world leased";
+  ASSERT_EQ(worldManager->GetMirroredWorld(), leased);
+  gazebo::physics::WorldPtr gzWorld = world->GetWorld();
+  const size_t numModels = gzWorld->Models().size();
+  const double stepSize = gzWorld->Physics()->GetMaxStepSize();
+  const ignition::math::Vector3d gravity = gzWorld->Gravity();
+
+  // change the models and the physics of the world
+  Shape::Ptr box(PrimitiveShape::CreateBox(1, 1, 1));
+  ASSERT_EQ(worldManager->AddModelFromShape("box", box, box).size(), 1);
+  ASSERT_NE(gzWorld->ModelByName("box"), nullptr);
+  gzWorld->Physics()->SetMaxStepSize(stepSize * 2);
+  gzWorld->SetGravity(gravity * 2);
+
+  pool.ReleaseAll();
+  ASSERT_EQ(worldManager->GetNumWorlds(), 0);
+  ASSERT_EQ(worldManager->GetMirroredWorld(), nullptr)
+    << "Mirror still mirrors the released world";
+  ASSERT_EQ(pool.GetNumIdle("ode"), 1);
+  ASSERT_EQ(gzWorld->ModelByName("box"), nullptr) << "World was not reset";
+  ASSERT_EQ(gzWorld->Models().size(), numModels);
+  ASSERT_DOUBLE_EQ(gzWorld->Physics()->GetMaxStepSize(), stepSize);
+  ASSERT_EQ(gzWorld->Gravity(), gravity);
+
+  // leasing again returns the same world, which is mirrored again
+  idx = pool.Lease("ode");
+  ASSERT_GE(idx, 0) << "Could not lease world";
+  ASSERT_EQ(worldManager->GetWorld(idx), leased);
+  ASSERT_EQ(worldManager->GetMirroredWorld(), leased);
+  ASSERT_EQ(pool.GetNumIdle("ode"), 0);
+  pool.ReleaseAll();
+}
 
 // cannot test simbody because there are still issues with meshes and
 // lack of bounding box support
@@ -273,6 +504,8 @@ int main(int argc, char**argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
 
+  // number of processes to split the grid sweeps into
+  unsigned int numShards = 1;
   for (int i = 1; i < argc; ++i)
   {
     if (strcmp(argv[i], "--interactive") == 0)
@@ -290,11 +523,52 @@ int main(int argc, char**argv)
       defaultOutputPath = argv[i];
       std::cout << "Writing files to " << defaultOutputPath << std::endl;
     }
+    else if (strcmp(argv[i], "--shards") == 0)
+    {
+      if (i+1 >= argc)
+      {
+        std::cerr << "--shards requires specification of a number"
+                  << std::endl;
+        continue;
+      }
+      ++i;
+      numShards = std::max(1, atoi(argv[i]));
+    }
+    else if (strcmp(argv[i], "--mesh-cache") == 0)
+    {
+      if (i+1 >= argc)
+      {
+        std::cerr << "--mesh-cache requires specification of a directory"
+                  << std::endl;
+        continue;
+      }
+      ++i;
+      // the directory is kept after the tests, see
+      // MultipleWorldsTestFramework::SetMeshCache()
+      collision_benchmark::MeshCache::Ptr cache
+        (new collision_benchmark::MeshCache(argv[i]));
+      if (!cache->IsValid())
+      {
+        std::cerr << "Could not create mesh cache in " << argv[i]
+                  << std::endl;
+        continue;
+      }
+      std::cout << "Using mesh cache in " << argv[i] << std::endl;
+      StaticTestFramework::SetMeshCache(cache);
+    }
     else
     {
       std::cerr << "Unrecognized command line parameter: "
                 << argv[i] << std::endl;
     }
   }
-  return RUN_ALL_TESTS();
+
+  if ((numShards > 1) && defaultInteractive)
+  {
+    std::cerr << "Interactive mode can't be used with --shards, "
+              << "running in one process." << std::endl;
+    numShards = 1;
+  }
+  return StaticTestFramework::RunShards(numShards,
+                                        []() { return RUN_ALL_TESTS(); });
 }
@@ -22,9 +22,12 @@
 
 #include <gazebo/gazebo.hh>
 #include <gazebo/msgs/msgs.hh>
+#include <gazebo/physics/physics.hh>
 
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <thread>
 #include <atomic>
@@ -66,14 +69,17 @@ bool collision_benchmark::GetConsistentAABB(const std::string &modelName,
                                   const double bbTol,
                                   GzAABB &mAABB)
 {
-  std::vector<GzWorldManager::PhysicsWorldModelInterfacePtr>
-    worlds = worldManager->GetModelPhysicsWorlds();
+  GzWorldManager::WorldRegistryConstPtr
+    registry = worldManager->GetWorldRegistry();
+  const std::vector<GzWorldManager::PhysicsWorldModelInterfacePtr>
+    &worlds = registry->modelWorlds;
 
   // AABB's from all worlds: need to be equal or this function
   // must return false.
   std::vector<GzAABB> aabbs;
 
-  std::vector<GzWorldManager::PhysicsWorldModelInterfacePtr>::iterator it;
+  std::vector<GzWorldManager::PhysicsWorldModelInterfacePtr>::const_iterator
+    it;
   for (it = worlds.begin(); it != worlds.end(); ++it)
   {
     GzWorldManager::PhysicsWorldModelInterfacePtr w = *it;
@@ -119,6 +125,91 @@ bool collision_benchmark::GetConsistentAABB(const std::string &modelName,
   return true;
 }
 
+////////////////////////////////////////////////////////////////
+bool collision_benchmark::GetBoundingSphere(const std::string &modelName,
+                                  const GzWorldManager::Ptr &worldManager,
+                                  GzBoundingSphere &sphere)
+{
+  GzWorldManager::WorldRegistryConstPtr
+    registry = worldManager->GetWorldRegistry();
+  GazeboPhysicsWorld::Ptr gzWorld;
+  if (!registry->worlds.empty())
+    gzWorld = std::dynamic_pointer_cast<GazeboPhysicsWorld>
+                (registry->worlds.front());
+  if (!gzWorld)
+  {
+    std::cerr << "Bounding sphere requires a Gazebo world" << std::endl;
+    return false;
+  }
+  gazebo::physics::ModelPtr model =
+    gzWorld->GetWorld()->ModelByName(modelName);
+  if (!model)
+  {
+    std::cerr << "Model " << modelName << " not found" << std::endl;
+    return false;
+  }
+
+  // centers and radii of the spheres around each collision shape
+  typedef GzBoundingSphere::Vec3 Vec3;
+  std::vector<GzBoundingSphere> shapeSpheres;
+  for (const gazebo::physics::LinkPtr &link : model->GetLinks())
+  {
+    for (const gazebo::physics::CollisionPtr &coll : link->GetCollisions())
+    {
+      GzBoundingSphere s;
+      s.center = coll->WorldPose().Pos();
+      gazebo::physics::ShapePtr shape = coll->GetShape();
+      // scaled shapes are not bounded by their nominal size
+      const bool unscaled = shape && shape->Scale() == Vec3::One;
+      gazebo::physics::SphereShapePtr sphereShape =
+        boost::dynamic_pointer_cast<gazebo::physics::SphereShape>(shape);
+      gazebo::physics::BoxShapePtr boxShape =
+        boost::dynamic_pointer_cast<gazebo::physics::BoxShape>(shape);
+      gazebo::physics::CylinderShapePtr cylShape =
+        boost::dynamic_pointer_cast<gazebo::physics::CylinderShape>(shape);
+      if (unscaled && sphereShape)
+      {
+        s.radius = sphereShape->GetRadius();
+      }
+      else if (unscaled && boxShape)
+      {
+        s.radius = boxShape->Size().Length() / 2;
+      }
+      else if (unscaled && cylShape)
+      {
+        const double halfLen = cylShape->GetLength() / 2;
+        const double r = cylShape->GetRadius();
+        s.radius = std::sqrt(r * r + halfLen * halfLen);
+      }
+      else
+      {
+        const ignition::math::Box box = coll->BoundingBox();
+        s.center = box.Center();
+        s.radius = (box.Max() - box.Min()).Length() / 2;
+      }
+      shapeSpheres.push_back(s);
+    }
+  }
+
+  if (shapeSpheres.empty())
+  {
+    std::cerr << "Model " << modelName << " has no collision shapes"
+              << std::endl;
+    return false;
+  }
+
+  // enclose all shape spheres, centered at the model's AABB center
+  const ignition::math::Box modelBox = model->BoundingBox();
+  sphere.center = modelBox.Center();
+  sphere.radius = 0;
+  for (const GzBoundingSphere &s : shapeSpheres)
+  {
+    sphere.radius = std::max(sphere.radius,
+                             (s.center - sphere.center).Length() + s.radius);
+  }
+  return true;
+}
+
 
 ////////////////////////////////////////////////////////////////
 std::vector<collision_benchmark::GzContactInfoPtr>
@@ -139,6 +230,24 @@ collision_benchmark::GetContactInfo(const std::string &modelName1,
 }
 
 
+////////////////////////////////////////////////////////////////
+bool collision_benchmark::GetContactInfo(const std::string &modelName1,
+                                       const std::string &modelName2,
+                                       const std::string &worldName,
+                                       const GzWorldManager::Ptr &worldManager,
+                                       GzContactBuffer &buffer)
+{
+  buffer.Clear();
+  PhysicsWorldBaseInterface::Ptr w = worldManager->GetWorld(worldName);
+  if (!w) return false;
+
+  GzWorldManager::PhysicsWorldPtr pWorld = worldManager->ToPhysicsWorld(w);
+  if (!pWorld) return false;
+
+  pWorld->GetContactInfo(modelName1, modelName2, buffer);
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////
 bool collision_benchmark::CollisionState(const std::string &modelName1,
                                        const std::string &modelName2,
@@ -146,16 +255,33 @@ bool collision_benchmark::CollisionState(const std::string &modelName1,
                                        std::vector<std::string>& colliding,
                                        std::vector<std::string>& notColliding,
                                        double &maxDepth)
+{
+  // re-use the buffer in subsequent calls from the same thread
+  static thread_local GzContactBuffer buffer;
+  return CollisionState(modelName1, modelName2, worldManager,
+                        colliding, notColliding, maxDepth, buffer);
+}
+
+////////////////////////////////////////////////////////////////
+bool collision_benchmark::CollisionState(const std::string &modelName1,
+                                       const std::string &modelName2,
+                                       const GzWorldManager::Ptr &worldManager,
+                                       std::vector<std::string>& colliding,
+                                       std::vector<std::string>& notColliding,
+                                       double &maxDepth,
+                                       GzContactBuffer &buffer)
 {
   colliding.clear();
   notColliding.clear();
   maxDepth = 0;
   if (!worldManager) return false;
 
-  std::vector<GzWorldManager::PhysicsWorldPtr>
-    worlds = worldManager->GetPhysicsWorlds();
+  GzWorldManager::WorldRegistryConstPtr
+    registry = worldManager->GetWorldRegistry();
+  const std::vector<GzWorldManager::PhysicsWorldPtr>
+    &worlds = registry->physicsWorlds;
 
-  std::vector<GzWorldManager::PhysicsWorldPtr>::iterator it;
+  std::vector<GzWorldManager::PhysicsWorldPtr>::const_iterator it;
   for (it = worlds.begin(); it != worlds.end(); ++it)
   {
     GzWorldManager::PhysicsWorldPtr w = *it;
@@ -165,19 +291,13 @@ bool collision_benchmark::CollisionState(const std::string &modelName1,
       return false;
     }
 
-    std::vector<GzContactInfoPtr> contacts =
-      w->GetContactInfo(modelName1, modelName2);
-    if (!contacts.empty())
+    w->GetContactInfo(modelName1, modelName2, buffer);
+    if (!buffer.Empty())
     {
       colliding.push_back(w->GetName());
-      for (typename std::vector<GzContactInfoPtr>::const_iterator
-           cit = contacts.begin(); cit != contacts.end(); ++cit)
-      {
-        GzContactInfoPtr c = *cit;
-        double tmpMax;
-        if (c->maxDepth(tmpMax) && tmpMax > maxDepth)
-          maxDepth = tmpMax;
-      }
+      double tmpMax;
+      if (buffer.MaxDepth(tmpMax) && tmpMax > maxDepth)
+        maxDepth = tmpMax;
       // std::cout << "Max depth: " << maxDepth << std::endl;
     }
     else
@@ -38,6 +38,15 @@ namespace collision_benchmark
     Vec3 min, max;
   };
 
+  // Sphere enclosing all collision shapes of a model
+  struct GzBoundingSphere
+  {
+    typedef ignition::math::Vector3d Vec3;
+    GzBoundingSphere(): radius(0) {}
+    Vec3 center;
+    double radius;
+  };
+
   typedef collision_benchmark::WorldManager<GazeboPhysicsWorldTypes::WorldState,
                        GazeboPhysicsWorldTypes::ModelID,
                        GazeboPhysicsWorldTypes::ModelPartID,
@@ -49,6 +58,9 @@ namespace collision_benchmark
             GzContactInfo;
   typedef GzContactInfo::Ptr GzContactInfoPtr;
 
+  typedef GzWorldManager::PhysicsWorldContactInterfaceT::ContactBuffer
+            GzContactBuffer;
+
 
 
   // Tests if the worlds agree about the collision states
@@ -70,6 +82,17 @@ namespace collision_benchmark
                       std::vector<std::string>& notColliding,
                       double &maxDepth);
 
+  // Like CollisionState() above, but uses the caller-owned \e buffer
+  // for querying the contacts. If the same buffer is re-used in
+  // subsequent calls, this avoids heap allocations for the contacts.
+  bool CollisionState(const std::string &modelName1,
+                      const std::string &modelName2,
+                      const GzWorldManager::Ptr &worldManager,
+                      std::vector<std::string>& colliding,
+                      std::vector<std::string>& notColliding,
+                      double &maxDepth,
+                      GzContactBuffer &buffer);
+
   // checks that AABB of model \e modelName is the same in all worlds in
   // \e worldManager and returns the AABBs of the model if it is
   // the same in all worlds.
@@ -81,6 +104,18 @@ namespace collision_benchmark
                          const double bbTol,
                          GzAABB &aabb);
 
+  // Gets a sphere enclosing all collision shapes of model \e modelName
+  // in its current pose in the first world of \e worldManager.
+  // Spheres, boxes and cylinders are bounded by their own enclosing sphere,
+  // which for corners of the shapes is a lot tighter than the AABB.
+  // All other shapes are bounded by the sphere around their AABB.
+  // The shapes are the same in all worlds, so the first one is
+  // representative for all of them.
+  // \return false if the model was not found in a Gazebo world
+  bool GetBoundingSphere(const std::string &modelName,
+                         const GzWorldManager::Ptr &worldManager,
+                         GzBoundingSphere &sphere);
+
   // Helper function
   // \return contact info between model 1 and 2 in the world \e worldName
   std::vector<GzContactInfoPtr> GetContactInfo(const std::string &modelName1,
@@ -88,6 +123,16 @@ namespace collision_benchmark
                                       const std::string &worldName,
                                       const GzWorldManager::Ptr &worldManager);
 
+  // Helper function
+  // Gets contact info between model 1 and 2 in the world \e worldName
+  // and writes it into \e buffer.
+  // \return false if the world was not found
+  bool GetContactInfo(const std::string &modelName1,
+                      const std::string &modelName2,
+                      const std::string &worldName,
+                      const GzWorldManager::Ptr &worldManager,
+                      GzContactBuffer &buffer);
+
 
   // waits for the [Enter] key to be pressed, and while it's waiting,
   // updates the worlds
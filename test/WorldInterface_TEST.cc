@@ -17,8 +17,14 @@
 #include <collision_benchmark/GazeboWorldLoader.hh>
 #include <collision_benchmark/PhysicsWorld.hh>
 #include <collision_benchmark/GazeboPhysicsWorld.hh>
+#include <collision_benchmark/GazeboStateBatchCompare.hh>
 #include <collision_benchmark/GazeboStateCompare.hh>
+#include <collision_benchmark/GazeboStateFingerprint.hh>
 #include <collision_benchmark/GazeboHelpers.hh>
+#include <collision_benchmark/GazeboMeshRegistry.hh>
+#include <collision_benchmark/GazeboNamespaceNotifier.hh>
+#include <collision_benchmark/GazeboWorldTemplateCache.hh>
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
 #include <collision_benchmark/WorldManager.hh>
 #include <collision_benchmark/PrimitiveShape.hh>
 #include <collision_benchmark/SimpleTriMeshShape.hh>
@@ -29,6 +35,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <set>
+
 #include "BasicTestFramework.hh"
 
 using collision_benchmark::PhysicsWorldBaseInterface;
@@ -109,6 +117,55 @@ TEST_F(WorldInterfaceTest, TransferWorldState)
   }
 }
 
+TEST_F(WorldInterfaceTest, TransferWorldSnapshot)
+{
+  GazeboPhysicsWorld::Ptr gzWorld1(new GazeboPhysicsWorld(false));
+  ASSERT_EQ(gzWorld1->LoadFromFile("worlds/empty.world", "blank"),
+            collision_benchmark::SUCCESS) << " Could not load empty world";
+  gzWorld1->SetDynamicsEnabled(false);
+
+  GazeboPhysicsWorld::Ptr gzWorld2(new GazeboPhysicsWorld(false));
+  ASSERT_EQ(gzWorld2->LoadFromFile("worlds/rubble.world", "rubble"),
+            collision_benchmark::SUCCESS) << " Could not load rubble world";
+
+  collision_benchmark::GazeboWorldSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Empty());
+  ASSERT_EQ(gzWorld1->SetWorldSnapshot(snapshot), collision_benchmark::FAILED)
+    << "An empty snapshot should not be restored";
+
+  // the first transfer inserts the rubble models into the empty world,
+  // all subsequent transfers write back the poses directly.
+  int numIters = 1000;
+  for (int i = 0; i < numIters; ++i)
+  {
+    gzWorld2->GetWorldSnapshot(snapshot);
+    ASSERT_EQ(gzWorld1->SetWorldSnapshot(snapshot),
+              collision_benchmark::SUCCESS) << " Could not restore snapshot";
+    GazeboStateCompare::Tolerances t =
+      GazeboStateCompare::Tolerances::CreateDefault(1e-03);
+    // don't check dynamics because we disable physics engine in gzWorld1
+    t.CheckDynamics = false;
+    ASSERT_TRUE(GazeboStateCompare::Equal(gzWorld1->GetWorldState(),
+                                          gzWorld2->GetWorldState(), t))
+      << "Snapshot was not restored as supposed to";
+    gzWorld1->Update(1);
+    gzWorld2->Update(1);
+  }
+
+  // rewind the rubble world to a snapshot taken earlier
+  gzWorld2->GetWorldSnapshot(snapshot);
+  gazebo::physics::WorldState rewindState = gzWorld2->GetWorldState();
+  gzWorld2->Update(100);
+  ASSERT_EQ(gzWorld2->SetWorldSnapshot(snapshot),
+            collision_benchmark::SUCCESS) << " Could not rewind";
+  GazeboStateCompare::Tolerances t =
+    GazeboStateCompare::Tolerances::CreateDefault(1e-03);
+  t.CheckDynamics = false;
+  ASSERT_TRUE(GazeboStateCompare::Equal(gzWorld2->GetWorldState(),
+                                        rewindState, t))
+    << "World was not rewound to the snapshot";
+}
+
 TEST_F(WorldInterfaceTest, WorldManager)
 {
   std::map<std::string, std::string> physicsEngines
@@ -173,8 +230,328 @@ TEST_F(WorldInterfaceTest, WorldManager)
     ASSERT_NE(state.HasModelState("box"), false)
       << "World " << world->GetName() << " has no model named 'box'";
   }
+
+  // the registry contains all worlds, already cast to all interfaces
+  GzWorldManager::WorldRegistryConstPtr registry =
+    worldManager.GetWorldRegistry();
+  ASSERT_EQ(registry->worlds.size(), physicsEngines.size());
+  ASSERT_EQ(registry->modelWorlds.size(), registry->worlds.size());
+  ASSERT_EQ(registry->contactWorlds.size(), registry->worlds.size());
+  ASSERT_EQ(registry->physicsWorlds.size(), registry->worlds.size());
+  for (int i = 0; i < registry->worlds.size(); ++i)
+  {
+    ASSERT_EQ(registry->worlds[i], worldManager.GetWorld(i));
+    ASSERT_NE(registry->modelWorlds[i], nullptr);
+    ASSERT_NE(registry->contactWorlds[i], nullptr);
+    ASSERT_NE(registry->physicsWorlds[i], nullptr);
+  }
+
+  // set the state of the box and a model which doesn't exist in one pass
+  collision_benchmark::BasicState boxState;
+  boxState.SetPosition(1, 2, 3);
+  std::vector<GzWorldManager::ModelStateEntry> states;
+  states.push_back(std::make_pair("box", boxState));
+  std::vector<int> numSet;
+  ASSERT_EQ(worldManager.SetBasicModelStates(states, &numSet, true),
+            physicsEngines.size());
+  ASSERT_EQ(numSet, std::vector<int>(physicsEngines.size(), 1));
+  states.push_back(std::make_pair("no_such_model", boxState));
+  ASSERT_EQ(worldManager.SetBasicModelStates(states, &numSet), 0);
+  ASSERT_EQ(numSet, std::vector<int>(physicsEngines.size(), 1));
+  for (int i = 0; i < registry->modelWorlds.size(); ++i)
+  {
+    collision_benchmark::BasicState s;
+    ASSERT_TRUE(registry->modelWorlds[i]->GetBasicModelState("box", s));
+    ASSERT_NEAR(s.position.x, 1, 1e-03);
+    ASSERT_NEAR(s.position.y, 2, 1e-03);
+    ASSERT_NEAR(s.position.z, 3, 1e-03);
+  }
+
+  // a registry obtained earlier is not changed when a world is added
+  GazeboPhysicsWorld::Ptr addedWorld(new GazeboPhysicsWorld(false));
+  addedWorld->SetWorld(collision_benchmark::to_std_ptr<gazebo::physics::World>
+    (collision_benchmark::LoadWorldFromFile(worldfile, "world_added")));
+  ASSERT_GE(worldManager.AddPhysicsWorld(addedWorld), 0);
+  ASSERT_EQ(registry->worlds.size(), physicsEngines.size());
+  ASSERT_EQ(worldManager.GetWorldRegistry()->worlds.size(),
+            physicsEngines.size() + 1);
+}
+
+
+TEST_F(WorldInterfaceTest, WorldManagerParallelUpdate)
+{
+  std::map<std::string, std::string> physicsEngines
+    = collision_benchmark::getPhysicsSettingsSdfForAllEngines();
+  std::string worldfile = "../test_worlds/cube.world";
+
+  GzWorldManager worldManager;
+  int i = 1;
+  for (std::map<std::string, std::string>::iterator it = physicsEngines.begin();
+       it != physicsEngines.end(); ++it, ++i)
+  {
+    std::stringstream _worldname;
+    _worldname << "world_" << i << "_" << it->first;
+    sdf::ElementPtr physics =
+      collision_benchmark::GetPhysicsFromSDF(it->second);
+    ASSERT_NE(physics.get(), nullptr)
+      << "Could not get phyiscs engine from " << it->second << std::endl;
+    gazebo::physics::WorldPtr gzworld =
+      collision_benchmark::LoadWorldFromFile(worldfile, _worldname.str(),
+                                             physics);
+    ASSERT_NE(gzworld.get(), nullptr)
+      << "Error loading world " << worldfile << std::endl;
+    GazeboPhysicsWorld::Ptr gzPhysicsWorld(new GazeboPhysicsWorld(false));
+    gzPhysicsWorld->SetWorld
+      (collision_benchmark::to_std_ptr<gazebo::physics::World>(gzworld));
+    worldManager.AddPhysicsWorld(gzPhysicsWorld);
+  }
+
+  // This only tests the bookkeeping of the parallel mode. It can't detect
+  // races in the engines, which is why the mode is experimental and not
+  // safe for Gazebo worlds (see WorldManager::SetParallelUpdate()).
+  worldManager.SetParallelUpdate(true);
+  ASSERT_TRUE(worldManager.IsParallelUpdate());
+
+  // all worlds must have advanced by the same number of iterations
+  int numIters = 100;
+  for (int k = 0; k < numIters; ++k) worldManager.Update(1);
+  for (int k = 0; k < worldManager.GetNumWorlds(); ++k)
+  {
+    PhysicsWorldBaseInterface::Ptr world = worldManager.GetWorld(k);
+    GzPhysicsWorldStateInterface::Ptr sWorld =
+      GzWorldManager::ToWorldWithState(world);
+    ASSERT_NE(sWorld, nullptr) <<"World should have been of Gazebo type";
+    GzWorldState state = sWorld->GetWorldState();
+    ASSERT_EQ(state.GetIterations(), numIters)
+      << "World " << world->GetName() << " was not updated in all iterations";
+  }
+
+  worldManager.SetParallelUpdate(false);
+  ASSERT_FALSE(worldManager.IsParallelUpdate());
+}
+
+TEST_F(WorldInterfaceTest, LoadWorldsTimings)
+{
+  std::vector<collision_benchmark::Worldfile> worldfiles;
+  for (int i = 0; i < 4; ++i)
+  {
+    std::stringstream _worldname;
+    _worldname << "timed_world_" << i;
+    worldfiles.push_back(collision_benchmark::Worldfile
+                           ("../test_worlds/cube.world", _worldname.str()));
+  }
+
+  std::vector<collision_benchmark::WorldLoadTiming> timings;
+  std::vector<gazebo::physics::WorldPtr> worlds =
+    collision_benchmark::LoadWorlds(worldfiles, &timings);
+  ASSERT_EQ(worlds.size(), worldfiles.size()) << "Not all worlds loaded";
+  ASSERT_EQ(timings.size(), worldfiles.size());
+  for (size_t i = 0; i < worlds.size(); ++i)
+  {
+    // the worlds are returned in the order of the files
+    ASSERT_EQ(worlds[i]->Name(), worldfiles[i].worldname);
+    ASSERT_EQ(timings[i].worldname, worldfiles[i].worldname);
+    ASSERT_GT(timings[i].Total(), 0);
+    ASSERT_NE(worlds[i]->ModelByName("box"), nullptr)
+      << "World " << worlds[i]->Name() << " has no box";
+  }
+}
+
+TEST_F(WorldInterfaceTest, GazeboNamespaceNotifier)
+{
+  collision_benchmark::GazeboNamespaceNotifier &notifier =
+    collision_benchmark::GazeboNamespaceNotifier::Instance();
+  gazebo::physics::WorldPtr world =
+    collision_benchmark::LoadWorldFromFile("../test_worlds/cube.world",
+                                           "notified_world");
+  ASSERT_NE(world, nullptr) << "Could not load world";
+  ASSERT_TRUE(notifier.WaitFor("notified_world", 10))
+    << "Namespace of the world was not announced";
+  ASSERT_TRUE(notifier.IsAvailable("notified_world"));
+
+  // waiting for a namespace which never appears has to time out
+  std::vector<std::string> namespaces;
+  namespaces.push_back("notified_world");
+  namespaces.push_back("nonexistent_world");
+  std::vector<std::string> missing;
+  gazebo::common::Timer timer;
+  timer.Start();
+  ASSERT_FALSE(notifier.WaitForAll(namespaces, 0.2, &missing));
+  ASSERT_GE(timer.GetElapsed().Double(), 0.2);
+  ASSERT_EQ(missing.size(), 1);
+  ASSERT_EQ(missing[0], "nonexistent_world");
+  ASSERT_FALSE(notifier.IsAvailable("nonexistent_world"));
+}
+
+TEST_F(WorldInterfaceTest, GazeboWorldTemplateCache)
+{
+  // the cache itself is tested in GazeboWorldTemplateCache_TEST.cc
+  collision_benchmark::GazeboWorldTemplateCache &cache =
+    collision_benchmark::GazeboWorldTemplateCache::Instance();
+  cache.Clear();
+  std::string worldfile = "../test_worlds/cube.world";
+
+  // loading worlds from file uses the cached template
+  gazebo::physics::WorldPtr world1 =
+    collision_benchmark::LoadWorldFromFile(worldfile, "cached_world_1");
+  ASSERT_NE(world1, nullptr) << "Could not load world";
+  ASSERT_EQ(cache.GetNumTemplates(), 1);
+  gazebo::physics::WorldPtr world2 =
+    collision_benchmark::LoadWorldFromFile(worldfile, "cached_world_2");
+  ASSERT_NE(world2, nullptr) << "Could not load world";
+  ASSERT_EQ(world2->Name(), "cached_world_2");
+  ASSERT_NE(world2->ModelByName("box"), nullptr);
+  ASSERT_EQ(cache.GetNumTemplates(), 1);
+}
+
+TEST_F(WorldInterfaceTest, GazeboHeadlessPoseSetting)
+{
+  std::string worldfile = "../test_worlds/cube.world";
+  GazeboPhysicsWorld::Ptr world(new GazeboPhysicsWorld(false, true));
+  ASSERT_EQ(world->LoadFromFile(worldfile), collision_benchmark::SUCCESS)
+    << " Could not load world";
+  ASSERT_TRUE(world->IsHeadless());
+  ASSERT_FALSE(world->ConsumeHeadlessPoseChange());
+
+  int numPoses = 10;
+  for (int i = 0; i < numPoses; ++i)
+  {
+    collision_benchmark::BasicState state;
+    state.SetPosition(i * 0.01, 0, 1);
+    ASSERT_TRUE(world->SetBasicModelState("box", state));
+  }
+  // the pose change is reported once, so that the latest poses can
+  // be published separately
+  ASSERT_TRUE(world->ConsumeHeadlessPoseChange());
+  ASSERT_FALSE(world->ConsumeHeadlessPoseChange());
+
+  // without the headless mode, poses are published by the world itself
+  // and no pose change is reported
+  world->SetHeadless(false);
+  ASSERT_FALSE(world->IsHeadless());
+  collision_benchmark::BasicState state;
+  state.SetPosition(0, 0, 1);
+  ASSERT_TRUE(world->SetBasicModelState("box", state));
+  ASSERT_FALSE(world->ConsumeHeadlessPoseChange());
+
+  // the headless mode is only used if it is requested explicitly
+  GazeboPhysicsWorld::Ptr defaultWorld(new GazeboPhysicsWorld(false));
+  ASSERT_FALSE(defaultWorld->IsHeadless());
 }
 
+TEST_F(WorldInterfaceTest, GazeboStateFingerprint)
+{
+  GazeboPhysicsWorld::Ptr gzWorld1(new GazeboPhysicsWorld(false, true));
+  ASSERT_EQ(gzWorld1->LoadFromFile("worlds/rubble.world", "rubble1"),
+            collision_benchmark::SUCCESS) << " Could not load rubble world";
+  GazeboPhysicsWorld::Ptr gzWorld2(new GazeboPhysicsWorld(false, true));
+  ASSERT_EQ(gzWorld2->LoadFromFile("worlds/rubble.world", "rubble2"),
+            collision_benchmark::SUCCESS) << " Could not load rubble world";
+  gzWorld1->SetDynamicsEnabled(false);
+  gzWorld2->SetDynamicsEnabled(false);
+
+  GazeboStateCompare::Tolerances t =
+    GazeboStateCompare::Tolerances::CreateDefault(1e-03);
+  t.CheckDynamics = false;
+  collision_benchmark::GazeboStateFingerprint f1(t), f2(t);
+  gzWorld1->UpdateStateFingerprint(f1);
+  gzWorld2->UpdateStateFingerprint(f2);
+  ASSERT_TRUE(f1.IsComputed());
+  ASSERT_EQ(f1.GetNumModels(), gzWorld1->GetWorld()->Models().size());
+  ASSERT_TRUE(f1.Matches(f2)) << "Fingerprints of same worlds should match";
+
+  std::vector<std::string> differentModels;
+  ASSERT_TRUE(GazeboStateCompare::Equal(gzWorld1->GetWorldState(),
+                                        gzWorld2->GetWorldState(),
+                                        f1, f2, &differentModels));
+  ASSERT_TRUE(differentModels.empty());
+
+  // move one model in the second world
+  const gazebo::physics::Model_V models = gzWorld2->GetWorld()->Models();
+  ASSERT_FALSE(models.empty());
+  const std::string movedModel = models.back()->GetName();
+  collision_benchmark::BasicState state;
+  state.SetPosition(100, 100, 100);
+  ASSERT_TRUE(gzWorld2->SetBasicModelState(movedModel, state));
+  gzWorld2->UpdateStateFingerprint(f2);
+  ASSERT_FALSE(f1.Matches(f2));
+  // moving a model doesn't change the structure of the state
+  ASSERT_FALSE(f1.StructureDiffers(f2));
+
+  gazebo::physics::WorldState s1 = gzWorld1->GetWorldState();
+  gazebo::physics::WorldState s2 = gzWorld2->GetWorldState();
+  ASSERT_FALSE(GazeboStateCompare::Equal(s1, s2, f1, f2, &differentModels));
+  ASSERT_EQ(differentModels.size(), 1u);
+  ASSERT_EQ(differentModels.front(), movedModel);
+  // the result has to be the same as with the detailed comparison
+  ASSERT_FALSE(GazeboStateCompare::Equal(s1, s2, t, true));
+
+  // incrementally updated fingerprints are equal to fully computed ones
+  collision_benchmark::GazeboStateFingerprint full(t);
+  full.Compute(s2);
+  ASSERT_EQ(full.GetHash(), f2.GetHash());
+
+  // a missing model is a difference in structure
+  ASSERT_TRUE(f2.RemoveModel(movedModel));
+  ASSERT_TRUE(f1.StructureDiffers(f2));
+  ASSERT_TRUE(f2.StructureDiffers(f1));
+}
+
+TEST_F(WorldInterfaceTest, GazeboStateBatchCompare)
+{
+  std::string worldfile = "../test_worlds/cube.world";
+  int numWorlds = 3;
+  std::vector<GazeboPhysicsWorld::Ptr> worlds;
+  for (int i = 0; i < numWorlds; ++i)
+  {
+    GazeboPhysicsWorld::Ptr world(new GazeboPhysicsWorld(false, true));
+    std::stringstream worldname;
+    worldname << "cube_world_" << i;
+    ASSERT_EQ(world->LoadFromFile(worldfile, worldname.str()),
+              collision_benchmark::SUCCESS) << " Could not load world";
+    world->SetDynamicsEnabled(false);
+    worlds.push_back(world);
+  }
+
+  GazeboStateCompare::Tolerances t =
+    GazeboStateCompare::Tolerances::CreateDefault(1e-03);
+  t.CheckDynamics = false;
+  collision_benchmark::GazeboStateBatchCompare batchCompare(t);
+  collision_benchmark::GazeboStateBatchCompare::Report report;
+
+  std::vector<gazebo::physics::WorldState> states;
+  for (int i = 0; i < numWorlds; ++i)
+    states.push_back(worlds[i]->GetWorldState());
+  ASSERT_TRUE(batchCompare.Compare(states, report)) << report;
+  ASSERT_TRUE(report.Equal());
+  ASSERT_GT(batchCompare.GetNumEntities(), 0u);
+
+  // move the box in the last world
+  collision_benchmark::BasicState state;
+  state.SetPosition(0.1, 0, 0.5);
+  ASSERT_TRUE(worlds.back()->SetBasicModelState("box", state));
+  states.back() = worlds.back()->GetWorldState();
+  ASSERT_FALSE(batchCompare.Compare(states, report));
+  ASSERT_TRUE(report.structureEqual);
+  ASSERT_FALSE(report.divergences.empty());
+  for (std::vector<collision_benchmark::GazeboStateBatchCompare::Divergence>
+       ::const_iterator it = report.divergences.begin();
+       it != report.divergences.end(); ++it)
+  {
+    ASSERT_EQ(it->world, static_cast<size_t>(numWorlds - 1)) << report;
+    ASSERT_EQ(it->entity.find("box"), 0u) << "Only the box has moved";
+    ASSERT_GE(it->deviation, it->tolerance);
+  }
+
+  // comparing a world without the box fails on the structure
+  GazeboPhysicsWorld::Ptr emptyWorld(new GazeboPhysicsWorld(false, true));
+  ASSERT_EQ(emptyWorld->LoadFromFile("worlds/empty.world", "empty"),
+            collision_benchmark::SUCCESS) << " Could not load empty world";
+  states.push_back(emptyWorld->GetWorldState());
+  ASSERT_FALSE(batchCompare.Compare(states, report));
+  ASSERT_FALSE(report.structureEqual);
+  ASSERT_EQ(report.structureWorld, static_cast<size_t>(numWorlds));
+}
 
 /**
  * Tests the model loading methods of the GazeboPhysicsWorld
@@ -251,14 +628,12 @@ TEST_F(WorldInterfaceTest, GazeboModelLoading)
   SimpleTriMeshShape::MeshDataPtr meshData(new SimpleTriMeshShape::MeshDataT());
   typedef SimpleTriMeshShape::Vertex Vertex;
   typedef SimpleTriMeshShape::Face Face;
-  std::vector<Vertex>& vertices = meshData->GetVertices();
-  std::vector<Face>& triangles = meshData->GetFaces();
-  vertices.push_back(Vertex(-1, 0, 0));
-  vertices.push_back(Vertex(0, 0, -1));
-  vertices.push_back(Vertex(1, 0, 0));
-  vertices.push_back(Vertex(0, 1, 0));
-  triangles.push_back(Face(0, 1, 2));
-  triangles.push_back(Face(0, 2, 3));
+  meshData->AddVertex(Vertex(-1, 0, 0));
+  meshData->AddVertex(Vertex(0, 0, -1));
+  meshData->AddVertex(Vertex(1, 0, 0));
+  meshData->AddVertex(Vertex(0, 1, 0));
+  meshData->AddFace(Face(0, 1, 2));
+  meshData->AddFace(Face(0, 2, 3));
   Shape::Ptr shape(new SimpleTriMeshShape(meshData, "test_mesh"));
 
   shape->SetPose(Shape::Pose3(2, 2, 2, 0, 0, 0));
@@ -298,14 +673,12 @@ TEST_F(WorldInterfaceTest, GazeboWorldSaving)
   SimpleTriMeshShape::MeshDataPtr meshData(new SimpleTriMeshShape::MeshDataT());
   typedef SimpleTriMeshShape::Vertex Vertex;
   typedef SimpleTriMeshShape::Face Face;
-  std::vector<Vertex>& vertices = meshData->GetVertices();
-  std::vector<Face>& triangles = meshData->GetFaces();
-  vertices.push_back(Vertex(-1, 0, 0));
-  vertices.push_back(Vertex(0, 0, -1));
-  vertices.push_back(Vertex(1, 0, 0));
-  vertices.push_back(Vertex(0, 1, 0));
-  triangles.push_back(Face(0, 1, 2));
-  triangles.push_back(Face(0, 2, 3));
+  meshData->AddVertex(Vertex(-1, 0, 0));
+  meshData->AddVertex(Vertex(0, 0, -1));
+  meshData->AddVertex(Vertex(1, 0, 0));
+  meshData->AddVertex(Vertex(0, 1, 0));
+  meshData->AddFace(Face(0, 1, 2));
+  meshData->AddFace(Face(0, 2, 3));
   Shape::Ptr shape(new SimpleTriMeshShape(meshData, "test_mesh"));
 
   shape->SetPose(Shape::Pose3(2, 2, 2, 0, 0, 0));
@@ -358,6 +731,112 @@ TEST_F(WorldInterfaceTest, GazeboWorldSaving)
     << "Did not save mesh to '" << filename << "'";
 }
 
+/**
+ * Tests that collision meshes are served from memory and only written
+ * to file when the world is saved, while visual meshes are written to file.
+ */
+TEST_F(WorldInterfaceTest, GazeboInMemoryMesh)
+{
+  std::string worldfile = "worlds/empty.world";
+  GazeboPhysicsWorld::Ptr world(new GazeboPhysicsWorld());
+  ASSERT_EQ(world->LoadFromFile(worldfile), collision_benchmark::SUCCESS)
+    << " Could not load world";
+
+  SimpleTriMeshShape::MeshDataPtr meshData(new SimpleTriMeshShape::MeshDataT());
+  typedef SimpleTriMeshShape::Vertex Vertex;
+  typedef SimpleTriMeshShape::Face Face;
+  meshData->AddVertex(Vertex(-1, 0, 0));
+  meshData->AddVertex(Vertex(0, 0, -1));
+  meshData->AddVertex(Vertex(1, 0, 0));
+  meshData->AddVertex(Vertex(0, 1, 0));
+  meshData->AddFace(Face(0, 1, 2));
+  meshData->AddFace(Face(0, 2, 3));
+  std::string meshName = "test_in_memory_mesh";
+  Shape::Ptr shape(new SimpleTriMeshShape(meshData, meshName));
+
+  // the visual mesh file is written when adding the model
+  std::string tempOutputSubdir;
+  std::string tempOutputPath = world->GetMeshOutputPath(tempOutputSubdir);
+  boost::filesystem::path tempMeshFile =
+    boost::filesystem::path(tempOutputPath) /
+    boost::filesystem::path(tempOutputSubdir) / (meshName + ".stl");
+  boost::filesystem::remove(tempMeshFile);
+
+  GazeboPhysicsWorld::ModelLoadResult res =
+    world->AddModelFromShape("test-in-memory-shape", shape, shape);
+  ASSERT_EQ(res.opResult, collision_benchmark::SUCCESS)
+    << "Could not add test shape to world";
+  ASSERT_TRUE(boost::filesystem::exists(tempMeshFile))
+    << "Visual mesh file should have been written";
+
+  std::string uri = collision_benchmark::GazeboMeshRegistry::URI_PREFIX
+                    + meshName + "." + SimpleTriMeshShape::MESH_EXT;
+  ASSERT_TRUE(collision_benchmark::GazeboMeshRegistry::Instance().
+              IsRegistered(uri)) << "Mesh was not registered as " << uri;
+
+  // the mesh has to be loaded as collision shape
+  world->Update(1);
+  gazebo::physics::ModelPtr model =
+    world->GetWorld()->ModelByName("test-in-memory-shape");
+  ASSERT_NE(model, nullptr);
+  ASSERT_FALSE(model->GetLinks().empty());
+  ASSERT_FALSE(model->GetLinks()[0]->GetCollisions().empty());
+  ignition::math::Box bbox = model->GetLinks()[0]->GetCollisions()[0]
+                             ->BoundingBox();
+  ASSERT_NEAR(bbox.Max().X() - bbox.Min().X(), 2, 1e-03)
+    << "Mesh was not loaded from memory";
+
+  // saving the world writes the mesh file
+  boost::filesystem::path testDir = "/tmp/.gazebo/test_in_memory/";
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(testDir, ec);
+  std::string filename = testDir.string() + "/test_file.world";
+  std::string resourceDir = testDir.string() + "/models";
+  std::string resourceSubdir = "resources";
+  ASSERT_TRUE(world->SaveToFile(filename, resourceDir, resourceSubdir))
+    << "Could not save world to file";
+  boost::filesystem::path expectedMeshLocation =
+    boost::filesystem::path(resourceDir) /
+    boost::filesystem::path(resourceSubdir) / (meshName + ".stl");
+  ASSERT_TRUE(boost::filesystem::exists(expectedMeshLocation))
+    << "Did not save mesh to '" << expectedMeshLocation << "'";
+}
+
+/**
+ * Tests that the low resolution mesh made with MeshSimplifier is used
+ * as collision shape.
+ */
+TEST_F(WorldInterfaceTest, MeshLevelsOfDetail)
+{
+  typedef SimpleTriMeshShape::MeshDataT MeshDataT;
+  collision_benchmark::MeshShapeGeneratorNative<float> generator;
+  MeshDataT::Ptr sphere = generator.MakeSphere(1, 40, 40);
+  ASSERT_NE(sphere, nullptr);
+
+  // the low resolution mesh is used as collision shape
+  SimpleTriMeshShape::Ptr shape(new SimpleTriMeshShape(sphere, "lod_sphere"));
+  ASSERT_FALSE(shape->SupportLowRes());
+  ASSERT_TRUE(shape->MakeLowResMesh(0.1));
+  ASSERT_TRUE(shape->SupportLowRes());
+
+  GazeboPhysicsWorld::Ptr world(new GazeboPhysicsWorld(false, true));
+  ASSERT_EQ(world->LoadFromFile("worlds/empty.world"),
+            collision_benchmark::SUCCESS) << " Could not load world";
+  GazeboPhysicsWorld::ModelLoadResult res =
+    world->AddModelFromShape("lod-shape", shape);
+  ASSERT_EQ(res.opResult, collision_benchmark::SUCCESS)
+    << "Could not add shape to world";
+  world->Update(1);
+  gazebo::physics::ModelPtr model = world->GetWorld()->ModelByName("lod-shape");
+  ASSERT_NE(model, nullptr);
+  ASSERT_FALSE(model->GetLinks().empty());
+  ASSERT_FALSE(model->GetLinks()[0]->GetCollisions().empty());
+  ignition::math::Box bbox = model->GetLinks()[0]->GetCollisions()[0]
+                             ->BoundingBox();
+  ASSERT_NEAR(bbox.Max().X() - bbox.Min().X(), 2, 1e-03)
+    << "Low resolution collision shape has the wrong size";
+}
+
 /**
  * Tests the GetContactInfo() methods of the GazeboPhysicsWorld
  */
@@ -418,6 +897,57 @@ TEST_F(WorldInterfaceTest, GazeboContacts)
       break;
     }
   }
+
+  // the query on the interned name IDs must return the same contacts
+  std::shared_ptr<GazeboPhysicsWorld> gzWorld
+    = std::dynamic_pointer_cast<GazeboPhysicsWorld>(world);
+  ASSERT_NE(gzWorld, nullptr) << "Expecting a GazeboPhyscisWorld";
+  std::vector<GzPhysicsWorld::ContactInfoPtr> contacts =
+    world->GetContactInfo("box", "ground_plane");
+  GazeboPhysicsWorld::NameID boxID = gzWorld->GetModelNameID("box");
+  GazeboPhysicsWorld::NameID groundID =
+    gzWorld->GetModelNameID("ground_plane");
+  ASSERT_EQ(boxID, gzWorld->GetModelNameID("box"))
+    << "Model name IDs must be stable";
+  ASSERT_NE(boxID, groundID) << "Model name IDs must be unique";
+  std::vector<GazeboPhysicsWorld::IdContactInfo> idContacts;
+  gzWorld->GetContactInfo(boxID, groundID, idContacts);
+  ASSERT_EQ(idContacts.size(), contacts.size());
+  for (int i = 0; i < idContacts.size(); ++i)
+  {
+    const GazeboPhysicsWorld::IdContactInfo &idInfo = idContacts[i];
+    ASSERT_EQ(idInfo.contacts.size(), contacts[i]->contacts.size());
+    std::set<std::string> models = { contacts[i]->model1,
+                                     contacts[i]->model2 };
+    std::set<std::string> idModels = { gzWorld->GetModelName(idInfo.model1),
+                                       gzWorld->GetModelName(idInfo.model2) };
+    ASSERT_EQ(models, idModels);
+  }
+
+  // the contact buffers must hold the same contacts, also when re-used
+  GzPhysicsWorld::ContactBuffer buffer;
+  GazeboPhysicsWorld::IdContactBuffer idBuffer;
+  for (int k = 0; k < 2; ++k)
+  {
+    world->GetContactInfo("box", "ground_plane", buffer);
+    gzWorld->GetContactInfo(boxID, groundID, idBuffer);
+    ASSERT_EQ(buffer.NumPairs(), contacts.size());
+    ASSERT_EQ(idBuffer.NumPairs(), contacts.size());
+    for (int i = 0; i < contacts.size(); ++i)
+    {
+      ASSERT_EQ(buffer.model1[i], contacts[i]->model1);
+      ASSERT_EQ(buffer.model2[i], contacts[i]->model2);
+      ASSERT_EQ(buffer.NumContacts(i), contacts[i]->contacts.size());
+      ASSERT_EQ(idBuffer.NumContacts(i), contacts[i]->contacts.size());
+      for (int j = 0; j < contacts[i]->contacts.size(); ++j)
+      {
+        const std::size_t cIdx = buffer.pairBegin[i] + j;
+        ASSERT_EQ(buffer.pairIndices[cIdx], i);
+        ASSERT_EQ(buffer.positions[cIdx], contacts[i]->contacts[j].position);
+        ASSERT_DOUBLE_EQ(buffer.depths[cIdx], contacts[i]->contacts[j].depth);
+      }
+    }
+  }
 }
 
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2012-2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <collision_benchmark/MeshShapeGeneratorNative.hh>
+#ifdef HAVE_VTK
+#include <collision_benchmark/MeshShapeGeneratorVtk.hh>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+typedef collision_benchmark::MeshShapeGenerator<double> Generator;
+
+/////////////////////////////////////////////////
+// \brief Makes shape number \e shape with \e generator
+// \param[in] res resolution of the curved shapes
+// \param[out] name name of the shape
+Generator::TriMeshDataPtr MakeShape(const Generator &generator,
+                                    const int shape,
+                                    const unsigned int res,
+                                    std::string &name)
+{
+  switch (shape)
+  {
+    case 0: name = "sphere";
+      return generator.MakeSphere(1, res, res, true);
+    case 1: name = "cylinder";
+      return generator.MakeCylinder(1, 2, res, true);
+    case 2: name = "box";
+      return generator.MakeBox(1, 2, 3);
+    case 3: name = "cone";
+      return generator.MakeCone(1, 2, res, 30, true);
+    case 4: name = "disk";
+      return generator.MakeDisk(0.5, 1, res, res);
+    case 5: name = "ellipsoid";
+      return generator.MakeEllipsoid(1, 2, 3, res, res);
+    case 6: name = "torus";
+      return generator.MakeTorus(2, 0.5, res, res);
+    default: return Generator::TriMeshDataPtr();
+  }
+}
+
+/////////////////////////////////////////////////
+// \brief Generates each shape \e repetitions times with \e generator and
+// prints the average time and size of the meshes.
+void Run(const std::string &generatorName, const Generator &generator,
+         const int repetitions, const unsigned int res)
+{
+  std::cout << "Generator: " << generatorName << std::endl;
+  std::string name;
+  for (int shape = 0; MakeShape(generator, shape, res, name); ++shape)
+  {
+    std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+    Generator::TriMeshDataPtr mesh;
+    for (int i = 0; i < repetitions; ++i)
+      mesh = MakeShape(generator, shape, res, name);
+    double us = std::chrono::duration<double, std::micro>
+      (std::chrono::steady_clock::now() - start).count() / repetitions;
+    std::cout << "  " << std::setw(10) << std::left << name
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << us << " us  "
+              << std::setw(8) << mesh->GetNumVertices() << " vertices "
+              << std::setw(8) << mesh->GetNumFaces() << " faces" << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if ((argc > 1 && std::string(argv[1]) == "-h") || argc > 3)
+  {
+    std::cout << "Compares the mesh generation backends." << std::endl
+              << argv[0] << " [repetitions (default 100)] "
+              << "[resolution (default 64)]" << std::endl;
+    return 1;
+  }
+  const int repetitions = argc > 1 ? std::max(1, atoi(argv[1])) : 100;
+  const unsigned int res = argc > 2 ? std::max(3, atoi(argv[2])) : 64;
+  std::cout << "Average time of " << repetitions << " repetitions, "
+            << "resolution " << res << std::endl;
+
+  Run("native", collision_benchmark::MeshShapeGeneratorNative<double>(),
+      repetitions, res);
+#ifdef HAVE_VTK
+  Run("vtk", collision_benchmark::MeshShapeGeneratorVtk<double>(),
+      repetitions, res);
+#else
+  std::cout << "Built without VTK, can't compare to MeshShapeGeneratorVtk"
+            << std::endl;
+#endif
+  return 0;
+}